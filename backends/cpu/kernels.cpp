@@ -0,0 +1,175 @@
+/// @file kernels.cpp
+/// @brief Per-isa instantiations of the CPU path tracer kernels.
+
+#include "backends/cpu/kernels.hpp"
+
+#include <quasi/io/tonemap.hpp>
+#include <quasi/math/half.hpp>
+#include <quasi/scene/sampling.hpp>
+
+#include <cmath>
+#include <type_traits>
+#include <variant>
+
+namespace Q::cpu {
+
+namespace {
+
+// ============================================================================
+// Kernel Bodies
+// ============================================================================
+
+namespace body {
+
+/// @brief Ray-quad distance, or infinity. Same test as scene::intersect
+///        without building a hit record, so it stays branch-light.
+inline float intersect_quad(const math::ray& r, const scene::quad& q, float t_min, float t_max) {
+    math::vec3 n = math::cross(q.u, q.v);
+    float area_sq = math::length_squared(n);
+    float denom = math::dot(n, r.direction);
+    float t = math::dot(n, q.origin - r.origin) / denom;
+
+    math::vec3 planar = r.at(t) - q.origin;
+    math::vec3 w = n / area_sq;
+    float alpha = math::dot(w, math::cross(planar, q.v));
+    float beta  = math::dot(w, math::cross(q.u, planar));
+
+    // n is unnormalized, so the parallel test scales by |n|.
+    bool hit = (area_sq >= 1e-8f) & (std::abs(denom) >= 1e-8f * std::sqrt(area_sq)) &
+               (t >= t_min) & (t <= t_max) &
+               (alpha >= 0.0f) & (alpha <= 1.0f) & (beta >= 0.0f) & (beta <= 1.0f);
+    return hit ? t : INFINITY;
+}
+
+template <bool Instrumented, typename Tree>
+inline void intersect_impl(const Tree& tree, std::span<const scene::quad> quads,
+                           std::span<const math::ray> rays, std::span<ray_hit> hits,
+                           [[maybe_unused]] std::span<accel::traversal_stats> stats) {
+    for (size_t i = 0; i < rays.size(); ++i) {
+        const math::ray& r = rays[i];
+        ray_hit best{1e30f, k_no_hit};
+        auto test = [&](uint32_t prim, float& t_max) {
+            float t = intersect_quad(r, quads[prim], 0.001f, t_max);
+            if (t < t_max) {
+                t_max = t;
+                best.prim = prim;
+                return true;
+            }
+            return false;
+        };
+        if constexpr (Instrumented) {
+            stats[i] = {};
+        }
+        if constexpr (Instrumented && std::is_same_v<Tree, accel::bvh>) {
+            tree.intersect_instrumented(r, best.t, test, stats[i]);
+        } else {
+            tree.intersect(r, best.t, test);
+        }
+        hits[i] = best;
+    }
+}
+
+/// @brief Runs the batch loop instantiated for the scene's structure.
+template <bool Instrumented>
+inline void intersect_impl(const scene_view& scene, std::span<const math::ray> rays,
+                           std::span<ray_hit> hits, std::span<accel::traversal_stats> stats) {
+    std::visit([&](const auto* tree) {
+        intersect_impl<Instrumented>(*tree, scene.quads, rays, hits, stats);
+    }, scene.tree);
+}
+
+inline void intersect(const scene_view& scene, std::span<const math::ray> rays,
+                      std::span<ray_hit> hits) {
+    intersect_impl<false>(scene, rays, hits, {});
+}
+
+inline void intersect_instrumented(const scene_view& scene, std::span<const math::ray> rays,
+                                   std::span<ray_hit> hits, std::span<accel::traversal_stats> stats) {
+    intersect_impl<true>(scene, rays, hits, stats);
+}
+
+inline void sample_hemisphere(std::span<const math::vec3> normals, std::span<const float> u1,
+                              std::span<const float> u2, std::span<math::vec3> out) {
+    scene::cosine_sample_hemisphere(normals, u1, u2, out);
+}
+
+inline void accumulate(std::span<float> accum, std::span<const float> sample,
+                       uint32_t frame_count) {
+    float weight = 1.0f / static_cast<float>(frame_count + 1);
+    for (size_t i = 0; i < accum.size(); ++i) {
+        accum[i] += (sample[i] - accum[i]) * weight;
+    }
+}
+
+inline void to_half(std::span<const float> in, std::span<uint16_t> out) {
+    math::to_half(in, out);
+}
+
+inline void tonemap(std::span<float> rgba) {
+    io::tonemap_reinhard(rgba);
+}
+
+}  // namespace body
+
+// ============================================================================
+// Per-ISA Tables
+// ============================================================================
+
+/// Defines namespace @p ns holding wrappers of every body compiled with
+/// @p attr, plus their table.
+#define Q_CPU_KERNEL_TABLE(ns, attr)                                                           \
+    namespace ns {                                                                             \
+    attr void intersect(const scene_view& scene, std::span<const math::ray> rays,              \
+                        std::span<ray_hit> hits) {                                             \
+        body::intersect(scene, rays, hits);                                                    \
+    }                                                                                          \
+    attr void intersect_instrumented(const scene_view& scene, std::span<const math::ray> rays, \
+                                     std::span<ray_hit> hits,                                  \
+                                     std::span<accel::traversal_stats> stats) {                \
+        body::intersect_instrumented(scene, rays, hits, stats);                                \
+    }                                                                                          \
+    attr void sample_hemisphere(std::span<const math::vec3> normals, std::span<const float> u1, \
+                                std::span<const float> u2, std::span<math::vec3> out) {        \
+        body::sample_hemisphere(normals, u1, u2, out);                                         \
+    }                                                                                          \
+    attr void accumulate(std::span<float> accum, std::span<const float> sample,                \
+                         uint32_t frame_count) {                                               \
+        body::accumulate(accum, sample, frame_count);                                          \
+    }                                                                                          \
+    attr void to_half(std::span<const float> in, std::span<uint16_t> out) {                    \
+        body::to_half(in, out);                                                                \
+    }                                                                                          \
+    attr void tonemap(std::span<float> rgba) {                                                 \
+        body::tonemap(rgba);                                                                   \
+    }                                                                                          \
+    constexpr kernel_table table{intersect, intersect_instrumented, sample_hemisphere,         \
+                                 accumulate, to_half, tonemap};                                \
+    }
+
+Q_CPU_KERNEL_TABLE(scalar, Q_TARGET_SCALAR)
+
+#if defined(Q_HAS_ISA_DISPATCH)
+Q_CPU_KERNEL_TABLE(sse4_2, Q_TARGET_SSE4_2)
+Q_CPU_KERNEL_TABLE(avx2, Q_TARGET_AVX2)
+Q_CPU_KERNEL_TABLE(avx512, Q_TARGET_AVX512)
+#endif
+
+#undef Q_CPU_KERNEL_TABLE
+
+}  // namespace
+
+const platform::kernel_registry<kernel_table>& kernel_registry() {
+    static const auto registry = [] {
+        platform::kernel_registry<kernel_table> r;
+        r.add(platform::isa::scalar, scalar::table);
+#if defined(Q_HAS_ISA_DISPATCH)
+        r.add(platform::isa::sse4_2, sse4_2::table);
+        r.add(platform::isa::avx2, avx2::table);
+        r.add(platform::isa::avx512, avx512::table);
+#endif
+        return r;
+    }();
+    return registry;
+}
+
+}  // namespace Q::cpu
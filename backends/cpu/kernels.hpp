@@ -0,0 +1,73 @@
+/// @file kernels.hpp
+/// @brief Hot loops of the CPU path tracer, compiled once per isa level.
+///
+/// Every kernel works on a batch so its loop can vectorize. kernels.cpp
+/// instantiates the same bodies for each isa level of this build; the
+/// plugin selects a table at create time (see Q::platform::kernel_registry).
+
+#pragma once
+
+#include <quasi/accel/bvh.hpp>
+#include <quasi/accel/layout.hpp>
+#include <quasi/accel/lazy_bvh.hpp>
+#include <quasi/math/ray.hpp>
+#include <quasi/math/vec.hpp>
+#include <quasi/platform/kernel_registry.hpp>
+#include <quasi/scene/quad.hpp>
+
+#include <cstdint>
+#include <span>
+#include <variant>
+
+namespace Q::cpu {
+
+/// @brief Primitive id of a ray that hit nothing.
+inline constexpr uint32_t k_no_hit = 0xFFFFFFFFu;
+
+/// @brief Acceleration structure the intersection kernel traverses.
+using accel_tree = std::variant<const accel::bvh*, const accel::ordered_bvh*, const accel::lazy_bvh*>;
+
+/// @brief Geometry the intersection kernel traces against.
+struct scene_view {
+    accel_tree                   tree;  ///< Structure over @p quads.
+    std::span<const scene::quad> quads;
+};
+
+/// @brief Closest hit of one ray.
+struct ray_hit {
+    float    t    = 0.0f;      ///< Hit distance; undefined on a miss.
+    uint32_t prim = k_no_hit;  ///< Index into scene_view::quads, or k_no_hit.
+};
+
+/// @brief One isa level's build of every hot kernel.
+struct kernel_table {
+    /// @brief Finds the closest quad hit of each ray.
+    void (*intersect)(const scene_view& scene, std::span<const math::ray> rays,
+                      std::span<ray_hit> hits);
+
+    /// @brief As intersect, also storing each ray's BVH work in @p stats.
+    ///
+    /// Used only by builds with Q_TRAVERSAL_STATS; intersect stays uninstrumented.
+    /// Only accel::bvh counts its work; other structures leave @p stats zero.
+    void (*intersect_instrumented)(const scene_view& scene, std::span<const math::ray> rays,
+                                   std::span<ray_hit> hits, std::span<accel::traversal_stats> stats);
+
+    /// @brief Draws cosine-weighted bounce directions (scene::cosine_sample_hemisphere).
+    void (*sample_hemisphere)(std::span<const math::vec3> normals, std::span<const float> u1,
+                              std::span<const float> u2, std::span<math::vec3> out);
+
+    /// @brief Folds a new sample into a running mean: accum += (sample - accum) / (n + 1).
+    void (*accumulate)(std::span<float> accum, std::span<const float> sample,
+                       uint32_t frame_count);
+
+    /// @brief Converts floats to binary16 (math::to_half).
+    void (*to_half)(std::span<const float> in, std::span<uint16_t> out);
+
+    /// @brief Reinhard tonemap and display gamma, in place (io::tonemap_reinhard).
+    void (*tonemap)(std::span<float> rgba);
+};
+
+/// @brief Returns the kernel tables compiled into this library.
+[[nodiscard]] const platform::kernel_registry<kernel_table>& kernel_registry();
+
+}  // namespace Q::cpu
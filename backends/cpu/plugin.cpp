@@ -0,0 +1,948 @@
+/// @file plugin.cpp
+/// @brief CPU backend - Cornell Box path tracer.
+///
+/// Mirrors the Metal backend's shader on the CPU, one image row at a time
+/// as a wavefront: each bounce gathers the live paths, runs the batch
+/// kernels from kernels.hpp over them, then shades. The kernel table is
+/// chosen for the host CPU at create time; set Q_ISA to force a lower
+/// level for benchmarking.
+///
+/// Rows are spread over the host's job system (Q_plugin_context::jobs).
+/// Hosts without one get a private pool with one pinned worker per
+/// physical core within the process's CPU quota. Either way each L3 domain
+/// traces a contiguous band of rows.
+///
+/// When the host profiles (Q_plugin_context::profiler), each row and the
+/// accumulate and present stages are recorded as "cpu.*" scopes.
+///
+/// The acceleration structure is chosen at create time from Q_ACCEL:
+/// "bvh" (default), "sbvh" (spatial splits, clipping the large walls),
+/// "ordered" (the bvh reordered depth-first into hot and cold nodes) or
+/// "lazy" (lazy_bvh, split on first traversal). The traversal heat map
+/// only counts work through "bvh" and "sbvh".
+///
+/// The scene BVH is kept in the host cache (Q_plugin_context::cache) when
+/// there is one, keyed by the primitive bounds, so a reloaded plugin
+/// reuses the tree instead of building it again.
+///
+/// The plugin advertises Q_CAPABILITY_ROW_BANDS: a frame may cover only
+/// rows [row_begin, row_end), and each row keeps its own sample count, so a
+/// host can split frames across several backends. A nonzero
+/// Q_render_frame::sample_salt is hashed into each pixel seed, so salted
+/// renders draw independent sequences; a full frame with salt 0 renders
+/// exactly as before. Each render reports the samples it added and whether
+/// it restarted accumulation (Q_render_frame::samples_added and
+/// accumulation_reset).
+///
+/// Bounce depth, the Russian roulette start, samples per frame and
+/// exposure are parameters (Q_plugin_params) the host may change between
+/// frames; changing the first two restarts accumulation.
+///
+/// Built with Q_TRAVERSAL_STATS (bazel --config=traversal_stats), the
+/// tracer also counts BVH nodes visited, primitives tested and segments
+/// traced per pixel, exports them as the Q_AOV_TRAVERSAL heat map and logs
+/// their histograms at AOV readback. Without it none of that code exists.
+
+#include "backends/cpu/kernels.hpp"
+
+#include <quasi/accel/layout.hpp>
+#include <quasi/accel/lazy_bvh.hpp>
+#include <quasi/accel/sbvh.hpp>
+#include <quasi/async/thread_pool.hpp>
+#include <quasi/plugin/plugin_interface.hpp>
+#include <quasi/gpu/types.hpp>
+#include <quasi/math/octahedral.hpp>
+#include <quasi/platform.hpp>
+#include <quasi/platform/cpu_features.hpp>
+#include <quasi/platform/kernel_registry.hpp>
+#include <quasi/platform/topology.hpp>
+#include <quasi/profile/histogram.hpp>
+#include <quasi/scene/cornell_box.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr const char* NAME        = "CPU Path Tracer";
+constexpr const char* DESCRIPTION = "Cornell Box path tracer with multi-ISA CPU kernels";
+constexpr const char* AUTHOR      = "Quasi";
+
+constexpr uint32_t DEFAULT_MAX_BOUNCES = 5;
+constexpr uint32_t DEFAULT_RR_START    = 3;
+
+/// @brief Indices into PARAMS.
+enum param_index : uint32_t {
+    PARAM_MAX_BOUNCES,
+    PARAM_RR_START,
+    PARAM_SAMPLES_PER_FRAME,
+    PARAM_EXPOSURE,
+    PARAM_COUNT,
+};
+
+constexpr Q_param_desc PARAMS[PARAM_COUNT] = {
+    {"max_bounces", "Longest path, in bounces.", Q_PARAM_INT, DEFAULT_MAX_BOUNCES, 1, 16},
+    {"rr_start_bounce", "First bounce that may end by Russian roulette.", Q_PARAM_INT, DEFAULT_RR_START, 0, 16},
+    {"samples_per_frame", "Samples per pixel traced each frame.", Q_PARAM_INT, 1, 1, 64},
+    {"exposure", "Scale applied before tonemapping the presented image.", Q_PARAM_FLOAT, 1.0, 0.01, 100.0},
+};
+
+/// @brief Environment variable naming the acceleration structure.
+constexpr const char* k_accel_env_var = "Q_ACCEL";
+
+/// @brief Acceleration structures the tracer can traverse.
+enum class accel_structure {
+    bvh,      ///< Binned SAH BVH, built in full at create.
+    sbvh,     ///< BVH with spatial splits; straddling quads are clipped.
+    ordered,  ///< The SAH BVH in depth-first order, split into hot and cold nodes.
+    lazy,     ///< SAH BVH whose subtrees are split on first traversal.
+};
+
+constexpr const char* to_string(accel_structure structure) {
+    switch (structure) {
+        case accel_structure::bvh:     return "bvh";
+        case accel_structure::sbvh:    return "sbvh";
+        case accel_structure::ordered: return "ordered";
+        case accel_structure::lazy:    return "lazy";
+    }
+    return "unknown";
+}
+
+std::optional<accel_structure> parse_accel_structure(std::string_view name) {
+    for (auto structure : {accel_structure::bvh, accel_structure::sbvh, accel_structure::ordered,
+                           accel_structure::lazy}) {
+        if (name == to_string(structure)) {
+            return structure;
+        }
+    }
+    return std::nullopt;
+}
+
+#if defined(Q_TRAVERSAL_STATS)
+constexpr bool k_traversal_stats = true;
+#else
+constexpr bool k_traversal_stats = false;
+#endif
+
+/// @brief Distributions behind the traversal heat map, per worker.
+struct traversal_histograms {
+    Q::profile::histogram nodes;     // BVH nodes visited per ray.
+    Q::profile::histogram prims;     // Primitives tested per ray.
+    Q::profile::histogram segments;  // Rays traced per path.
+
+    void merge(const traversal_histograms& other) {
+        nodes.merge(other.nodes);
+        prims.merge(other.prims);
+        segments.merge(other.segments);
+    }
+};
+
+/// @brief Per-path state of one row's wavefront.
+struct path_batch {
+    std::vector<Q::math::ray>  rays;        // Gathered rays of live paths.
+    std::vector<Q::cpu::ray_hit> hits;
+    std::vector<uint32_t>      live;        // Pixel x of each live path.
+    std::vector<Q::math::vec3> normals;     // Bounce normals of live paths.
+    std::vector<float>         u1;
+    std::vector<float>         u2;
+    std::vector<Q::math::vec3> directions;
+
+    // Indexed by pixel x.
+    std::vector<Q::math::ray>  path_ray;
+    std::vector<Q::math::vec3> throughput;
+    std::vector<Q::math::vec3> radiance;
+    std::vector<uint32_t>      rng;
+
+    // Traversal statistics; left empty unless k_traversal_stats.
+    std::vector<Q::accel::traversal_stats> ray_stats;      // Per live ray.
+    std::vector<Q::accel::traversal_stats> path_stats;     // Indexed by pixel x.
+    traversal_histograms                   histograms;
+
+    void resize(uint32_t width) {
+        for (auto* v : {&rays, &path_ray}) v->resize(width);
+        for (auto* v : {&normals, &directions, &throughput, &radiance}) v->resize(width);
+        for (auto* v : {&u1, &u2}) v->resize(width);
+        for (auto* v : {&live, &rng}) v->resize(width);
+        hits.resize(width);
+        if constexpr (k_traversal_stats) {
+            ray_stats.resize(width);
+            path_stats.resize(width);
+        }
+    }
+};
+
+struct plugin_state {
+    Q_plugin_context* context = nullptr;
+
+    const Q::cpu::kernel_table* kernels = nullptr;
+    Q::platform::isa            kernel_isa = Q::platform::isa::scalar;
+
+    Q::scene::cornell_box_scene scene;
+    std::vector<Q::scene::quad> quads;
+    accel_structure             structure = accel_structure::bvh;
+    Q::accel::bvh               tree;          // structure == bvh or sbvh.
+    Q::accel::ordered_bvh       ordered_tree;  // structure == ordered.
+    Q::accel::lazy_bvh          lazy_tree;     // structure == lazy.
+    Q::cpu::accel_tree          traced;        // Whichever of the above is in use.
+
+    // Current frame's samples, RGBA32F (normals as unpacked xyz).
+    std::vector<float> beauty_sample;
+    std::vector<float> albedo_sample;
+    std::vector<float> normal_sample;
+    std::vector<float> depth_sample;
+
+    // Progressive averages, same layout.
+    std::vector<float> beauty_accum;
+    std::vector<float> albedo_accum;
+    std::vector<float> normal_accum;
+    std::vector<float> depth_accum;
+
+    std::vector<float> display;  // Tonemap scratch for presentation.
+
+    std::vector<uint32_t> row_samples;  // Samples accumulated in each row.
+
+    // Traversal heat map (k_traversal_stats only), same layout.
+    std::vector<float> traversal_sample;
+    std::vector<float> traversal_accum;
+
+    Q_profiler*                            profiler = nullptr;  // Host profiler, if profiling.
+    Q_job_system*                          jobs = nullptr;  // Host job system, if any.
+    std::unique_ptr<Q::async::thread_pool> pool;            // Fallback without one.
+    std::vector<path_batch>                batches;         // One per worker.
+
+    // Host-set parameters (PARAMS).
+    uint32_t max_bounces       = DEFAULT_MAX_BOUNCES;
+    uint32_t rr_start          = DEFAULT_RR_START;
+    uint32_t samples_per_frame = 1;
+    float    exposure          = 1.0f;
+    bool     reset_pending     = false;  // A parameter change invalidated the accumulation.
+
+    bool     present = false;  // Write tonemapped RGBA16F into frame->drawable.
+    uint32_t frame_count = 0;
+    uint32_t salt_hash = 0;  // pcg_hash of the current frame's sample_salt; 0 for no salt.
+    uint32_t last_width = 0;
+    uint32_t last_height = 0;
+};
+
+void log_msg(plugin_state* state, const char* msg) {
+    if (state->context && state->context->log) {
+        state->context->log(state->context->host_data, msg);
+    }
+}
+
+/// @brief Records a stage in the host profiler for the enclosing scope.
+class stage_scope {
+public:
+    stage_scope(const plugin_state* state, const char* name) : profiler_{state->profiler} {
+        if (profiler_) profiler_->begin(profiler_->host_data, name);
+    }
+    ~stage_scope() {
+        if (profiler_) profiler_->end(profiler_->host_data);
+    }
+    stage_scope(const stage_scope&) = delete;
+    stage_scope& operator=(const stage_scope&) = delete;
+
+private:
+    Q_profiler* profiler_;
+};
+
+// ----- Random Number Generation (PCG, matches the Metal shader) -----
+
+uint32_t pcg_hash(uint32_t input) {
+    uint32_t state = input * 747796405u + 2891336453u;
+    uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+float random_float(uint32_t& state) {
+    state = pcg_hash(state);
+    return static_cast<float>(state) / static_cast<float>(0xFFFFFFFFu);
+}
+
+float max_component(Q::math::vec3 v) {
+    return std::max(v.x, std::max(v.y, v.z));
+}
+
+void create_buffers(plugin_state* state, uint32_t width, uint32_t height) {
+    size_t size = size_t{width} * height * 4;
+    for (auto* buffer : {&state->beauty_sample, &state->albedo_sample, &state->normal_sample,
+                         &state->depth_sample, &state->beauty_accum, &state->albedo_accum,
+                         &state->normal_accum, &state->depth_accum, &state->display}) {
+        buffer->assign(size, 0.0f);
+    }
+    if constexpr (k_traversal_stats) {
+        state->traversal_sample.assign(size, 0.0f);
+        state->traversal_accum.assign(size, 0.0f);
+    }
+    state->row_samples.assign(height, 0);
+    for (auto& batch : state->batches) {
+        batch.resize(width);
+    }
+
+    state->last_width = width;
+    state->last_height = height;
+    state->frame_count = 0;
+}
+
+/// @brief Path traces one sample per pixel for image row @p y (0 = top).
+/// @param b The calling worker's scratch.
+void trace_row(plugin_state* state, path_batch& b, const Q::scene::camera& cam, uint32_t y) {
+    stage_scope stage{state, "cpu.trace_row"};
+    using Q::math::vec3;
+
+    const Q::cpu::kernel_table& k = *state->kernels;
+    const Q::cpu::scene_view view{state->traced, state->quads};
+
+    uint32_t width = state->last_width;
+    uint32_t height = state->last_height;
+    size_t row = size_t{y} * width * 4;
+
+    for (uint32_t x = 0; x < width; ++x) {
+        uint32_t& rng = b.rng[x];
+        rng = pcg_hash(x + y * 1920u + state->row_samples[y] * 1920u * 1080u);
+        if (state->salt_hash != 0) {
+            rng = pcg_hash(rng ^ state->salt_hash);
+        }
+
+        // Jitter for anti-aliasing (same scale as the shader).
+        float ju = random_float(rng) - 0.5f;
+        float jv = random_float(rng) - 0.5f;
+        float u = (static_cast<float>(x) + 0.5f) / static_cast<float>(width) + ju * 0.001f;
+        float v = 1.0f - (static_cast<float>(y) + 0.5f) / static_cast<float>(height) + jv * 0.001f;
+
+        b.path_ray[x] = cam.get_ray(u, v);
+        b.throughput[x] = vec3{1.0f};
+        b.radiance[x] = vec3{0.0f};
+        b.live[x] = x;
+
+        float* albedo = &state->albedo_sample[row + x * 4];
+        float* normal = &state->normal_sample[row + x * 4];
+        float* depth  = &state->depth_sample[row + x * 4];
+        std::fill_n(albedo, 3, 0.0f);
+        std::fill_n(normal, 3, 0.0f);
+        std::fill_n(depth, 3, 0.0f);
+        albedo[3] = normal[3] = depth[3] = 1.0f;
+
+        if constexpr (k_traversal_stats) {
+            b.path_stats[x] = {};
+        }
+    }
+
+    uint32_t live_count = width;
+    for (uint32_t bounce = 0; bounce < state->max_bounces && live_count > 0; ++bounce) {
+        for (uint32_t i = 0; i < live_count; ++i) {
+            b.rays[i] = b.path_ray[b.live[i]];
+        }
+        if constexpr (k_traversal_stats) {
+            k.intersect_instrumented(view, std::span{b.rays}.first(live_count),
+                                     std::span{b.hits}.first(live_count),
+                                     std::span{b.ray_stats}.first(live_count));
+            for (uint32_t i = 0; i < live_count; ++i) {
+                const auto& ray = b.ray_stats[i];
+                b.path_stats[b.live[i]] += ray;
+                b.histograms.nodes.add(ray.nodes_visited);
+                b.histograms.prims.add(ray.prims_tested);
+            }
+        } else {
+            k.intersect(view, std::span{b.rays}.first(live_count), std::span{b.hits}.first(live_count));
+        }
+
+        uint32_t next_count = 0;
+        for (uint32_t i = 0; i < live_count; ++i) {
+            uint32_t x = b.live[i];
+            const Q::cpu::ray_hit& hit = b.hits[i];
+            if (hit.prim == Q::cpu::k_no_hit) {
+                continue;
+            }
+
+            const Q::math::ray& r = b.rays[i];
+            const auto& obj = state->scene.quads[hit.prim];
+            vec3 n = obj.geometry.normal();
+            if (Q::math::dot(n, r.direction) > 0.0f) {
+                n = -n;
+            }
+
+            // Capture AOV data on first hit.
+            if (bounce == 0) {
+                vec3 albedo = max_component(obj.mat.emission) > 0.1f ? obj.mat.emission : obj.mat.albedo;
+                float norm_depth = std::clamp((hit.t - 1.0f) / 4.0f, 0.0f, 1.0f);
+                float* a = &state->albedo_sample[row + x * 4];
+                float* nn = &state->normal_sample[row + x * 4];
+                float* d = &state->depth_sample[row + x * 4];
+                a[0] = albedo.x; a[1] = albedo.y; a[2] = albedo.z;
+                nn[0] = n.x; nn[1] = n.y; nn[2] = n.z;
+                d[0] = d[1] = d[2] = norm_depth;
+            }
+
+            // Add emission; stop at lights.
+            b.radiance[x] += b.throughput[x] * obj.mat.emission;
+            if (max_component(obj.mat.emission) > 0.1f) {
+                continue;
+            }
+
+            b.throughput[x] = b.throughput[x] * obj.mat.albedo;
+
+            // Russian roulette after a few bounces.
+            if (bounce >= state->rr_start) {
+                float p = std::max(0.05f, max_component(b.throughput[x]));
+                if (random_float(b.rng[x]) > p) {
+                    continue;
+                }
+                b.throughput[x] /= p;
+            }
+
+            b.path_ray[x].origin = r.at(hit.t) + n * 0.001f;
+            b.normals[next_count] = n;
+            b.u1[next_count] = random_float(b.rng[x]);
+            b.u2[next_count] = random_float(b.rng[x]);
+            b.live[next_count++] = x;
+        }
+
+        k.sample_hemisphere(std::span{b.normals}.first(next_count),
+                            std::span{b.u1}.first(next_count),
+                            std::span{b.u2}.first(next_count),
+                            std::span{b.directions}.first(next_count));
+        for (uint32_t i = 0; i < next_count; ++i) {
+            b.path_ray[b.live[i]].direction = b.directions[i];
+        }
+        live_count = next_count;
+    }
+
+    for (uint32_t x = 0; x < width; ++x) {
+        float* out = &state->beauty_sample[row + x * 4];
+        out[0] = b.radiance[x].x;
+        out[1] = b.radiance[x].y;
+        out[2] = b.radiance[x].z;
+        out[3] = 1.0f;
+    }
+
+    if constexpr (k_traversal_stats) {
+        for (uint32_t x = 0; x < width; ++x) {
+            float* out = &state->traversal_sample[row + x * 4];
+            const auto& path = b.path_stats[x];
+            out[0] = static_cast<float>(path.nodes_visited);
+            out[1] = static_cast<float>(path.prims_tested);
+            out[2] = static_cast<float>(path.rays);
+            out[3] = 1.0f;
+            b.histograms.segments.add(path.rays);
+        }
+    }
+}
+
+/// @brief Traces rows [first, last) on the host's workers, or the fallback pool.
+void trace_rows(plugin_state* state, const Q::scene::camera& cam, uint32_t first, uint32_t last) {
+    struct rows_job {
+        plugin_state*           state;
+        const Q::scene::camera* cam;
+        uint32_t                first;
+    } job{state, &cam, first};
+
+    if (state->jobs) {
+        state->jobs->parallel_for(
+            state->jobs->host_data, last - first, 1,
+            [](void* user, uint32_t begin, uint32_t end, uint32_t worker) {
+                auto* j = static_cast<rows_job*>(user);
+                for (uint32_t y = begin; y < end; ++y) {
+                    trace_row(j->state, j->state->batches[worker], *j->cam, j->first + y);
+                }
+            },
+            &job);
+        return;
+    }
+    state->pool->parallel_for(last - first, [&](uint32_t y, uint32_t worker) {
+        trace_row(state, state->batches[worker], cam, first + y);
+    });
+}
+
+/// @brief Averages rows [first, last) of @p sample into @p accum.
+///
+/// Rows are weighted by their own sample counts. Consecutive rows with the
+/// same count, which is every row of an unsplit frame, go to the kernel in
+/// one call.
+void accumulate_rows(const plugin_state* state, std::vector<float>& accum, const std::vector<float>& sample,
+                     uint32_t first, uint32_t last) {
+    const Q::cpu::kernel_table& k = *state->kernels;
+    size_t row_floats = size_t{state->last_width} * 4;
+    for (uint32_t y = first; y < last;) {
+        uint32_t count = state->row_samples[y];
+        uint32_t run = y + 1;
+        while (run < last && state->row_samples[run] == count) {
+            ++run;
+        }
+        size_t offset = y * row_floats;
+        size_t size = (run - y) * row_floats;
+        k.accumulate(std::span{accum}.subspan(offset, size), std::span{sample}.subspan(offset, size), count);
+        y = run;
+    }
+}
+
+/// @brief Checks that a cached tree only refers to its own nodes and to the scene's primitives.
+///
+/// Interior nodes must point past themselves at a child pair inside the
+/// array, every node must be reached once and no deeper than traversal's
+/// stack allows, leaf ranges must lie inside the index array, and every
+/// index must name a primitive. Indices may repeat (spatial splits
+/// reference a primitive from several leaves).
+bool valid_bvh(std::span<const Q::accel::bvh_node> nodes, std::span<const uint32_t> indices, size_t prim_count) {
+    if (nodes.empty()) {
+        return false;
+    }
+    for (uint32_t index : indices) {
+        if (index >= prim_count) {
+            return false;
+        }
+    }
+    std::vector<uint8_t> seen(nodes.size(), 0);
+    std::vector<std::pair<uint32_t, uint32_t>> stack{{0u, 0u}};  // Node, depth.
+    while (!stack.empty()) {
+        auto [i, depth] = stack.back();
+        stack.pop_back();
+        if (seen[i]) {
+            return false;
+        }
+        seen[i] = 1;
+        const auto& node = nodes[i];
+        if (node.is_leaf()) {
+            if (node.offset > indices.size() || node.count > indices.size() - node.offset) {
+                return false;
+            }
+            continue;
+        }
+        if (node.offset <= i || node.offset >= nodes.size() - 1 || depth >= Q::accel::k_max_depth) {
+            return false;
+        }
+        stack.push_back({node.offset, depth + 1});
+        stack.push_back({node.offset + 1, depth + 1});
+    }
+    return true;
+}
+
+/// @brief Builds the scene BVH, or takes the one the host cached for the same input.
+/// @param spatial Build with spatial splits (accel_structure::sbvh).
+///
+/// Cached layout: u32 node count | u32 index count | bvh_node[] | u32[].
+/// A cached tree that fails valid_bvh() is rebuilt and replaced.
+Q::accel::bvh build_bvh(plugin_state* state, std::span<const Q::math::aabb> bounds, bool spatial) {
+    Q::accel::sbvh_options options;
+    auto build = [&] {
+        if (!spatial) {
+            return Q::accel::bvh::build(bounds, options.build);
+        }
+        return Q::accel::build_sbvh(bounds, [&](uint32_t prim, int axis, float lo, float hi) {
+            return state->quads[prim].clipped_bounds(axis, lo, hi);
+        }, options);
+    };
+
+    Q_cache* cache = state->context->cache;
+    if (!cache || !cache->get || !cache->put) {
+        return build();
+    }
+
+    // Everything the tree depends on: layout version (bump it when the builder
+    // changes), node size, builder options and primitive bounds.
+    std::string key = spatial ? "cpu.sbvh.v1" : "cpu.bvh.v1";
+    uint32_t node_size = sizeof(Q::accel::bvh_node);
+    key.append(reinterpret_cast<const char*>(&node_size), sizeof(node_size));
+    if (spatial) {
+        key.append(reinterpret_cast<const char*>(&options), sizeof(options));
+    } else {
+        key.append(reinterpret_cast<const char*>(&options.build), sizeof(options.build));
+    }
+    key.append(reinterpret_cast<const char*>(bounds.data()), bounds.size_bytes());
+
+    Q_cache_blob blob{};
+    if (cache->get(cache->host_data, key.data(), key.size(), &blob)) {
+        uint32_t counts[2] = {};
+        const auto* bytes = static_cast<const std::byte*>(blob.data);
+        std::vector<Q::accel::bvh_node> nodes;
+        std::vector<uint32_t> indices;
+        if (blob.size >= sizeof(counts)) {
+            std::memcpy(counts, bytes, sizeof(counts));
+            size_t node_bytes = size_t{counts[0]} * sizeof(Q::accel::bvh_node);
+            size_t index_bytes = size_t{counts[1]} * sizeof(uint32_t);
+            if (blob.size == sizeof(counts) + node_bytes + index_bytes) {
+                nodes.resize(counts[0]);
+                indices.resize(counts[1]);
+                std::memcpy(nodes.data(), bytes + sizeof(counts), node_bytes);
+                std::memcpy(indices.data(), bytes + sizeof(counts) + node_bytes, index_bytes);
+            }
+        }
+        cache->release(cache->host_data, &blob);
+        if (valid_bvh(nodes, indices, bounds.size())) {
+            log_msg(state, std::format("BVH: {} nodes from the host cache", nodes.size()).c_str());
+            return Q::accel::bvh{std::move(nodes), std::move(indices)};
+        }
+        log_msg(state, "BVH: cached tree is damaged; rebuilding");
+    }
+
+    auto tree = build();
+    auto nodes = tree.nodes();
+    auto indices = tree.primitive_indices();
+    uint32_t counts[2] = {static_cast<uint32_t>(nodes.size()), static_cast<uint32_t>(indices.size())};
+    std::vector<std::byte> value(sizeof(counts) + nodes.size_bytes() + indices.size_bytes());
+    std::memcpy(value.data(), counts, sizeof(counts));
+    std::memcpy(value.data() + sizeof(counts), nodes.data(), nodes.size_bytes());
+    std::memcpy(value.data() + sizeof(counts) + nodes.size_bytes(), indices.data(), indices.size_bytes());
+    cache->put(cache->host_data, key.data(), key.size(), value.data(), value.size());
+    return tree;
+}
+
+/// @brief Copies an accumulation buffer into a malloc'd AOV buffer.
+Q_aov_buffer copy_to_aov(const std::vector<float>& source, uint32_t width, uint32_t height) {
+    Q_aov_buffer buf{};
+    if (source.empty()) return buf;
+
+    size_t bytes = source.size() * sizeof(float);
+    auto* data = static_cast<float*>(std::malloc(bytes));
+    if (!data) return buf;
+    std::memcpy(data, source.data(), bytes);
+
+    buf.data     = data;
+    buf.width    = width;
+    buf.height   = height;
+    buf.channels = 4;
+    buf.format   = Q_AOV_FORMAT_RGBA32F;
+    return buf;
+}
+
+/// @brief Packs averaged normals octahedrally; pixels that never hit stay k_none.
+Q_aov_buffer pack_normals(const std::vector<float>& source, uint32_t width, uint32_t height) {
+    Q_aov_buffer buf{};
+    size_t count = size_t{width} * height;
+    if (source.size() < count * 4) return buf;
+
+    auto* packed = static_cast<uint32_t*>(std::malloc(count * sizeof(uint32_t)));
+    if (!packed) return buf;
+    for (size_t i = 0; i < count; ++i) {
+        Q::math::vec3 n{source[i * 4 + 0], source[i * 4 + 1], source[i * 4 + 2]};
+        packed[i] = Q::math::length_squared(n) > 1e-12f
+            ? Q::math::oct_normal::encode(Q::math::normalize(n)).bits
+            : Q::math::oct_normal::k_none;
+    }
+
+    buf.packed   = packed;
+    buf.width    = width;
+    buf.height   = height;
+    buf.channels = 1;
+    buf.format   = Q_AOV_FORMAT_OCT16X2;
+    return buf;
+}
+
+}  // namespace
+
+extern "C" {
+
+Q_EXPORT_API uint32_t Q_plugin_abi_version(void) {
+    return Q::plugin::k_plugin_abi_version;
+}
+
+Q_EXPORT_API uint32_t Q_plugin_capabilities(void) {
+    return Q_CAPABILITY_ROW_BANDS;
+}
+
+Q_EXPORT_API const Q_param_desc* Q_plugin_params(uint32_t* count) {
+    if (count) {
+        *count = PARAM_COUNT;
+    }
+    return PARAMS;
+}
+
+Q_EXPORT_API void Q_plugin_set_param(Q_plugin_handle* handle, uint32_t index, double value) {
+    if (!handle) return;
+    auto* state = reinterpret_cast<plugin_state*>(handle);
+
+    // Values arrive clamped and rounded to PARAMS.
+    switch (index) {
+        case PARAM_MAX_BOUNCES:
+            state->reset_pending |= state->max_bounces != static_cast<uint32_t>(value);
+            state->max_bounces = static_cast<uint32_t>(value);
+            break;
+        case PARAM_RR_START:
+            state->reset_pending |= state->rr_start != static_cast<uint32_t>(value);
+            state->rr_start = static_cast<uint32_t>(value);
+            break;
+        case PARAM_SAMPLES_PER_FRAME:
+            state->samples_per_frame = static_cast<uint32_t>(value);
+            break;
+        case PARAM_EXPOSURE:
+            state->exposure = static_cast<float>(value);
+            break;
+        default:
+            return;
+    }
+    log_msg(state, std::format("{} = {}", PARAMS[index].name, value).c_str());
+}
+
+Q_EXPORT_API Q_plugin_info Q_plugin_get_info(void) {
+    return Q_plugin_info{
+        .name        = NAME,
+        .version     = {1, 0, 0},
+        .description = DESCRIPTION,
+        .author      = AUTHOR,
+    };
+}
+
+Q_EXPORT_API Q_plugin_handle* Q_plugin_create(Q_plugin_context* ctx) {
+    if (!ctx || ctx->viewport_width == 0 || ctx->viewport_height == 0) {
+        return nullptr;
+    }
+
+    auto* state = new plugin_state{};
+    state->context = ctx;
+    state->present = !ctx->gpu || ctx->gpu->backend == Q_GPU_BACKEND_NONE;
+    state->profiler = ctx->profiler && ctx->profiler->begin && ctx->profiler->end ? ctx->profiler : nullptr;
+
+    // Pick the best kernels for this CPU, capped by Q_ISA if set.
+    const auto& cpu = Q::platform::host_cpu();
+    auto request = Q::platform::isa_override_from_env();
+    if (const char* env = std::getenv(Q::platform::k_isa_env_var); env && *env && !request) {
+        log_msg(state, std::format("Ignoring unknown {}={}", Q::platform::k_isa_env_var, env).c_str());
+    }
+    auto chosen = Q::cpu::kernel_registry().select(cpu, request);
+    state->kernels = chosen.table;
+    state->kernel_isa = chosen.level;
+
+    std::string msg = std::format("CPU kernels: {} ({}, best {})",
+                                  Q::platform::to_string(chosen.level),
+                                  cpu.brand.empty() ? "unknown CPU" : cpu.brand,
+                                  Q::platform::to_string(cpu.best_isa()));
+    if (request && *request != chosen.level) {
+        msg += std::format(", {} requested but unavailable", Q::platform::to_string(*request));
+    }
+    log_msg(state, msg.c_str());
+
+    // Share the host's workers; without them, one pinned worker per
+    // physical core the CPU quota pays for.
+    if (ctx->jobs && ctx->jobs->parallel_for && ctx->jobs->worker_count > 0) {
+        state->jobs = ctx->jobs;
+        state->batches.resize(ctx->jobs->worker_count);
+        log_msg(state, std::format("CPU workers: {} (host job system)", ctx->jobs->worker_count).c_str());
+    } else {
+        const auto& topo = Q::platform::host_topology();
+        state->pool = std::make_unique<Q::async::thread_pool>(topo, Q::platform::pin_policy::physical_cores);
+        state->batches.resize(state->pool->size());
+        std::string quota = topo.cpu_quota ? std::format("{:.2f}", *topo.cpu_quota) : "none";
+        log_msg(state, std::format("CPU workers: {} ({} CPUs, {} cores, {} L3, {} NUMA, quota {})",
+                                   state->pool->size(), topo.cpus.size(), topo.physical_cores,
+                                   topo.l3_domains, topo.numa_nodes, quota).c_str());
+    }
+
+    // Set up Cornell Box scene.
+    float aspect = static_cast<float>(ctx->viewport_width) /
+                   static_cast<float>(ctx->viewport_height);
+    state->scene = Q::scene::make_cornell_box(aspect);
+
+    std::vector<Q::math::aabb> bounds;
+    for (const auto& q : state->scene.quads) {
+        state->quads.push_back(q.geometry);
+        bounds.push_back(q.geometry.bounds());
+    }
+    if (const char* env = std::getenv(k_accel_env_var); env && *env) {
+        if (auto structure = parse_accel_structure(env)) {
+            state->structure = *structure;
+        } else {
+            log_msg(state, std::format("Ignoring unknown {}={}", k_accel_env_var, env).c_str());
+        }
+    }
+    switch (state->structure) {
+        case accel_structure::bvh:
+        case accel_structure::sbvh:
+            state->tree = build_bvh(state, bounds, state->structure == accel_structure::sbvh);
+            state->traced = &state->tree;
+            break;
+        case accel_structure::ordered:
+            state->ordered_tree = Q::accel::reorder(build_bvh(state, bounds, false));
+            state->traced = &state->ordered_tree;
+            break;
+        case accel_structure::lazy:
+            state->lazy_tree = Q::accel::lazy_bvh::build(bounds);
+            state->traced = &state->lazy_tree;
+            break;
+    }
+    log_msg(state, std::format("Acceleration structure: {}", to_string(state->structure)).c_str());
+
+    create_buffers(state, ctx->viewport_width, ctx->viewport_height);
+
+    log_msg(state, "Cornell Box CPU path tracer initialized");
+
+    return reinterpret_cast<Q_plugin_handle*>(state);
+}
+
+Q_EXPORT_API void Q_plugin_destroy(Q_plugin_handle* handle) {
+    if (!handle) return;
+    auto* state = reinterpret_cast<plugin_state*>(handle);
+
+    log_msg(state, "Path tracer destroyed");
+    delete state;
+}
+
+Q_EXPORT_API void Q_plugin_update(Q_plugin_handle* handle, float delta_time) {
+    (void)handle;
+    (void)delta_time;
+}
+
+Q_EXPORT_API void Q_plugin_render(Q_plugin_handle* handle, Q_render_frame* frame) {
+    if (!handle || !frame || frame->width == 0 || frame->height == 0) return;
+
+    auto* state = reinterpret_cast<plugin_state*>(handle);
+    const Q::cpu::kernel_table& k = *state->kernels;
+
+    uint32_t width = frame->width;
+    uint32_t height = frame->height;
+
+    // Recreate buffers if size changed.
+    bool reset = false;
+    if (width != state->last_width || height != state->last_height) {
+        create_buffers(state, width, height);
+        reset = true;
+    }
+
+    // Reset accumulation if the camera or a parameter the samples depend on changed.
+    if (frame->camera_dirty || state->reset_pending) {
+        state->reset_pending = false;
+        state->frame_count = 0;
+        std::fill(state->row_samples.begin(), state->row_samples.end(), 0u);
+        reset = true;
+    }
+
+    // The band of rows this frame covers; all of them unless the host splits frames.
+    uint32_t first = std::min(frame->row_begin, height);
+    uint32_t last = frame->row_end == 0 ? height : std::clamp(frame->row_end, first, height);
+    state->salt_hash = frame->sample_salt != 0 ? pcg_hash(frame->sample_salt) : 0;
+    if constexpr (k_traversal_stats) {
+        if (state->frame_count == 0) {
+            for (auto& batch : state->batches) {
+                batch.histograms = {};
+            }
+        }
+    }
+
+    // Use camera from host, falling back to the scene camera if unset.
+    Q::scene::camera cam = state->scene.cam;
+    const auto& host_cam = frame->camera;
+    if (host_cam.fov > 0.0f) {
+        cam = Q::scene::camera::look_at(
+            {host_cam.position[0], host_cam.position[1], host_cam.position[2]},
+            {host_cam.target[0], host_cam.target[1], host_cam.target[2]},
+            {host_cam.up[0], host_cam.up[1], host_cam.up[2]});
+        cam.fov = host_cam.fov;
+    }
+    cam.aspect = static_cast<float>(width) / static_cast<float>(height);
+
+    for (uint32_t s = 0; s < state->samples_per_frame; ++s) {
+        // 1. Path trace a new sample per pixel (beauty + AOVs).
+        {
+            stage_scope stage{state, "cpu.trace"};
+            trace_rows(state, cam, first, last);
+        }
+
+        // 2. Accumulate all layers.
+        {
+            stage_scope stage{state, "cpu.accumulate"};
+            accumulate_rows(state, state->beauty_accum, state->beauty_sample, first, last);
+            accumulate_rows(state, state->albedo_accum, state->albedo_sample, first, last);
+            accumulate_rows(state, state->normal_accum, state->normal_sample, first, last);
+            accumulate_rows(state, state->depth_accum, state->depth_sample, first, last);
+            if constexpr (k_traversal_stats) {
+                accumulate_rows(state, state->traversal_accum, state->traversal_sample, first, last);
+            }
+            for (uint32_t y = first; y < last; ++y) {
+                state->row_samples[y]++;
+            }
+        }
+    }
+
+    // 3. Tonemap into the host's RGBA16F image when presenting without a GPU.
+    if (state->present && frame->drawable) {
+        stage_scope stage{state, "cpu.present"};
+        size_t offset = size_t{first} * width * 4;
+        size_t size = size_t{last - first} * width * 4;
+        auto display = std::span{state->display}.subspan(offset, size);
+        std::copy_n(state->beauty_accum.begin() + offset, size, display.begin());
+        if (state->exposure != 1.0f) {
+            for (size_t i = 0; i < size; i += 4) {
+                display[i] *= state->exposure;
+                display[i + 1] *= state->exposure;
+                display[i + 2] *= state->exposure;
+            }
+        }
+        k.tonemap(display);
+        k.to_half(display, {static_cast<uint16_t*>(frame->drawable) + offset, size});
+    }
+
+    state->frame_count += state->samples_per_frame;
+    frame->samples_added = state->samples_per_frame;
+    frame->accumulation_reset = reset ? 1 : 0;
+}
+
+Q_EXPORT_API Q_readback_result Q_plugin_readback(Q_plugin_handle* handle) {
+    Q_readback_result result{};
+    if (!handle) return result;
+
+    auto* state = reinterpret_cast<plugin_state*>(handle);
+    Q_aov_buffer buf = copy_to_aov(state->beauty_accum, state->last_width, state->last_height);
+    result.data     = buf.data;
+    result.width    = buf.width;
+    result.height   = buf.height;
+    result.channels = buf.channels;
+    return result;
+}
+
+Q_EXPORT_API void Q_plugin_readback_free(Q_readback_result* result) {
+    if (result && result->data) {
+        std::free(result->data);
+        result->data = nullptr;
+    }
+}
+
+Q_EXPORT_API Q_readback_aov_result Q_plugin_readback_aov(Q_plugin_handle* handle) {
+    Q_readback_aov_result result{};
+    if (!handle) return result;
+
+    auto* state = reinterpret_cast<plugin_state*>(handle);
+    uint32_t w = state->last_width;
+    uint32_t h = state->last_height;
+
+    result.buffers[Q_AOV_BEAUTY] = copy_to_aov(state->beauty_accum, w, h);
+    result.buffers[Q_AOV_ALBEDO] = copy_to_aov(state->albedo_accum, w, h);
+    result.buffers[Q_AOV_NORMAL] = pack_normals(state->normal_accum, w, h);
+    result.buffers[Q_AOV_DEPTH]  = copy_to_aov(state->depth_accum, w, h);
+
+    if constexpr (k_traversal_stats) {
+        result.buffers[Q_AOV_TRAVERSAL] = copy_to_aov(state->traversal_accum, w, h);
+
+        traversal_histograms total;
+        for (const auto& batch : state->batches) {
+            total.merge(batch.histograms);
+        }
+        log_msg(state, std::format("Traversal over {} samples/pixel", state->frame_count).c_str());
+        log_msg(state, std::format("  nodes/ray:     {}", total.nodes.summary()).c_str());
+        log_msg(state, std::format("  prims/ray:     {}", total.prims.summary()).c_str());
+        log_msg(state, std::format("  segments/path: {}", total.segments.summary()).c_str());
+    }
+
+    log_msg(state, "AOV readback complete");
+    return result;
+}
+
+Q_EXPORT_API void Q_plugin_readback_aov_free(Q_readback_aov_result* result) {
+    if (!result) return;
+    for (auto& buffer : result->buffers) {
+        if (buffer.data) {
+            std::free(buffer.data);
+            buffer.data = nullptr;
+        }
+    }
+}
+
+}  // extern "C"
@@ -1,5 +1,16 @@
 /// @file plugin.mm
 /// @brief Metal backend - Cornell Box path tracer.
+///
+/// When the host has a cache (Q_plugin_context::cache), the compiled
+/// pipelines are kept there as a serialized MTLBinaryArchive, keyed by the
+/// device, shader source and output format. A reloaded or restarted plugin
+/// then builds its pipelines from the archive instead of compiling the
+/// shaders for the GPU again.
+///
+/// Bounce depth, the Russian roulette start, samples per frame and
+/// exposure are parameters (Q_plugin_params) the host may change between
+/// frames. The first two go to the shader in SceneUniforms, so changing
+/// them restarts accumulation but compiles nothing.
 
 #include <quasi/plugin/plugin_interface.hpp>
 #include <quasi/gpu/types.hpp>
@@ -11,6 +22,7 @@
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
+#include <string>
 
 namespace {
 
@@ -19,8 +31,24 @@ constexpr const char* DESCRIPTION = "Cornell Box path tracer using Metal";
 constexpr const char* AUTHOR      = "Quasi";
 
 constexpr uint32_t MAX_QUADS   = 32;
-constexpr uint32_t MAX_BOUNCES = 5;
-constexpr uint32_t SAMPLES_PER_FRAME = 1;
+constexpr uint32_t DEFAULT_MAX_BOUNCES = 5;
+constexpr uint32_t DEFAULT_RR_START    = 3;
+
+/// @brief Indices into PARAMS.
+enum param_index : uint32_t {
+    PARAM_MAX_BOUNCES,
+    PARAM_RR_START,
+    PARAM_SAMPLES_PER_FRAME,
+    PARAM_EXPOSURE,
+    PARAM_COUNT,
+};
+
+constexpr Q_param_desc PARAMS[PARAM_COUNT] = {
+    {"max_bounces", "Longest path, in bounces.", Q_PARAM_INT, DEFAULT_MAX_BOUNCES, 1, 16},
+    {"rr_start_bounce", "First bounce that may end by Russian roulette.", Q_PARAM_INT, DEFAULT_RR_START, 0, 16},
+    {"samples_per_frame", "Samples per pixel traced each frame.", Q_PARAM_INT, 1, 1, 64},
+    {"exposure", "Scale applied before tonemapping.", Q_PARAM_FLOAT, 1.0, 0.01, 100.0},
+};
 
 // Path tracing shader.
 constexpr const char* k_shader_source = R"(
@@ -28,7 +56,6 @@ constexpr const char* k_shader_source = R"(
 using namespace metal;
 
 #define MAX_QUADS 32
-#define MAX_BOUNCES 5
 
 struct VertexOut {
     float4 position [[position]];
@@ -75,7 +102,9 @@ struct SceneUniforms {
     uint quad_count;
     uint frame_count;
     uint light_index;
-    float _pad;
+    uint max_bounces;
+    uint rr_start;
+    uint _pad[3];
     Quad quads[MAX_QUADS];
     Material materials[MAX_QUADS];
 };
@@ -211,12 +240,33 @@ HitRecord trace_scene(Ray ray, constant SceneUniforms& scene) {
     return closest;
 }
 
+// ----- Octahedral Normal Encoding (matches Q::math::oct_normal) -----
+
+#define OCT_NONE 0x80008000u
+
+uint oct_encode(float3 n) {
+    float2 p = n.xy / (abs(n.x) + abs(n.y) + abs(n.z));
+    if (n.z < 0.0f) {
+        p = (1.0f - abs(p.yx)) * select(float2(-1.0f), float2(1.0f), p >= 0.0f);
+    }
+    return pack_float_to_snorm2x16(p);
+}
+
+float3 oct_decode(uint bits) {
+    if (bits == OCT_NONE) return float3(0.0f);
+    float2 p = unpack_snorm2x16_to_float(bits);
+    float3 n = float3(p, 1.0f - abs(p.x) - abs(p.y));
+    float t = max(-n.z, 0.0f);
+    n.xy += select(float2(t), float2(-t), n.xy >= 0.0f);
+    return normalize(n);
+}
+
 // ----- Path Tracing -----
 
 struct PathTraceResult {
     float3 color;
     float3 first_hit_albedo;
-    float3 first_hit_normal;
+    uint   first_hit_normal;  // Octahedral, OCT_NONE on a miss.
     float  first_hit_depth;
 };
 
@@ -224,12 +274,12 @@ PathTraceResult path_trace(Ray ray, constant SceneUniforms& scene, thread uint&
     PathTraceResult result;
     result.color = float3(0.0f);
     result.first_hit_albedo = float3(0.0f);
-    result.first_hit_normal = float3(0.0f);
+    result.first_hit_normal = OCT_NONE;
     result.first_hit_depth = 0.0f;
 
     float3 throughput = float3(1.0f);
 
-    for (int bounce = 0; bounce < MAX_BOUNCES; bounce++) {
+    for (uint bounce = 0; bounce < scene.max_bounces; bounce++) {
         HitRecord hit = trace_scene(ray, scene);
 
         if (!hit.hit) {
@@ -244,7 +294,7 @@ PathTraceResult path_trace(Ray ray, constant SceneUniforms& scene, thread uint&
             result.first_hit_albedo = (emit_str > 0.1f)
                 ? float3(mat.emission)  // Use emission for light sources.
                 : float3(mat.albedo);
-            result.first_hit_normal = hit.normal * 0.5f + 0.5f;  // Remap [-1,1] to [0,1].
+            result.first_hit_normal = oct_encode(hit.normal);
             result.first_hit_depth  = hit.t;
         }
 
@@ -261,7 +311,7 @@ PathTraceResult path_trace(Ray ray, constant SceneUniforms& scene, thread uint&
         throughput *= float3(mat.albedo);
 
         // Russian roulette after a few bounces.
-        if (bounce > 2) {
+        if (bounce >= scene.rr_start) {
             float p = max(0.05f, max(throughput.x, max(throughput.y, throughput.z)));
             if (random_float(rng) > p) break;
             throughput /= p;
@@ -280,7 +330,7 @@ PathTraceResult path_trace(Ray ray, constant SceneUniforms& scene, thread uint&
 struct FragmentOutput {
     float4 beauty  [[color(0)]];
     float4 albedo  [[color(1)]];
-    float4 normal  [[color(2)]];
+    uint   normal  [[color(2)]];
     float4 depth   [[color(3)]];
 };
 
@@ -303,7 +353,7 @@ fragment FragmentOutput pathtrace_frag(
     FragmentOutput out;
     out.beauty = float4(pt.color, 1.0f);
     out.albedo = float4(pt.first_hit_albedo, 1.0f);
-    out.normal = float4(pt.first_hit_normal, 1.0f);
+    out.normal = pt.first_hit_normal;
     out.depth  = float4(norm_depth, norm_depth, norm_depth, 1.0f);
     return out;
 }
@@ -329,16 +379,36 @@ kernel void accumulate(
     output.write(result, gid);
 }
 
+// Normals are averaged as vectors and re-packed; misses contribute zero.
+kernel void accumulate_normal(
+    texture2d<uint, access::read> current [[texture(0)]],
+    texture2d<uint, access::read> history [[texture(1)]],
+    texture2d<uint, access::write> output [[texture(2)]],
+    constant uint& frame_count [[buffer(0)]],
+    uint2 gid [[thread_position_in_grid]]
+) {
+    if (gid.x >= output.get_width() || gid.y >= output.get_height()) return;
+
+    float3 new_sample = oct_decode(current.read(gid).r);
+    float3 accumulated = frame_count == 0 ? float3(0.0f) : oct_decode(history.read(gid).r);
+
+    float weight = 1.0f / float(frame_count + 1);
+    float3 n = mix(accumulated, new_sample, weight);
+
+    output.write(uint4(length_squared(n) > 1e-12f ? oct_encode(n) : OCT_NONE), gid);
+}
+
 // ----- Tonemap + Output Shader -----
 
 fragment float4 tonemap_frag(
     VertexOut in [[stage_in]],
-    texture2d<float> accumulated [[texture(0)]]
+    texture2d<float> accumulated [[texture(0)]],
+    constant float& exposure [[buffer(0)]]
 ) {
     constexpr sampler s(filter::nearest);
     // Flip Y: Metal textures have (0,0) at top-left, but screen has (0,0) at bottom-left.
     float2 uv = float2(in.uv.x, 1.0f - in.uv.y);
-    float3 color = accumulated.sample(s, uv).rgb;
+    float3 color = accumulated.sample(s, uv).rgb * exposure;
 
     // Simple Reinhard tonemap.
     color = color / (color + 1.0f);
@@ -381,7 +451,9 @@ struct GpuSceneUniforms {
     uint32_t quad_count;
     uint32_t frame_count;
     uint32_t light_index;
-    float _pad;
+    uint32_t max_bounces;
+    uint32_t rr_start;
+    uint32_t _pad[3];
     GpuQuad quads[MAX_QUADS];
     GpuMaterial materials[MAX_QUADS];
 };
@@ -393,6 +465,7 @@ struct plugin_state {
     id<MTLRenderPipelineState> pathtrace_pipeline = nil;
     id<MTLRenderPipelineState> tonemap_pipeline = nil;
     id<MTLComputePipelineState> accumulate_pipeline = nil;
+    id<MTLComputePipelineState> accumulate_normal_pipeline = nil;
     id<MTLTexture> render_target = nil;
     id<MTLTexture> accum_a = nil;
     id<MTLTexture> accum_b = nil;
@@ -411,6 +484,14 @@ struct plugin_state {
     id<MTLTexture> aov_depth_accum_b  = nil;
 
     Q::scene::cornell_box_scene scene;
+
+    // Host-set parameters (PARAMS).
+    uint32_t max_bounces       = DEFAULT_MAX_BOUNCES;
+    uint32_t rr_start          = DEFAULT_RR_START;
+    uint32_t samples_per_frame = 1;
+    float    exposure          = 1.0f;
+    bool     reset_pending     = false;  // A parameter change invalidated the accumulation.
+
     uint32_t frame_count = 0;
     uint32_t last_width = 0;
     uint32_t last_height = 0;
@@ -423,9 +504,85 @@ void log_msg(plugin_state* state, const char* msg) {
     }
 }
 
+/// @brief Host cache key of the pipeline archive: everything the compiled pipelines depend on.
+std::string archive_key(plugin_state* state, MTLPixelFormat output_format) {
+    std::string key = "metal.pipelines.v1";
+    key += '\0';
+    key += [state->device.name UTF8String];
+    key += '\0';
+    key += std::to_string(static_cast<unsigned long>(output_format));
+    key += '\0';
+    key += k_shader_source;
+    return key;
+}
+
+/// @brief Returns a temporary file for moving an archive between Metal and the cache.
+NSURL* archive_temp_url() {
+    NSString* name = [NSString stringWithFormat:@"quasi_metal_%@.metallib", [[NSUUID UUID] UUIDString]];
+    return [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:name]];
+}
+
+/// @brief Opens the pipeline archive the host cached, or an empty one to fill.
+/// @param warm Set to true if the archive came from the cache.
+id<MTLBinaryArchive> open_archive(plugin_state* state, const std::string& key, bool& warm) {
+    warm = false;
+    Q_cache* cache = state->context->cache;
+    if (!cache || !cache->get || !cache->put) {
+        return nil;
+    }
+
+    MTLBinaryArchiveDescriptor* desc = [[MTLBinaryArchiveDescriptor alloc] init];
+    NSURL* url = nil;
+    Q_cache_blob blob{};
+    if (cache->get(cache->host_data, key.data(), key.size(), &blob)) {
+        // Metal reads archives only from files.
+        url = archive_temp_url();
+        NSData* data = [NSData dataWithBytesNoCopy:const_cast<void*>(blob.data) length:blob.size freeWhenDone:NO];
+        if ([data writeToURL:url atomically:NO]) {
+            desc.url = url;
+        }
+        cache->release(cache->host_data, &blob);
+    }
+
+    NSError* error = nil;
+    id<MTLBinaryArchive> archive = [state->device newBinaryArchiveWithDescriptor:desc error:&error];
+    if (url) {
+        [[NSFileManager defaultManager] removeItemAtURL:url error:nil];
+    }
+    if (!archive && desc.url) {
+        // A stale or damaged archive: start an empty one instead.
+        desc.url = nil;
+        archive = [state->device newBinaryArchiveWithDescriptor:desc error:&error];
+    } else {
+        warm = desc.url != nil;
+    }
+    return archive;
+}
+
+/// @brief Serializes the filled archive into the host cache.
+void store_archive(plugin_state* state, id<MTLBinaryArchive> archive, const std::string& key) {
+    Q_cache* cache = state->context->cache;
+    NSURL* url = archive_temp_url();
+    NSError* error = nil;
+    if ([archive serializeToURL:url error:&error]) {
+        NSData* data = [NSData dataWithContentsOfURL:url];
+        if (data) {
+            cache->put(cache->host_data, key.data(), key.size(), data.bytes, data.length);
+        }
+    } else {
+        NSLog(@"Failed to serialize pipeline archive: %@", error);
+    }
+    [[NSFileManager defaultManager] removeItemAtURL:url error:nil];
+}
+
 bool create_pipelines(plugin_state* state, MTLPixelFormat output_format) {
     NSError* error = nil;
 
+    std::string key = archive_key(state, output_format);
+    bool warm = false;
+    id<MTLBinaryArchive> archive = open_archive(state, key, warm);
+    NSArray<id<MTLBinaryArchive>>* archives = archive ? @[archive] : nil;
+
     NSString* source = [NSString stringWithUTF8String:k_shader_source];
     MTLCompileOptions* options = [[MTLCompileOptions alloc] init];
     options.fastMathEnabled = YES;
@@ -442,8 +599,9 @@ bool create_pipelines(plugin_state* state, MTLPixelFormat output_format) {
     id<MTLFunction> pathtrace_frag = [library newFunctionWithName:@"pathtrace_frag"];
     id<MTLFunction> tonemap_frag = [library newFunctionWithName:@"tonemap_frag"];
     id<MTLFunction> accumulate_fn = [library newFunctionWithName:@"accumulate"];
+    id<MTLFunction> accumulate_normal_fn = [library newFunctionWithName:@"accumulate_normal"];
 
-    if (!fullscreen_vert || !pathtrace_frag || !tonemap_frag || !accumulate_fn) {
+    if (!fullscreen_vert || !pathtrace_frag || !tonemap_frag || !accumulate_fn || !accumulate_normal_fn) {
         log_msg(state, "Failed to find shader functions");
         return false;
     }
@@ -454,8 +612,9 @@ bool create_pipelines(plugin_state* state, MTLPixelFormat output_format) {
     pt_desc.fragmentFunction = pathtrace_frag;
     pt_desc.colorAttachments[0].pixelFormat = MTLPixelFormatRGBA32Float;  // beauty
     pt_desc.colorAttachments[1].pixelFormat = MTLPixelFormatRGBA32Float;  // albedo
-    pt_desc.colorAttachments[2].pixelFormat = MTLPixelFormatRGBA32Float;  // normal
+    pt_desc.colorAttachments[2].pixelFormat = MTLPixelFormatR32Uint;      // normal (octahedral)
     pt_desc.colorAttachments[3].pixelFormat = MTLPixelFormatRGBA32Float;  // depth
+    pt_desc.binaryArchives = archives;
 
     state->pathtrace_pipeline = [state->device newRenderPipelineStateWithDescriptor:pt_desc
                                                                               error:&error];
@@ -469,6 +628,7 @@ bool create_pipelines(plugin_state* state, MTLPixelFormat output_format) {
     tm_desc.vertexFunction = fullscreen_vert;
     tm_desc.fragmentFunction = tonemap_frag;
     tm_desc.colorAttachments[0].pixelFormat = output_format;
+    tm_desc.binaryArchives = archives;
 
     state->tonemap_pipeline = [state->device newRenderPipelineStateWithDescriptor:tm_desc
                                                                             error:&error];
@@ -478,13 +638,44 @@ bool create_pipelines(plugin_state* state, MTLPixelFormat output_format) {
     }
 
     // Accumulation compute pipeline.
-    state->accumulate_pipeline = [state->device newComputePipelineStateWithFunction:accumulate_fn
-                                                                              error:&error];
+    MTLComputePipelineDescriptor* acc_desc = [[MTLComputePipelineDescriptor alloc] init];
+    acc_desc.computeFunction = accumulate_fn;
+    acc_desc.binaryArchives = archives;
+    state->accumulate_pipeline = [state->device newComputePipelineStateWithDescriptor:acc_desc
+                                                                              options:MTLPipelineOptionNone
+                                                                           reflection:nil
+                                                                                error:&error];
     if (!state->accumulate_pipeline) {
         NSLog(@"Failed to create accumulate pipeline: %@", error);
         return false;
     }
 
+    MTLComputePipelineDescriptor* acc_normal_desc = [[MTLComputePipelineDescriptor alloc] init];
+    acc_normal_desc.computeFunction = accumulate_normal_fn;
+    acc_normal_desc.binaryArchives = archives;
+    state->accumulate_normal_pipeline = [state->device newComputePipelineStateWithDescriptor:acc_normal_desc
+                                                                                     options:MTLPipelineOptionNone
+                                                                                  reflection:nil
+                                                                                       error:&error];
+    if (!state->accumulate_normal_pipeline) {
+        NSLog(@"Failed to create normal accumulate pipeline: %@", error);
+        return false;
+    }
+
+    // First run: record the compiled pipelines for the next instance.
+    if (archive && !warm) {
+        bool added = [archive addRenderPipelineFunctionsWithDescriptor:pt_desc error:&error] &&
+                     [archive addRenderPipelineFunctionsWithDescriptor:tm_desc error:&error] &&
+                     [archive addComputePipelineFunctionsWithDescriptor:acc_desc error:&error] &&
+                     [archive addComputePipelineFunctionsWithDescriptor:acc_normal_desc error:&error];
+        if (added) {
+            store_archive(state, archive, key);
+        } else {
+            NSLog(@"Failed to fill pipeline archive: %@", error);
+        }
+    }
+    log_msg(state, warm ? "Pipelines built from the host cache" : "Pipelines compiled");
+
     return true;
 }
 
@@ -514,17 +705,22 @@ void create_textures(plugin_state* state, uint32_t width, uint32_t height) {
 
     state->render_target = [state->device newTextureWithDescriptor:rt_desc];
     state->aov_albedo_rt = [state->device newTextureWithDescriptor:rt_desc];
-    state->aov_normal_rt = [state->device newTextureWithDescriptor:rt_desc];
     state->aov_depth_rt  = [state->device newTextureWithDescriptor:rt_desc];
 
+    // Normals are stored octahedral-packed in one uint32 (4 bytes vs 16).
+    MTLTextureDescriptor* oct_desc = [rt_desc copy];
+    oct_desc.pixelFormat = MTLPixelFormatR32Uint;
+    state->aov_normal_rt = [state->device newTextureWithDescriptor:oct_desc];
+
     // Accumulation descriptor (ShaderRead + ShaderWrite for compute).
     rt_desc.usage = MTLTextureUsageShaderRead | MTLTextureUsageShaderWrite;
     state->accum_a = [state->device newTextureWithDescriptor:rt_desc];
     state->accum_b = [state->device newTextureWithDescriptor:rt_desc];
     state->aov_albedo_accum_a = [state->device newTextureWithDescriptor:rt_desc];
     state->aov_albedo_accum_b = [state->device newTextureWithDescriptor:rt_desc];
-    state->aov_normal_accum_a = [state->device newTextureWithDescriptor:rt_desc];
-    state->aov_normal_accum_b = [state->device newTextureWithDescriptor:rt_desc];
+    oct_desc.usage = MTLTextureUsageShaderRead | MTLTextureUsageShaderWrite;
+    state->aov_normal_accum_a = [state->device newTextureWithDescriptor:oct_desc];
+    state->aov_normal_accum_b = [state->device newTextureWithDescriptor:oct_desc];
     state->aov_depth_accum_a  = [state->device newTextureWithDescriptor:rt_desc];
     state->aov_depth_accum_b  = [state->device newTextureWithDescriptor:rt_desc];
 
@@ -544,6 +740,38 @@ Q_EXPORT uint32_t Q_plugin_abi_version(void) {
     return Q::plugin::k_plugin_abi_version;
 }
 
+Q_EXPORT const Q_param_desc* Q_plugin_params(uint32_t* count) {
+    if (count) {
+        *count = PARAM_COUNT;
+    }
+    return PARAMS;
+}
+
+Q_EXPORT void Q_plugin_set_param(Q_plugin_handle* handle, uint32_t index, double value) {
+    if (!handle) return;
+    auto* state = reinterpret_cast<plugin_state*>(handle);
+
+    // Values arrive clamped and rounded to PARAMS.
+    switch (index) {
+        case PARAM_MAX_BOUNCES:
+            state->reset_pending |= state->max_bounces != static_cast<uint32_t>(value);
+            state->max_bounces = static_cast<uint32_t>(value);
+            break;
+        case PARAM_RR_START:
+            state->reset_pending |= state->rr_start != static_cast<uint32_t>(value);
+            state->rr_start = static_cast<uint32_t>(value);
+            break;
+        case PARAM_SAMPLES_PER_FRAME:
+            state->samples_per_frame = static_cast<uint32_t>(value);
+            break;
+        case PARAM_EXPOSURE:
+            state->exposure = static_cast<float>(value);
+            break;
+        default:
+            break;
+    }
+}
+
 Q_EXPORT Q_plugin_info Q_plugin_get_info(void) {
     return Q_plugin_info{
         .name        = NAME,
@@ -639,8 +867,9 @@ Q_EXPORT void Q_plugin_render(Q_plugin_handle* handle, Q_render_frame* frame) {
         create_textures(state, width, height);
     }
 
-    // Reset accumulation if camera changed.
-    if (frame->camera_dirty) {
+    // Reset accumulation if the camera or a parameter the samples depend on changed.
+    if (frame->camera_dirty || state->reset_pending) {
+        state->reset_pending = false;
         state->frame_count = 0;
         state->ping = true;
     }
@@ -674,8 +903,9 @@ Q_EXPORT void Q_plugin_render(Q_plugin_handle* handle, Q_render_frame* frame) {
     uniforms.camera.aspect = aspect;
 
     uniforms.quad_count = static_cast<uint32_t>(std::min(state->scene.quads.size(), size_t(MAX_QUADS)));
-    uniforms.frame_count = state->frame_count;
     uniforms.light_index = static_cast<uint32_t>(state->scene.light_index);
+    uniforms.max_bounces = state->max_bounces;
+    uniforms.rr_start = state->rr_start;
 
     for (size_t i = 0; i < uniforms.quad_count; i++) {
         const auto& q = state->scene.quads[i];
@@ -699,78 +929,90 @@ Q_EXPORT void Q_plugin_render(Q_plugin_handle* handle, Q_render_frame* frame) {
         uniforms.materials[i].metallic = q.mat.metallic;
     }
 
-    // Select accumulation buffers.
-    id<MTLTexture> read_accum = state->ping ? state->accum_a : state->accum_b;
-    id<MTLTexture> write_accum = state->ping ? state->accum_b : state->accum_a;
-
-    // Select AOV accumulation buffers (same ping-pong as beauty).
-    id<MTLTexture> albedo_read  = state->ping ? state->aov_albedo_accum_a : state->aov_albedo_accum_b;
-    id<MTLTexture> albedo_write = state->ping ? state->aov_albedo_accum_b : state->aov_albedo_accum_a;
-    id<MTLTexture> normal_read  = state->ping ? state->aov_normal_accum_a : state->aov_normal_accum_b;
-    id<MTLTexture> normal_write = state->ping ? state->aov_normal_accum_b : state->aov_normal_accum_a;
-    id<MTLTexture> depth_read   = state->ping ? state->aov_depth_accum_a  : state->aov_depth_accum_b;
-    id<MTLTexture> depth_write  = state->ping ? state->aov_depth_accum_b  : state->aov_depth_accum_a;
-
-    // 1. Path trace pass - render new sample (MRT: beauty + AOVs).
-    {
-        MTLRenderPassDescriptor* pass = [MTLRenderPassDescriptor renderPassDescriptor];
-        pass.colorAttachments[0].texture     = state->render_target;
-        pass.colorAttachments[0].loadAction  = MTLLoadActionDontCare;
-        pass.colorAttachments[0].storeAction = MTLStoreActionStore;
-
-        pass.colorAttachments[1].texture     = state->aov_albedo_rt;
-        pass.colorAttachments[1].loadAction  = MTLLoadActionDontCare;
-        pass.colorAttachments[1].storeAction = MTLStoreActionStore;
-
-        pass.colorAttachments[2].texture     = state->aov_normal_rt;
-        pass.colorAttachments[2].loadAction  = MTLLoadActionDontCare;
-        pass.colorAttachments[2].storeAction = MTLStoreActionStore;
-
-        pass.colorAttachments[3].texture     = state->aov_depth_rt;
-        pass.colorAttachments[3].loadAction  = MTLLoadActionDontCare;
-        pass.colorAttachments[3].storeAction = MTLStoreActionStore;
-
-        id<MTLRenderCommandEncoder> enc = [cmd_buf renderCommandEncoderWithDescriptor:pass];
-        [enc setRenderPipelineState:state->pathtrace_pipeline];
-        [enc setFragmentBytes:&uniforms length:sizeof(uniforms) atIndex:0];
-        [enc drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:3];
-        [enc endEncoding];
-    }
+    // Trace and accumulate samples_per_frame samples, ping-ponging after each.
+    id<MTLTexture> result = nil;
+    for (uint32_t sample = 0; sample < state->samples_per_frame; ++sample) {
+        uniforms.frame_count = state->frame_count;
+
+        // Select accumulation buffers.
+        id<MTLTexture> read_accum = state->ping ? state->accum_a : state->accum_b;
+        id<MTLTexture> write_accum = state->ping ? state->accum_b : state->accum_a;
+
+        // Select AOV accumulation buffers (same ping-pong as beauty).
+        id<MTLTexture> albedo_read  = state->ping ? state->aov_albedo_accum_a : state->aov_albedo_accum_b;
+        id<MTLTexture> albedo_write = state->ping ? state->aov_albedo_accum_b : state->aov_albedo_accum_a;
+        id<MTLTexture> normal_read  = state->ping ? state->aov_normal_accum_a : state->aov_normal_accum_b;
+        id<MTLTexture> normal_write = state->ping ? state->aov_normal_accum_b : state->aov_normal_accum_a;
+        id<MTLTexture> depth_read   = state->ping ? state->aov_depth_accum_a  : state->aov_depth_accum_b;
+        id<MTLTexture> depth_write  = state->ping ? state->aov_depth_accum_b  : state->aov_depth_accum_a;
+
+        // 1. Path trace pass - render new sample (MRT: beauty + AOVs).
+        {
+            MTLRenderPassDescriptor* pass = [MTLRenderPassDescriptor renderPassDescriptor];
+            pass.colorAttachments[0].texture     = state->render_target;
+            pass.colorAttachments[0].loadAction  = MTLLoadActionDontCare;
+            pass.colorAttachments[0].storeAction = MTLStoreActionStore;
+
+            pass.colorAttachments[1].texture     = state->aov_albedo_rt;
+            pass.colorAttachments[1].loadAction  = MTLLoadActionDontCare;
+            pass.colorAttachments[1].storeAction = MTLStoreActionStore;
+
+            pass.colorAttachments[2].texture     = state->aov_normal_rt;
+            pass.colorAttachments[2].loadAction  = MTLLoadActionDontCare;
+            pass.colorAttachments[2].storeAction = MTLStoreActionStore;
+
+            pass.colorAttachments[3].texture     = state->aov_depth_rt;
+            pass.colorAttachments[3].loadAction  = MTLLoadActionDontCare;
+            pass.colorAttachments[3].storeAction = MTLStoreActionStore;
+
+            id<MTLRenderCommandEncoder> enc = [cmd_buf renderCommandEncoderWithDescriptor:pass];
+            [enc setRenderPipelineState:state->pathtrace_pipeline];
+            [enc setFragmentBytes:&uniforms length:sizeof(uniforms) atIndex:0];
+            [enc drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:3];
+            [enc endEncoding];
+        }
 
-    // 2. Accumulate all layers in a single compute encoder.
-    {
-        id<MTLComputeCommandEncoder> enc = [cmd_buf computeCommandEncoder];
-        [enc setComputePipelineState:state->accumulate_pipeline];
-        [enc setBytes:&state->frame_count length:sizeof(uint32_t) atIndex:0];
-
-        MTLSize grid = MTLSizeMake(width, height, 1);
-        MTLSize group = MTLSizeMake(16, 16, 1);
-
-        // Beauty.
-        [enc setTexture:state->render_target atIndex:0];
-        [enc setTexture:read_accum atIndex:1];
-        [enc setTexture:write_accum atIndex:2];
-        [enc dispatchThreads:grid threadsPerThreadgroup:group];
-
-        // Albedo.
-        [enc setTexture:state->aov_albedo_rt atIndex:0];
-        [enc setTexture:albedo_read atIndex:1];
-        [enc setTexture:albedo_write atIndex:2];
-        [enc dispatchThreads:grid threadsPerThreadgroup:group];
-
-        // Normal.
-        [enc setTexture:state->aov_normal_rt atIndex:0];
-        [enc setTexture:normal_read atIndex:1];
-        [enc setTexture:normal_write atIndex:2];
-        [enc dispatchThreads:grid threadsPerThreadgroup:group];
-
-        // Depth.
-        [enc setTexture:state->aov_depth_rt atIndex:0];
-        [enc setTexture:depth_read atIndex:1];
-        [enc setTexture:depth_write atIndex:2];
-        [enc dispatchThreads:grid threadsPerThreadgroup:group];
+        // 2. Accumulate all layers in a single compute encoder.
+        {
+            id<MTLComputeCommandEncoder> enc = [cmd_buf computeCommandEncoder];
+            [enc setComputePipelineState:state->accumulate_pipeline];
+            [enc setBytes:&state->frame_count length:sizeof(uint32_t) atIndex:0];
+
+            MTLSize grid = MTLSizeMake(width, height, 1);
+            MTLSize group = MTLSizeMake(16, 16, 1);
+
+            // Beauty.
+            [enc setTexture:state->render_target atIndex:0];
+            [enc setTexture:read_accum atIndex:1];
+            [enc setTexture:write_accum atIndex:2];
+            [enc dispatchThreads:grid threadsPerThreadgroup:group];
+
+            // Albedo.
+            [enc setTexture:state->aov_albedo_rt atIndex:0];
+            [enc setTexture:albedo_read atIndex:1];
+            [enc setTexture:albedo_write atIndex:2];
+            [enc dispatchThreads:grid threadsPerThreadgroup:group];
+
+            // Normal (packed; bindings persist across the pipeline switch).
+            [enc setComputePipelineState:state->accumulate_normal_pipeline];
+            [enc setTexture:state->aov_normal_rt atIndex:0];
+            [enc setTexture:normal_read atIndex:1];
+            [enc setTexture:normal_write atIndex:2];
+            [enc dispatchThreads:grid threadsPerThreadgroup:group];
+            [enc setComputePipelineState:state->accumulate_pipeline];
+
+            // Depth.
+            [enc setTexture:state->aov_depth_rt atIndex:0];
+            [enc setTexture:depth_read atIndex:1];
+            [enc setTexture:depth_write atIndex:2];
+            [enc dispatchThreads:grid threadsPerThreadgroup:group];
+
+            [enc endEncoding];
+        }
 
-        [enc endEncoding];
+        result = write_accum;
+        state->ping = !state->ping;
+        state->frame_count++;
     }
 
     // 3. Tonemap pass - output to screen.
@@ -782,18 +1024,19 @@ Q_EXPORT void Q_plugin_render(Q_plugin_handle* handle, Q_render_frame* frame) {
 
         id<MTLRenderCommandEncoder> enc = [cmd_buf renderCommandEncoderWithDescriptor:pass];
         [enc setRenderPipelineState:state->tonemap_pipeline];
-        [enc setFragmentTexture:write_accum atIndex:0];
+        [enc setFragmentTexture:result atIndex:0];
+        [enc setFragmentBytes:&state->exposure length:sizeof(float) atIndex:0];
         [enc drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:3];
         [enc endEncoding];
     }
-
-    state->ping = !state->ping;
-    state->frame_count++;
 }
 
 namespace {
 
-/// @brief Blits a GPU-private texture to a malloc'd float array.
+/// @brief Blits a GPU-private texture to a malloc'd array.
+///
+/// RGBA32Float textures come back as 4 floats per pixel; R32Uint textures
+/// as one packed octahedral normal per pixel, left packed for the host.
 Q_aov_buffer blit_texture_to_cpu(
     id<MTLDevice> device,
     id<MTLTexture> source,
@@ -802,9 +1045,10 @@ Q_aov_buffer blit_texture_to_cpu(
     Q_aov_buffer buf{};
     if (!source) return buf;
 
+    bool packed = source.pixelFormat == MTLPixelFormatR32Uint;
     uint32_t w  = static_cast<uint32_t>(source.width);
     uint32_t h  = static_cast<uint32_t>(source.height);
-    uint32_t ch = 4;
+    uint32_t ch = packed ? 1 : 4;
     size_t bpr   = w * ch * sizeof(float);
     size_t total = bpr * h;
 
@@ -838,6 +1082,7 @@ Q_aov_buffer blit_texture_to_cpu(
     buf.width    = w;
     buf.height   = h;
     buf.channels = ch;
+    buf.format   = packed ? Q_AOV_FORMAT_OCT16X2 : Q_AOV_FORMAT_RGBA32F;
     return buf;
 }
 
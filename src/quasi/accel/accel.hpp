@@ -0,0 +1,13 @@
+/// @file accel.hpp
+/// @brief Main header for the acceleration structure module.
+///
+/// This header includes all accel module components. For finer-grained
+/// control, include individual headers directly.
+
+#pragma once
+
+#include <quasi/accel/bvh.hpp>
+#include <quasi/accel/layout.hpp>
+#include <quasi/accel/lazy_bvh.hpp>
+#include <quasi/accel/lod.hpp>
+#include <quasi/accel/sbvh.hpp>
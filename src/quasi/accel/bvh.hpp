@@ -0,0 +1,388 @@
+/// @file bvh.hpp
+/// @brief Bounding volume hierarchy built with the binned surface area heuristic.
+///
+/// The BVH is primitive-agnostic: it is built from a list of primitive bounds
+/// and traversal reports candidate primitive indices to a caller-supplied
+/// intersection callback. This keeps geometry types (quads, spheres) in the
+/// scene module and acceleration structures here.
+
+#pragma once
+
+#include <quasi/math/aabb.hpp>
+#include <quasi/math/ray.hpp>
+#include <quasi/math/vec.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace Q::accel {
+
+/// @brief Upper bound on SAH bins per axis.
+inline constexpr uint32_t k_max_bins = 64;
+
+/// @brief Maximum traversal stack depth.
+inline constexpr uint32_t k_max_stack_depth = 64;
+
+/// @brief Deepest leaf a builder may create.
+///
+/// Traversal keeps at most one pending sibling per level plus the two
+/// children just pushed, so leaves deeper than this would overflow the
+/// fixed traversal stack.
+inline constexpr uint32_t k_max_depth = k_max_stack_depth - 2;
+
+/// @brief Tunables shared by all BVH builders.
+struct build_options {
+    uint32_t max_leaf_size     = 4;            ///< Nodes with this many primitives or fewer become leaves.
+    uint32_t bin_count         = 16;           ///< SAH bins per axis (clamped to k_max_bins).
+    uint32_t max_depth         = k_max_depth;  ///< Nodes at this depth become leaves (clamped to k_max_depth).
+    float    traversal_cost    = 1.0f;         ///< Relative cost of visiting an interior node.
+    float    intersection_cost = 1.0f;         ///< Relative cost of one primitive test.
+};
+
+/// @brief A node in a flattened BVH.
+///
+/// Children of an interior node are stored next to each other: the left
+/// child at @c offset and the right child at @c offset + 1.
+struct bvh_node {
+    math::aabb bounds;
+    uint32_t   offset = 0;  ///< First primitive (leaf) or left child index (interior).
+    uint32_t   count  = 0;  ///< Primitive count; 0 for interior nodes.
+
+    [[nodiscard]] constexpr bool is_leaf() const noexcept { return count > 0; }
+};
+
+namespace detail {
+
+/// @brief Result of an SAH split search.
+struct sah_split {
+    int      axis = -1;     ///< Split axis, or -1 if no split is possible.
+    uint32_t bin  = 0;      ///< Primitives in bins [0, bin) go left.
+    float    cost = 0.0f;   ///< SAH cost of the split (relative to parent area).
+    float    origin = 0.0f; ///< Centroid bounds minimum on the split axis.
+    float    scale  = 0.0f; ///< Bin index per unit length on the split axis.
+};
+
+/// @brief Maps a centroid coordinate to its bin.
+[[nodiscard]] inline uint32_t bin_index(float c, float origin, float scale, uint32_t bins) {
+    auto b = static_cast<int64_t>((c - origin) * scale);
+    return static_cast<uint32_t>(std::clamp<int64_t>(b, 0, bins - 1));
+}
+
+/// @brief Finds the cheapest binned SAH object split for a primitive range.
+/// @param bounds Per-primitive bounds, indexed by primitive id.
+/// @param centroids Per-primitive centroids, indexed by primitive id.
+/// @param indices Primitive ids in the node.
+/// @param node_bounds Bounds of the node being split.
+/// @param options Builder tunables.
+inline sah_split find_sah_split(
+    std::span<const math::aabb> bounds,
+    std::span<const math::vec3> centroids,
+    std::span<const uint32_t> indices,
+    const math::aabb& node_bounds,
+    const build_options& options
+) {
+    sah_split best;
+    best.cost = std::numeric_limits<float>::infinity();
+
+    math::aabb centroid_bounds;
+    for (uint32_t i : indices) {
+        centroid_bounds.expand(centroids[i]);
+    }
+
+    uint32_t bins = std::clamp<uint32_t>(options.bin_count, 2, k_max_bins);
+    float parent_area = node_bounds.surface_area();
+    if (parent_area <= 0.0f) {
+        parent_area = 1.0f;
+    }
+
+    for (int axis = 0; axis < 3; ++axis) {
+        float lo = centroid_bounds.min[axis];
+        float hi = centroid_bounds.max[axis];
+        if (!(hi > lo)) {
+            continue;
+        }
+
+        float scale = static_cast<float>(bins) / (hi - lo);
+
+        std::array<math::aabb, k_max_bins> bin_bounds{};
+        std::array<uint32_t, k_max_bins>   bin_counts{};
+        for (uint32_t i : indices) {
+            uint32_t b = bin_index(centroids[i][axis], lo, scale, bins);
+            bin_bounds[b].expand(bounds[i]);
+            ++bin_counts[b];
+        }
+
+        // Sweep from the right to get the area/count of every right-hand side.
+        std::array<float, k_max_bins>    right_area{};
+        std::array<uint32_t, k_max_bins> right_count{};
+        math::aabb acc;
+        uint32_t   n = 0;
+        for (uint32_t b = bins - 1; b > 0; --b) {
+            acc.expand(bin_bounds[b]);
+            n += bin_counts[b];
+            right_area[b]  = acc.surface_area();
+            right_count[b] = n;
+        }
+
+        acc = {};
+        n   = 0;
+        for (uint32_t b = 1; b < bins; ++b) {
+            acc.expand(bin_bounds[b - 1]);
+            n += bin_counts[b - 1];
+            if (n == 0 || right_count[b] == 0) {
+                continue;
+            }
+            float cost = options.traversal_cost +
+                options.intersection_cost *
+                (acc.surface_area() * static_cast<float>(n) +
+                 right_area[b] * static_cast<float>(right_count[b])) / parent_area;
+            if (cost < best.cost) {
+                best = {.axis = axis, .bin = b, .cost = cost, .origin = lo, .scale = scale};
+            }
+        }
+    }
+
+    return best;
+}
+
+/// @brief Partitions a primitive range according to an SAH split.
+/// @return Number of primitives placed on the left side. Always in [1, size).
+inline uint32_t partition(
+    std::span<uint32_t> indices,
+    std::span<const math::vec3> centroids,
+    const sah_split& split,
+    const build_options& options
+) {
+    uint32_t bins = std::clamp<uint32_t>(options.bin_count, 2, k_max_bins);
+    auto mid = std::partition(indices.begin(), indices.end(), [&](uint32_t i) {
+        return bin_index(centroids[i][split.axis], split.origin, split.scale, bins) < split.bin;
+    });
+
+    auto left = static_cast<uint32_t>(mid - indices.begin());
+    if (left == 0 || left == indices.size()) {
+        // Float rounding put everything on one side; fall back to a median split.
+        left = static_cast<uint32_t>(indices.size() / 2);
+        std::nth_element(indices.begin(), indices.begin() + left, indices.end(),
+            [&](uint32_t a, uint32_t b) {
+                return centroids[a][split.axis] < centroids[b][split.axis];
+            });
+    }
+    return left;
+}
+
+/// @brief Returns the depth at which a builder must stop splitting.
+[[nodiscard]] inline uint32_t depth_limit(const build_options& options) noexcept {
+    return std::min(options.max_depth, k_max_depth);
+}
+
+/// @brief Computes the union of primitive bounds over a range.
+inline math::aabb range_bounds(std::span<const math::aabb> bounds, std::span<const uint32_t> indices) {
+    math::aabb b;
+    for (uint32_t i : indices) {
+        b.expand(bounds[i]);
+    }
+    return b;
+}
+
+}  // namespace detail
+
+/// @brief Counters gathered by bvh::intersect_instrumented() and
+///        ordered_bvh::intersect_instrumented(). Only the latter fills the
+///        cache fields.
+struct traversal_stats {
+    uint64_t rays          = 0;
+    uint64_t nodes_visited = 0;  ///< Nodes (hot nodes) whose bounds were tested.
+    uint64_t leaves_visited = 0;
+    uint64_t prims_tested  = 0;
+    uint64_t line_accesses = 0;  ///< Cache lines read (from cache_model).
+    uint64_t cache_misses  = 0;  ///< Cache lines missed (from cache_model).
+
+    traversal_stats& operator+=(const traversal_stats& o) noexcept {
+        rays           += o.rays;
+        nodes_visited  += o.nodes_visited;
+        leaves_visited += o.leaves_visited;
+        prims_tested   += o.prims_tested;
+        line_accesses  += o.line_accesses;
+        cache_misses   += o.cache_misses;
+        return *this;
+    }
+};
+
+/// @class bvh
+/// @brief A fully built binary BVH over primitive bounds.
+///
+/// Example usage:
+/// @code
+/// std::vector<math::aabb> bounds;
+/// for (const auto& q : scene.quads) bounds.push_back(q.geometry.bounds());
+/// auto tree = bvh::build(bounds);
+///
+/// float t_max = 1e30f;
+/// tree.intersect(ray, t_max, [&](uint32_t prim, float& t) {
+///     auto hit = scene::intersect(ray, scene.quads[prim].geometry, 0.001f, t);
+///     if (hit) t = hit->t;
+///     return hit.has_value();
+/// });
+/// @endcode
+class bvh {
+public:
+    bvh() = default;
+
+    /// @brief Wraps nodes and leaf primitive ids produced by another builder.
+    /// @param nodes Flattened nodes, root at index 0, siblings adjacent.
+    /// @param prim_indices Primitive ids referenced by leaf ranges. May
+    ///        contain duplicates (e.g. from spatial splits).
+    bvh(std::vector<bvh_node> nodes, std::vector<uint32_t> prim_indices)
+        : nodes_{std::move(nodes)}
+        , prim_indices_{std::move(prim_indices)} {}
+
+    /// @brief Builds a BVH over the given primitive bounds.
+    /// @param prim_bounds Bounds of each primitive, indexed by primitive id.
+    /// @param options Builder tunables.
+    [[nodiscard]] static bvh build(std::span<const math::aabb> prim_bounds, build_options options = {}) {
+        bvh tree;
+        auto n = static_cast<uint32_t>(prim_bounds.size());
+        if (n == 0) {
+            return tree;
+        }
+
+        std::vector<math::vec3> centroids(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            centroids[i] = prim_bounds[i].centroid();
+        }
+
+        tree.prim_indices_.resize(n);
+        std::iota(tree.prim_indices_.begin(), tree.prim_indices_.end(), 0u);
+        tree.nodes_.reserve(2 * n - 1);
+        tree.nodes_.push_back({detail::range_bounds(prim_bounds, tree.prim_indices_), 0, n});
+
+        // (node index, depth) pairs still to be split.
+        std::vector<std::pair<uint32_t, uint32_t>> stack{{0u, 0u}};
+        const uint32_t max_depth = detail::depth_limit(options);
+        while (!stack.empty()) {
+            auto [node_index, depth] = stack.back();
+            stack.pop_back();
+
+            bvh_node node = tree.nodes_[node_index];
+            if (node.count <= options.max_leaf_size || depth >= max_depth) {
+                continue;
+            }
+
+            std::span<uint32_t> range{tree.prim_indices_.data() + node.offset, node.count};
+            auto split = detail::find_sah_split(prim_bounds, centroids, range, node.bounds, options);
+            if (split.axis < 0) {
+                continue;  // All centroids coincide; keep as a leaf.
+            }
+
+            uint32_t left_count = detail::partition(range, centroids, split, options);
+            auto left  = std::span<const uint32_t>{range}.first(left_count);
+            auto right = std::span<const uint32_t>{range}.subspan(left_count);
+
+            auto child = static_cast<uint32_t>(tree.nodes_.size());
+            tree.nodes_.push_back({detail::range_bounds(prim_bounds, left), node.offset, left_count});
+            tree.nodes_.push_back({detail::range_bounds(prim_bounds, right),
+                                   node.offset + left_count, node.count - left_count});
+            tree.nodes_[node_index].offset = child;
+            tree.nodes_[node_index].count  = 0;
+
+            stack.push_back({child, depth + 1});
+            stack.push_back({child + 1, depth + 1});
+        }
+
+        return tree;
+    }
+
+    /// @brief Finds the closest intersection along a ray.
+    /// @tparam Intersect Callable `bool(uint32_t prim, float& t_max)` that tests a
+    ///         primitive and shrinks @p t_max on a hit.
+    /// @param r The ray to trace.
+    /// @param t_max In: maximum distance. Out: distance to the closest hit.
+    /// @param intersect_prim Primitive intersection callback.
+    /// @return True if any primitive was hit.
+    template <typename Intersect>
+    bool intersect(const math::ray& r, float& t_max, Intersect&& intersect_prim) const {
+        return traverse<false>(r, t_max, intersect_prim, nullptr);
+    }
+
+    /// @brief Like intersect(), but adds the ray's traversal work to @p stats.
+    ///
+    /// A separate instantiation, so intersect() pays nothing for it.
+    template <typename Intersect>
+    bool intersect_instrumented(const math::ray& r, float& t_max, Intersect&& intersect_prim,
+                                traversal_stats& stats) const {
+        ++stats.rays;
+        return traverse<true>(r, t_max, intersect_prim, &stats);
+    }
+
+    /// @brief Returns the flattened node array (root at index 0).
+    [[nodiscard]] std::span<const bvh_node> nodes() const noexcept { return nodes_; }
+
+    /// @brief Returns primitive ids in leaf order.
+    [[nodiscard]] std::span<const uint32_t> primitive_indices() const noexcept { return prim_indices_; }
+
+    /// @brief Returns the bounds of the whole tree.
+    [[nodiscard]] math::aabb bounds() const {
+        return nodes_.empty() ? math::aabb{} : nodes_[0].bounds;
+    }
+
+    /// @brief Returns true if the tree has no nodes.
+    [[nodiscard]] bool empty() const noexcept { return nodes_.empty(); }
+
+private:
+    template <bool Instrumented, typename Intersect>
+    bool traverse(const math::ray& r, float& t_max, Intersect& intersect_prim,
+                  [[maybe_unused]] traversal_stats* stats) const {
+        if (nodes_.empty()) {
+            return false;
+        }
+
+        math::vec3 inv_dir = math::inverse_direction(r);
+        bool hit = false;
+
+        std::array<uint32_t, k_max_stack_depth> stack;
+        uint32_t sp = 0;
+        stack[sp++] = 0;
+
+        while (sp > 0) {
+            const bvh_node& node = nodes_[stack[--sp]];
+            if constexpr (Instrumented) {
+                ++stats->nodes_visited;
+            }
+            if (math::intersect(node.bounds, r.origin, inv_dir, 0.0f, t_max) > t_max) {
+                continue;
+            }
+
+            if (node.is_leaf()) {
+                if constexpr (Instrumented) {
+                    ++stats->leaves_visited;
+                    stats->prims_tested += node.count;
+                }
+                for (uint32_t i = 0; i < node.count; ++i) {
+                    hit |= intersect_prim(prim_indices_[node.offset + i], t_max);
+                }
+                continue;
+            }
+
+            // Visit the nearer child first by pushing it last.
+            float t_left  = math::intersect(nodes_[node.offset].bounds, r.origin, inv_dir, 0.0f, t_max);
+            float t_right = math::intersect(nodes_[node.offset + 1].bounds, r.origin, inv_dir, 0.0f, t_max);
+            uint32_t near_child = t_left <= t_right ? node.offset : node.offset + 1;
+            uint32_t far_child  = t_left <= t_right ? node.offset + 1 : node.offset;
+            stack[sp++] = far_child;
+            stack[sp++] = near_child;
+        }
+
+        return hit;
+    }
+
+    std::vector<bvh_node> nodes_;
+    std::vector<uint32_t> prim_indices_;
+};
+
+}  // namespace Q::accel
@@ -0,0 +1,475 @@
+/// @file layout.hpp
+/// @brief Post-build BVH node reordering with hot/cold data separation.
+///
+/// Node order determines how many cache lines a traversal touches. The
+/// builders emit nodes in construction order, which scatters a subtree's
+/// nodes across memory. This pass rewrites a built tree in one of several
+/// cache-friendly orders and splits each node into:
+///
+/// - hot data (bounds, child indices) read at every visited node, packed
+///   two nodes per 64-byte cache line; and
+/// - cold data (primitive range, build metadata) read only at leaves or by
+///   tooling.
+///
+/// A small set-associative cache model is provided so layouts can be
+/// compared by simulated cache misses, not just node counts.
+
+#pragma once
+
+#include <quasi/accel/bvh.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <format>
+#include <new>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Q::accel {
+
+/// @brief Node orderings supported by reorder().
+enum class node_order {
+    breadth_first,  ///< Level by level. Siblings adjacent, subtrees scattered.
+    depth_first,    ///< Pre-order. The left child directly follows its parent.
+    van_emde_boas,  ///< Recursive top/bottom subtree blocking; cache-oblivious.
+    treelet,        ///< Greedy surface-area treelets sized to a memory block.
+};
+
+/// @brief Converts a node_order to a human-readable string.
+[[nodiscard]] constexpr const char* to_string(node_order order) noexcept {
+    switch (order) {
+        case node_order::breadth_first: return "breadth-first";
+        case node_order::depth_first:   return "depth-first";
+        case node_order::van_emde_boas: return "van Emde Boas";
+        case node_order::treelet:       return "treelet";
+    }
+    return "unknown";
+}
+
+/// @brief Tunables for reorder().
+struct layout_options {
+    node_order order         = node_order::depth_first;
+    uint32_t   treelet_bytes = 4096;  ///< Hot bytes per treelet (node_order::treelet only).
+};
+
+/// @brief Per-node data read on every visit. Exactly half a cache line.
+struct alignas(32) hot_node {
+    math::aabb bounds;
+    uint32_t   left  = 0;  ///< Left child index, or k_leaf_flag for leaves.
+    uint32_t   right = 0;  ///< Right child index (interior only).
+};
+
+static_assert(sizeof(hot_node) == 32, "hot_node must stay half a cache line");
+
+/// @brief Allocator that starts every array on a cache line.
+///
+/// hot_node's own alignment only guarantees 32 bytes, so a plain vector
+/// may start halfway into a line and split every sibling pair across two.
+template <typename T>
+struct cache_line_allocator {
+    using value_type = T;
+
+    static constexpr std::align_val_t k_alignment{64};
+
+    cache_line_allocator() = default;
+    template <typename U>
+    cache_line_allocator(const cache_line_allocator<U>&) noexcept {}
+
+    [[nodiscard]] T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), k_alignment));
+    }
+    void deallocate(T* p, size_t) noexcept { ::operator delete(p, k_alignment); }
+
+    friend bool operator==(const cache_line_allocator&, const cache_line_allocator&) noexcept { return true; }
+};
+
+/// @brief Hot node storage, cache-line aligned.
+using hot_node_array = std::vector<hot_node, cache_line_allocator<hot_node>>;
+
+/// @brief Marks a hot_node as a leaf; its primitive range is in the cold node.
+inline constexpr uint32_t k_leaf_flag = 0xFFFFFFFFu;
+
+/// @brief Per-node data read only at leaves or by tooling.
+struct cold_node {
+    uint32_t first  = 0;  ///< First primitive in primitive_indices (leaves only).
+    uint32_t count  = 0;  ///< Primitive count (0 for interior nodes).
+    uint32_t parent = 0;  ///< Parent index in the reordered tree (root: itself).
+    uint32_t depth  = 0;  ///< Distance from the root.
+};
+
+/// @class cache_model
+/// @brief Set-associative LRU cache simulator for layout comparisons.
+///
+/// Feed it every address a traversal reads; it counts line accesses and
+/// misses. The defaults model a 32 KiB, 8-way L1 data cache.
+class cache_model {
+public:
+    /// @param line_bytes Cache line size in bytes (power of two).
+    /// @param sets Number of sets.
+    /// @param ways Associativity.
+    explicit cache_model(uint32_t line_bytes = 64, uint32_t sets = 64, uint32_t ways = 8)
+        : line_bytes_{line_bytes}
+        , sets_{sets}
+        , ways_{ways}
+        , tags_(static_cast<size_t>(sets) * ways, k_invalid)
+        , stamps_(static_cast<size_t>(sets) * ways, 0) {}
+
+    /// @brief Records a read of @p bytes starting at @p ptr.
+    void access(const void* ptr, size_t bytes) {
+        auto addr = reinterpret_cast<uintptr_t>(ptr);
+        uintptr_t first = addr / line_bytes_;
+        uintptr_t last  = (addr + (bytes ? bytes - 1 : 0)) / line_bytes_;
+        for (uintptr_t line = first; line <= last; ++line) {
+            touch(line);
+        }
+    }
+
+    /// @brief Total cache line accesses.
+    [[nodiscard]] uint64_t accesses() const noexcept { return accesses_; }
+
+    /// @brief Cache line accesses that missed.
+    [[nodiscard]] uint64_t misses() const noexcept { return misses_; }
+
+    /// @brief Invalidates all lines and resets counters.
+    void reset() {
+        std::fill(tags_.begin(), tags_.end(), k_invalid);
+        std::fill(stamps_.begin(), stamps_.end(), 0);
+        accesses_ = misses_ = clock_ = 0;
+    }
+
+private:
+    static constexpr uintptr_t k_invalid = ~uintptr_t{0};
+
+    void touch(uintptr_t line) {
+        ++accesses_;
+        ++clock_;
+        size_t base = static_cast<size_t>(line % sets_) * ways_;
+        size_t victim = base;
+        for (size_t w = base; w < base + ways_; ++w) {
+            if (tags_[w] == line) {
+                stamps_[w] = clock_;
+                return;
+            }
+            if (stamps_[w] < stamps_[victim]) {
+                victim = w;
+            }
+        }
+        ++misses_;
+        tags_[victim]   = line;
+        stamps_[victim] = clock_;
+    }
+
+    uint32_t               line_bytes_;
+    uint32_t               sets_;
+    uint32_t               ways_;
+    std::vector<uintptr_t> tags_;
+    std::vector<uint64_t>  stamps_;
+    uint64_t               accesses_ = 0;
+    uint64_t               misses_   = 0;
+    uint64_t               clock_    = 0;
+};
+
+/// @brief Formats traversal statistics as a single report line.
+[[nodiscard]] inline std::string to_string(const traversal_stats& s) {
+    auto per_ray = [&](uint64_t v) {
+        return s.rays ? static_cast<double>(v) / static_cast<double>(s.rays) : 0.0;
+    };
+    double miss_rate = s.line_accesses
+        ? 100.0 * static_cast<double>(s.cache_misses) / static_cast<double>(s.line_accesses)
+        : 0.0;
+    return std::format(
+        "rays={} nodes/ray={:.2f} prims/ray={:.2f} lines/ray={:.2f} misses/ray={:.2f} miss_rate={:.1f}%",
+        s.rays, per_ray(s.nodes_visited), per_ray(s.prims_tested),
+        per_ray(s.line_accesses), per_ray(s.cache_misses), miss_rate);
+}
+
+/// @class ordered_bvh
+/// @brief A BVH rewritten in a cache-friendly order with hot/cold node data.
+///
+/// Example usage:
+/// @code
+/// auto tree = reorder(bvh::build(bounds), {.order = node_order::treelet});
+/// tree.intersect(ray, t_max, intersect_prim);
+///
+/// cache_model cache;
+/// traversal_stats stats;
+/// tree.intersect_instrumented(ray, t_max, intersect_prim, stats, cache);
+/// std::puts(to_string(stats).c_str());
+/// @endcode
+class ordered_bvh {
+public:
+    ordered_bvh() = default;
+
+    ordered_bvh(hot_node_array hot, std::vector<cold_node> cold,
+                std::vector<uint32_t> prim_indices, node_order order)
+        : hot_{std::move(hot)}
+        , cold_{std::move(cold)}
+        , prim_indices_{std::move(prim_indices)}
+        , order_{order} {}
+
+    /// @brief Finds the closest intersection along a ray.
+    /// @see bvh::intersect for the callback contract.
+    template <typename Intersect>
+    bool intersect(const math::ray& r, float& t_max, Intersect&& intersect_prim) const {
+        traversal_stats* no_stats = nullptr;
+        cache_model* no_cache = nullptr;
+        return traverse<false>(r, t_max, intersect_prim, no_stats, no_cache);
+    }
+
+    /// @brief Like intersect(), but records counters and feeds every node
+    ///        and index read through a cache model.
+    template <typename Intersect>
+    bool intersect_instrumented(const math::ray& r, float& t_max, Intersect&& intersect_prim,
+                                traversal_stats& stats, cache_model& cache) const {
+        traversal_stats* s = &stats;
+        cache_model* c = &cache;
+        uint64_t accesses = cache.accesses();
+        uint64_t misses = cache.misses();
+        bool hit = traverse<true>(r, t_max, intersect_prim, s, c);
+        ++stats.rays;
+        stats.line_accesses += cache.accesses() - accesses;
+        stats.cache_misses  += cache.misses() - misses;
+        return hit;
+    }
+
+    [[nodiscard]] std::span<const hot_node>  hot_nodes() const noexcept { return hot_; }
+    [[nodiscard]] std::span<const cold_node> cold_nodes() const noexcept { return cold_; }
+    [[nodiscard]] std::span<const uint32_t>  primitive_indices() const noexcept { return prim_indices_; }
+    [[nodiscard]] node_order order() const noexcept { return order_; }
+    [[nodiscard]] bool empty() const noexcept { return hot_.empty(); }
+
+private:
+    template <bool Instrumented, typename Intersect>
+    bool traverse(const math::ray& r, float& t_max, Intersect& intersect_prim,
+                  traversal_stats* stats, cache_model* cache) const {
+        if (hot_.empty()) {
+            return false;
+        }
+
+        math::vec3 inv_dir = math::inverse_direction(r);
+        bool hit = false;
+
+        std::array<uint32_t, k_max_stack_depth> stack;
+        uint32_t sp = 0;
+        stack[sp++] = 0;
+
+        while (sp > 0) {
+            uint32_t index = stack[--sp];
+            const hot_node& node = hot_[index];
+            if constexpr (Instrumented) {
+                ++stats->nodes_visited;
+                cache->access(&node, sizeof(hot_node));
+            }
+
+            if (math::intersect(node.bounds, r.origin, inv_dir, 0.0f, t_max) > t_max) {
+                continue;
+            }
+
+            if (node.left == k_leaf_flag) {
+                const cold_node& leaf = cold_[index];
+                if constexpr (Instrumented) {
+                    ++stats->leaves_visited;
+                    stats->prims_tested += leaf.count;
+                    cache->access(&leaf, sizeof(cold_node));
+                    cache->access(&prim_indices_[leaf.first], leaf.count * sizeof(uint32_t));
+                }
+                for (uint32_t i = 0; i < leaf.count; ++i) {
+                    hit |= intersect_prim(prim_indices_[leaf.first + i], t_max);
+                }
+                continue;
+            }
+
+            // Children are pushed without a distance test; the pop tests them.
+            // Ordering by the ray's sign on the parent's widest axis keeps the
+            // near child first without reading both children's bounds here.
+            int axis = node.bounds.largest_axis();
+            bool left_first = r.direction[axis] >= 0.0f;
+            stack[sp++] = left_first ? node.right : node.left;
+            stack[sp++] = left_first ? node.left : node.right;
+        }
+
+        return hit;
+    }
+
+    hot_node_array         hot_;
+    std::vector<cold_node> cold_;
+    std::vector<uint32_t>  prim_indices_;
+    node_order             order_ = node_order::depth_first;
+};
+
+namespace detail {
+
+/// @brief Computes the sequence of source node indices for a given order.
+class layout_sequencer {
+public:
+    layout_sequencer(std::span<const bvh_node> nodes, const layout_options& options)
+        : nodes_{nodes}
+        , options_{options}
+        , height_(nodes.size(), 1) {
+        // Children always have larger indices than their parents in builder
+        // output, so a reverse sweep computes subtree heights bottom-up.
+        for (size_t i = nodes.size(); i-- > 0;) {
+            if (!nodes[i].is_leaf()) {
+                height_[i] = 1 + std::max(height_[nodes[i].offset], height_[nodes[i].offset + 1]);
+            }
+        }
+    }
+
+    std::vector<uint32_t> sequence() {
+        order_.reserve(nodes_.size());
+        switch (options_.order) {
+            case node_order::breadth_first: breadth_first(); break;
+            case node_order::depth_first:   depth_first(0); break;
+            case node_order::van_emde_boas: van_emde_boas(0, height_[0]); break;
+            case node_order::treelet:       treelets(); break;
+        }
+        return std::move(order_);
+    }
+
+private:
+    void breadth_first() {
+        std::deque<uint32_t> queue{0};
+        while (!queue.empty()) {
+            uint32_t i = queue.front();
+            queue.pop_front();
+            order_.push_back(i);
+            if (!nodes_[i].is_leaf()) {
+                queue.push_back(nodes_[i].offset);
+                queue.push_back(nodes_[i].offset + 1);
+            }
+        }
+    }
+
+    void depth_first(uint32_t root) {
+        std::vector<uint32_t> stack{root};
+        while (!stack.empty()) {
+            uint32_t i = stack.back();
+            stack.pop_back();
+            order_.push_back(i);
+            if (!nodes_[i].is_leaf()) {
+                stack.push_back(nodes_[i].offset + 1);
+                stack.push_back(nodes_[i].offset);
+            }
+        }
+    }
+
+    /// @brief Lays out the top @p levels of the subtree at @p root.
+    void van_emde_boas(uint32_t root, uint32_t levels) {
+        if (levels <= 1 || nodes_[root].is_leaf()) {
+            order_.push_back(root);
+            return;
+        }
+
+        uint32_t top = levels / 2;
+        van_emde_boas(root, top);
+
+        // Each node just below the top block roots a bottom block.
+        std::vector<uint32_t> frontier{root};
+        for (uint32_t d = 0; d < top; ++d) {
+            std::vector<uint32_t> next;
+            for (uint32_t i : frontier) {
+                if (!nodes_[i].is_leaf()) {
+                    next.push_back(nodes_[i].offset);
+                    next.push_back(nodes_[i].offset + 1);
+                }
+            }
+            frontier = std::move(next);
+        }
+        for (uint32_t i : frontier) {
+            van_emde_boas(i, levels - top);
+        }
+    }
+
+    void treelets() {
+        auto capacity = std::max<uint32_t>(1, options_.treelet_bytes / sizeof(hot_node));
+
+        std::deque<uint32_t> roots{0};
+        while (!roots.empty()) {
+            uint32_t root = roots.front();
+            roots.pop_front();
+
+            // Grow the treelet by repeatedly adding the frontier node with the
+            // largest surface area, i.e. the one rays most likely enter next.
+            std::vector<uint32_t> members{root};
+            std::vector<uint32_t> frontier;
+            auto open = [&](uint32_t i) {
+                if (!nodes_[i].is_leaf()) {
+                    frontier.push_back(nodes_[i].offset);
+                    frontier.push_back(nodes_[i].offset + 1);
+                }
+            };
+            open(root);
+
+            while (members.size() < capacity && !frontier.empty()) {
+                auto best = std::max_element(frontier.begin(), frontier.end(), [&](uint32_t a, uint32_t b) {
+                    return nodes_[a].bounds.surface_area() < nodes_[b].bounds.surface_area();
+                });
+                uint32_t next = *best;
+                frontier.erase(best);
+                members.push_back(next);
+                open(next);
+            }
+
+            order_.insert(order_.end(), members.begin(), members.end());
+            roots.insert(roots.end(), frontier.begin(), frontier.end());
+        }
+    }
+
+    std::span<const bvh_node> nodes_;
+    layout_options            options_;
+    std::vector<uint32_t>     height_;
+    std::vector<uint32_t>     order_;
+};
+
+}  // namespace detail
+
+/// @brief Rewrites a built BVH in a cache-friendly node order.
+/// @param tree The source tree (from bvh::build or build_sbvh).
+/// @param options Target order and treelet size.
+/// @return The reordered tree with hot/cold node data.
+[[nodiscard]] inline ordered_bvh reorder(const bvh& tree, layout_options options = {}) {
+    auto nodes = tree.nodes();
+    if (nodes.empty()) {
+        return {};
+    }
+
+    auto sequence = detail::layout_sequencer{nodes, options}.sequence();
+
+    std::vector<uint32_t> new_index(nodes.size());
+    for (uint32_t i = 0; i < sequence.size(); ++i) {
+        new_index[sequence[i]] = i;
+    }
+
+    hot_node_array         hot(nodes.size());
+    std::vector<cold_node> cold(nodes.size());
+    std::vector<uint32_t>  prims;
+    prims.reserve(tree.primitive_indices().size());
+
+    for (uint32_t i = 0; i < sequence.size(); ++i) {
+        const bvh_node& src = nodes[sequence[i]];
+        hot[i].bounds = src.bounds;
+
+        if (src.is_leaf()) {
+            hot[i].left   = k_leaf_flag;
+            cold[i].first = static_cast<uint32_t>(prims.size());
+            cold[i].count = src.count;
+            // Leaf primitive ids follow the new node order as well.
+            auto ids = tree.primitive_indices().subspan(src.offset, src.count);
+            prims.insert(prims.end(), ids.begin(), ids.end());
+        } else {
+            uint32_t l = new_index[src.offset];
+            uint32_t r = new_index[src.offset + 1];
+            hot[i].left  = l;
+            hot[i].right = r;
+            cold[l].parent = cold[r].parent = i;
+            cold[l].depth  = cold[r].depth  = cold[i].depth + 1;
+        }
+    }
+
+    return {std::move(hot), std::move(cold), std::move(prims), options.order};
+}
+
+}  // namespace Q::accel
@@ -0,0 +1,290 @@
+/// @file lazy_bvh.hpp
+/// @brief BVH that defers subtree construction until a ray first enters it.
+///
+/// A full SAH build must finish before the first ray is traced. For large
+/// scenes that delays the first image on startup and after every hot reload.
+/// The lazy BVH builds only the top few levels up front; deeper nodes stay
+/// "pending" and are split by whichever thread first traverses them. Regions
+/// no ray ever reaches are never built.
+///
+/// Thread safety: intersect() may be called concurrently. Each pending node
+/// is claimed with a compare-exchange, split, and published with a release
+/// store. Threads that reach a node while it is being split wait on the node
+/// state (futex-backed std::atomic::wait) until it is published.
+
+#pragma once
+
+#include <quasi/accel/bvh.hpp>
+
+#include <atomic>
+#include <memory>
+
+namespace Q::accel {
+
+/// @brief Tunables for the lazy builder.
+struct lazy_build_options {
+    build_options build{};          ///< SAH parameters used for every split.
+    uint32_t      eager_depth = 4;  ///< Levels built before the first traversal.
+};
+
+/// @class lazy_bvh
+/// @brief A BVH whose subtrees are split on first traversal.
+///
+/// Example usage:
+/// @code
+/// auto tree = lazy_bvh::build(bounds, {.eager_depth = 3});
+///
+/// // First rays can be traced immediately; nodes expand as they are hit.
+/// tree.intersect(ray, t_max, intersect_prim);
+///
+/// // Optionally finish the build in the background once interactive.
+/// std::thread{[&] { tree.expand_all(); }}.detach();
+/// @endcode
+class lazy_bvh {
+public:
+    /// @brief Construction state of a node.
+    enum class node_state : uint32_t {
+        pending,   ///< Not yet split; primitive range is valid.
+        building,  ///< Being split by another thread.
+        leaf,      ///< Final leaf; primitive range is valid.
+        interior,  ///< Split; children are at left and left + 1.
+    };
+
+    /// @brief A node in the lazily built tree.
+    ///
+    /// bounds, first, count and depth are written once before the node is
+    /// published and never change. left is written before the release
+    /// store that moves the node to node_state::interior.
+    struct node {
+        math::aabb              bounds;
+        uint32_t                first = 0;  ///< First primitive in prim_indices.
+        uint32_t                count = 0;  ///< Number of primitives.
+        uint32_t                left  = 0;  ///< Left child index (interior only).
+        uint32_t                depth = 0;  ///< Distance from the root.
+        std::atomic<node_state> state{node_state::pending};
+    };
+
+    lazy_bvh() = default;
+
+    /// @brief Builds the top levels of a BVH over the given primitive bounds.
+    /// @param prim_bounds Bounds of each primitive, indexed by primitive id.
+    /// @param options Builder tunables.
+    [[nodiscard]] static lazy_bvh build(std::span<const math::aabb> prim_bounds,
+                                        lazy_build_options options = {}) {
+        lazy_bvh tree;
+        auto n = static_cast<uint32_t>(prim_bounds.size());
+        if (n == 0) {
+            return tree;
+        }
+
+        auto s = std::make_unique<storage>();
+        s->options = options.build;
+        s->bounds.assign(prim_bounds.begin(), prim_bounds.end());
+        s->centroids.resize(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            s->centroids[i] = prim_bounds[i].centroid();
+        }
+        s->prim_indices.resize(n);
+        std::iota(s->prim_indices.begin(), s->prim_indices.end(), 0u);
+
+        // Every split produces two non-empty children, so 2n - 1 nodes always
+        // suffice. Allocating up front keeps node addresses stable while
+        // other threads are reading them.
+        s->nodes = std::make_unique<node[]>(2 * n - 1);
+        s->node_count.store(1, std::memory_order_relaxed);
+
+        node& root = s->nodes[0];
+        root.bounds = detail::range_bounds(s->bounds, s->prim_indices);
+        root.first  = 0;
+        root.count  = n;
+        if (n <= s->options.max_leaf_size) {
+            root.state.store(node_state::leaf, std::memory_order_relaxed);
+        } else {
+            s->pending.store(1, std::memory_order_relaxed);
+        }
+
+        tree.storage_ = std::move(s);
+
+        // Eagerly split the top levels, breadth first.
+        std::vector<uint32_t> level{0};
+        for (uint32_t depth = 0; depth < options.eager_depth && !level.empty(); ++depth) {
+            std::vector<uint32_t> next;
+            for (uint32_t index : level) {
+                if (tree.expand(index) == node_state::interior) {
+                    uint32_t left = tree.storage_->nodes[index].left;
+                    next.push_back(left);
+                    next.push_back(left + 1);
+                }
+            }
+            level = std::move(next);
+        }
+
+        return tree;
+    }
+
+    /// @brief Finds the closest intersection along a ray, expanding nodes as needed.
+    /// @tparam Intersect Callable `bool(uint32_t prim, float& t_max)` that tests a
+    ///         primitive and shrinks @p t_max on a hit.
+    /// @param r The ray to trace.
+    /// @param t_max In: maximum distance. Out: distance to the closest hit.
+    /// @param intersect_prim Primitive intersection callback.
+    /// @return True if any primitive was hit.
+    template <typename Intersect>
+    bool intersect(const math::ray& r, float& t_max, Intersect&& intersect_prim) const {
+        if (!storage_) {
+            return false;
+        }
+
+        const storage& s = *storage_;
+        math::vec3 inv_dir = math::inverse_direction(r);
+        bool hit = false;
+
+        std::array<uint32_t, k_max_stack_depth> stack;
+        uint32_t sp = 0;
+        stack[sp++] = 0;
+
+        while (sp > 0) {
+            uint32_t index = stack[--sp];
+            const node& n = s.nodes[index];
+            if (math::intersect(n.bounds, r.origin, inv_dir, 0.0f, t_max) > t_max) {
+                continue;
+            }
+
+            node_state state = n.state.load(std::memory_order_acquire);
+            if (state == node_state::pending || state == node_state::building) {
+                state = expand(index);
+            }
+
+            if (state == node_state::leaf) {
+                for (uint32_t i = 0; i < n.count; ++i) {
+                    hit |= intersect_prim(s.prim_indices[n.first + i], t_max);
+                }
+                continue;
+            }
+
+            float t_left  = math::intersect(s.nodes[n.left].bounds, r.origin, inv_dir, 0.0f, t_max);
+            float t_right = math::intersect(s.nodes[n.left + 1].bounds, r.origin, inv_dir, 0.0f, t_max);
+            uint32_t near_child = t_left <= t_right ? n.left : n.left + 1;
+            uint32_t far_child  = t_left <= t_right ? n.left + 1 : n.left;
+            stack[sp++] = far_child;
+            stack[sp++] = near_child;
+        }
+
+        return hit;
+    }
+
+    /// @brief Splits every remaining pending node.
+    ///
+    /// Safe to call while other threads trace rays, e.g. from a background
+    /// thread once the first frames are on screen.
+    void expand_all() const {
+        if (!storage_) {
+            return;
+        }
+        std::vector<uint32_t> stack{0};
+        while (!stack.empty()) {
+            uint32_t index = stack.back();
+            stack.pop_back();
+            if (expand(index) == node_state::interior) {
+                uint32_t left = storage_->nodes[index].left;
+                stack.push_back(left);
+                stack.push_back(left + 1);
+            }
+        }
+    }
+
+    /// @brief Returns true once no pending nodes remain.
+    [[nodiscard]] bool is_fully_built() const noexcept {
+        return !storage_ || storage_->pending.load(std::memory_order_acquire) == 0;
+    }
+
+    /// @brief Returns the number of nodes allocated so far.
+    [[nodiscard]] uint32_t node_count() const noexcept {
+        return storage_ ? storage_->node_count.load(std::memory_order_acquire) : 0;
+    }
+
+    /// @brief Returns the number of nodes still waiting to be split.
+    [[nodiscard]] uint32_t pending_count() const noexcept {
+        return storage_ ? storage_->pending.load(std::memory_order_acquire) : 0;
+    }
+
+    /// @brief Returns the bounds of the whole tree.
+    [[nodiscard]] math::aabb bounds() const {
+        return storage_ ? storage_->nodes[0].bounds : math::aabb{};
+    }
+
+    /// @brief Returns true if the tree has no nodes.
+    [[nodiscard]] bool empty() const noexcept { return !storage_; }
+
+private:
+    /// @brief Heap-allocated state so the tree stays movable despite its atomics.
+    struct storage {
+        build_options               options;
+        std::vector<math::aabb>     bounds;
+        std::vector<math::vec3>     centroids;
+        std::vector<uint32_t>       prim_indices;
+        std::unique_ptr<node[]>     nodes;
+        std::atomic<uint32_t>       node_count{0};
+        std::atomic<uint32_t>       pending{0};
+    };
+
+    /// @brief Ensures a node is split (or finalized as a leaf).
+    /// @return The node's published state: leaf or interior.
+    node_state expand(uint32_t index) const {
+        storage& s = *storage_;
+        node& n = s.nodes[index];
+
+        node_state expected = node_state::pending;
+        if (!n.state.compare_exchange_strong(expected, node_state::building,
+                                             std::memory_order_acquire)) {
+            // Another thread owns the split (or it is already done).
+            while (expected == node_state::building) {
+                n.state.wait(node_state::building, std::memory_order_acquire);
+                expected = n.state.load(std::memory_order_acquire);
+            }
+            return expected;
+        }
+
+        // This thread owns the node's primitive range until publication.
+        std::span<uint32_t> range{s.prim_indices.data() + n.first, n.count};
+        detail::sah_split split;
+        if (n.depth < detail::depth_limit(s.options)) {
+            split = detail::find_sah_split(s.bounds, s.centroids, range, n.bounds, s.options);
+        }
+
+        node_state result = node_state::leaf;
+        uint32_t new_pending = 0;
+        if (split.axis >= 0) {
+            uint32_t left_count = detail::partition(range, s.centroids, split, s.options);
+            uint32_t left = s.node_count.fetch_add(2, std::memory_order_relaxed);
+
+            auto init_child = [&](node& child, uint32_t first, uint32_t count) {
+                child.first  = first;
+                child.count  = count;
+                child.depth  = n.depth + 1;
+                child.bounds = detail::range_bounds(
+                    s.bounds, std::span<const uint32_t>{s.prim_indices.data() + first, count});
+                if (count <= s.options.max_leaf_size) {
+                    child.state.store(node_state::leaf, std::memory_order_relaxed);
+                } else {
+                    ++new_pending;
+                }
+            };
+            init_child(s.nodes[left], n.first, left_count);
+            init_child(s.nodes[left + 1], n.first + left_count, n.count - left_count);
+
+            n.left = left;
+            result = node_state::interior;
+        }
+
+        s.pending.fetch_add(new_pending, std::memory_order_relaxed);
+        s.pending.fetch_sub(1, std::memory_order_release);
+        n.state.store(result, std::memory_order_release);
+        n.state.notify_all();
+        return result;
+    }
+
+    std::unique_ptr<storage> storage_;
+};
+
+}  // namespace Q::accel
@@ -0,0 +1,173 @@
+/// @file lod.hpp
+/// @brief Instanced geometry with per-ray level-of-detail selection.
+///
+/// A distant instance covers a few pixels, yet tracing it through its full
+/// detail BVH costs as much as tracing it up close. Here each geometry
+/// carries a chain of levels, finest first: the full mesh, simplified
+/// meshes, and typically an aggregate proxy (see scene::box_quads and
+/// scene::average) as the coarsest level. When a ray reaches an instance,
+/// its ray cone footprint at the instance's entry distance picks the
+/// coarsest level whose geometric error stays below that footprint.
+///
+/// Like bvh, the structure is primitive-agnostic: each level is a BVH over
+/// caller-owned primitives and candidates are reported to a callback.
+///
+/// No backend uses it yet: the Cornell box scenes have no instanced
+/// geometry, so there is nothing to select levels of. It is tested on its
+/// own (accel_test) until a backend loads instanced scenes.
+
+#pragma once
+
+#include <quasi/accel/bvh.hpp>
+#include <quasi/math/ray_cone.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Q::accel {
+
+/// @brief One detail level of an instanced geometry.
+struct lod_level {
+    bvh   tree;                 ///< Object-space BVH over this level's primitives.
+    float feature_size = 0.0f;  ///< Largest deviation from full detail, in object units.
+};
+
+/// @brief A geometry shared by instances, as a chain of detail levels.
+struct lod_geometry {
+    std::vector<lod_level> levels;  ///< Finest first; feature_size must not decrease.
+
+    /// @brief Object-space bounds (those of the finest level).
+    [[nodiscard]] math::aabb bounds() const {
+        return levels.empty() ? math::aabb{} : levels.front().tree.bounds();
+    }
+};
+
+/// @brief A placement of a geometry: uniform scale, then translation.
+struct lod_instance {
+    uint32_t   geometry    = 0;
+    math::vec3 translation = {0.0f, 0.0f, 0.0f};
+    float      scale       = 1.0f;  ///< Must be positive.
+};
+
+/// @brief Tunables for instance_bvh.
+struct lod_options {
+    float         lod_bias = 1.0f;  ///< Footprint multiplier. 0 always selects the finest level.
+    build_options build{};          ///< Top-level BVH parameters.
+};
+
+/// @brief A primitive candidate reported during instance traversal.
+struct lod_candidate {
+    uint32_t  instance = 0;  ///< Instance index.
+    uint32_t  level    = 0;  ///< Selected level of the instance's geometry.
+    uint32_t  prim     = 0;  ///< Primitive id within that level.
+    math::ray object_ray;    ///< The ray in object space; t values match the world ray.
+};
+
+/// @brief Picks the coarsest level whose error fits within a footprint.
+/// @param geometry The geometry to choose a level of.
+/// @param footprint Ray footprint width in the geometry's object units.
+/// @return Index into geometry.levels.
+[[nodiscard]] inline uint32_t select_level(const lod_geometry& geometry, float footprint) {
+    uint32_t level = 0;
+    for (uint32_t i = 1; i < geometry.levels.size(); ++i) {
+        if (geometry.levels[i].feature_size > footprint) {
+            break;
+        }
+        level = i;
+    }
+    return level;
+}
+
+/// @class instance_bvh
+/// @brief A top-level BVH over instances whose detail level is chosen per ray.
+///
+/// Example usage:
+/// @code
+/// lod_geometry tree_geom;
+/// tree_geom.levels.push_back({bvh::build(full_bounds), 0.0f});
+/// tree_geom.levels.push_back({bvh::build(simplified_bounds), 0.05f});
+/// tree_geom.levels.push_back({bvh::build(proxy_bounds), 1.0f});
+///
+/// auto forest = instance_bvh::build({tree_geom}, placements);
+/// math::ray_cone cone{0.0f, cam.pixel_spread_angle(height)};
+/// forest.intersect(ray, cone, t_max, [&](const lod_candidate& c, float& t) {
+///     return intersect_level(c.instance, c.level, c.prim, c.object_ray, t);
+/// });
+/// @endcode
+class instance_bvh {
+public:
+    instance_bvh() = default;
+
+    /// @brief Builds the top-level BVH over world-space instance bounds.
+    /// @param geometries Shared geometries with their detail levels.
+    /// @param instances Placements referencing @p geometries.
+    /// @param options Selection and builder tunables.
+    [[nodiscard]] static instance_bvh build(std::vector<lod_geometry> geometries,
+                                            std::vector<lod_instance> instances,
+                                            lod_options options = {}) {
+        instance_bvh out;
+        out.world_bounds_.reserve(instances.size());
+        for (const auto& inst : instances) {
+            math::aabb local = geometries[inst.geometry].bounds();
+            out.world_bounds_.push_back({local.min * inst.scale + inst.translation,
+                                         local.max * inst.scale + inst.translation});
+        }
+        out.top_        = bvh::build(out.world_bounds_, options.build);
+        out.geometries_ = std::move(geometries);
+        out.instances_  = std::move(instances);
+        out.options_    = options;
+        return out;
+    }
+
+    /// @brief Finds the closest intersection, tracing each instance at the
+    ///        level its footprint selects.
+    /// @tparam Intersect Callable `bool(const lod_candidate&, float& t_max)` that
+    ///         tests a primitive and shrinks @p t_max on a hit.
+    /// @param r The world-space ray.
+    /// @param cone The ray's footprint cone.
+    /// @param t_max In: maximum distance. Out: distance to the closest hit.
+    /// @param intersect_prim Primitive intersection callback.
+    /// @return True if any primitive was hit.
+    template <typename Intersect>
+    bool intersect(const math::ray& r, const math::ray_cone& cone, float& t_max,
+                   Intersect&& intersect_prim) const {
+        math::vec3 inv_dir = math::inverse_direction(r);
+
+        return top_.intersect(r, t_max, [&](uint32_t index, float& t) {
+            float t_entry = math::intersect(world_bounds_[index], r.origin, inv_dir, 0.0f, t);
+            if (t_entry > t) {
+                return false;
+            }
+
+            const lod_instance& inst = instances_[index];
+            const lod_geometry& geom = geometries_[inst.geometry];
+            float footprint = options_.lod_bias * cone.width_at(t_entry) / inst.scale;
+
+            lod_candidate c;
+            c.instance   = index;
+            c.level      = select_level(geom, footprint);
+            c.object_ray = {(r.origin - inst.translation) / inst.scale, r.direction / inst.scale};
+
+            return geom.levels[c.level].tree.intersect(c.object_ray, t, [&](uint32_t prim, float& tt) {
+                c.prim = prim;
+                return intersect_prim(std::as_const(c), tt);
+            });
+        });
+    }
+
+    [[nodiscard]] std::span<const lod_geometry> geometries() const noexcept { return geometries_; }
+    [[nodiscard]] std::span<const lod_instance> instances() const noexcept { return instances_; }
+    [[nodiscard]] const bvh& top_level() const noexcept { return top_; }
+    [[nodiscard]] bool empty() const noexcept { return top_.empty(); }
+
+private:
+    std::vector<lod_geometry> geometries_;
+    std::vector<lod_instance> instances_;
+    std::vector<math::aabb>   world_bounds_;
+    bvh                       top_;
+    lod_options               options_;
+};
+
+}  // namespace Q::accel
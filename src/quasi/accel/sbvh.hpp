@@ -0,0 +1,364 @@
+/// @file sbvh.hpp
+/// @brief Spatial split BVH builder (SBVH).
+///
+/// Object splits partition primitives, so large primitives that overlap
+/// most of a node (walls, floors and ceilings) end up in both children's
+/// bounds and traversal degrades towards a linear scan. The SBVH builder
+/// additionally considers spatial splits: a primitive straddling the split
+/// plane is clipped and referenced from both children with tighter bounds.
+/// Duplication is capped by a budget relative to the primitive count.
+///
+/// Reference: Stich, Friedrich, Dietrich, "Spatial Splits in Bounding
+/// Volume Hierarchies", HPG 2009.
+
+#pragma once
+
+#include <quasi/accel/bvh.hpp>
+
+#include <concepts>
+#include <utility>
+
+namespace Q::accel {
+
+/// @brief Tunables for the spatial split builder.
+struct sbvh_options {
+    build_options build{};                    ///< SAH parameters shared with object splits.
+    float         overlap_threshold  = 1e-5f; ///< Try spatial splits when child overlap area exceeds this fraction of the root area.
+    float         duplication_budget = 0.5f;  ///< Extra references allowed, as a fraction of the primitive count.
+};
+
+/// @brief Clips a primitive to the slab lo <= p[axis] <= hi.
+///
+/// Implementations return the bounds of the part of the primitive inside
+/// the slab (e.g. scene::quad::clipped_bounds). The result may be loose;
+/// the builder intersects it with the reference's current bounds.
+template <typename F>
+concept primitive_clipper = std::invocable<F, uint32_t, int, float, float> &&
+    std::convertible_to<std::invoke_result_t<F, uint32_t, int, float, float>, math::aabb>;
+
+namespace detail {
+
+/// @brief A (possibly clipped) reference to a primitive.
+struct reference {
+    math::aabb bounds;
+    uint32_t   prim = 0;
+};
+
+/// @brief Result of a spatial split search.
+struct spatial_split {
+    int        axis = -1;  ///< Split axis, or -1 if none was found.
+    float      position = 0.0f;
+    float      cost = std::numeric_limits<float>::infinity();
+    math::aabb left_bounds;
+    math::aabb right_bounds;
+    uint32_t   left_count  = 0;
+    uint32_t   right_count = 0;
+};
+
+template <primitive_clipper Clip>
+class sbvh_builder {
+public:
+    sbvh_builder(Clip& clip, const sbvh_options& options, uint32_t prim_count)
+        : clip_{clip}
+        , options_{options}
+        , bins_{std::clamp<uint32_t>(options.build.bin_count, 2, k_max_bins)}
+        , max_references_{prim_count + static_cast<uint32_t>(
+              static_cast<float>(prim_count) * std::max(options.duplication_budget, 0.0f))}
+        , reference_count_{prim_count} {}
+
+    bvh build(std::vector<reference> refs) {
+        math::aabb root_bounds;
+        for (const auto& r : refs) {
+            root_bounds.expand(r.bounds);
+        }
+        root_area_ = std::max(root_bounds.surface_area(), 1e-12f);
+
+        nodes_.push_back({root_bounds, 0, 0});
+        build_node(0, std::move(refs), 0);
+        return bvh{std::move(nodes_), std::move(indices_)};
+    }
+
+private:
+    void make_leaf(uint32_t node_index, const std::vector<reference>& refs) {
+        nodes_[node_index].offset = static_cast<uint32_t>(indices_.size());
+        nodes_[node_index].count  = static_cast<uint32_t>(refs.size());
+        for (const auto& r : refs) {
+            indices_.push_back(r.prim);
+        }
+    }
+
+    void build_node(uint32_t node_index, std::vector<reference> refs, uint32_t depth) {
+        auto n = static_cast<uint32_t>(refs.size());
+        const math::aabb node_bounds = nodes_[node_index].bounds;
+
+        if (n <= options_.build.max_leaf_size || depth >= detail::depth_limit(options_.build)) {
+            make_leaf(node_index, refs);
+            return;
+        }
+
+        // Object split over reference bounds.
+        std::vector<math::aabb> ref_bounds(n);
+        std::vector<math::vec3> ref_centroids(n);
+        std::vector<uint32_t>   order(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            ref_bounds[i]    = refs[i].bounds;
+            ref_centroids[i] = refs[i].bounds.centroid();
+            order[i]         = i;
+        }
+
+        auto object = find_sah_split(ref_bounds, ref_centroids, order, node_bounds, options_.build);
+        uint32_t object_left = 0;
+        float overlap_area = 0.0f;
+        if (object.axis >= 0) {
+            object_left = partition(order, ref_centroids, object, options_.build);
+            auto left  = range_bounds(ref_bounds, std::span<const uint32_t>{order}.first(object_left));
+            auto right = range_bounds(ref_bounds, std::span<const uint32_t>{order}.subspan(object_left));
+            overlap_area = math::intersection(left, right).surface_area();
+        }
+
+        // Spatial splits only pay off where object-split children overlap.
+        spatial_split spatial;
+        if (overlap_area / root_area_ > options_.overlap_threshold &&
+            reference_count_ < max_references_) {
+            spatial = find_spatial_split(refs, node_bounds);
+        }
+
+        std::vector<reference> left, right;
+        if (spatial.axis >= 0 && spatial.cost < object.cost) {
+            split_spatially(refs, spatial, left, right);
+        }
+
+        if (left.empty() || right.empty() || left.size() >= n || right.size() >= n) {
+            left.clear();
+            right.clear();
+            if (object.axis < 0) {
+                make_leaf(node_index, refs);
+                return;
+            }
+            for (uint32_t i = 0; i < n; ++i) {
+                (i < object_left ? left : right).push_back(refs[order[i]]);
+            }
+        }
+
+        refs.clear();
+        refs.shrink_to_fit();
+
+        auto child = static_cast<uint32_t>(nodes_.size());
+        nodes_.push_back({bounds_of(left), 0, 0});
+        nodes_.push_back({bounds_of(right), 0, 0});
+        nodes_[node_index].offset = child;
+        nodes_[node_index].count  = 0;
+
+        build_node(child, std::move(left), depth + 1);
+        build_node(child + 1, std::move(right), depth + 1);
+    }
+
+    /// @brief Clips a reference to a slab, returning an empty box if nothing remains.
+    math::aabb clip_reference(const reference& r, int axis, float lo, float hi) {
+        math::aabb b = math::intersection(clip_(r.prim, axis, lo, hi), r.bounds);
+        b.min[axis] = std::max(b.min[axis], lo);
+        b.max[axis] = std::min(b.max[axis], hi);
+        return b;
+    }
+
+    spatial_split find_spatial_split(const std::vector<reference>& refs, const math::aabb& node_bounds) {
+        spatial_split best;
+        float parent_area = std::max(node_bounds.surface_area(), 1e-12f);
+
+        for (int axis = 0; axis < 3; ++axis) {
+            float lo = node_bounds.min[axis];
+            float width = (node_bounds.max[axis] - lo) / static_cast<float>(bins_);
+            if (!(width > 0.0f)) {
+                continue;
+            }
+
+            auto plane = [&](uint32_t b) { return lo + width * static_cast<float>(b); };
+            auto bin_of = [&](float x) {
+                return bin_index(x, lo, 1.0f / width, bins_);
+            };
+
+            std::array<math::aabb, k_max_bins> bin_bounds{};
+            std::array<uint32_t, k_max_bins>   entries{};
+            std::array<uint32_t, k_max_bins>   exits{};
+
+            for (const auto& r : refs) {
+                uint32_t first = bin_of(r.bounds.min[axis]);
+                uint32_t last  = bin_of(r.bounds.max[axis]);
+                ++entries[first];
+                ++exits[last];
+                if (first == last) {
+                    bin_bounds[first].expand(r.bounds);
+                    continue;
+                }
+                for (uint32_t b = first; b <= last; ++b) {
+                    float slab_lo = b == first ? -std::numeric_limits<float>::infinity() : plane(b);
+                    float slab_hi = b == last  ?  std::numeric_limits<float>::infinity() : plane(b + 1);
+                    bin_bounds[b].expand(clip_reference(r, axis, slab_lo, slab_hi));
+                }
+            }
+
+            std::array<math::aabb, k_max_bins> right_bounds{};
+            std::array<uint32_t, k_max_bins>   right_count{};
+            math::aabb acc;
+            uint32_t   count = 0;
+            for (uint32_t b = bins_ - 1; b > 0; --b) {
+                acc.expand(bin_bounds[b]);
+                count += exits[b];
+                right_bounds[b] = acc;
+                right_count[b]  = count;
+            }
+
+            acc   = {};
+            count = 0;
+            for (uint32_t b = 1; b < bins_; ++b) {
+                acc.expand(bin_bounds[b - 1]);
+                count += entries[b - 1];
+                if (count == 0 || right_count[b] == 0) {
+                    continue;
+                }
+                float cost = options_.build.traversal_cost +
+                    options_.build.intersection_cost *
+                    (acc.surface_area() * static_cast<float>(count) +
+                     right_bounds[b].surface_area() * static_cast<float>(right_count[b])) / parent_area;
+                if (cost < best.cost) {
+                    best = {
+                        .axis         = axis,
+                        .position     = plane(b),
+                        .cost         = cost,
+                        .left_bounds  = acc,
+                        .right_bounds = right_bounds[b],
+                        .left_count   = count,
+                        .right_count  = right_count[b],
+                    };
+                }
+            }
+        }
+
+        // Reject splits that would blow the duplication budget.
+        uint32_t duplicates = best.left_count + best.right_count - static_cast<uint32_t>(refs.size());
+        if (best.axis >= 0 && reference_count_ + duplicates > max_references_) {
+            best.axis = -1;
+        }
+        return best;
+    }
+
+    void split_spatially(
+        const std::vector<reference>& refs,
+        const spatial_split& split,
+        std::vector<reference>& left,
+        std::vector<reference>& right
+    ) {
+        const int axis = split.axis;
+        math::aabb left_bounds  = split.left_bounds;
+        math::aabb right_bounds = split.right_bounds;
+        auto n_left  = static_cast<float>(split.left_count);
+        auto n_right = static_cast<float>(split.right_count);
+
+        for (const auto& r : refs) {
+            if (r.bounds.max[axis] <= split.position) {
+                left.push_back(r);
+                continue;
+            }
+            if (r.bounds.min[axis] >= split.position) {
+                right.push_back(r);
+                continue;
+            }
+
+            reference l{clip_reference(r, axis, -std::numeric_limits<float>::infinity(), split.position), r.prim};
+            reference rr{clip_reference(r, axis, split.position, std::numeric_limits<float>::infinity()), r.prim};
+            if (l.bounds.empty()) {
+                right.push_back(r);
+                continue;
+            }
+            if (rr.bounds.empty()) {
+                left.push_back(r);
+                continue;
+            }
+
+            // Reference unsplitting: keep the whole reference on one side
+            // when that is cheaper than duplicating it.
+            float split_cost  = left_bounds.surface_area() * n_left + right_bounds.surface_area() * n_right;
+            float left_cost   = math::merge(left_bounds, r.bounds).surface_area() * n_left +
+                                right_bounds.surface_area() * (n_right - 1.0f);
+            float right_cost  = left_bounds.surface_area() * (n_left - 1.0f) +
+                                math::merge(right_bounds, r.bounds).surface_area() * n_right;
+            bool can_duplicate = reference_count_ < max_references_;
+
+            if (can_duplicate && split_cost < left_cost && split_cost < right_cost) {
+                left.push_back(l);
+                right.push_back(rr);
+                ++reference_count_;
+            } else if (left_cost <= right_cost) {
+                left.push_back(r);
+                left_bounds.expand(r.bounds);
+                n_right -= 1.0f;
+            } else {
+                right.push_back(r);
+                right_bounds.expand(r.bounds);
+                n_left -= 1.0f;
+            }
+        }
+    }
+
+    static math::aabb bounds_of(const std::vector<reference>& refs) {
+        math::aabb b;
+        for (const auto& r : refs) {
+            b.expand(r.bounds);
+        }
+        return b;
+    }
+
+    Clip&                 clip_;
+    sbvh_options          options_;
+    uint32_t              bins_;
+    uint32_t              max_references_;
+    uint32_t              reference_count_;
+    float                 root_area_ = 1.0f;
+    std::vector<bvh_node> nodes_;
+    std::vector<uint32_t> indices_;
+};
+
+}  // namespace detail
+
+/// @brief Builds a BVH with object and spatial splits.
+///
+/// The result is an ordinary bvh; leaves may reference a primitive more
+/// than once, so the intersection callback can be invoked repeatedly for
+/// the same primitive on one ray.
+///
+/// Example usage:
+/// @code
+/// auto tree = build_sbvh(bounds, [&](uint32_t prim, int axis, float lo, float hi) {
+///     return scene.quads[prim].geometry.clipped_bounds(axis, lo, hi);
+/// });
+/// @endcode
+///
+/// @param prim_bounds Bounds of each primitive, indexed by primitive id.
+/// @param clip Primitive clipper used to split straddling references.
+/// @param options Builder tunables.
+template <primitive_clipper Clip>
+[[nodiscard]] bvh build_sbvh(std::span<const math::aabb> prim_bounds, Clip&& clip, sbvh_options options = {}) {
+    if (prim_bounds.empty()) {
+        return {};
+    }
+
+    std::vector<detail::reference> refs(prim_bounds.size());
+    for (uint32_t i = 0; i < prim_bounds.size(); ++i) {
+        refs[i] = {prim_bounds[i], i};
+    }
+
+    detail::sbvh_builder<std::remove_reference_t<Clip>> builder{
+        clip, options, static_cast<uint32_t>(prim_bounds.size())};
+    return builder.build(std::move(refs));
+}
+
+/// @brief Builds a spatial split BVH when only primitive boxes are known.
+///
+/// Straddling references are clipped to the slab without consulting the
+/// primitive geometry, which is exact for box-shaped primitives.
+[[nodiscard]] inline bvh build_sbvh(std::span<const math::aabb> prim_bounds, sbvh_options options = {}) {
+    auto clip_box = [&](uint32_t prim, int, float, float) { return prim_bounds[prim]; };
+    return build_sbvh(prim_bounds, clip_box, options);
+}
+
+}  // namespace Q::accel
@@ -9,7 +9,12 @@
 #include <quasi/async/task.hpp>
 #include <quasi/async/scheduler.hpp>
 #include <quasi/async/awaitables.hpp>
+#include <quasi/async/sync_wait.hpp>
+#include <quasi/async/reactor.hpp>
 #include <quasi/async/file_watcher.hpp>
+#include <quasi/async/thread_pool.hpp>
+#include <quasi/async/task_graph.hpp>
+#include <quasi/async/task_group.hpp>
 
 namespace Q::async {
 
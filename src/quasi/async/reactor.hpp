@@ -0,0 +1,496 @@
+/// @file reactor.hpp
+/// @brief Readiness-based I/O, timers and cross-thread wake-ups for the scheduler.
+///
+/// The scheduler only knows coroutines that are ready to run. A reactor
+/// adds the ones waiting on the outside world: a file descriptor becoming
+/// readable or writable, a deadline passing, or another thread handing
+/// work over. It parks them in an epoll set, so a thousand idle
+/// connections cost no CPU. run() is the blocking loop: it ticks the
+/// scheduler while coroutines are ready, and sleeps in epoll_wait() when
+/// none are.
+///
+/// Timers share one timerfd, armed for the earliest deadline. post(),
+/// schedule() and stop() may be called from any thread; they wake the
+/// loop through an eventfd. Everything else belongs to the thread that
+/// calls run().
+///
+/// Linux only (epoll, timerfd and eventfd); other platforms get no reactor.
+
+#pragma once
+
+#include <quasi/platform.hpp>
+
+#if defined(Q_PLATFORM_LINUX)
+
+#include <quasi/async/scheduler.hpp>
+#include <quasi/async/task.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <span>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace Q::async {
+
+/// @brief Result of a reactor I/O call; the error is an errno value.
+template <typename T>
+using io_result = std::expected<T, std::error_code>;
+
+/// @brief Puts @p fd in non-blocking mode, which every fd given to a reactor must be in.
+inline bool set_nonblocking(int fd) noexcept {
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+/// @class reactor
+/// @brief An epoll loop that resumes coroutines on a scheduler when their I/O is ready.
+///
+/// Example usage:
+/// @code
+/// scheduler sched;
+/// reactor io{sched};
+/// sched.spawn([&]() -> task<void> {
+///     for (;;) {
+///         auto client = co_await io.accept(listener);
+///         if (client) {
+///             sched.spawn(serve(io, *client));
+///         }
+///     }
+/// }());
+/// io.run();  // Until io.stop().
+/// @endcode
+class reactor {
+public:
+    /// @param sched Scheduler that runs the coroutines this reactor resumes.
+    explicit reactor(scheduler& sched) : sched_{sched} {
+        epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        wake_fd_  = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        timer_fd_ = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        for (int fd : {wake_fd_, timer_fd_}) {
+            epoll_event ev{};
+            ev.events  = EPOLLIN;
+            ev.data.fd = fd;
+            if (epoll_fd_ >= 0 && fd >= 0) {
+                ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+            }
+        }
+    }
+
+    ~reactor() {
+        for (int fd : {timer_fd_, wake_fd_, epoll_fd_}) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    }
+
+    reactor(const reactor&) = delete;
+    reactor& operator=(const reactor&) = delete;
+    reactor(reactor&&) = delete;
+    reactor& operator=(reactor&&) = delete;
+
+    /// @brief Returns false if the epoll, eventfd or timerfd could not be created.
+    [[nodiscard]] bool valid() const noexcept { return epoll_fd_ >= 0 && wake_fd_ >= 0 && timer_fd_ >= 0; }
+
+    // ------------------------------------------------------------------------
+    // Awaitables
+    // ------------------------------------------------------------------------
+
+    /// @brief Awaitable that resumes once @p fd is readable (or has hung up or failed).
+    [[nodiscard]] auto readable(int fd) { return fd_awaiter{*this, fd, EPOLLIN, {}}; }
+
+    /// @brief Awaitable that resumes once @p fd is writable (or has hung up or failed).
+    [[nodiscard]] auto writable(int fd) { return fd_awaiter{*this, fd, EPOLLOUT, {}}; }
+
+    /// @brief Awaitable that resumes once @p duration has passed.
+    template <typename Rep, typename Period>
+    [[nodiscard]] auto sleep_for(std::chrono::duration<Rep, Period> duration) {
+        return sleep_until(std::chrono::steady_clock::now() +
+                           std::chrono::duration_cast<std::chrono::steady_clock::duration>(duration));
+    }
+
+    /// @brief Awaitable that resumes once @p deadline has passed.
+    [[nodiscard]] auto sleep_until(std::chrono::steady_clock::time_point deadline) {
+        struct awaiter {
+            reactor&                              io;
+            std::chrono::steady_clock::time_point deadline;
+
+            bool await_ready() const noexcept { return deadline <= std::chrono::steady_clock::now(); }
+            void await_suspend(std::coroutine_handle<> h) { io.add_timer(deadline, h); }
+            void await_resume() const noexcept {}
+        };
+        return awaiter{*this, deadline};
+    }
+
+    /// @brief Awaitable that moves the awaiting coroutine onto the reactor's thread.
+    ///
+    /// Await it from another thread (a pool worker, say) to continue on the
+    /// scheduler once that work is done.
+    [[nodiscard]] auto schedule() {
+        struct awaiter {
+            reactor& io;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { io.post(h); }
+            void await_resume() const noexcept {}
+        };
+        return awaiter{*this};
+    }
+
+    /// @brief Accepts one connection on a non-blocking listening socket.
+    /// @return The new socket, already non-blocking and close-on-exec.
+    task<io_result<int>> accept(int listener) {
+        for (;;) {
+            int fd = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd >= 0) {
+                co_return fd;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                co_return std::unexpected{std::error_code{errno, std::system_category()}};
+            }
+            if (auto ready = co_await readable(listener); !ready) {
+                co_return std::unexpected{ready.error()};
+            }
+        }
+    }
+
+    /// @brief Reads what is available from @p fd, waiting until something is.
+    /// @return Bytes read; 0 at end of file.
+    task<io_result<size_t>> read_some(int fd, std::span<std::byte> buffer) {
+        for (;;) {
+            ssize_t n = ::read(fd, buffer.data(), buffer.size());
+            if (n >= 0) {
+                co_return static_cast<size_t>(n);
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                co_return std::unexpected{std::error_code{errno, std::system_category()}};
+            }
+            if (auto ready = co_await readable(fd); !ready) {
+                co_return std::unexpected{ready.error()};
+            }
+        }
+    }
+
+    /// @brief Writes all of @p data to @p fd, waiting whenever it is full.
+    ///
+    /// Sockets are written with MSG_NOSIGNAL, so a peer that hung up is an
+    /// EPIPE error rather than a SIGPIPE.
+    task<io_result<size_t>> write_all(int fd, std::span<const std::byte> data) {
+        size_t written = 0;
+        bool socket = true;
+        while (written < data.size()) {
+            ssize_t n = socket ? ::send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL) : -1;
+            if (n < 0 && socket && errno == ENOTSOCK) {
+                socket = false;
+            }
+            if (!socket) {
+                n = ::write(fd, data.data() + written, data.size() - written);
+            }
+            if (n >= 0) {
+                written += static_cast<size_t>(n);
+                continue;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                co_return std::unexpected{std::error_code{errno, std::system_category()}};
+            }
+            if (auto ready = co_await writable(fd); !ready) {
+                co_return std::unexpected{ready.error()};
+            }
+        }
+        co_return written;
+    }
+
+    /// @brief Stops watching @p fd and closes it.
+    ///
+    /// Use instead of ::close() for an fd this reactor has waited on, so a
+    /// later fd with the same number starts clean. Coroutines still waiting
+    /// on it are not resumed.
+    void close(int fd) {
+        if (auto it = watched_.find(fd); it != watched_.end()) {
+            waiting_ -= (it->second.reader ? 1 : 0) + (it->second.writer ? 1 : 0);
+            watched_.erase(it);
+            ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        }
+        ::close(fd);
+    }
+
+    // ------------------------------------------------------------------------
+    // Any thread
+    // ------------------------------------------------------------------------
+
+    /// @brief Queues @p h to run on the scheduler and wakes the loop.
+    void post(std::coroutine_handle<> h) {
+        {
+            std::lock_guard lock{posted_mutex_};
+            posted_.push_back(h);
+        }
+        wake();
+    }
+
+    /// @brief Makes run() return after its current iteration.
+    void stop() {
+        stop_requested_.store(true, std::memory_order_release);
+        wake();
+    }
+
+    /// @brief Wakes a run() or poll() that is blocked in epoll_wait().
+    void wake() noexcept {
+        uint64_t one = 1;
+        [[maybe_unused]] auto n = ::write(wake_fd_, &one, sizeof(one));
+    }
+
+    // ------------------------------------------------------------------------
+    // Loop
+    // ------------------------------------------------------------------------
+
+    /// @brief Ticks the scheduler and waits for I/O until stop() is called.
+    void run() { loop(false); }
+
+    /// @brief Like run(), but also returns once no coroutine is ready or waiting here.
+    void run_until_idle() { loop(true); }
+
+    /// @brief Waits up to @p timeout for events and queues the coroutines they resume.
+    /// @param timeout Negative waits indefinitely; zero only collects what is ready.
+    /// @return The number of coroutines queued.
+    size_t poll(std::chrono::milliseconds timeout) {
+        epoll_event events[64];
+        int n = ::epoll_wait(epoll_fd_, events, 64, timeout.count() < 0 ? -1 : static_cast<int>(timeout.count()));
+        size_t resumed = 0;
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wake_fd_) {
+                uint64_t count = 0;
+                [[maybe_unused]] auto r = ::read(wake_fd_, &count, sizeof(count));
+                resumed += drain_posted();
+            } else if (fd == timer_fd_) {
+                uint64_t expirations = 0;
+                [[maybe_unused]] auto r = ::read(timer_fd_, &expirations, sizeof(expirations));
+                resumed += expire_timers();
+            } else {
+                resumed += dispatch(fd, events[i].events);
+            }
+        }
+        return resumed;
+    }
+
+    /// @brief Coroutines suspended on an fd or a timer.
+    [[nodiscard]] size_t waiting() const noexcept { return waiting_ + timers_.size(); }
+
+private:
+    /// @brief Who waits on one fd; at most one reader and one writer.
+    struct watch {
+        std::coroutine_handle<> reader;
+        std::coroutine_handle<> writer;
+        std::error_code*        reader_error = nullptr;
+        std::error_code*        writer_error = nullptr;
+        bool                    registered   = false;
+    };
+
+    struct fd_awaiter {
+        reactor&        io;
+        int             fd;
+        uint32_t        events;
+        std::error_code error;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h) { return io.arm(fd, events, h, &error); }
+        io_result<void> await_resume() const {
+            if (error) {
+                return std::unexpected{error};
+            }
+            return {};
+        }
+    };
+
+    struct timer {
+        std::chrono::steady_clock::time_point deadline;
+        uint64_t                              sequence;  // Equal deadlines resume in order.
+        std::coroutine_handle<>               handle;
+
+        bool operator>(const timer& other) const noexcept {
+            return deadline != other.deadline ? deadline > other.deadline : sequence > other.sequence;
+        }
+    };
+
+    void loop(bool until_idle) {
+        while (!stop_requested_.exchange(false, std::memory_order_acq_rel)) {
+            if (!sched_.empty()) {
+                sched_.tick();
+            }
+            bool idle = sched_.empty();
+            if (until_idle && idle && waiting() == 0 && !has_posted()) {
+                break;
+            }
+            // While coroutines are ready, only collect events; otherwise sleep in the kernel.
+            poll(std::chrono::milliseconds{idle ? -1 : 0});
+        }
+    }
+
+    /// @brief Registers @p h to be resumed when @p fd has @p events.
+    /// @return False (resume now, with @p error set) if epoll refused the fd.
+    bool arm(int fd, uint32_t events, std::coroutine_handle<> h, std::error_code* error) {
+        auto& w = watched_[fd];
+        if (events & EPOLLIN) {
+            w.reader       = h;
+            w.reader_error = error;
+        } else {
+            w.writer       = h;
+            w.writer_error = error;
+        }
+        ++waiting_;
+        if (!update(fd, w)) {
+            *error = std::error_code{errno, std::system_category()};
+            (events & EPOLLIN ? w.reader : w.writer) = {};
+            --waiting_;
+            return false;
+        }
+        return true;
+    }
+
+    /// @brief Points the epoll registration of @p fd at its current waiters.
+    bool update(int fd, watch& w) {
+        epoll_event ev{};
+        ev.events  = (w.reader ? EPOLLIN : 0u) | (w.writer ? EPOLLOUT : 0u) | EPOLLONESHOT;
+        ev.data.fd = fd;
+        if (w.registered && ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) == 0) {
+            return true;
+        }
+        // Not registered yet, or the fd was closed and its number reused.
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == 0 ||
+            (errno == EEXIST && ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) == 0)) {
+            w.registered = true;
+            return true;
+        }
+        return false;
+    }
+
+    size_t dispatch(int fd, uint32_t events) {
+        auto it = watched_.find(fd);
+        if (it == watched_.end()) {
+            return 0;
+        }
+        auto& w = it->second;
+        size_t resumed = 0;
+        bool failed = events & (EPOLLERR | EPOLLHUP);
+        if (w.reader && (events & (EPOLLIN | EPOLLRDHUP) || failed)) {
+            sched_.enqueue(std::exchange(w.reader, {}));
+            ++resumed;
+        }
+        if (w.writer && (events & EPOLLOUT || failed)) {
+            sched_.enqueue(std::exchange(w.writer, {}));
+            ++resumed;
+        }
+        waiting_ -= resumed;
+        // One-shot: re-arm for whoever still waits.
+        if ((w.reader || w.writer) && !update(fd, w)) {
+            for (auto* side : {&w.reader, &w.writer}) {
+                if (*side) {
+                    auto* error = side == &w.reader ? w.reader_error : w.writer_error;
+                    *error = std::error_code{errno, std::system_category()};
+                    sched_.enqueue(std::exchange(*side, {}));
+                    --waiting_;
+                    ++resumed;
+                }
+            }
+        }
+        return resumed;
+    }
+
+    void add_timer(std::chrono::steady_clock::time_point deadline, std::coroutine_handle<> h) {
+        bool earliest = timers_.empty() || deadline < timers_.top().deadline;
+        timers_.push({deadline, next_sequence_++, h});
+        if (earliest) {
+            arm_timer();
+        }
+    }
+
+    size_t expire_timers() {
+        auto now = std::chrono::steady_clock::now();
+        size_t resumed = 0;
+        while (!timers_.empty() && timers_.top().deadline <= now) {
+            sched_.enqueue(timers_.top().handle);
+            timers_.pop();
+            ++resumed;
+        }
+        arm_timer();
+        return resumed;
+    }
+
+    /// @brief Arms the timerfd for the earliest deadline, or disarms it.
+    void arm_timer() {
+        itimerspec spec{};
+        if (!timers_.empty()) {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          timers_.top().deadline.time_since_epoch())
+                          .count();
+            // steady_clock is CLOCK_MONOTONIC; zero would disarm, so round up to 1 ns.
+            ns = std::max<int64_t>(ns, 1);
+            spec.it_value.tv_sec  = static_cast<time_t>(ns / 1'000'000'000);
+            spec.it_value.tv_nsec = static_cast<long>(ns % 1'000'000'000);
+        }
+        ::timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+    }
+
+    bool has_posted() {
+        std::lock_guard lock{posted_mutex_};
+        return !posted_.empty();
+    }
+
+    size_t drain_posted() {
+        std::vector<std::coroutine_handle<>> handles;
+        {
+            std::lock_guard lock{posted_mutex_};
+            handles.swap(posted_);
+        }
+        for (auto h : handles) {
+            sched_.enqueue(h);
+        }
+        return handles.size();
+    }
+
+    scheduler& sched_;
+    int        epoll_fd_ = -1;
+    int        wake_fd_  = -1;
+    int        timer_fd_ = -1;
+
+    std::unordered_map<int, watch>                                 watched_;
+    size_t                                                         waiting_ = 0;
+    std::priority_queue<timer, std::vector<timer>, std::greater<>> timers_;
+    uint64_t                                                       next_sequence_ = 0;
+
+    std::mutex                           posted_mutex_;
+    std::vector<std::coroutine_handle<>> posted_;
+    std::atomic<bool>                    stop_requested_{false};
+};
+
+}  // namespace Q::async
+
+#endif  // Q_PLATFORM_LINUX
@@ -4,9 +4,14 @@
 #pragma once
 
 #include <quasi/async/task.hpp>
+#include <quasi/profile/profiler.hpp>
 
+#include <cassert>
 #include <coroutine>
 #include <cstdint>
+#include <optional>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace Q::async {
@@ -37,6 +42,13 @@ inline thread_local scheduler* t_current_scheduler = nullptr;
 /// yield. It is also single-threaded: all coroutines run on the thread
 /// that calls tick().
 ///
+/// The scheduler owns only the tasks passed to spawn(). A coroutine
+/// re-enqueued by yield() may be a task awaited by another, whose frame
+/// belongs to the awaiting coroutine, so only spawned tasks are destroyed
+/// here, once they complete. A spawned task moves itself onto a finished
+/// list as it completes (see detail::spawn_hook), so a tick destroys just
+/// the tasks that finished instead of scanning every one still running.
+///
 /// Example usage:
 /// @code
 /// scheduler sched;
@@ -49,13 +61,17 @@ inline thread_local scheduler* t_current_scheduler = nullptr;
 /// @endcode
 class scheduler {
 public:
-    scheduler() = default;
+    scheduler() noexcept {
+        live_.prev = live_.next = &live_;
+    }
 
+    /// @brief Destroys every spawned task, finished or not, and the tasks they await.
     ~scheduler() {
-        for (auto h : ready_queue_) {
-            if (h && !h.done()) {
-                h.destroy();
-            }
+        destroy_finished();
+        while (live_.next != &live_) {
+            auto* hook = live_.next;
+            hook->unlink();
+            hook->self.destroy();
         }
     }
 
@@ -67,8 +83,16 @@ public:
     /// @brief Schedules a task to be driven by this scheduler.
     /// @param t The task to schedule. Ownership is transferred to the scheduler.
     void spawn(task<void> t) {
+        assert(owned_by_caller());
         if (t.valid() && !t.done()) {
             auto h = t.release();
+            auto& hook = h.promise().hook_;
+            hook.self        = h;
+            hook.finished    = &finished_;
+            hook.prev        = live_.prev;
+            hook.next        = &live_;
+            live_.prev->next = &hook;
+            live_.prev       = &hook;
             ready_queue_.push_back(h);
         }
     }
@@ -77,6 +101,7 @@ public:
     /// @param h The coroutine handle to enqueue.
     /// @note Typically called by yield() to re-enqueue the current coroutine.
     void enqueue(std::coroutine_handle<> h) {
+        assert(owned_by_caller());
         if (h && !h.done()) {
             ready_queue_.push_back(h);
         }
@@ -85,10 +110,15 @@ public:
     /// @brief Runs one scheduler tick, resuming all ready coroutines.
     ///
     /// Each coroutine in the ready queue is resumed once. Coroutines that
-    /// yield will re-enqueue themselves. Completed coroutines are destroyed.
+    /// yield will re-enqueue themselves. Completed spawned tasks are destroyed.
     void tick() {
         ++tick_count_;
 
+        std::optional<profile::profiler::scope> scope;
+        if (profiler_) {
+            scope.emplace(*profiler_, "scheduler.tick");
+        }
+
         auto* prev_scheduler = detail::t_current_scheduler;
         detail::t_current_scheduler = this;
 
@@ -96,23 +126,32 @@ public:
         std::swap(to_run, ready_queue_);
 
         for (auto h : to_run) {
-            if (!h || h.done()) {
-                if (h) {
-                    h.destroy();
-                }
-                continue;
-            }
-
-            h.resume();
-
-            if (h.done()) {
-                h.destroy();
+            if (!h.done()) {
+                h.resume();
             }
         }
 
+        // Only spawned tasks are ours: a finished nested task belongs to its awaiter.
+        destroy_finished();
+
         detail::t_current_scheduler = prev_scheduler;
     }
 
+    /// @brief Asserts, in debug builds, that only the calling thread spawns or enqueues here.
+    ///
+    /// Nothing in the scheduler is locked, so work handed over from another
+    /// thread is a data race, and a thread parked waiting for this
+    /// scheduler's queue to fill (sync_wait()) would never see it.
+    void bind_to_current_thread() noexcept {
+        owner_ = std::this_thread::get_id();
+    }
+
+    /// @brief Records every tick in @p prof as "scheduler.tick", or stops if nullptr.
+    /// @note The profiler must outlive the scheduler or be detached first.
+    void set_profiler(profile::profiler* prof) noexcept {
+        profiler_ = prof;
+    }
+
     /// @brief Runs ticks until all coroutines complete.
     void run_until_empty() {
         while (!empty()) {
@@ -136,8 +175,23 @@ public:
     }
 
 private:
+    [[nodiscard]] bool owned_by_caller() const noexcept {
+        return owner_ == std::thread::id{} || owner_ == std::this_thread::get_id();
+    }
+
+    void destroy_finished() noexcept {
+        while (finished_) {
+            auto* hook = std::exchange(finished_, finished_->next);
+            hook->self.destroy();
+        }
+    }
+
     std::vector<std::coroutine_handle<>> ready_queue_;
+    detail::spawn_hook                   live_;               ///< Sentinel of the unfinished spawned tasks.
+    detail::spawn_hook*                  finished_ = nullptr;  ///< Spawned tasks done since the last tick.
     uint64_t                             tick_count_ = 0;
+    profile::profiler*                   profiler_   = nullptr;
+    std::thread::id                      owner_;  ///< Set by bind_to_current_thread(); empty if unbound.
 };
 
 /// @brief Returns a global default scheduler instance.
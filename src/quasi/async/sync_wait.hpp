@@ -0,0 +1,175 @@
+/// @file sync_wait.hpp
+/// @brief Blocks a thread on a task without spinning.
+///
+/// Code outside any coroutine, or a coroutine that must finish a nested
+/// step before it continues (the manager's reload hooks), needs a task's
+/// result right away. Resuming the task in a loop until done() spins a
+/// core. It also resumes the task at the wrong point if the task is
+/// suspended inside something it awaits. sync_wait() instead runs the
+/// task on a private scheduler on the calling thread while it has work,
+/// and parks the thread on a condition variable (a futex on Linux) while
+/// it waits for work done elsewhere. The task may complete on any thread.
+
+#pragma once
+
+#include <quasi/async/scheduler.hpp>
+#include <quasi/async/task.hpp>
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace Q::async {
+
+namespace detail {
+
+/// @brief One-shot event; set() may be called from any thread.
+class sync_wait_event {
+public:
+    void set() {
+        // Notify under the lock: the waiter may destroy the event as soon as it sees it set.
+        std::lock_guard lock{mutex_};
+        set_ = true;
+        cv_.notify_all();
+    }
+
+    [[nodiscard]] bool is_set() {
+        std::lock_guard lock{mutex_};
+        return set_;
+    }
+
+    void wait() {
+        std::unique_lock lock{mutex_};
+        cv_.wait(lock, [this] { return set_; });
+    }
+
+private:
+    std::mutex              mutex_;
+    std::condition_variable cv_;
+    bool                    set_ = false;
+};
+
+/// @brief Coroutine that awaits the waited-for task and sets an event when done.
+class sync_wait_task {
+public:
+    struct promise_type {
+        sync_wait_event* done = nullptr;
+
+        sync_wait_task get_return_object() noexcept {
+            return sync_wait_task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        auto final_suspend() noexcept {
+            struct awaiter {
+                bool await_ready() noexcept { return false; }
+                void await_suspend(std::coroutine_handle<promise_type> h) noexcept { h.promise().done->set(); }
+                void await_resume() noexcept {}
+            };
+            return awaiter{};
+        }
+
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }  // The body catches everything.
+    };
+
+    explicit sync_wait_task(std::coroutine_handle<promise_type> h) noexcept : handle_{h} {}
+    sync_wait_task(sync_wait_task&& other) noexcept : handle_{std::exchange(other.handle_, nullptr)} {}
+    sync_wait_task(const sync_wait_task&) = delete;
+    sync_wait_task& operator=(const sync_wait_task&) = delete;
+    sync_wait_task& operator=(sync_wait_task&&) = delete;
+
+    ~sync_wait_task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    void start(sync_wait_event& done) {
+        handle_.promise().done = &done;
+        handle_.resume();
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template <typename T>
+using sync_wait_storage = std::conditional_t<std::is_void_v<T>, std::monostate, std::optional<T>>;
+
+template <typename T>
+sync_wait_task make_sync_wait_task(task<T>& t, sync_wait_storage<T>& value, std::exception_ptr& error) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await t;
+        } else {
+            value.emplace(co_await t);
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+}
+
+}  // namespace detail
+
+/// @brief Runs @p t to completion and returns its result, blocking the calling thread.
+///
+/// While the task has work on this thread (it yields, or awaits tasks
+/// that yield), sync_wait() runs it on a private scheduler, so those
+/// yields do not go to a scheduler the caller may itself be blocking.
+/// While the task waits for another thread to resume it, the calling
+/// thread sleeps until the task completes. A task resumed on another
+/// thread stays there: if it yields, it goes to that thread's scheduler.
+/// A task that polls, like wait_for(), keeps this thread busy until it
+/// finishes.
+///
+/// Only this thread may hand work to the private scheduler. The loop
+/// sleeps on completion alone, so a coroutine resumed elsewhere that
+/// enqueues onto it (say, a task_group created inside the task whose child
+/// finished on another thread) would never wake it; the scheduler is bound
+/// to this thread, which turns that deadlock into an assertion in debug
+/// builds. Hand such work back by completing the task on its own thread.
+///
+/// @throws Rethrows any exception the task threw.
+///
+/// Example usage:
+/// @code
+/// auto result = sync_wait(mgr.reload_async());
+/// @endcode
+template <typename T>
+T sync_wait(task<T> t) {
+    detail::sync_wait_event      done;
+    detail::sync_wait_storage<T> value;
+    std::exception_ptr           error;
+    auto waiter = detail::make_sync_wait_task(t, value, error);
+
+    scheduler local;
+    local.bind_to_current_thread();
+    auto* outer = detail::t_current_scheduler;
+    detail::t_current_scheduler = &local;
+    waiter.start(done);
+    detail::t_current_scheduler = outer;
+
+    while (!done.is_set()) {
+        if (!local.empty()) {
+            local.tick();
+        } else {
+            done.wait();
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(*value);
+    }
+}
+
+}  // namespace Q::async
@@ -90,11 +90,32 @@ struct task_promise {
     }
 };
 
+/// @brief Intrusive hook by which a scheduler owns a spawned task<void>.
+///
+/// scheduler::spawn() links the task into the scheduler's list of live
+/// tasks. At its final suspend point the task moves itself onto the
+/// scheduler's finished list, which the scheduler destroys after its tick,
+/// so finishing costs O(1) whatever the number of spawned tasks. Like every
+/// coroutine a scheduler drives, a spawned task must finish on its thread.
+struct spawn_hook {
+    spawn_hook*             prev     = nullptr;
+    spawn_hook*             next     = nullptr;
+    spawn_hook**            finished = nullptr;  ///< Owner's finished list; null unless spawned.
+    std::coroutine_handle<> self;
+
+    void unlink() noexcept {
+        prev->next = next;
+        next->prev = prev;
+        prev = next = nullptr;
+    }
+};
+
 /// @brief Promise specialization for task<void>.
 template <>
 struct task_promise<void> {
     std::exception_ptr      exception_;
     std::coroutine_handle<> continuation_;
+    spawn_hook              hook_;
     bool                    returned_ = false;
 
     task<void> get_return_object() noexcept;
@@ -104,16 +125,22 @@ struct task_promise<void> {
     auto final_suspend() noexcept {
         struct final_awaiter {
             std::coroutine_handle<> cont;
+            spawn_hook&             hook;
 
             bool await_ready() noexcept { return false; }
 
             std::coroutine_handle<> await_suspend(std::coroutine_handle<>) noexcept {
+                if (hook.finished) {
+                    hook.unlink();
+                    hook.next      = *hook.finished;
+                    *hook.finished = &hook;
+                }
                 return cont ? cont : std::noop_coroutine();
             }
 
             void await_resume() noexcept {}
         };
-        return final_awaiter{continuation_};
+        return final_awaiter{continuation_, hook_};
     }
 
     void unhandled_exception() noexcept {
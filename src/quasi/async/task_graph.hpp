@@ -0,0 +1,400 @@
+/// @file task_graph.hpp
+/// @brief Dependency graphs of tasks run on a thread_pool.
+///
+/// Render work has a shape: build the BVH, trace tiles, accumulate,
+/// denoise, tonemap. when_all() and the FIFO scheduler can only express
+/// that by running the stages one after another. A task_graph names the
+/// stages as nodes and the orderings as edges, and a graph_executor runs
+/// it on the work-stealing pool. Each node starts once its last predecessor
+/// finishes. The finishing worker dispatches it itself (a continuation),
+/// with no central loop polling for ready nodes.
+///
+/// A graph is a reusable template, typically built once and launched
+/// every frame. Runs of one graph overlap: frame N+1 may start tracing
+/// while frame N is still being denoised. A node marked serial also waits
+/// for the same node of the previous run, e.g. an accumulate stage that
+/// owns the accumulation buffer.
+
+#pragma once
+
+#include <quasi/async/thread_pool.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <expected>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Q::async {
+
+/// @brief Error codes for building and launching task graphs.
+enum class graph_error {
+    bad_node,   ///< A node id the graph does not have.
+    self_edge,  ///< An edge from a node to itself.
+    cycle,      ///< The edges form a cycle, so some node could never start.
+};
+
+/// @brief Converts a graph_error to a human-readable string.
+[[nodiscard]] constexpr std::string_view to_string(graph_error err) noexcept {
+    switch (err) {
+        case graph_error::bad_node:  return "no such node";
+        case graph_error::self_edge: return "node depends on itself";
+        case graph_error::cycle:     return "dependency cycle";
+    }
+    return "unknown error";
+}
+
+/// @brief Identifies a node within its task_graph.
+using node_id = uint32_t;
+
+/// @class task_graph
+/// @brief Nodes and edges of a reusable dependency graph.
+///
+/// Node bodies receive the index of the run (0 for the graph's first
+/// launch, then 1, 2, ...), so per-frame resources can be kept in a ring.
+/// Runs of a graph overlap, so a body may be called again before its
+/// previous call has returned unless the node is serial. A graph must not
+/// be modified while it has runs in flight.
+///
+/// Example usage:
+/// @code
+/// task_graph frame;
+/// auto trace = frame.add("trace", [&](uint64_t run) { trace_tiles(buffers[run % 2]); });
+/// auto accum = frame.add("accumulate", [&](uint64_t run) { accumulate(buffers[run % 2]); }, true);
+/// auto tonemap = frame.add("tonemap", [&](uint64_t run) { tonemap(buffers[run % 2]); });
+/// (void)frame.precede(trace, accum);
+/// (void)frame.precede(accum, tonemap);
+/// @endcode
+class task_graph {
+public:
+    /// @brief Adds a node.
+    /// @param name Shown in diagnostics.
+    /// @param body Called as body(run_index) on a pool worker.
+    /// @param serial Also wait for this node of the previous run.
+    node_id add(std::string name, std::function<void(uint64_t)> body, bool serial = false) {
+        nodes_.push_back({std::move(name), std::move(body), {}, 0, serial});
+        checked_ = false;
+        return static_cast<node_id>(nodes_.size() - 1);
+    }
+
+    /// @brief Adds a node whose body does not need the run index.
+    node_id add(std::string name, std::function<void()> body, bool serial = false) {
+        return add(std::move(name), [body = std::move(body)](uint64_t) { body(); }, serial);
+    }
+
+    /// @brief Makes @p after start only once @p before has finished.
+    std::expected<void, graph_error> precede(node_id before, node_id after) {
+        if (before >= nodes_.size() || after >= nodes_.size()) {
+            return std::unexpected{graph_error::bad_node};
+        }
+        if (before == after) {
+            return std::unexpected{graph_error::self_edge};
+        }
+        nodes_[before].successors.push_back(after);
+        ++nodes_[after].predecessors;
+        checked_ = false;
+        return {};
+    }
+
+    /// @brief Checks that every node can start, i.e. that the edges form no cycle.
+    [[nodiscard]] std::expected<void, graph_error> validate() const {
+        if (checked_) {
+            return {};
+        }
+        // Kahn's algorithm: every node must be reached by peeling off ready ones.
+        std::vector<uint32_t> waiting(nodes_.size());
+        std::vector<node_id> ready;
+        for (node_id i = 0; i < nodes_.size(); ++i) {
+            waiting[i] = nodes_[i].predecessors;
+            if (waiting[i] == 0) {
+                ready.push_back(i);
+            }
+        }
+        size_t reached = 0;
+        while (!ready.empty()) {
+            node_id n = ready.back();
+            ready.pop_back();
+            ++reached;
+            for (node_id s : nodes_[n].successors) {
+                if (--waiting[s] == 0) {
+                    ready.push_back(s);
+                }
+            }
+        }
+        if (reached != nodes_.size()) {
+            return std::unexpected{graph_error::cycle};
+        }
+        checked_ = true;
+        return {};
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return nodes_.size(); }
+    [[nodiscard]] const std::string& name(node_id n) const { return nodes_[n].name; }
+    [[nodiscard]] bool serial(node_id n) const { return nodes_[n].serial; }
+
+private:
+    friend class graph_executor;
+
+    struct node {
+        std::string                   name;
+        std::function<void(uint64_t)> body;
+        std::vector<node_id>          successors;
+        uint32_t                      predecessors = 0;
+        bool                          serial       = false;
+    };
+
+    std::vector<node> nodes_;
+    mutable bool      checked_ = false;
+};
+
+namespace detail {
+
+/// @brief Shared state of one launch of a task_graph.
+struct graph_run_state {
+    static constexpr uint8_t k_done   = 1;  ///< This run finished the node.
+    static constexpr uint8_t k_linked = 2;  ///< The next run waits for the node.
+
+    const task_graph*                        graph = nullptr;
+    thread_pool*                             pool  = nullptr;
+    uint64_t                                 index = 0;
+    std::unique_ptr<std::atomic<uint32_t>[]> pending;  ///< Unfinished predecessors per node.
+    std::unique_ptr<std::atomic<uint8_t>[]>  links;    ///< Serial handoff flags per node.
+    std::shared_ptr<graph_run_state>         next;     ///< Set before any k_linked flag.
+    std::atomic<uint32_t>                    handoffs{0};  ///< Serial nodes not yet handed to next.
+    std::atomic<uint32_t>                    remaining{0};
+    std::atomic<bool>                        failed{false};
+    std::once_flag                           error_once;
+    std::exception_ptr                       error;
+
+    std::mutex              mutex;
+    std::condition_variable finished_cv;
+    bool                    finished = false;
+};
+
+}  // namespace detail
+
+/// @class graph_run
+/// @brief Handle to one launch of a task_graph.
+///
+/// Dropping the handle does not cancel or wait for the run.
+class graph_run {
+public:
+    graph_run() = default;
+
+    /// @brief Index of this run among the graph's launches.
+    [[nodiscard]] uint64_t index() const noexcept { return state_ ? state_->index : 0; }
+
+    /// @brief Returns true once every node has finished or been skipped.
+    [[nodiscard]] bool done() const {
+        if (!state_) {
+            return true;
+        }
+        std::lock_guard lock{state_->mutex};
+        return state_->finished;
+    }
+
+    /// @brief Blocks until the run is done, then rethrows the first exception a node threw.
+    ///
+    /// Called from a pool worker, it runs other pool tasks while it waits.
+    void wait() const {
+        if (!state_) {
+            return;
+        }
+        if (state_->pool->current_worker()) {
+            while (!done()) {
+                if (!state_->pool->run_pending()) {
+                    std::this_thread::yield();
+                }
+            }
+        } else {
+            std::unique_lock lock{state_->mutex};
+            state_->finished_cv.wait(lock, [this] { return state_->finished; });
+        }
+        if (state_->error) {
+            std::rethrow_exception(state_->error);
+        }
+    }
+
+private:
+    friend class graph_executor;
+
+    explicit graph_run(std::shared_ptr<detail::graph_run_state> state) : state_{std::move(state)} {}
+
+    std::shared_ptr<detail::graph_run_state> state_;
+};
+
+/// @class graph_executor
+/// @brief Launches task graphs on a thread_pool.
+///
+/// A node that throws fails its run: the nodes of that run not yet started
+/// are skipped, the run still completes, and graph_run::wait() rethrows.
+/// Serial nodes of the next run are released either way. The pool must
+/// outlive every run.
+///
+/// Example usage:
+/// @code
+/// graph_executor executor{pool};
+/// for (int f = 0; f < frames; ++f) {
+///     runs.push_back(*executor.launch(frame));  // Frames overlap.
+/// }
+/// for (auto& r : runs) {
+///     r.wait();
+/// }
+/// @endcode
+class graph_executor {
+public:
+    explicit graph_executor(thread_pool& pool) : pool_{pool} {}
+
+    graph_executor(const graph_executor&) = delete;
+    graph_executor& operator=(const graph_executor&) = delete;
+
+    /// @brief Starts a run of @p graph; its roots are queued at once.
+    /// @return The run, or graph_error::cycle if some node could never start.
+    std::expected<graph_run, graph_error> launch(const task_graph& graph) {
+        if (auto valid = graph.validate(); !valid) {
+            return std::unexpected{valid.error()};
+        }
+        auto count = static_cast<uint32_t>(graph.nodes_.size());
+        auto state = std::make_shared<detail::graph_run_state>();
+        state->graph   = &graph;
+        state->pool    = &pool_;
+        state->pending = std::make_unique<std::atomic<uint32_t>[]>(count);
+        state->links   = std::make_unique<std::atomic<uint8_t>[]>(count);
+        state->remaining.store(count, std::memory_order_relaxed);
+
+        std::vector<node_id> roots;
+        {
+            std::lock_guard lock{mutex_};
+            auto& last = last_[&graph];
+            state->index = last.runs++;
+            auto previous = last.run.lock();
+            uint32_t serial = 0;
+            for (node_id i = 0; i < count; ++i) {
+                const auto& n = graph.nodes_[i];
+                state->pending[i].store(n.predecessors + (n.serial && previous ? 1 : 0), std::memory_order_relaxed);
+                serial += n.serial ? 1 : 0;
+            }
+            state->handoffs.store(serial, std::memory_order_relaxed);
+            if (previous && serial > 0) {
+                previous->next = state;
+                for (node_id i = 0; i < count; ++i) {
+                    if (graph.nodes_[i].serial &&
+                        (previous->links[i].fetch_or(detail::graph_run_state::k_linked, std::memory_order_acq_rel) &
+                         detail::graph_run_state::k_done)) {
+                        state->pending[i].fetch_sub(1, std::memory_order_relaxed);
+                        handed_over(*previous);
+                    }
+                }
+            }
+            last.run = state;
+        }
+        for (node_id i = 0; i < count; ++i) {
+            if (state->pending[i].load(std::memory_order_relaxed) == 0) {
+                roots.push_back(i);
+            }
+        }
+
+        if (count == 0) {
+            std::lock_guard lock{state->mutex};
+            state->finished = true;
+        }
+        for (node_id r : roots) {
+            dispatch(state, r);
+        }
+        return graph_run{std::move(state)};
+    }
+
+    /// @brief Forgets the runs of @p graph, so its next run starts without serial waits.
+    ///
+    /// Call before destroying a graph; runs are tracked by its address.
+    void reset(const task_graph& graph) {
+        std::lock_guard lock{mutex_};
+        last_.erase(&graph);
+    }
+
+private:
+    /// @brief The latest run of a graph; serial nodes of the next run chain onto it.
+    struct lineage {
+        std::weak_ptr<detail::graph_run_state> run;
+        uint64_t                               runs = 0;
+    };
+
+    /// @brief Drops @p state's link to the next run once its last serial node is handed over.
+    ///
+    /// Otherwise a kept handle to an old run would pin every later run.
+    static void handed_over(detail::graph_run_state& state) {
+        if (state.handoffs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            state.next.reset();
+        }
+    }
+
+    static void dispatch(std::shared_ptr<detail::graph_run_state> state, node_id n) {
+        thread_pool* pool = state->pool;
+        pool->submit([state = std::move(state), n]() mutable { execute(std::move(state), n); });
+    }
+
+    /// @brief Runs node @p n, then whichever successors it made ready.
+    ///
+    /// One ready successor runs inline on this worker; the rest are queued
+    /// for others to steal.
+    static void execute(std::shared_ptr<detail::graph_run_state> state, node_id n) {
+        const auto& nodes = state->graph->nodes_;
+        for (;;) {
+            const auto& node = nodes[n];
+            if (!state->failed.load(std::memory_order_acquire)) {
+                try {
+                    node.body(state->index);
+                } catch (...) {
+                    std::call_once(state->error_once, [&] { state->error = std::current_exception(); });
+                    state->failed.store(true, std::memory_order_release);
+                }
+            }
+
+            if (node.serial &&
+                (state->links[n].fetch_or(detail::graph_run_state::k_done, std::memory_order_acq_rel) &
+                 detail::graph_run_state::k_linked)) {
+                auto& next = state->next;
+                if (next->pending[n].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    dispatch(next, n);
+                }
+                handed_over(*state);
+            }
+
+            std::optional<node_id> inline_next;
+            for (node_id s : node.successors) {
+                if (state->pending[s].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    if (inline_next) {
+                        dispatch(state, *inline_next);
+                    }
+                    inline_next = s;
+                }
+            }
+
+            if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard lock{state->mutex};
+                state->finished = true;
+                state->finished_cv.notify_all();
+            }
+            if (!inline_next) {
+                return;
+            }
+            n = *inline_next;
+        }
+    }
+
+    thread_pool&                                   pool_;
+    std::mutex                                     mutex_;
+    std::unordered_map<const task_graph*, lineage> last_;
+};
+
+}  // namespace Q::async
@@ -0,0 +1,211 @@
+/// @file task_group.hpp
+/// @brief Structured fan-out of coroutines with a concurrency limit.
+///
+/// Spawning one coroutine per tile, file or EXR part starts them all at
+/// once, and each holds its buffers and I/O until it finishes. A task_group
+/// runs at most a fixed number of its children at a time and starts the
+/// next one as each finishes. The parent co_awaits join(), which completes
+/// once every child has, and rethrows the first exception a child threw.
+/// Optionally the first error cancels the group: children not yet started
+/// are dropped, and running ones can stop early by checking cancelled().
+
+#pragma once
+
+#include <quasi/async/scheduler.hpp>
+#include <quasi/async/task.hpp>
+
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <utility>
+
+namespace Q::async {
+
+/// @brief How a task_group reacts to a child that throws.
+enum class error_policy {
+    run_all,          ///< Start every child anyway; join() rethrows the first error.
+    cancel_on_error,  ///< Cancel the group at the first error.
+};
+
+/// @class task_group
+/// @brief Runs child tasks on a scheduler, at most max_concurrency at a time.
+///
+/// Children run on the scheduler the group was created with, which must
+/// be driven (tick()) until join() completes. The group must outlive its
+/// children: always co_await join() before it goes out of scope.
+///
+/// Example usage:
+/// @code
+/// task<void> write_parts(const std::vector<part>& parts) {
+///     task_group group{4, error_policy::cancel_on_error};
+///     for (const auto& p : parts) {
+///         co_await group.submit(write_part(p));  // Waits while four are running.
+///     }
+///     co_await group.join();
+/// }
+/// @endcode
+class task_group {
+public:
+    /// @param max_concurrency Children running at once; at least one.
+    /// @param policy What a child's exception does to the others.
+    /// @param sched Scheduler the children run on; defaults to the current one.
+    explicit task_group(size_t max_concurrency, error_policy policy = error_policy::run_all,
+                        scheduler* sched = current_scheduler())
+        : sched_{sched ? *sched : default_scheduler()},
+          limit_{max_concurrency > 0 ? max_concurrency : 1},
+          policy_{policy} {}
+
+    task_group(const task_group&) = delete;
+    task_group& operator=(const task_group&) = delete;
+    task_group(task_group&&) = delete;
+    task_group& operator=(task_group&&) = delete;
+
+    /// @brief Adds a child; it starts now if a slot is free, else when one frees up.
+    ///
+    /// Never suspends, so the queue of waiting children is unbounded; use
+    /// submit() to bound it too. Dropped if the group is cancelled.
+    void spawn(task<void> child) {
+        if (cancelled_) {
+            return;
+        }
+        if (running_ < limit_) {
+            start(std::move(child));
+        } else {
+            queued_.push_back({std::move(child), {}});
+        }
+    }
+
+    /// @brief Awaitable that adds a child, suspending the caller while every slot is taken.
+    ///
+    /// The caller resumes once its child has started (or the group was
+    /// cancelled), so at most max_concurrency children exist at a time.
+    [[nodiscard]] auto submit(task<void> child) {
+        struct awaiter {
+            task_group& group;
+            task<void>  child;
+
+            bool await_ready() {
+                if (group.cancelled_ || group.running_ < group.limit_) {
+                    group.spawn(std::move(child));
+                    return true;
+                }
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> producer) {
+                group.queued_.push_back({std::move(child), producer});
+            }
+
+            void await_resume() const noexcept {}
+        };
+        return awaiter{*this, std::move(child)};
+    }
+
+    /// @brief Awaitable that completes once every child has finished.
+    ///
+    /// Rethrows the first exception a child threw. Only one coroutine may
+    /// wait at a time.
+    [[nodiscard]] auto join() {
+        struct awaiter {
+            task_group& group;
+
+            bool await_ready() const noexcept { return group.running_ == 0 && group.queued_.empty(); }
+
+            void await_suspend(std::coroutine_handle<> parent) noexcept { group.joiner_ = parent; }
+
+            void await_resume() const {
+                if (auto error = std::exchange(group.error_, nullptr)) {
+                    std::rethrow_exception(error);
+                }
+            }
+        };
+        return awaiter{*this};
+    }
+
+    /// @brief Drops every child not yet started; running ones should check cancelled().
+    void cancel() {
+        cancelled_ = true;
+        while (!queued_.empty()) {
+            auto producer = queued_.front().producer;
+            queued_.pop_front();  // Destroys the unstarted coroutine.
+            if (producer) {
+                sched_.enqueue(producer);
+            }
+        }
+        maybe_finish();
+    }
+
+    [[nodiscard]] bool cancelled() const noexcept { return cancelled_; }
+    [[nodiscard]] size_t max_concurrency() const noexcept { return limit_; }
+    [[nodiscard]] size_t running() const noexcept { return running_; }
+    [[nodiscard]] size_t queued() const noexcept { return queued_.size(); }
+
+    /// @brief Most children that were ever running at once.
+    [[nodiscard]] size_t peak() const noexcept { return peak_; }
+
+    /// @brief Children that finished, with or without an exception.
+    [[nodiscard]] uint64_t completed() const noexcept { return completed_; }
+
+private:
+    struct waiting {
+        task<void>              child;
+        std::coroutine_handle<> producer;  ///< Suspended in submit(); may be null.
+    };
+
+    void start(task<void> child) {
+        ++running_;
+        peak_ = std::max(peak_, running_);
+        sched_.spawn(run(std::move(child)));
+    }
+
+    /// @brief Awaits one child, then hands its slot to the next.
+    task<void> run(task<void> child) {
+        try {
+            co_await child;
+        } catch (...) {
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+            if (policy_ == error_policy::cancel_on_error) {
+                cancelled_ = true;
+            }
+        }
+        --running_;
+        ++completed_;
+        if (cancelled_) {
+            cancel();
+            co_return;
+        }
+        if (!queued_.empty()) {
+            auto next = std::move(queued_.front());
+            queued_.pop_front();
+            start(std::move(next.child));
+            if (next.producer) {
+                sched_.enqueue(next.producer);
+            }
+        }
+        maybe_finish();
+    }
+
+    void maybe_finish() {
+        if (running_ == 0 && queued_.empty() && joiner_) {
+            sched_.enqueue(std::exchange(joiner_, nullptr));
+        }
+    }
+
+    scheduler&              sched_;
+    size_t                  limit_;
+    error_policy            policy_;
+    std::deque<waiting>     queued_;
+    std::coroutine_handle<> joiner_;
+    std::exception_ptr      error_;
+    size_t                  running_   = 0;
+    size_t                  peak_      = 0;
+    uint64_t                completed_ = 0;
+    bool                    cancelled_ = false;
+};
+
+}  // namespace Q::async
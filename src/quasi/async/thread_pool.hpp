@@ -0,0 +1,368 @@
+/// @file thread_pool.hpp
+/// @brief Topology-aware worker pool for data-parallel loops.
+///
+/// The coroutine scheduler is single-threaded by design; CPU-heavy work
+/// such as software rendering runs here instead. Workers are placed with
+/// Q::platform::plan_workers(), so the pool never outgrows the container's
+/// CPU quota, and optionally pin themselves to their CPU.
+///
+/// parallel_for() hands each L3 domain a contiguous slice of the index
+/// range, so neighbouring tiles (which touch neighbouring scene data and
+/// framebuffer rows) are processed by workers sharing a cache. A domain
+/// that finishes early steals from the others.
+///
+/// submit() queues independent tasks. Each worker owns a deque: tasks
+/// submitted from a worker go to its own deque and run LIFO there, idle
+/// workers steal the oldest task of another deque, and submissions from
+/// other threads are spread round-robin. wait_idle() blocks until every
+/// submitted task has finished, which lets the host quiesce the pool
+/// before unloading a plugin whose code the tasks run.
+
+#pragma once
+
+#include <quasi/platform/topology.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Q::async {
+
+class thread_pool;
+
+namespace detail {
+
+/// @brief Pool owning the current thread, if it is a pool worker.
+inline thread_local const thread_pool* t_current_pool = nullptr;
+
+/// @brief Index of the current thread within t_current_pool.
+inline thread_local uint32_t t_current_worker = 0;
+
+}  // namespace detail
+
+/// @class thread_pool
+/// @brief A fixed set of (optionally pinned) worker threads.
+///
+/// Example usage:
+/// @code
+/// thread_pool pool{platform::host_topology(), platform::pin_policy::physical_cores};
+/// pool.parallel_for(height, [&](uint32_t row, uint32_t worker) {
+///     render_row(scratch[worker], row);
+/// });
+/// @endcode
+class thread_pool {
+public:
+    /// @brief Starts one worker per placement.
+    /// @param placements Worker CPUs and L3 domains; an empty list starts one unpinned worker.
+    explicit thread_pool(std::vector<platform::worker_placement> placements)
+        : placements_(std::move(placements)) {
+        if (placements_.empty()) {
+            placements_.push_back({});
+        }
+
+        // Dense domain ids in order of first appearance.
+        for (const auto& p : placements_) {
+            auto it = std::find(domain_keys_.begin(), domain_keys_.end(), p.l3);
+            worker_domain_.push_back(static_cast<uint32_t>(it - domain_keys_.begin()));
+            if (it == domain_keys_.end()) {
+                domain_keys_.push_back(p.l3);
+                domain_workers_.push_back(0);
+            }
+            ++domain_workers_[worker_domain_.back()];
+        }
+        domains_ = std::make_unique<domain_range[]>(domain_keys_.size());
+        queues_  = std::make_unique<task_queue[]>(placements_.size());
+
+        threads_.reserve(placements_.size());
+        for (uint32_t i = 0; i < placements_.size(); ++i) {
+            threads_.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    /// @brief Plans workers for a topology and starts them.
+    /// @param topo Usable CPUs and their sharing.
+    /// @param policy Which CPUs get workers and whether they are pinned.
+    /// @param max_workers Optional cap on the worker count; 0 means none.
+    thread_pool(const platform::cpu_topology& topo, platform::pin_policy policy,
+                uint32_t max_workers = 0)
+        : thread_pool(platform::plan_workers(topo, policy, max_workers)) {}
+
+    /// @brief Finishes every queued task, then stops the workers.
+    ~thread_pool() {
+        {
+            std::lock_guard lock{mutex_};
+            stopping_ = true;
+        }
+        work_cv_.notify_all();
+        for (auto& t : threads_) {
+            t.join();
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+    thread_pool(thread_pool&&) = delete;
+    thread_pool& operator=(thread_pool&&) = delete;
+
+    /// @brief Returns the number of workers.
+    [[nodiscard]] uint32_t size() const noexcept {
+        return static_cast<uint32_t>(threads_.size());
+    }
+
+    /// @brief Returns the number of distinct L3 domains the workers span.
+    [[nodiscard]] uint32_t domain_count() const noexcept {
+        return static_cast<uint32_t>(domain_keys_.size());
+    }
+
+    /// @brief Returns where each worker runs.
+    [[nodiscard]] const std::vector<platform::worker_placement>& placements() const noexcept {
+        return placements_;
+    }
+
+    /// @brief Returns the calling thread's worker index, if it is one of this pool's workers.
+    [[nodiscard]] std::optional<uint32_t> current_worker() const noexcept {
+        if (detail::t_current_pool != this) {
+            return std::nullopt;
+        }
+        return detail::t_current_worker;
+    }
+
+    /// @brief Queues a task to run on some worker.
+    /// @param task Callable with no arguments; it must not throw.
+    void submit(std::move_only_function<void()> task) {
+        uint32_t q = current_worker().value_or(next_queue_.fetch_add(1, std::memory_order_relaxed) % size());
+        in_flight_.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard lock{queues_[q].mutex};
+            queues_[q].tasks.push_back(std::move(task));
+        }
+        {
+            // Under mutex_ so a worker between its check and its wait sees it.
+            std::lock_guard lock{mutex_};
+            queued_.fetch_add(1, std::memory_order_relaxed);
+        }
+        work_cv_.notify_one();
+    }
+
+    /// @brief Runs one queued task on the calling thread, if there is one.
+    ///
+    /// Lets a thread that waits for a task help instead of blocking.
+    /// @return False if every queue was empty.
+    bool run_pending() {
+        auto task = take(current_worker().value_or(0));
+        if (!task) {
+            return false;
+        }
+        run_task(*task);
+        return true;
+    }
+
+    /// @brief Blocks until every submitted task has finished.
+    ///
+    /// Must not be called from a worker, which would wait for itself.
+    void wait_idle() {
+        std::unique_lock lock{mutex_};
+        idle_cv_.wait(lock, [this] { return in_flight_.load(std::memory_order_acquire) == 0; });
+    }
+
+    /// @brief Calls fn(index, worker) for every index in [0, count) and waits.
+    ///
+    /// Each index runs exactly once, on a pool worker; worker is in
+    /// [0, size()) and identifies per-worker scratch. The first exception
+    /// thrown by fn is rethrown here after all workers have stopped.
+    /// Calls from different threads are serialized. Called from a worker
+    /// (inside a task or another parallel_for), the loop runs inline on
+    /// that worker.
+    /// @param count Number of indices.
+    /// @param fn Callable as fn(uint32_t index, uint32_t worker).
+    /// @param grain Indices claimed per step; larger values trade balance for fewer atomics.
+    template <typename Fn>
+    void parallel_for(uint32_t count, Fn&& fn, uint32_t grain = 1) {
+        if (count == 0) {
+            return;
+        }
+        if (auto worker = current_worker()) {
+            for (uint32_t i = 0; i < count; ++i) {
+                fn(i, *worker);
+            }
+            return;
+        }
+        std::lock_guard submit_lock{submit_mutex_};
+
+        // Split [0, count) across domains in proportion to their workers.
+        uint32_t begin = 0;
+        for (uint32_t d = 0; d < domain_keys_.size(); ++d) {
+            uint32_t end = d + 1 == domain_keys_.size()
+                               ? count
+                               : begin + static_cast<uint32_t>(uint64_t{count} * domain_workers_[d] / size());
+            domains_[d].next.store(begin, std::memory_order_relaxed);
+            domains_[d].end = end;
+            begin = end;
+        }
+
+        job j;
+        j.fn    = &fn;
+        j.call  = [](void* f, uint32_t index, uint32_t worker) {
+            (*static_cast<std::remove_reference_t<Fn>*>(f))(index, worker);
+        };
+        j.grain = std::max(grain, 1u);
+
+        std::unique_lock lock{mutex_};
+        job_     = &j;
+        pending_ = size();
+        ++generation_;
+        work_cv_.notify_all();
+        done_cv_.wait(lock, [this] { return pending_ == 0; });
+        job_ = nullptr;
+        lock.unlock();
+
+        if (j.error) {
+            std::rethrow_exception(j.error);
+        }
+    }
+
+private:
+    /// @brief One parallel_for in flight.
+    struct job {
+        void* fn = nullptr;
+        void (*call)(void*, uint32_t, uint32_t) = nullptr;
+        uint32_t           grain = 1;
+        std::once_flag     error_once;
+        std::exception_ptr error;
+    };
+
+    /// @brief The slice of the index range owned by one L3 domain.
+    struct alignas(64) domain_range {
+        std::atomic<uint32_t> next{0};
+        uint32_t              end = 0;
+    };
+
+    /// @brief One worker's task deque.
+    struct alignas(64) task_queue {
+        std::mutex                                   mutex;
+        std::deque<std::move_only_function<void()>> tasks;
+    };
+
+    void worker_loop(uint32_t worker) {
+        detail::t_current_pool   = this;
+        detail::t_current_worker = worker;
+        platform::pin_current_thread(placements_[worker].cpu);
+
+        uint64_t seen = 0;
+        for (;;) {
+            job* j = nullptr;
+            {
+                std::unique_lock lock{mutex_};
+                work_cv_.wait(lock, [&] {
+                    return stopping_ || generation_ != seen || queued_.load(std::memory_order_relaxed) > 0;
+                });
+                if (generation_ != seen) {
+                    seen = generation_;
+                    j = job_;
+                } else if (stopping_ && queued_.load(std::memory_order_relaxed) == 0) {
+                    return;
+                }
+            }
+
+            // A parallel_for waits for every worker, so it takes priority.
+            if (j) {
+                run(*j, worker);
+                std::lock_guard lock{mutex_};
+                if (--pending_ == 0) {
+                    done_cv_.notify_one();
+                }
+                continue;
+            }
+
+            if (auto task = take(worker)) {
+                run_task(*task);
+            }
+        }
+    }
+
+    /// @brief Pops the newest task of @p worker's deque, else steals the oldest of another.
+    std::optional<std::move_only_function<void()>> take(uint32_t worker) {
+        for (uint32_t k = 0; k < size(); ++k) {
+            task_queue& q = queues_[(worker + k) % size()];
+            std::lock_guard lock{q.mutex};
+            if (q.tasks.empty()) {
+                continue;
+            }
+            std::move_only_function<void()> task;
+            if (k == 0) {
+                task = std::move(q.tasks.back());
+                q.tasks.pop_back();
+            } else {
+                task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+            }
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return task;
+        }
+        return std::nullopt;
+    }
+
+    void run_task(std::move_only_function<void()>& task) {
+        task();
+        if (in_flight_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard lock{mutex_};
+            idle_cv_.notify_all();
+        }
+    }
+
+    /// @brief Drains the worker's own domain, then steals from the others.
+    void run(job& j, uint32_t worker) {
+        auto domains = static_cast<uint32_t>(domain_keys_.size());
+        uint32_t home = worker_domain_[worker];
+        for (uint32_t k = 0; k < domains; ++k) {
+            domain_range& range = domains_[(home + k) % domains];
+            for (;;) {
+                uint32_t first = range.next.fetch_add(j.grain, std::memory_order_relaxed);
+                if (first >= range.end) {
+                    break;
+                }
+                uint32_t last = std::min(first + j.grain, range.end);
+                try {
+                    for (uint32_t i = first; i < last; ++i) {
+                        j.call(j.fn, i, worker);
+                    }
+                } catch (...) {
+                    std::call_once(j.error_once, [&] { j.error = std::current_exception(); });
+                }
+            }
+        }
+    }
+
+    std::vector<platform::worker_placement> placements_;
+    std::vector<uint32_t>                   worker_domain_;   ///< Dense domain of each worker.
+    std::vector<uint32_t>                   domain_keys_;     ///< L3 id of each dense domain.
+    std::vector<uint32_t>                   domain_workers_;  ///< Worker count of each domain.
+    std::unique_ptr<domain_range[]>         domains_;
+    std::unique_ptr<task_queue[]>           queues_;
+    std::vector<std::thread>                threads_;
+
+    std::mutex              submit_mutex_;
+    std::mutex              mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    std::condition_variable idle_cv_;
+    std::atomic<uint32_t>   queued_{0};     ///< Tasks in the deques; raised under mutex_.
+    std::atomic<uint64_t>   in_flight_{0};  ///< Tasks submitted and not yet finished.
+    std::atomic<uint32_t>   next_queue_{0};
+    job*                    job_        = nullptr;
+    uint64_t                generation_ = 0;
+    uint32_t                pending_    = 0;
+    bool                    stopping_   = false;
+};
+
+}  // namespace Q::async
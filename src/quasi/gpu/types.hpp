@@ -60,6 +60,27 @@ struct Q_camera {
 /// Vulkan:
 ///   - drawable:           VkImage (swapchain image)
 ///   - command_buffer:     VkCommandBuffer
+///
+/// None (CPU backends, no GPU context):
+///   - drawable:           uint16_t[width * height * 4], host-owned RGBA16F
+///                         image that receives the tonemapped frame; may be null
+///   - command_buffer:     unused
+///
+/// Row bands (ABI v8+, plugins reporting Q_CAPABILITY_ROW_BANDS): a plugin
+/// renders and presents only rows [row_begin, row_end) and leaves every
+/// other row's accumulation untouched, each row averaging the samples it
+/// received. A host can then give different bands to different plugins
+/// each frame and merge their readbacks weighted by the samples each took.
+/// Zero-initialized frames render every row. Plugins must hash
+/// sample_salt into their random seeds on its own, not add it to a pixel
+/// or sample index, or two salts would replay each other's sequences at
+/// shifted pixels.
+///
+/// Sample reports (ABI v11+, row-band plugins): after render, a plugin
+/// stores in samples_added how many samples each pixel of the band
+/// received, and sets accumulation_reset if it discarded the samples of
+/// every row first (camera change, resize or a parameter change). Hosts
+/// zero both before the call; zero samples_added means one sample.
 struct Q_render_frame {
     void* drawable;         ///< Current frame's drawable/swapchain image.
     void* command_buffer;   ///< Command buffer for this frame.
@@ -67,6 +88,11 @@ struct Q_render_frame {
     uint32_t height;        ///< Drawable height in pixels.
     Q_camera camera;        ///< Camera parameters from host.
     uint32_t camera_dirty;  ///< Non-zero if camera changed this frame.
+    uint32_t row_begin;     ///< First image row to render, 0 = top (ABI v8+).
+    uint32_t row_end;       ///< One past the last row to render; 0 for every row (ABI v8+).
+    uint32_t sample_salt;   ///< Varies the random sequence; plugins sharing a frame get different salts (ABI v8+).
+    uint32_t samples_added;       ///< Out: samples per pixel this call added to the band (ABI v11+).
+    uint32_t accumulation_reset;  ///< Out: non-zero if every row's samples were discarded first (ABI v11+).
 };
 
 }  // extern "C"
@@ -87,4 +113,22 @@ inline constexpr gpu_backend k_backend_metal  = Q_GPU_BACKEND_METAL;
 inline constexpr gpu_backend k_backend_vulkan = Q_GPU_BACKEND_VULKAN;
 inline constexpr gpu_backend k_backend_webgpu = Q_GPU_BACKEND_WEBGPU;
 
+/// @brief Derives the sample salt of sub-stream @p stream of a pass salted @p salt.
+///
+/// Both inputs go through MurmurHash3's 32-bit finalizer, so derived salts
+/// do not line up by arithmetic: deriving twice (a split inside a split, a
+/// resumed pass of a split frame) gives distinct salts for distinct
+/// paths. Zero for both inputs stays zero, the unsalted sequence.
+[[nodiscard]] constexpr uint32_t derive_salt(uint32_t salt, uint32_t stream) noexcept {
+    auto mix = [](uint32_t h) {
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35u;
+        h ^= h >> 16;
+        return h;
+    };
+    return mix(salt ^ mix(stream));
+}
+
 }  // namespace Q::gpu
@@ -0,0 +1,251 @@
+/// @file ab.cpp
+/// @brief A/B test of two plugin builds in one process.
+///
+/// Loads a baseline and a candidate build of a backend side by side, each
+/// in its own dynamic-linker namespace, so neither sees the other's
+/// globals even when both are built from the same sources. Both share the
+/// host job system. Every frame is rendered by both with the same camera
+/// and delta time, alternating which goes first so neither always runs
+/// with warm caches. The report gives per-frame time percentiles for each
+/// side and the differences between their final images: the displayed
+/// RGBA16F output and, where the plugins support readback, the linear HDR
+/// accumulation.
+///
+/// Usage:
+///   quasi_ab baseline.so candidate.so [--frames N] [--size WxH] [--json out.json]
+///            [--tolerance T] [--shared-namespace]
+
+#include <quasi/async/thread_pool.hpp>
+#include <quasi/host/plugin_log.hpp>
+#include <quasi/io/image_compare.hpp>
+#include <quasi/log/logger.hpp>
+#include <quasi/math/half.hpp>
+#include <quasi/platform/topology.hpp>
+#include <quasi/plugin/plugin.hpp>
+#include <quasi/profile/histogram.hpp>
+#include <quasi/profile/profiler.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+/// @brief Plugins may not end an A/B run early.
+void plugin_request_shutdown(void* /*host_data*/) {}
+
+/// @brief One side of the comparison.
+struct side {
+    std::filesystem::path         path;
+    Q::plugin::dynamic_library    library;
+    Q::plugin::plugin_context     context{};
+    std::optional<Q::plugin::loader> plugin;
+    std::vector<uint16_t>         image;
+    Q::profile::histogram         frame_ns;
+};
+
+void write_number(std::ostream& out, double v) {
+    if (std::isfinite(v)) {
+        out << v;
+    } else {
+        out << "null";  // JSON has no infinity; null means identical.
+    }
+}
+
+void write_difference(std::ostream& out, const Q::io::image_difference& d) {
+    out << "{\"max_abs\": ";
+    write_number(out, d.max_abs);
+    out << ", \"mean_abs\": ";
+    write_number(out, d.mean_abs);
+    out << ", \"rmse\": ";
+    write_number(out, d.rmse);
+    out << ", \"psnr_db\": ";
+    write_number(out, d.psnr);
+    out << ", \"differing_pixels\": " << d.differing_pixels << ", \"nonfinite\": " << d.nonfinite << '}';
+}
+
+void write_side(std::ostream& out, const side& s) {
+    auto info = s.plugin->info();
+    out << "{\"path\": ";
+    Q::profile::detail::write_json_string(out, s.path.string());
+    out << ", \"plugin\": ";
+    Q::profile::detail::write_json_string(out, info.name ? info.name : "");
+    out << ", \"isolated\": " << (s.library.is_isolated() ? "true" : "false") << ", \"frame_ns\": ";
+    s.frame_ns.write_json(out);
+    out << '}';
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    using clock = std::chrono::steady_clock;
+
+    std::vector<std::filesystem::path> paths;
+    std::filesystem::path json_path;
+    uint32_t width     = 256;
+    uint32_t height    = 256;
+    int      frames    = 32;
+    float    tolerance = 0.0f;
+    auto     ns        = Q::plugin::link_namespace::isolated;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        } else if (arg == "--size" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+                std::fprintf(stderr, "Bad size (expected WxH): %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--json" && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            tolerance = std::strtof(argv[++i], nullptr);
+        } else if (arg == "--shared-namespace") {
+            ns = Q::plugin::link_namespace::shared;
+        } else if (arg == "--log-level" && i + 1 < argc) {
+            if (auto level = Q::log::parse_severity(argv[++i])) {
+                Q::log::default_logger().set_level(*level);
+            }
+        } else if (arg[0] != '-') {
+            paths.emplace_back(arg);
+        }
+    }
+    if (paths.size() != 2) {
+        std::fprintf(stderr, "Usage: %s <baseline.so> <candidate.so> [--frames N] [--size WxH] [--json FILE]\n",
+                     argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Q::async::thread_pool pool{Q::platform::host_topology(), Q::platform::pin_policy::physical_cores};
+    Q::plugin::job_system jobs{pool};
+    Q_gpu_context gpu{};
+    gpu.backend = Q_GPU_BACKEND_NONE;
+
+    side sides[2];
+    for (int s = 0; s < 2; ++s) {
+        auto& x = sides[s];
+        x.path = paths[s];
+        auto lib = Q::plugin::dynamic_library::open(x.path, ns);
+        if (!lib) {
+            std::fprintf(stderr, "Failed to load %s: %s (%s)\n", x.path.c_str(),
+                         Q::plugin::to_string(lib.error()).data(), Q::plugin::dynamic_library::last_error());
+            return EXIT_FAILURE;
+        }
+        x.library = std::move(*lib);
+        x.context = Q::plugin::plugin_context{
+            .viewport_width   = width,
+            .viewport_height  = height,
+            .host_data        = nullptr,
+            .gpu              = &gpu,
+            .log              = Q::host::plugin_log,
+            .request_shutdown = plugin_request_shutdown,
+            .jobs             = jobs.table(),
+            .profiler         = nullptr,
+            .cache            = nullptr,  // Each build does its own setup.
+        };
+        auto plugin = Q::plugin::loader::load(x.library, &x.context);
+        if (!plugin) {
+            std::fprintf(stderr, "Failed to load plugin %s: %s\n", x.path.c_str(), to_string(plugin.error()));
+            return EXIT_FAILURE;
+        }
+        x.plugin.emplace(std::move(*plugin));
+        x.image.assign(size_t{width} * height * 4, 0);
+    }
+
+    Q_render_frame frame{};
+    frame.width  = width;
+    frame.height = height;
+    frame.camera.position[1] = 1.0f;
+    frame.camera.position[2] = 3.5f;
+    frame.camera.target[1]   = 1.0f;
+    frame.camera.up[1]       = 1.0f;
+    frame.camera.fov         = 40.0f;
+
+    for (int i = 0; i < frames; ++i) {
+        frame.camera_dirty = i == 0 ? 1 : 0;
+        for (int k = 0; k < 2; ++k) {
+            auto& x = sides[(i + k) % 2];  // Alternate who runs first.
+            frame.drawable = x.image.data();
+            auto start = clock::now();
+            x.plugin->update(1.0f / 60.0f);
+            x.plugin->render(&frame);
+            x.frame_ns.add(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count()));
+        }
+    }
+    jobs.quiesce();
+
+    // Displayed output: the tonemapped half-float images.
+    std::vector<float> display[2];
+    for (int s = 0; s < 2; ++s) {
+        display[s].resize(sides[s].image.size());
+        Q::math::from_half(sides[s].image, display[s]);
+    }
+    auto display_diff = Q::io::compare_images(display[0], display[1], 4, tolerance);
+
+    // Linear HDR accumulation, when both sides can read it back.
+    std::optional<Q::io::image_difference> hdr_diff;
+    if (sides[0].plugin->supports_readback() && sides[1].plugin->supports_readback()) {
+        auto a = sides[0].plugin->readback();
+        auto b = sides[1].plugin->readback();
+        if (a.data && b.data && a.width == b.width && a.height == b.height) {
+            size_t n = size_t{a.width} * a.height * a.channels;
+            hdr_diff = Q::io::compare_images({a.data, n}, {b.data, n}, a.channels, tolerance);
+        }
+        sides[0].plugin->readback_free(&a);
+        sides[1].plugin->readback_free(&b);
+    }
+
+    const char* names[2] = {"baseline", "candidate"};
+    for (int s = 0; s < 2; ++s) {
+        std::fprintf(stderr, "%-9s %s\n", names[s], sides[s].frame_ns.summary().c_str());
+    }
+    double speedup = static_cast<double>(sides[0].frame_ns.percentile(0.5)) /
+                     static_cast<double>(std::max<uint64_t>(1, sides[1].frame_ns.percentile(0.5)));
+    std::fprintf(stderr, "candidate median speedup %.3fx; display max diff %g over %llu pixels\n", speedup,
+                 display_diff.max_abs, static_cast<unsigned long long>(display_diff.differing_pixels));
+
+    auto write_report = [&](std::ostream& out) {
+        out << "{\"width\": " << width << ", \"height\": " << height << ", \"frames\": " << frames
+            << ", \"workers\": " << pool.size() << ", \"tolerance\": " << tolerance
+            << ",\n \"baseline\": ";
+        write_side(out, sides[0]);
+        out << ",\n \"candidate\": ";
+        write_side(out, sides[1]);
+        out << ",\n \"median_speedup\": " << speedup << ",\n \"display_difference\": ";
+        write_difference(out, display_diff);
+        out << ",\n \"hdr_difference\": ";
+        if (hdr_diff) {
+            write_difference(out, *hdr_diff);
+        } else {
+            out << "null";
+        }
+        out << "}\n";
+    };
+
+    // Destroy both plugins before their libraries close.
+    for (auto& x : sides) {
+        jobs.quiesce();
+        x.plugin->destroy();
+    }
+
+    if (json_path.empty()) {
+        write_report(std::cout);
+    } else {
+        std::ofstream out{json_path};
+        write_report(out);
+        if (!out) {
+            std::fprintf(stderr, "Failed to write %s\n", json_path.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
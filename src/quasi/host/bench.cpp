@@ -0,0 +1,315 @@
+/// @file bench.cpp
+/// @brief Headless benchmark: renders N frames through a plugin and reports timings.
+///
+/// No window and no GPU: the plugin presents into a host-owned RGBA16F
+/// image. Every plugin call and every stage the plugin reports through
+/// Q_plugin_context::profiler is timed, with hardware counters where the
+/// machine provides them, and written as benchmark JSON (stdout or --json)
+/// and optionally as a Chrome trace (--trace).
+///
+/// With --replay the frames come from a call trace recorded by the
+/// interactive host (quasi --record), so a session's camera moves and
+/// resizes run as a repeatable benchmark, at full speed or, with
+/// --realtime, at the pace they were recorded.
+///
+/// --param and --params set plugin parameters before the first frame, so
+/// one build can be benchmarked at several quality settings.
+///
+/// Usage:
+///   quasi_bench [plugin.so] [--frames N] [--size WxH] [--json out.json]
+///               [--trace trace.json] [--no-counters] [--isa LEVEL] [--accel NAME]
+///               [--replay session.qct [--realtime]] [--record out.qct]
+///               [--param name=value ...] [--params FILE]
+
+#include <quasi/async/thread_pool.hpp>
+#include <quasi/host/plugin_log.hpp>
+#include <quasi/log/logger.hpp>
+#include <quasi/platform/kernel_registry.hpp>
+#include <quasi/platform/topology.hpp>
+#include <quasi/plugin/plugin.hpp>
+#include <quasi/plugin/profiler_bridge.hpp>
+#include <quasi/profile/profiler.hpp>
+
+#include "tools/cpp/runfiles/runfiles.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/// @brief Plugins may not end a benchmark early.
+void plugin_request_shutdown(void* /*host_data*/) {}
+
+/// @brief The interactive host's default view of the Cornell Box.
+Q_camera default_camera() {
+    Q_camera cam{};
+    cam.position[0] = 0.0f;
+    cam.position[1] = 1.0f;
+    cam.position[2] = 3.5f;
+    cam.target[1]   = 1.0f;
+    cam.up[1]       = 1.0f;
+    cam.fov         = 40.0f;
+    return cam;
+}
+
+/// @brief Times each replayed frame like the synthetic loop does.
+struct profiled_plugin {
+    Q::plugin::loader&    plugin;
+    Q::profile::profiler& prof;
+
+    void update(float delta_time) { plugin.update(delta_time); }
+
+    void render(Q_render_frame* frame) {
+        auto s = prof.measure("frame");
+        plugin.render(frame);
+    }
+};
+
+/// @brief Writes the report: run parameters, then the profiler's stages.
+void write_report(std::ostream& out, const Q::plugin::plugin_info& info, const std::filesystem::path& replay,
+                  uint32_t width, uint32_t height, int frames, uint32_t workers, uint64_t wall_ns,
+                  uint32_t counters, const Q::profile::profiler& prof) {
+    out << "{\"plugin\": ";
+    Q::profile::detail::write_json_string(out, info.name ? info.name : "");
+    out << ", \"version\": \"" << info.version.major << '.' << info.version.minor << '.'
+        << info.version.patch << "\"";
+    if (!replay.empty()) {
+        out << ", \"replay\": ";
+        Q::profile::detail::write_json_string(out, replay.string());
+    }
+    out << ", \"width\": " << width << ", \"height\": " << height
+        << ", \"frames\": " << frames << ", \"workers\": " << workers
+        << ", \"wall_ns\": " << wall_ns
+        << ", \"counters_available\": [";
+    bool first = true;
+    for (size_t i = 0; i < Q::profile::k_counter_count; ++i) {
+        if ((counters >> i) & 1u) {
+            out << (first ? "" : ", ") << '"' << to_string(static_cast<Q::profile::counter>(i)) << '"';
+            first = false;
+        }
+    }
+    out << "],\n\"stages\": ";
+    prof.write_stages_json(out);
+    out << "}\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    using bazel::tools::cpp::runfiles::Runfiles;
+
+    std::filesystem::path plugin_path;
+    std::filesystem::path json_path;
+    std::filesystem::path trace_path;
+    std::filesystem::path replay_path;
+    std::filesystem::path record_path;
+    std::filesystem::path params_path;
+    std::vector<std::string_view> param_args;
+    uint32_t width  = 256;
+    uint32_t height = 256;
+    int      frames = 64;
+    bool     counters = true;
+    bool     realtime = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        } else if (arg == "--size" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+                std::fprintf(stderr, "Bad size (expected WxH): %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--json" && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (arg == "--record" && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (arg == "--param" && i + 1 < argc) {
+            param_args.emplace_back(argv[++i]);
+        } else if (arg == "--params" && i + 1 < argc) {
+            params_path = argv[++i];
+        } else if (arg == "--realtime") {
+            realtime = true;
+        } else if (arg == "--no-counters") {
+            counters = false;
+        } else if (arg == "--log-level" && i + 1 < argc) {
+            if (auto level = Q::log::parse_severity(argv[++i])) {
+                Q::log::default_logger().set_level(*level);
+            } else {
+                std::fprintf(stderr, "Unknown log level: %s\n", argv[i]);
+            }
+        } else if (arg == "--isa" && i + 1 < argc) {
+            setenv(Q::platform::k_isa_env_var, argv[++i], 1);
+        } else if (arg == "--accel" && i + 1 < argc) {
+            setenv("Q_ACCEL", argv[++i], 1);  // CPU backend acceleration structure.
+        } else if (arg[0] != '-') {
+            plugin_path = arg;
+        }
+    }
+
+    std::unique_ptr<Runfiles> runfiles;
+    if (plugin_path.empty()) {
+        std::string error;
+        runfiles.reset(Runfiles::Create(argv[0], &error));
+        if (runfiles) {
+            plugin_path = runfiles->Rlocation("quasi/backends/cpu/libquasi_cpu.so");
+        }
+        if (plugin_path.empty() || !std::filesystem::exists(plugin_path)) {
+            std::fprintf(stderr, "Default plugin not found in runfiles\n");
+            std::fprintf(stderr, "Usage: %s <plugin.so> [--frames N] [--size WxH] [--json FILE] [--trace FILE]\n",
+                         argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // A replay takes its viewport and frames from the trace.
+    Q::plugin::call_trace replay_trace;
+    if (!replay_path.empty()) {
+        auto trace = Q::plugin::call_trace::load(replay_path);
+        if (!trace) {
+            std::fprintf(stderr, "Failed to read %s: %s\n", replay_path.c_str(), to_string(trace.error()));
+            return EXIT_FAILURE;
+        }
+        replay_trace = std::move(*trace);
+        width  = replay_trace.viewport_width;
+        height = replay_trace.viewport_height;
+        frames = static_cast<int>(replay_trace.render_count());
+    }
+
+    auto lib_result = Q::plugin::dynamic_library::open(plugin_path);
+    if (!lib_result) {
+        std::fprintf(stderr, "Failed to load plugin library: %s\n",
+                     Q::plugin::to_string(lib_result.error()).data());
+        return EXIT_FAILURE;
+    }
+
+    Q::async::thread_pool pool{Q::platform::host_topology(), Q::platform::pin_policy::physical_cores};
+    Q::plugin::job_system jobs{pool};
+
+    Q::profile::profiler prof{Q::profile::profiler_options{.counters = counters}};
+    Q::plugin::profiler_bridge bridge{prof};
+
+    Q_gpu_context gpu{};
+    gpu.backend = Q_GPU_BACKEND_NONE;
+
+    Q::plugin::plugin_context ctx{
+        .viewport_width   = width,
+        .viewport_height  = height,
+        .host_data        = nullptr,
+        .gpu              = &gpu,
+        .log              = Q::host::plugin_log,
+        .request_shutdown = plugin_request_shutdown,
+        .jobs             = jobs.table(),
+        .profiler         = bridge.table(),
+        .cache            = nullptr,
+    };
+
+    auto plugin_result = Q::plugin::loader::load(*lib_result, &ctx);
+    if (!plugin_result) {
+        std::fprintf(stderr, "Failed to load plugin: %s\n", to_string(plugin_result.error()));
+        return EXIT_FAILURE;
+    }
+    auto& plugin = *plugin_result;
+    plugin.set_profiler(&prof);
+
+    Q::plugin::param_registry params;
+    params.apply(plugin, true);  // Learn the declared names.
+    for (auto arg : param_args) {
+        if (auto r = params.set(arg); !r) {
+            std::fprintf(stderr, "Bad --param %.*s: %s\n", static_cast<int>(arg.size()), arg.data(),
+                         Q::plugin::to_string(r.error()).data());
+            return EXIT_FAILURE;
+        }
+    }
+    if (!params_path.empty()) {
+        if (auto r = params.load_file(params_path); !r) {
+            std::fprintf(stderr, "Parameter file %s: %s\n", params_path.c_str(),
+                         Q::plugin::to_string(r.error()).data());
+            return EXIT_FAILURE;
+        }
+    }
+    params.apply(plugin);
+
+    std::ofstream record_file;
+    std::unique_ptr<Q::plugin::call_recorder> recorder;
+    if (!record_path.empty()) {
+        record_file.open(record_path, std::ios::binary);
+        recorder = std::make_unique<Q::plugin::call_recorder>(record_file, width, height);
+        plugin.set_recorder(recorder.get());
+    }
+
+    uint64_t wall_ns = 0;
+    if (!replay_path.empty()) {
+        profiled_plugin target{plugin, prof};
+        auto timing = realtime ? Q::plugin::replay_timing::original : Q::plugin::replay_timing::full_speed;
+        auto result = Q::plugin::replay(replay_trace, target, Q::plugin::replay_options{.timing = timing});
+        wall_ns = result.wall_ns;
+        if (realtime && result.max_lag_ns > 0) {
+            std::fprintf(stderr, "Replay fell behind the recording by up to %.1f ms\n",
+                         static_cast<double>(result.max_lag_ns) / 1e6);
+        }
+    } else {
+        std::vector<uint16_t> image(size_t{width} * height * 4);
+        Q_render_frame frame{};
+        frame.drawable = image.data();
+        frame.width    = width;
+        frame.height   = height;
+        frame.camera   = default_camera();
+
+        auto start = std::chrono::steady_clock::now();
+        auto last  = start;
+        for (int i = 0; i < frames; ++i) {
+            auto s = prof.measure("frame");
+            auto now = std::chrono::steady_clock::now();
+            plugin.update(std::chrono::duration<float>(now - last).count());
+            last = now;
+            frame.camera_dirty = i == 0 ? 1 : 0;
+            plugin.render(&frame);
+        }
+        wall_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                            std::chrono::steady_clock::now() - start)
+                                            .count());
+    }
+
+    jobs.quiesce();
+    plugin.set_profiler(nullptr);
+    plugin.set_recorder(nullptr);
+    if (recorder && !recorder->flush()) {
+        std::fprintf(stderr, "Failed to write %s\n", record_path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    if (json_path.empty()) {
+        write_report(std::cout, plugin.info(), replay_path, width, height, frames, pool.size(), wall_ns,
+                     prof.available_counters(), prof);
+    } else {
+        std::ofstream out{json_path};
+        write_report(out, plugin.info(), replay_path, width, height, frames, pool.size(), wall_ns,
+                     prof.available_counters(), prof);
+        if (!out) {
+            std::fprintf(stderr, "Failed to write %s\n", json_path.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    if (!trace_path.empty()) {
+        std::ofstream out{trace_path};
+        prof.write_trace(out);
+        if (!out) {
+            std::fprintf(stderr, "Failed to write %s\n", trace_path.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -3,10 +3,17 @@
 ///
 /// Creates a window, sets up Metal, loads a plugin, and runs the main loop.
 
+#include <quasi/host/plugin_log.hpp>
 #include <quasi/host/window.hpp>
 #include <quasi/gpu/metal/context.hpp>
 #include <quasi/io/exr_writer.hpp>
+#include <quasi/log/logger.hpp>
+#include <quasi/async/thread_pool.hpp>
+#include <quasi/platform/kernel_registry.hpp>
+#include <quasi/platform/topology.hpp>
 #include <quasi/plugin/plugin.hpp>
+#include <quasi/plugin/profiler_bridge.hpp>
+#include <quasi/profile/profiler.hpp>
 
 #include "tools/cpp/runfiles/runfiles.h"
 
@@ -15,16 +22,15 @@
 #include <cstdio>
 #include <cstdlib>
 #include <filesystem>
+#include <fstream>
 #include <memory>
+#include <optional>
+#include <string>
 #include <string_view>
+#include <vector>
 
 namespace {
 
-/// @brief Log callback for plugins.
-void plugin_log(void* /*host_data*/, const char* message) {
-    std::printf("[Plugin] %s\n", message);
-}
-
 /// @brief Shutdown callback for plugins.
 void plugin_request_shutdown(void* host_data) {
     auto* window = static_cast<Q::host::window*>(host_data);
@@ -122,6 +128,13 @@ int main(int argc, char* argv[]) {
 
     // Parse command line.
     std::filesystem::path plugin_path;
+    std::filesystem::path trace_path;  // Chrome trace of plugin calls and stages, written at exit.
+    std::filesystem::path record_path;  // Call trace for quasi_bench --replay.
+    std::filesystem::path cache_dir = Q::plugin::cache_store::default_directory();  // Empty = memory only.
+    uint64_t cache_disk_budget = Q::plugin::cache_options{}.disk_budget;  // Bytes; 0 = unlimited.
+    std::vector<std::string_view> param_args;  // --param name=value, in order.
+    std::filesystem::path params_path;  // Watched parameter file.
+    std::filesystem::path param_socket_path;  // Control socket for live parameter changes.
     std::unique_ptr<Runfiles> runfiles;
     int render_frames = 0;  // 0 = interactive, >0 = render N frames then save & exit.
 
@@ -129,6 +142,34 @@ int main(int argc, char* argv[]) {
         std::string_view arg = argv[i];
         if (arg == "--render" && i + 1 < argc) {
             render_frames = std::atoi(argv[++i]);
+        } else if (arg == "--log-level" && i + 1 < argc) {
+            if (auto level = Q::log::parse_severity(argv[++i])) {
+                Q::log::default_logger().set_level(*level);
+            } else {
+                std::fprintf(stderr, "Unknown log level: %s\n", argv[i]);
+            }
+        } else if (arg == "--isa" && i + 1 < argc) {
+            // CPU kernel override (e.g. sse4.2), read by plugins at create.
+            setenv(Q::platform::k_isa_env_var, argv[++i], 1);
+        } else if (arg == "--accel" && i + 1 < argc) {
+            // CPU backend acceleration structure (e.g. lazy), read at create.
+            setenv("Q_ACCEL", argv[++i], 1);
+        } else if (arg == "--trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (arg == "--record" && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (arg == "--cache-dir" && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else if (arg == "--no-disk-cache") {
+            cache_dir.clear();
+        } else if (arg == "--disk-cache-mb" && i + 1 < argc) {
+            cache_disk_budget = std::strtoull(argv[++i], nullptr, 10) << 20;
+        } else if (arg == "--param" && i + 1 < argc) {
+            param_args.emplace_back(argv[++i]);
+        } else if (arg == "--params" && i + 1 < argc) {
+            params_path = argv[++i];
+        } else if (arg == "--param-socket" && i + 1 < argc) {
+            param_socket_path = argv[++i];
         } else if (arg[0] != '-') {
             plugin_path = arg;
         }
@@ -205,14 +246,33 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
+    // One shared worker pool for every plugin, sized to the CPUs we may use.
+    Q::async::thread_pool pool{Q::platform::host_topology(), Q::platform::pin_policy::physical_cores};
+    Q::plugin::job_system jobs{pool};
+    std::printf("[Host] Job system: %u workers\n", pool.size());
+
+    // Profiling is off unless a trace was requested.
+    std::unique_ptr<Q::profile::profiler> profiler;
+    std::unique_ptr<Q::plugin::profiler_bridge> profiler_bridge;
+    if (!trace_path.empty()) {
+        profiler = std::make_unique<Q::profile::profiler>();
+        profiler_bridge = std::make_unique<Q::plugin::profiler_bridge>(*profiler);
+    }
+
+    // Plugins keep compiled pipelines and the like here across reloads and runs.
+    Q::plugin::cache_store cache{Q::plugin::cache_options{.directory = cache_dir, .disk_budget = cache_disk_budget}};
+
     // Set up plugin context
     Q::plugin::plugin_context ctx{
         .viewport_width  = window.framebuffer_width(),
         .viewport_height = window.framebuffer_height(),
         .host_data       = &window,
         .gpu             = metal.gpu(),
-        .log             = plugin_log,
+        .log             = Q::host::plugin_log,
         .request_shutdown = plugin_request_shutdown,
+        .jobs            = jobs.table(),
+        .profiler        = profiler_bridge ? profiler_bridge->table() : nullptr,
+        .cache           = cache.table(),
     };
 
     auto plugin_result = Q::plugin::loader::load(*lib_result, &ctx);
@@ -222,6 +282,21 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
     auto& plugin = *plugin_result;
+    plugin.set_profiler(profiler.get());
+
+    // Recording is off unless a call trace was requested.
+    std::ofstream record_file;
+    std::unique_ptr<Q::plugin::call_recorder> recorder;
+    if (!record_path.empty()) {
+        record_file.open(record_path, std::ios::binary);
+        if (!record_file) {
+            std::fprintf(stderr, "Failed to open %s\n", record_path.c_str());
+            return EXIT_FAILURE;
+        }
+        recorder = std::make_unique<Q::plugin::call_recorder>(record_file, ctx.viewport_width,
+                                                              ctx.viewport_height);
+        plugin.set_recorder(recorder.get());
+    }
 
     // Print plugin info
     auto info = plugin.info();
@@ -232,6 +307,32 @@ int main(int argc, char* argv[]) {
                 info.version.patch);
     std::printf("Description: %s\n", info.description);
 
+    // Tunables set without a reload: command line first, then the watched file.
+    Q::plugin::param_registry params;
+    params.apply(plugin, true);  // Learn the declared names.
+    for (auto arg : param_args) {
+        if (auto r = params.set(arg); !r) {
+            std::fprintf(stderr, "Ignoring --param %.*s: %s\n", static_cast<int>(arg.size()), arg.data(),
+                         Q::plugin::to_string(r.error()).data());
+        }
+    }
+    if (!params_path.empty()) {
+        if (auto r = params.watch_file(params_path); !r) {
+            std::fprintf(stderr, "Parameter file %s: %s\n", params_path.c_str(),
+                         Q::plugin::to_string(r.error()).data());
+        }
+    }
+    std::optional<Q::plugin::param_socket> param_socket;
+    if (!param_socket_path.empty()) {
+        if (auto s = Q::plugin::param_socket::listen(param_socket_path)) {
+            param_socket.emplace(std::move(*s));
+            std::printf("[Host] Parameters: %s\n", param_socket_path.c_str());
+        } else {
+            std::fprintf(stderr, "Parameter socket %s: %s\n", param_socket_path.c_str(),
+                         Q::plugin::to_string(s.error()).data());
+        }
+    }
+
     // Main loop
     auto last_time = std::chrono::steady_clock::now();
     int frames_rendered = 0;
@@ -261,6 +362,18 @@ int main(int argc, char* argv[]) {
             frame.camera_dirty = camera.dirty ? 1 : 0;
             camera.dirty = false;
 
+            // Apply parameter changes between frames.
+            if (param_socket) {
+                param_socket->poll(params);
+            }
+            if (auto r = params.poll_file(); !r) {
+                std::fprintf(stderr, "Parameter file %s: %s\n", params_path.c_str(),
+                             Q::plugin::to_string(r.error()).data());
+            }
+            if (params.pending()) {
+                params.apply(plugin);
+            }
+
             // Render plugin
             plugin.render(&frame);
 
@@ -323,5 +436,22 @@ int main(int argc, char* argv[]) {
     }
 
     std::printf("Shutting down...\n");
+    jobs.quiesce();  // Before the plugin is destroyed and its library closed.
+
+    if (recorder) {
+        plugin.set_recorder(nullptr);
+        if (recorder->flush()) {
+            std::printf("[Host] Recorded %llu calls: %s\n",
+                        static_cast<unsigned long long>(recorder->calls()), record_path.c_str());
+        } else {
+            std::fprintf(stderr, "[Host] Failed to write %s\n", record_path.c_str());
+        }
+    }
+
+    if (profiler) {
+        std::ofstream out{trace_path};
+        profiler->write_trace(out);
+        std::printf("[Host] Trace: %s\n", trace_path.c_str());
+    }
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,35 @@
+/// @file plugin_log.hpp
+/// @brief The log callback every host tool hands to its plugins.
+
+#pragma once
+
+#include <quasi/log/logger.hpp>
+
+#include <chrono>
+
+namespace Q::host {
+
+/// @brief Log channel for plugin messages; a chatty plugin is rate limited.
+inline log::channel& plugin_channel() {
+    static log::channel& channel = []() -> log::channel& {
+        auto& c = log::default_logger().get("Plugin");
+        c.set_rate_limit(200, std::chrono::seconds{1});
+        return c;
+    }();
+    return channel;
+}
+
+/// @brief Log callback for plugins (plugin_context::log).
+///
+/// Copies the message and returns; the logger's flusher thread writes it,
+/// so a plugin can log from its render loop without waiting on the console.
+///
+/// Example usage:
+/// @code
+/// Q::plugin::plugin_context ctx{.log = Q::host::plugin_log, ...};
+/// @endcode
+inline void plugin_log(void* /*host_data*/, const char* message) {
+    plugin_channel().write(log::severity::info, message ? message : "(null)");
+}
+
+}  // namespace Q::host
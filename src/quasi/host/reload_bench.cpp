@@ -0,0 +1,218 @@
+/// @file reload_bench.cpp
+/// @brief Hot-reload benchmark: reinstalls a plugin many times and times each reload.
+///
+/// Each iteration optionally runs a rebuild command, then installs the
+/// plugin over the watched path the way a build would. The host loop
+/// (scheduler tick, update, render) keeps running until the new plugin has
+/// rendered its first frame. plugin::manager records the time of every
+/// phase, from file write to first frame. The report prints percentiles
+/// per phase and writes the histograms as JSON.
+///
+/// Plugins get an in-memory host cache, as in the interactive host, so
+/// every reload after the first warm-starts; --no-cache measures cold
+/// starts instead.
+///
+/// Usage:
+///   quasi_reload_bench [plugin.so] [--reloads N] [--size WxH] [--settle MS]
+///                      [--rebuild "command"] [--json out.json] [--no-cache]
+
+#include <quasi/async/async.hpp>
+#include <quasi/async/thread_pool.hpp>
+#include <quasi/host/plugin_log.hpp>
+#include <quasi/log/logger.hpp>
+#include <quasi/platform/topology.hpp>
+#include <quasi/plugin/plugin.hpp>
+
+#include "tools/cpp/runfiles/runfiles.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+/// @brief Writes the library to the watched path the way a build would.
+bool install(const std::filesystem::path& from, const std::filesystem::path& to) {
+    std::error_code ec;
+    std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing, ec);
+    if (!ec) {
+        // Coarse filesystem timestamps could hide back-to-back installs.
+        std::filesystem::last_write_time(to, std::filesystem::file_time_type::clock::now(), ec);
+    }
+    return !ec;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    using bazel::tools::cpp::runfiles::Runfiles;
+    using clock = std::chrono::steady_clock;
+
+    std::filesystem::path plugin_path;
+    std::filesystem::path json_path;
+    std::string rebuild_command;
+    uint32_t width   = 64;
+    uint32_t height  = 64;
+    int      reloads = 20;
+    int      settle_ms = 300;
+    bool     use_cache = true;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--reloads" && i + 1 < argc) {
+            reloads = std::atoi(argv[++i]);
+        } else if (arg == "--size" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+                std::fprintf(stderr, "Bad size (expected WxH): %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--settle" && i + 1 < argc) {
+            settle_ms = std::atoi(argv[++i]);
+        } else if (arg == "--rebuild" && i + 1 < argc) {
+            rebuild_command = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (arg == "--no-cache") {
+            use_cache = false;
+        } else if (arg == "--log-level" && i + 1 < argc) {
+            if (auto level = Q::log::parse_severity(argv[++i])) {
+                Q::log::default_logger().set_level(*level);
+            }
+        } else if (arg[0] != '-') {
+            plugin_path = arg;
+        }
+    }
+
+    std::unique_ptr<Runfiles> runfiles;
+    if (plugin_path.empty()) {
+        std::string error;
+        runfiles.reset(Runfiles::Create(argv[0], &error));
+        if (runfiles) {
+            plugin_path = runfiles->Rlocation("quasi/backends/cpu/libquasi_cpu.so");
+        }
+        if (plugin_path.empty() || !std::filesystem::exists(plugin_path)) {
+            std::fprintf(stderr, "Default plugin not found in runfiles\n");
+            std::fprintf(stderr, "Usage: %s <plugin.so> [--reloads N] [--settle MS] [--rebuild CMD]\n",
+                         argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // The manager watches a private copy, so the source can be rebuilt freely.
+    auto watched = std::filesystem::temp_directory_path() /
+                   ("quasi_reload_bench_" + std::to_string(getpid()) + plugin_path.extension().string());
+    if (!install(plugin_path, watched)) {
+        std::fprintf(stderr, "Failed to copy %s\n", plugin_path.c_str());
+        return EXIT_FAILURE;
+    }
+
+    Q::async::thread_pool pool{Q::platform::host_topology(), Q::platform::pin_policy::physical_cores};
+    Q::plugin::job_system jobs{pool};
+    Q::plugin::cache_store cache;
+    Q_gpu_context gpu{};
+    gpu.backend = Q_GPU_BACKEND_NONE;
+
+    auto exit_code = EXIT_SUCCESS;
+    {
+        Q::plugin::manager mgr{watched};
+        mgr.set_viewport(width, height);
+        mgr.set_gpu_context(&gpu);
+        mgr.set_log_callback(Q::host::plugin_log);
+        mgr.set_job_system(&jobs);
+        mgr.set_cache(use_cache ? &cache : nullptr);
+        mgr.set_settle_time(std::chrono::milliseconds{settle_ms});
+        if (!mgr.load_sync()) {
+            std::fprintf(stderr, "Failed to load %s\n", plugin_path.c_str());
+            return EXIT_FAILURE;
+        }
+
+        Q::async::scheduler sched;
+        sched.spawn(mgr.watch_and_reload_loop());
+
+        std::vector<uint16_t> image(size_t{width} * height * 4);
+        Q_render_frame frame{};
+        frame.drawable     = image.data();
+        frame.width        = width;
+        frame.height       = height;
+        frame.camera.position[1] = 1.0f;
+        frame.camera.position[2] = 3.5f;
+        frame.camera.target[1]   = 1.0f;
+        frame.camera.up[1]       = 1.0f;
+        frame.camera.fov         = 40.0f;
+        frame.camera_dirty       = 1;
+
+        auto host_frame = [&] {
+            sched.tick();
+            mgr.update(1.0f / 60.0f);
+            mgr.render(&frame);
+        };
+        host_frame();
+
+        for (int i = 0; i < reloads; ++i) {
+            if (!rebuild_command.empty() && std::system(rebuild_command.c_str()) != 0) {
+                std::fprintf(stderr, "Rebuild failed: %s\n", rebuild_command.c_str());
+                exit_code = EXIT_FAILURE;
+                break;
+            }
+            const auto& stats = mgr.stats();
+            uint64_t done = stats.edit_to_pixel.count() + stats.failure_count;
+            if (!install(plugin_path, watched)) {
+                std::fprintf(stderr, "Failed to install %s\n", plugin_path.c_str());
+                exit_code = EXIT_FAILURE;
+                break;
+            }
+            auto deadline = clock::now() + std::chrono::seconds{30};
+            while (stats.edit_to_pixel.count() + stats.failure_count == done && clock::now() < deadline) {
+                host_frame();
+            }
+            if (clock::now() >= deadline) {
+                std::fprintf(stderr, "Reload %d did not finish\n", i);
+                exit_code = EXIT_FAILURE;
+                break;
+            }
+        }
+        jobs.quiesce();
+
+        const auto& stats = mgr.stats();
+        for (size_t p = 0; p < Q::plugin::k_reload_phase_count; ++p) {
+            auto phase = static_cast<Q::plugin::reload_phase>(p);
+            std::fprintf(stderr, "%-13s %s\n", to_string(phase).data(), stats.phase(phase).summary().c_str());
+        }
+        std::fprintf(stderr, "%-13s %s\n", "edit_to_pixel", stats.edit_to_pixel.summary().c_str());
+        if (use_cache) {
+            auto c = cache.stats();
+            std::fprintf(stderr, "cache         %llu hits, %llu misses, %zu entries, %zu bytes\n",
+                         static_cast<unsigned long long>(c.memory_hits),
+                         static_cast<unsigned long long>(c.misses), c.entries, c.memory_bytes);
+        }
+        if (stats.failure_count > 0) {
+            exit_code = EXIT_FAILURE;
+        }
+
+        if (json_path.empty()) {
+            stats.write_json(std::cout);
+            std::cout << '\n';
+        } else {
+            std::ofstream out{json_path};
+            stats.write_json(out);
+            out << '\n';
+            if (!out) {
+                std::fprintf(stderr, "Failed to write %s\n", json_path.c_str());
+                exit_code = EXIT_FAILURE;
+            }
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(watched, ec);
+    return exit_code;
+}
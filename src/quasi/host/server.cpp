@@ -0,0 +1,635 @@
+/// @file server.cpp
+/// @brief Headless render server: keeps plugins warm and takes jobs over a Unix socket.
+///
+/// Batch renders through quasi_bench or the interactive host pay process
+/// start, plugin load and scene setup on every invocation. The server pays
+/// them once per backend build and resolution. It keeps the most recently
+/// used plugin instances resident, each with its scene and BVH built, and a
+/// host cache, so an evicted instance rebuilds from cached setup. Every
+/// instance loads a private copy of its library and is keyed by a hash of
+/// the build, so a backend rebuilt in place gets new instances. Jobs
+/// (see plugin/render_server.hpp) arrive one per line. Each client is
+/// served on a thread of its own, so a client that connects and stalls
+/// holds up nobody, and one that sends nothing for --read-timeout seconds
+/// is dropped; jobs from every client still run one at a time. Each job
+/// gets a stream of reply lines:
+/// @code
+/// accepted <id> warm|cold <setup_ms>
+/// progress <id> <samples>/<spp>
+/// done <id> <samples> <render_ms> [output]
+/// error <id> <reason>
+/// @endcode
+/// "stats" reports instance and cache counters; "shutdown" stops the server.
+///
+/// Finished beauty images are memoized (see plugin/result_cache.hpp) under
+/// the plugin build, resolution, camera, seed and job parameters. A job
+/// already rendered with at least as many samples is answered from the
+/// cache without loading its plugin ("accepted <id> cached"); one rendered
+/// with fewer samples renders only the rest ("resumed <id> <samples>").
+/// Jobs with aovs=1 or cache=0 always render.
+///
+/// Usage:
+///   quasi_server [default.so] [--socket PATH] [--instances N] [--cache-dir DIR] [--no-disk-cache]
+///                [--disk-cache-mb N] [--no-result-cache] [--read-timeout SECONDS]
+///
+///   echo "render id=a size=256x256 spp=64 out=/tmp/a.exr" | nc -U /tmp/quasi.sock
+
+#include <quasi/async/thread_pool.hpp>
+#include <quasi/host/plugin_log.hpp>
+#include <quasi/io/exr_writer.hpp>
+#include <quasi/log/logger.hpp>
+#include <quasi/platform/topology.hpp>
+#include <quasi/plugin/param_socket.hpp>
+#include <quasi/plugin/plugin.hpp>
+#include <quasi/plugin/render_server.hpp>
+#include <quasi/plugin/result_cache.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+/// @brief Clients served at once; more are turned away.
+constexpr size_t k_max_clients = 64;
+
+/// @brief Bytes a client may send without a newline before it is dropped.
+constexpr size_t k_max_line = size_t{64} << 10;
+
+/// @brief Plugins may not stop the server.
+void plugin_request_shutdown(void* /*host_data*/) {}
+
+double elapsed_ms(clock_type::time_point since) {
+    return std::chrono::duration<double, std::milli>(clock_type::now() - since).count();
+}
+
+/// @brief A loaded plugin with its scene prepared at one resolution.
+struct resident {
+    Q::plugin::job_system*           jobs = nullptr;
+    Q::plugin::dynamic_library       library;
+    Q::plugin::plugin_context        context{};
+    std::optional<Q::plugin::loader> plugin;
+
+    resident() = default;
+    resident(const resident&) = delete;
+    resident& operator=(const resident&) = delete;
+
+    ~resident() {
+        // Jobs may still reference plugin state, and run plugin code.
+        jobs->quiesce();
+        if (plugin) {
+            plugin->destroy();
+        }
+        jobs->quiesce();
+    }
+};
+
+/// @brief A plugin library as last hashed.
+struct build_entry {
+    uintmax_t                       size = 0;
+    std::filesystem::file_time_type written{};
+    uint64_t                        hash = 0;
+};
+
+/// @brief Everything shared by every job. Client threads hold job_mutex to touch anything but stopping.
+struct server_state {
+    Q::plugin::job_system&                       jobs;
+    Q::plugin::cache_store&                      cache;
+    Q_gpu_context&                               gpu;
+    std::filesystem::path                        default_plugin;
+    Q::plugin::instance_lru<resident>            warm;
+    std::optional<Q::plugin::result_cache>       results;  // Unset with --no-result-cache.
+    std::unordered_map<std::string, build_entry> builds;   // By library path.
+    uint64_t                                     results_served  = 0;
+    uint64_t                                     results_resumed = 0;
+    uint64_t                                     jobs_done       = 0;
+    std::atomic<bool>                            stopping        = false;
+    std::mutex                                   job_mutex;  // Plugin instances run one job at a time.
+};
+
+/// @brief A connected client and the thread serving it.
+struct client_thread {
+    int               fd = -1;
+    std::thread       thread;
+    std::atomic<bool> done = false;
+};
+
+/// @brief Sends one reply line; a client that went away is noticed on its next read.
+///
+/// Client sockets have a send timeout, so one that stops reading cannot
+/// stall the job (and every client queued behind it).
+void reply(int fd, const std::string& line) {
+    std::string text = line + '\n';
+    (void)::send(fd, text.data(), text.size(), 0);
+}
+
+/// @brief Loads a private copy of the library at @p path, which must still be build @p build.
+///
+/// Like plugin::manager, each instance loads its own copy (an in-memory
+/// image on Linux), so a rebuilt library is a new load rather than the one
+/// dlopen() already has under that path, and instances of one build at two
+/// resolutions share no globals.
+std::unique_ptr<resident> load_resident(server_state& server, const std::filesystem::path& path, uint64_t build,
+                                        uint32_t width, uint32_t height, std::string& error) {
+    auto r = std::make_unique<resident>();
+    r->jobs = &server.jobs;
+#if defined(Q_PLATFORM_LINUX)
+    auto image = Q::plugin::library_image::copy(path);
+    if (!image) {
+        error = Q::plugin::to_string(image.error());
+        return nullptr;
+    }
+    if (Q::plugin::result_cache::build_hash(image->proc_path()) != build) {
+        error = "plugin changed while loading";
+        return nullptr;
+    }
+    auto lib = Q::plugin::dynamic_library::open(std::move(*image));
+#else
+    auto lib = Q::plugin::dynamic_library::open(path);
+#endif
+    if (!lib) {
+        error = Q::plugin::to_string(lib.error());
+        if (lib.error() == Q::plugin::library_error::load_failed) {
+            error += std::string{": "} + Q::plugin::dynamic_library::last_error();
+        }
+        return nullptr;
+    }
+    r->library = std::move(*lib);
+    r->context = Q::plugin::plugin_context{
+        .viewport_width   = width,
+        .viewport_height  = height,
+        .host_data        = nullptr,
+        .gpu              = &server.gpu,
+        .log              = Q::host::plugin_log,
+        .request_shutdown = plugin_request_shutdown,
+        .jobs             = server.jobs.table(),
+        .profiler         = nullptr,
+        .cache            = server.cache.table(),
+    };
+    auto plugin = Q::plugin::loader::load(r->library, &r->context);
+    if (!plugin) {
+        error = to_string(plugin.error());
+        return nullptr;
+    }
+    r->plugin.emplace(std::move(*plugin));
+    if (!r->plugin->supports_readback()) {
+        error = "plugin has no readback";
+        return nullptr;
+    }
+    return r;
+}
+
+/// @brief Returns the build hash of a plugin library, hashing the file only when it changed.
+uint64_t build_hash(server_state& server, const std::filesystem::path& path) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    auto written = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return 0;
+    }
+    auto& known = server.builds[path.string()];
+    if (known.hash == 0 || known.size != size || known.written != written) {
+        known = {size, written, Q::plugin::result_cache::build_hash(path)};
+    }
+    return known.hash;
+}
+
+/// @brief Writes @p render as the job's EXR, if it asked for one.
+bool write_output(int fd, const std::string& id, const Q::plugin::render_job& job,
+                  const Q::plugin::cached_render& render) {
+    if (job.output.empty()) {
+        return true;
+    }
+    Q_readback_result result{};
+    result.data     = const_cast<float*>(render.rgba.data());
+    result.width    = render.width;
+    result.height   = render.height;
+    result.channels = 4;
+    if (auto written = Q::io::write_exr(job.output, result); !written) {
+        reply(fd, "error " + id + " " + Q::io::to_string(written.error()));
+        return false;
+    }
+    return true;
+}
+
+void reply_done(int fd, const std::string& id, const Q::plugin::render_job& job, uint32_t samples, double ms) {
+    char line[128];
+    std::snprintf(line, sizeof(line), "done %s %u %.3f", id.c_str(), samples, ms);
+    reply(fd, job.output.empty() ? std::string{line} : line + (' ' + job.output.string()));
+}
+
+/// @brief Runs one job, streaming replies to @p fd.
+void run_job(server_state& server, int fd, const Q::plugin::render_job& job) {
+    std::string id = job.id.empty() ? "-" : job.id;
+    auto path = job.plugin.empty() ? server.default_plugin : job.plugin;
+    if (path.empty()) {
+        reply(fd, "error " + id + " " + std::string{to_string(Q::plugin::job_error::missing_plugin)});
+        return;
+    }
+    std::error_code ec;
+    auto canonical = std::filesystem::weakly_canonical(path, ec);
+    if (!ec) {
+        path = canonical;
+    }
+    auto setup_start = clock_type::now();
+    char line[128];
+
+    // Only beauty is memoized; a job that wants AOVs always renders.
+    std::string result_key;
+    std::optional<Q::plugin::cached_render> cached;
+    if (server.results && job.cache && !job.aovs) {
+        Q::plugin::render_inputs inputs{
+            .build  = build_hash(server, path),
+            .width  = job.width,
+            .height = job.height,
+            .camera = job.camera,
+            .seed   = job.seed,
+            .params = {},
+        };
+        for (const auto& p : job.params) {
+            if (p.name != "samples_per_frame") {  // The server's to set; changes no pixel.
+                inputs.params.push_back(p);
+            }
+        }
+        if (inputs.build != 0) {
+            result_key = Q::plugin::result_cache::key(inputs);
+            cached = server.results->find(result_key);
+        }
+    }
+    if (cached && cached->samples >= job.spp) {
+        std::snprintf(line, sizeof(line), "accepted %s cached %.3f", id.c_str(), elapsed_ms(setup_start));
+        reply(fd, line);
+        if (write_output(fd, id, job, *cached)) {
+            reply_done(fd, id, job, cached->samples, 0.0);
+            ++server.jobs_done;
+            ++server.results_served;
+        }
+        return;
+    }
+
+    // A rebuilt library gets new instances; the old build's age out of the LRU.
+    uint64_t build = build_hash(server, path);
+    char build_text[24];
+    std::snprintf(build_text, sizeof(build_text), "#%016llx", static_cast<unsigned long long>(build));
+    std::string key = path.string() + '@' + std::to_string(job.width) + 'x' + std::to_string(job.height) + build_text;
+    uint64_t misses = server.warm.misses();
+    std::string error;
+    resident* r = server.warm.acquire(
+        key, [&] { return load_resident(server, path, build, job.width, job.height, error); });
+    if (!r) {
+        reply(fd, "error " + id + " " + error);
+        return;
+    }
+    auto& plugin = *r->plugin;
+
+    // Every parameter the job does not set takes its default, whatever the last job used.
+    Q::plugin::param_registry params;
+    params.apply(plugin, true);
+    for (const auto& d : params.declared()) {
+        (void)params.set(d.name, d.default_value);
+    }
+    for (const auto& p : job.params) {
+        if (auto set = params.set(p.name, p.value); !set) {
+            reply(fd, "error " + id + " " + p.name + ": " + std::string{Q::plugin::to_string(set.error())});
+            return;
+        }
+    }
+    params.apply(plugin, true);
+
+    std::snprintf(line, sizeof(line), "accepted %s %s %.3f", id.c_str(),
+                  server.warm.misses() == misses ? "warm" : "cold", elapsed_ms(setup_start));
+    reply(fd, line);
+
+    // A cached render with fewer samples is extended rather than redone.
+    uint32_t have = cached ? cached->samples : 0;
+    if (have > 0) {
+        std::snprintf(line, sizeof(line), "resumed %s %u", id.c_str(), have);
+        reply(fd, line);
+        ++server.results_resumed;
+    }
+
+    // With samples_per_frame, one call traces a whole progress step.
+    std::optional<uint32_t> spp_index;
+    auto declared = plugin.params();
+    for (uint32_t i = 0; i < declared.size(); ++i) {
+        if (std::string_view{declared[i].name} == "samples_per_frame") {
+            spp_index = i;
+        }
+    }
+
+    Q_render_frame frame{};
+    frame.width       = job.width;
+    frame.height      = job.height;
+    frame.camera      = job.camera;
+    frame.sample_salt = Q::plugin::result_cache::resume_salt(job.seed, have);
+
+    auto render_start = clock_type::now();
+    uint32_t done = have;
+    uint32_t next_report = job.progress > 0 ? (have / job.progress + 1) * job.progress : 0;
+    while (done < job.spp) {
+        uint32_t step = job.progress > 0 ? next_report - done : job.spp - done;
+        step = std::min(step, job.spp - done);
+        if (spp_index) {
+            step = static_cast<uint32_t>(Q::plugin::coerce(declared[*spp_index], step));
+            plugin.set_param(*spp_index, step);
+        } else {
+            step = 1;
+        }
+        frame.camera_dirty = done == have ? 1 : 0;
+        plugin.update(0.0f);
+        plugin.render(&frame);
+        done += step;
+        if (job.progress > 0 && done >= next_report && done < job.spp) {
+            std::snprintf(line, sizeof(line), "progress %s %u/%u", id.c_str(), done, job.spp);
+            reply(fd, line);
+            next_report += job.progress;
+        }
+    }
+    server.jobs.quiesce();
+    double render_ms = elapsed_ms(render_start);
+
+    if (job.aovs && plugin.supports_readback_aov()) {
+        if (!job.output.empty()) {
+            auto aov = plugin.readback_aov();
+            auto written = Q::io::write_exr(job.output, aov);
+            plugin.readback_aov_free(&aov);
+            if (!written) {
+                reply(fd, "error " + id + " " + Q::io::to_string(written.error()));
+                return;
+            }
+        }
+        reply_done(fd, id, job, done, render_ms);
+        ++server.jobs_done;
+        return;
+    }
+
+    auto result = plugin.readback();
+    if (!result.data || result.width != job.width || result.height != job.height || result.channels != 4) {
+        plugin.readback_free(&result);
+        reply(fd, "error " + id + " readback failed");
+        return;
+    }
+    std::span<const float> added{result.data, size_t{result.width} * result.height * 4};
+    Q::plugin::cached_render image;
+    if (cached) {
+        image = std::move(*cached);
+        Q::plugin::result_cache::merge(image, added, done - have);
+    } else {
+        image = {result.width, result.height, done, {added.begin(), added.end()}};
+    }
+    plugin.readback_free(&result);
+    if (!result_key.empty()) {
+        server.results->store(result_key, image);
+    }
+
+    if (write_output(fd, id, job, image)) {
+        reply_done(fd, id, job, done, render_ms);
+        ++server.jobs_done;
+    }
+}
+
+void run_command(server_state& server, int fd, std::string_view command) {
+    command = Q::plugin::detail::trim(command);
+    if (command.empty()) {
+        return;
+    }
+    if (command == "shutdown") {
+        server.stopping = true;
+        reply(fd, "ok");
+        return;
+    }
+
+    // Waits for another client's job to finish.
+    std::lock_guard lock{server.job_mutex};
+    if (server.stopping) {
+        reply(fd, "error - shutting down");
+        return;
+    }
+    if (command == "stats") {
+        auto cache = server.cache.stats();
+        char line[256];
+        std::snprintf(line, sizeof(line),
+                      "stats jobs=%llu instances=%zu/%zu warm=%llu cold=%llu evicted=%llu cache_hits=%llu "
+                      "cache_misses=%llu results_served=%llu results_resumed=%llu",
+                      static_cast<unsigned long long>(server.jobs_done), server.warm.size(),
+                      server.warm.capacity(), static_cast<unsigned long long>(server.warm.hits()),
+                      static_cast<unsigned long long>(server.warm.misses()),
+                      static_cast<unsigned long long>(server.warm.evictions()),
+                      static_cast<unsigned long long>(cache.memory_hits + cache.disk_hits),
+                      static_cast<unsigned long long>(cache.misses),
+                      static_cast<unsigned long long>(server.results_served),
+                      static_cast<unsigned long long>(server.results_resumed));
+        reply(fd, line);
+        return;
+    }
+    auto job = Q::plugin::parse_render_job(command);
+    if (!job) {
+        reply(fd, "error - " + std::string{to_string(job.error())});
+        return;
+    }
+    run_job(server, fd, *job);
+}
+
+/// @brief Serves one client until it hangs up, times out or the server stops.
+void serve_client(server_state& server, int fd) {
+    std::string input;
+    char buffer[4096];
+    while (!server.stopping) {
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;  // Hung up, or idle past the read timeout (EAGAIN).
+        }
+        if (input.size() + static_cast<size_t>(n) > k_max_line &&
+            input.find('\n') == std::string::npos) {
+            reply(fd, "error - line too long");
+            return;
+        }
+        input.append(buffer, static_cast<size_t>(n));
+        size_t start = 0;
+        for (size_t end; !server.stopping && (end = input.find('\n', start)) != std::string::npos; start = end + 1) {
+            run_command(server, fd, std::string_view{input}.substr(start, end - start));
+        }
+        input.erase(0, start);
+    }
+    if (!input.empty() && !server.stopping) {
+        run_command(server, fd, input);  // Last line without a newline.
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::filesystem::path socket_path = "/tmp/quasi.sock";
+    std::filesystem::path default_plugin;
+    std::filesystem::path cache_dir = Q::plugin::cache_store::default_directory();
+    uint64_t disk_budget = Q::plugin::cache_options{}.disk_budget;  // Per store; 0 = unlimited.
+    size_t instances = 4;
+    bool result_cache = true;
+    int read_timeout = 30;  // Seconds a client may stay silent.
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (arg == "--instances" && i + 1 < argc) {
+            instances = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--cache-dir" && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else if (arg == "--no-disk-cache") {
+            cache_dir.clear();
+        } else if (arg == "--disk-cache-mb" && i + 1 < argc) {
+            disk_budget = std::strtoull(argv[++i], nullptr, 10) << 20;
+        } else if (arg == "--no-result-cache") {
+            result_cache = false;
+        } else if (arg == "--read-timeout" && i + 1 < argc) {
+            read_timeout = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--log-level" && i + 1 < argc) {
+            if (auto level = Q::log::parse_severity(argv[++i])) {
+                Q::log::default_logger().set_level(*level);
+            }
+        } else if (arg[0] != '-') {
+            default_plugin = arg;
+        } else {
+            std::fprintf(stderr,
+                         "Usage: %s [default.so] [--socket PATH] [--instances N] [--cache-dir DIR] "
+                         "[--no-disk-cache] [--disk-cache-mb N] [--no-result-cache] [--read-timeout SECONDS]\n",
+                         argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socket_path.native().size() >= sizeof(addr.sun_path)) {
+        std::fprintf(stderr, "Socket path too long: %s\n", socket_path.c_str());
+        return EXIT_FAILURE;
+    }
+    std::memcpy(addr.sun_path, socket_path.c_str(), socket_path.native().size());
+    // Never take over a running server's socket, or delete a file that is not a socket.
+    if (auto cleared = Q::plugin::remove_stale_socket(addr); !cleared) {
+        std::fprintf(stderr, "Cannot listen on %s: %s\n", socket_path.c_str(),
+                     Q::plugin::to_string(cleared.error()).data());
+        return EXIT_FAILURE;
+    }
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || ::bind(listener, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listener, 8) != 0) {
+        std::fprintf(stderr, "Failed to listen on %s: %s\n", socket_path.c_str(), std::strerror(errno));
+        return EXIT_FAILURE;
+    }
+    std::signal(SIGPIPE, SIG_IGN);  // Clients may hang up mid-job.
+
+    Q::async::thread_pool pool{Q::platform::host_topology(), Q::platform::pin_policy::physical_cores};
+    Q::plugin::job_system jobs{pool};
+    Q::plugin::cache_store cache{Q::plugin::cache_options{.directory = cache_dir, .disk_budget = disk_budget}};
+    // Images get their own store so they never push plugin setup data out of memory.
+    Q::plugin::cache_store images{Q::plugin::cache_options{
+        .memory_budget = size_t{1} << 30,
+        .directory     = cache_dir.empty() ? cache_dir : cache_dir / "results",
+        .disk_budget   = disk_budget,
+    }};
+    Q_gpu_context gpu{};
+    gpu.backend = Q_GPU_BACKEND_NONE;
+
+    server_state server{
+        .jobs            = jobs,
+        .cache           = cache,
+        .gpu             = gpu,
+        .default_plugin  = default_plugin,
+        .warm            = Q::plugin::instance_lru<resident>{instances},
+        .results         = std::nullopt,
+        .builds          = {},
+        .results_served  = 0,
+        .results_resumed = 0,
+        .jobs_done       = 0,
+        .stopping        = false,
+        .job_mutex       = {},
+    };
+    if (result_cache) {
+        server.results.emplace(images);
+    }
+    std::fprintf(stderr, "[Server] Listening on %s, %zu warm instances, %u workers\n", socket_path.c_str(),
+                 instances, pool.size());
+
+    std::list<client_thread> clients;
+    auto reap = [&](bool all) {
+        for (auto it = clients.begin(); it != clients.end();) {
+            if (all || it->done) {
+                it->thread.join();
+                ::close(it->fd);
+                it = clients.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    };
+    while (!server.stopping) {
+        reap(false);
+        // Wake up now and then to notice a shutdown sent by a client.
+        pollfd listening{listener, POLLIN, 0};
+        int ready = ::poll(&listening, 1, 250);
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+        if (ready <= 0) {
+            continue;
+        }
+        int client = ::accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == ECONNABORTED) {
+                continue;
+            }
+            break;
+        }
+        if (clients.size() >= k_max_clients) {
+            reply(client, "error - too many clients");
+            ::close(client);
+            continue;
+        }
+        timeval timeout{};
+        timeout.tv_sec = read_timeout;
+        ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        auto& c = clients.emplace_back();
+        c.fd = client;
+        c.thread = std::thread{[&server, &c] {
+            serve_client(server, c.fd);
+            c.done = true;
+        }};
+    }
+
+    // Wake clients blocked in read(); a running job finishes first.
+    for (auto& c : clients) {
+        ::shutdown(c.fd, SHUT_RDWR);
+    }
+    reap(true);
+    server.warm.clear();  // Plugins go before the job system and cache they use.
+    ::close(listener);
+    ::unlink(socket_path.c_str());
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,203 @@
+/// @file split.cpp
+/// @brief Renders frames split across several backends at once.
+///
+/// Loads every backend given on the command line and hands them to a
+/// plugin::frame_splitter, which cuts each frame into row bands sized by
+/// each backend's measured throughput and composites the results into one
+/// image. The report gives frame-time percentiles and, per backend, the
+/// smoothed throughput and the share of the last frame's rows. Frames are
+/// only composited into a displayable image every --present-every frames,
+/// since that reads back every backend.
+///
+/// Usage:
+///   quasi_split a.so b.so [...] [--frames N] [--size WxH] [--present-every N] [--json out.json]
+///               [--sequential]
+
+#include <quasi/async/thread_pool.hpp>
+#include <quasi/host/plugin_log.hpp>
+#include <quasi/log/logger.hpp>
+#include <quasi/platform/topology.hpp>
+#include <quasi/plugin/plugin.hpp>
+#include <quasi/profile/histogram.hpp>
+#include <quasi/profile/profiler.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+/// @brief Plugins may not end a split run early.
+void plugin_request_shutdown(void* /*host_data*/) {}
+
+/// @brief One loaded backend.
+struct backend {
+    std::filesystem::path            path;
+    Q::plugin::dynamic_library       library;
+    Q::plugin::plugin_context        context{};
+    std::optional<Q::plugin::loader> plugin;
+};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    using clock = std::chrono::steady_clock;
+
+    std::vector<std::filesystem::path> paths;
+    std::filesystem::path json_path;
+    uint32_t width  = 256;
+    uint32_t height = 256;
+    int      frames = 64;
+    int      present_every = 0;
+    bool     concurrent = true;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        } else if (arg == "--size" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+                std::fprintf(stderr, "Bad size (expected WxH): %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (arg == "--present-every" && i + 1 < argc) {
+            present_every = std::atoi(argv[++i]);
+        } else if (arg == "--json" && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (arg == "--sequential") {
+            concurrent = false;
+        } else if (arg == "--log-level" && i + 1 < argc) {
+            if (auto level = Q::log::parse_severity(argv[++i])) {
+                Q::log::default_logger().set_level(*level);
+            }
+        } else if (arg[0] != '-') {
+            paths.emplace_back(arg);
+        }
+    }
+    if (paths.empty()) {
+        std::fprintf(stderr,
+                     "Usage: %s <a.so> [b.so ...] [--frames N] [--size WxH] [--present-every N] [--json FILE] "
+                     "[--sequential]\n",
+                     argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    Q::async::thread_pool pool{Q::platform::host_topology(), Q::platform::pin_policy::physical_cores};
+    Q::plugin::job_system jobs{pool};
+    Q_gpu_context gpu{};
+    gpu.backend = Q_GPU_BACKEND_NONE;
+
+    // Each backend gets its own namespace, so two copies of one build keep separate globals.
+    std::vector<backend> backends(paths.size());
+    std::vector<Q::plugin::loader*> plugins;
+    for (size_t b = 0; b < paths.size(); ++b) {
+        auto& x = backends[b];
+        x.path = paths[b];
+        auto lib = Q::plugin::dynamic_library::open(x.path, Q::plugin::link_namespace::isolated);
+        if (!lib) {
+            std::fprintf(stderr, "Failed to load %s: %s (%s)\n", x.path.c_str(),
+                         Q::plugin::to_string(lib.error()).data(), Q::plugin::dynamic_library::last_error());
+            return EXIT_FAILURE;
+        }
+        x.library = std::move(*lib);
+        x.context = Q::plugin::plugin_context{
+            .viewport_width   = width,
+            .viewport_height  = height,
+            .host_data        = nullptr,
+            .gpu              = &gpu,
+            .log              = Q::host::plugin_log,
+            .request_shutdown = plugin_request_shutdown,
+            .jobs             = jobs.table(),
+            .profiler         = nullptr,
+            .cache            = nullptr,
+        };
+        auto plugin = Q::plugin::loader::load(x.library, &x.context);
+        if (!plugin) {
+            std::fprintf(stderr, "Failed to load plugin %s: %s\n", x.path.c_str(), to_string(plugin.error()));
+            return EXIT_FAILURE;
+        }
+        x.plugin.emplace(std::move(*plugin));
+        if (!Q::plugin::frame_splitter::supports(*x.plugin)) {
+            std::fprintf(stderr, "%s cannot render row bands\n", x.path.c_str());
+            return EXIT_FAILURE;
+        }
+        plugins.push_back(&*x.plugin);
+    }
+
+    Q::profile::histogram frame_ns;
+    std::vector<uint16_t> image(size_t{width} * height * 4);
+    Q_render_frame frame{};
+    frame.width    = width;
+    frame.height   = height;
+    frame.camera.position[1] = 1.0f;
+    frame.camera.position[2] = 3.5f;
+    frame.camera.target[1]   = 1.0f;
+    frame.camera.up[1]       = 1.0f;
+    frame.camera.fov         = 40.0f;
+
+    {
+        Q::plugin::frame_splitter split{plugins, Q::plugin::splitter_options{.concurrent = concurrent}};
+        for (int i = 0; i < frames; ++i) {
+            frame.camera_dirty = i == 0 ? 1 : 0;
+            auto start = clock::now();
+            for (auto* p : plugins) {
+                p->update(1.0f / 60.0f);
+            }
+            split.render(&frame);
+            if (present_every > 0 && i % present_every == 0) {
+                split.present(image);
+            }
+            frame_ns.add(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count()));
+        }
+        jobs.quiesce();
+
+        std::fprintf(stderr, "frame     %s\n", frame_ns.summary().c_str());
+        for (size_t b = 0; b < plugins.size(); ++b) {
+            std::fprintf(stderr, "backend %zu %5u rows, %.0f rows/s  %s\n", b, split.bands()[b].rows(),
+                         split.throughput()[b], backends[b].path.c_str());
+        }
+
+        auto write_report = [&](std::ostream& out) {
+            out << "{\"width\": " << width << ", \"height\": " << height << ", \"frames\": " << frames
+                << ", \"workers\": " << pool.size() << ", \"concurrent\": " << (concurrent ? "true" : "false")
+                << ", \"present_every\": " << present_every
+                << ",\n \"frame_ns\": ";
+            frame_ns.write_json(out);
+            out << ",\n \"backends\": [";
+            for (size_t b = 0; b < plugins.size(); ++b) {
+                auto info = plugins[b]->info();
+                out << (b ? ",\n  " : "\n  ") << "{\"path\": ";
+                Q::profile::detail::write_json_string(out, backends[b].path.string());
+                out << ", \"plugin\": ";
+                Q::profile::detail::write_json_string(out, info.name ? info.name : "");
+                out << ", \"rows\": " << split.bands()[b].rows() << ", \"rows_per_second\": "
+                    << split.throughput()[b] << '}';
+            }
+            out << "]}\n";
+        };
+        if (json_path.empty()) {
+            write_report(std::cout);
+        } else {
+            std::ofstream out{json_path};
+            write_report(out);
+            if (!out) {
+                std::fprintf(stderr, "Failed to write %s\n", json_path.c_str());
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    // Destroy every plugin before its library closes.
+    for (auto& x : backends) {
+        jobs.quiesce();
+        x.plugin->destroy();
+    }
+    return EXIT_SUCCESS;
+}
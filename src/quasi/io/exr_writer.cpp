@@ -2,6 +2,7 @@
 /// @brief OpenEXR writer implementation.
 
 #include <quasi/io/exr_writer.hpp>
+#include <quasi/math/octahedral.hpp>
 
 #include <ImfChannelList.h>
 #include <ImfFrameBuffer.h>
@@ -86,6 +87,7 @@ std::expected<void, exr_error> write_exr(
     bool has_albedo = result.buffers[Q_AOV_ALBEDO].data != nullptr;
     bool has_normal = result.buffers[Q_AOV_NORMAL].data != nullptr;
     bool has_depth  = result.buffers[Q_AOV_DEPTH].data != nullptr;
+    bool has_traversal = result.buffers[Q_AOV_TRAVERSAL].data != nullptr;
 
     // Convert float32 RGBA buffers to interleaved half arrays.
     auto to_half = [](const float* src, size_t count) {
@@ -96,10 +98,29 @@ std::expected<void, exr_error> write_exr(
         return out;
     };
 
+    // Decode packed unit vectors to interleaved half XYZ1. Export is the
+    // only place packed normals are expanded back to floats.
+    auto oct_to_half = [](const uint32_t* src, size_t count) {
+        std::vector<half> out(count * 4);
+        for (size_t i = 0; i < count; ++i) {
+            math::vec3 n = math::oct_normal{src[i]}.decode();
+            out[i * 4 + 0] = half(n.x);
+            out[i * 4 + 1] = half(n.y);
+            out[i * 4 + 2] = half(n.z);
+            out[i * 4 + 3] = half(1.0f);
+        }
+        return out;
+    };
+
     auto beauty_half = to_half(beauty.data, pixel_count);
     std::vector<half> albedo_half, normal_half;
     if (has_albedo) albedo_half = to_half(result.buffers[Q_AOV_ALBEDO].data, pixel_count);
-    if (has_normal) normal_half = to_half(result.buffers[Q_AOV_NORMAL].data, pixel_count);
+    if (has_normal) {
+        const auto& normal = result.buffers[Q_AOV_NORMAL];
+        normal_half = normal.format == Q_AOV_FORMAT_OCT16X2
+            ? oct_to_half(normal.packed, pixel_count)
+            : to_half(normal.data, pixel_count);
+    }
 
     try {
         Imf::Header header(w, h);
@@ -123,6 +144,11 @@ std::expected<void, exr_error> write_exr(
         if (has_depth) {
             header.channels().insert("depth.Z", Imf::Channel(Imf::FLOAT));
         }
+        if (has_traversal) {
+            header.channels().insert("traversal.nodes", Imf::Channel(Imf::FLOAT));
+            header.channels().insert("traversal.prims", Imf::Channel(Imf::FLOAT));
+            header.channels().insert("traversal.segments", Imf::Channel(Imf::FLOAT));
+        }
 
         Imf::OutputFile file(path.c_str(), header);
         Imf::FrameBuffer fb;
@@ -162,6 +188,16 @@ std::expected<void, exr_error> write_exr(
             fb.insert("depth.Z", Imf::Slice(Imf::FLOAT, d, float_pixel_stride, float_row_stride));
         }
 
+        // Traversal heat map slices (full float; counts exceed half precision).
+        if (has_traversal) {
+            char* t = reinterpret_cast<char*>(const_cast<float*>(result.buffers[Q_AOV_TRAVERSAL].data));
+            size_t float_pixel_stride = 4 * sizeof(float);
+            size_t float_row_stride   = w * float_pixel_stride;
+            fb.insert("traversal.nodes", Imf::Slice(Imf::FLOAT, t + 0 * sizeof(float), float_pixel_stride, float_row_stride));
+            fb.insert("traversal.prims", Imf::Slice(Imf::FLOAT, t + 1 * sizeof(float), float_pixel_stride, float_row_stride));
+            fb.insert("traversal.segments", Imf::Slice(Imf::FLOAT, t + 2 * sizeof(float), float_pixel_stride, float_row_stride));
+        }
+
         file.setFrameBuffer(fb);
         file.writePixels(h);
     } catch (...) {
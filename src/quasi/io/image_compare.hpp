@@ -0,0 +1,80 @@
+/// @file image_compare.hpp
+/// @brief Numeric differences between two float images.
+///
+/// Used to A/B test backend builds: two renders of the same frames should
+/// match exactly when only performance changed, and the error figures
+/// show how far apart they are when the output changed.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+namespace Q::io {
+
+/// @brief Differences between two images of the same size.
+struct image_difference {
+    double   max_abs  = 0.0;  ///< Largest per-channel absolute difference.
+    double   mean_abs = 0.0;  ///< Mean per-channel absolute difference.
+    double   rmse     = 0.0;  ///< Root mean square difference.
+    double   psnr     = std::numeric_limits<double>::infinity();  ///< dB, against a peak of 1.
+    uint64_t differing_pixels = 0;  ///< Pixels with any channel above the tolerance.
+    uint64_t nonfinite = 0;  ///< Channels where exactly one image is NaN or infinite.
+};
+
+/// @brief Compares interleaved pixels channel by channel.
+///
+/// Values are compared as stored, so pass linear HDR to compare radiance
+/// or tonemapped values for what a viewer would see. PSNR uses a peak of
+/// 1, which is meaningful for tonemapped images. A channel where one image
+/// is finite and the other is not counts as different but stays out of
+/// the error sums; it is reported in nonfinite.
+/// @param a First image.
+/// @param b Second image, same size as @p a.
+/// @param channels Channels per pixel.
+/// @param tolerance Largest difference that still counts as equal.
+[[nodiscard]] inline image_difference compare_images(std::span<const float> a, std::span<const float> b,
+                                                     uint32_t channels = 4, float tolerance = 0.0f) {
+    image_difference d;
+    size_t n = std::min(a.size(), b.size());
+    if (n == 0 || channels == 0) {
+        return d;
+    }
+
+    double sum_abs = 0.0;
+    double sum_sq  = 0.0;
+    for (size_t pixel = 0; pixel + channels <= n; pixel += channels) {
+        bool differs = false;
+        for (uint32_t c = 0; c < channels; ++c) {
+            float x = a[pixel + c];
+            float y = b[pixel + c];
+            if (std::isfinite(x) != std::isfinite(y)) {
+                ++d.nonfinite;
+                differs = true;
+                continue;
+            }
+            if (!std::isfinite(x)) {
+                continue;  // Both non-finite.
+            }
+            double diff = std::abs(static_cast<double>(x) - static_cast<double>(y));
+            d.max_abs = std::max(d.max_abs, diff);
+            sum_abs += diff;
+            sum_sq += diff * diff;
+            differs = differs || diff > tolerance;
+        }
+        d.differing_pixels += differs ? 1 : 0;
+    }
+
+    auto count = static_cast<double>(n - n % channels);
+    d.mean_abs = sum_abs / count;
+    d.rmse     = std::sqrt(sum_sq / count);
+    if (d.rmse > 0.0) {
+        d.psnr = -20.0 * std::log10(d.rmse);
+    }
+    return d;
+}
+
+}  // namespace Q::io
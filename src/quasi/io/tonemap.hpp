@@ -0,0 +1,38 @@
+/// @file tonemap.hpp
+/// @brief HDR to display conversion.
+///
+/// Mirrors the backend tonemap pass (Reinhard, then display gamma) for
+/// images read back to the CPU. Uses fast_pow so the per-pixel loop
+/// vectorizes.
+
+#pragma once
+
+#include <quasi/math/fast_math.hpp>
+
+#include <span>
+
+namespace Q::io {
+
+/// @brief Display gamma applied after tonemapping.
+inline constexpr float k_display_gamma = 2.2f;
+
+/// @brief Tonemaps a single linear HDR value to display range.
+[[nodiscard]] inline float tonemap_reinhard(float v) {
+    v = math::select(v > 0.0f, v, 0.0f);  // Also maps NaN to 0.
+    return math::fast_pow(v / (v + 1.0f), 1.0f / k_display_gamma);
+}
+
+/// @brief Tonemaps interleaved RGBA float pixels in place.
+///
+/// Color channels are mapped with Reinhard and gamma corrected; alpha is
+/// left untouched.
+/// @param rgba Pixel data, four floats per pixel.
+inline void tonemap_reinhard(std::span<float> rgba) {
+    for (size_t i = 0; i + 3 < rgba.size(); i += 4) {
+        rgba[i + 0] = tonemap_reinhard(rgba[i + 0]);
+        rgba[i + 1] = tonemap_reinhard(rgba[i + 1]);
+        rgba[i + 2] = tonemap_reinhard(rgba[i + 2]);
+    }
+}
+
+}  // namespace Q::io
@@ -0,0 +1,23 @@
+/// @file log.hpp
+/// @brief Main header for the logging module.
+///
+/// This header includes all logging module components. For finer-grained
+/// control, include individual headers directly.
+
+#pragma once
+
+#include <quasi/log/ring_buffer.hpp>
+#include <quasi/log/logger.hpp>
+
+namespace Q::log {
+
+/// @brief Major version of the logging module.
+inline constexpr int k_version_major = 0;
+
+/// @brief Minor version of the logging module.
+inline constexpr int k_version_minor = 1;
+
+/// @brief Patch version of the logging module.
+inline constexpr int k_version_patch = 0;
+
+}  // namespace Q::log
@@ -0,0 +1,622 @@
+/// @file logger.hpp
+/// @brief Asynchronous logging with deferred formatting.
+///
+/// Logging from a render worker must not wait on stdio locks. A log call
+/// here only checks the channel's severity and rate limit, then copies the
+/// format string pointer and the raw arguments into a lock-free ring owned
+/// by the calling thread. A background flusher formats the records, orders
+/// them by time and hands them to the sink. When a ring is full the record
+/// is dropped and counted rather than blocking the caller; drops and rate
+/// limited messages are reported by the flusher.
+///
+/// Records point at their format string and at a formatter instantiated in
+/// the binary that logged them, so plugins log through
+/// Q_plugin_context::log (which copies the message into the host's logger)
+/// rather than calling this header directly.
+///
+/// Example usage:
+/// @code
+/// auto& render_log = log::default_logger().get("render");
+/// render_log.set_rate_limit(10, std::chrono::seconds{1});
+/// render_log.info("frame {} took {:.2f} ms", frame, ms);
+/// @endcode
+
+#pragma once
+
+#include <quasi/log/ring_buffer.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Q::log {
+
+/// @brief Message severity, in increasing order.
+enum class severity : uint8_t {
+    trace,
+    debug,
+    info,
+    warn,
+    error,
+    off,  ///< As a level: log nothing.
+};
+
+/// @brief Converts a severity to a string.
+[[nodiscard]] inline constexpr std::string_view to_string(severity s) noexcept {
+    switch (s) {
+        case severity::trace: return "trace";
+        case severity::debug: return "debug";
+        case severity::info:  return "info";
+        case severity::warn:  return "warn";
+        case severity::error: return "error";
+        case severity::off:   return "off";
+    }
+    return "unknown";
+}
+
+/// @brief Parses a severity name as produced by to_string().
+[[nodiscard]] inline std::optional<severity> parse_severity(std::string_view name) noexcept {
+    for (auto s : {severity::trace, severity::debug, severity::info, severity::warn,
+                   severity::error, severity::off}) {
+        if (name == to_string(s)) {
+            return s;
+        }
+    }
+    return std::nullopt;
+}
+
+/// @brief Environment variable that sets the default logger's level, e.g. Q_LOG_LEVEL=debug.
+inline constexpr const char* k_log_level_env_var = "Q_LOG_LEVEL";
+
+/// @brief A formatted message as handed to a sink.
+struct entry {
+    severity                 level;
+    std::string_view         channel;
+    std::chrono::nanoseconds time;     ///< Since the logger was created.
+    uint32_t                 thread;   ///< Logger-assigned index of the logging thread.
+    std::string_view         message;
+};
+
+/// @brief Receives formatted messages on the flusher thread.
+using sink = std::function<void(const entry&)>;
+
+/// @brief Writes "[channel] message" lines; warnings and errors go to stderr.
+inline void stdio_sink(const entry& e) {
+    std::FILE* out = e.level >= severity::warn ? stderr : stdout;
+    std::string_view prefix = e.level == severity::error ? "error: "
+                            : e.level == severity::warn  ? "warning: "
+                                                         : "";
+    std::string line = std::format("[{}] {}{}\n", e.channel, prefix, e.message);
+    std::fwrite(line.data(), 1, line.size(), out);
+    std::fflush(out);
+}
+
+// ============================================================================
+// Rate Limiting
+// ============================================================================
+
+/// @class rate_limiter
+/// @brief Lock-free fixed-window limiter: at most N events per period.
+///
+/// Windows restart on the first event after they expire. Concurrent
+/// callers at a window boundary may let a few extra events through; the
+/// limiter bounds log volume, it does not meter it exactly.
+class rate_limiter {
+public:
+    /// @brief Sets the limit; zero events means unlimited.
+    void set_limit(uint32_t max_events, std::chrono::nanoseconds period) noexcept {
+        period_ns_.store(period.count(), std::memory_order_relaxed);
+        max_events_.store(max_events, std::memory_order_relaxed);
+    }
+
+    /// @brief Counts an event at @p now_ns and checks whether it is allowed.
+    [[nodiscard]] bool allow(int64_t now_ns) noexcept {
+        uint32_t max_events = max_events_.load(std::memory_order_relaxed);
+        if (max_events == 0) {
+            return true;
+        }
+        int64_t start = window_start_.load(std::memory_order_relaxed);
+        if (now_ns - start >= period_ns_.load(std::memory_order_relaxed) &&
+            window_start_.compare_exchange_strong(start, now_ns, std::memory_order_relaxed)) {
+            count_.store(0, std::memory_order_relaxed);
+        }
+        if (count_.fetch_add(1, std::memory_order_relaxed) < max_events) {
+            return true;
+        }
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    /// @brief Total events refused so far.
+    [[nodiscard]] uint64_t suppressed() const noexcept {
+        return suppressed_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint32_t> max_events_{0};
+    std::atomic<int64_t>  period_ns_{0};
+    std::atomic<int64_t>  window_start_{0};
+    std::atomic<uint32_t> count_{0};
+    std::atomic<uint64_t> suppressed_{0};
+};
+
+class logger;
+class channel;
+
+namespace detail {
+
+/// @brief Strings are copied into the record and read back as string_view;
+///        everything else is copied by value.
+template <typename T>
+inline constexpr bool is_string_arg_v =
+    std::is_convertible_v<const std::remove_reference_t<T>&, std::string_view>;
+
+template <typename T>
+using stored_t = std::conditional_t<is_string_arg_v<T>, std::string_view, std::remove_cvref_t<T>>;
+
+template <typename T>
+[[nodiscard]] std::string_view as_string(const T& value) noexcept {
+    if constexpr (std::is_pointer_v<T>) {
+        return value ? std::string_view{value} : std::string_view{"(null)"};
+    } else {
+        return std::string_view{value};
+    }
+}
+
+template <typename T>
+[[nodiscard]] size_t encoded_size(const T& value) noexcept {
+    if constexpr (is_string_arg_v<T>) {
+        return sizeof(uint32_t) + as_string(value).size();
+    } else {
+        static_assert(std::is_trivially_copyable_v<std::remove_cvref_t<T>>,
+                      "log arguments must be strings or trivially copyable");
+        return sizeof(T);
+    }
+}
+
+template <typename T>
+void encode(std::byte*& out, const T& value) noexcept {
+    if constexpr (is_string_arg_v<T>) {
+        std::string_view s = as_string(value);
+        auto size = static_cast<uint32_t>(s.size());
+        std::memcpy(out, &size, sizeof(size));
+        std::memcpy(out + sizeof(size), s.data(), s.size());
+        out += sizeof(size) + s.size();
+    } else {
+        std::memcpy(out, &value, sizeof(T));
+        out += sizeof(T);
+    }
+}
+
+template <typename Stored>
+[[nodiscard]] Stored decode(const std::byte*& in) noexcept {
+    if constexpr (std::is_same_v<Stored, std::string_view>) {
+        uint32_t size = 0;
+        std::memcpy(&size, in, sizeof(size));
+        std::string_view s{reinterpret_cast<const char*>(in + sizeof(size)), size};
+        in += sizeof(size) + size;
+        return s;
+    } else {
+        Stored value;
+        std::memcpy(&value, in, sizeof(Stored));
+        in += sizeof(Stored);
+        return value;
+    }
+}
+
+/// @brief Formats a record's arguments; runs on the flusher thread.
+using format_fn = void (*)(std::string_view fmt, const std::byte* args, std::string& out);
+
+template <typename... Stored>
+void format_record(std::string_view fmt, const std::byte* args, std::string& out) {
+    [[maybe_unused]] const std::byte* in = args;
+    // Braced initialization decodes left to right.
+    std::tuple<Stored...> values{decode<Stored>(in)...};
+    std::apply([&](auto&... v) {
+        std::vformat_to(std::back_inserter(out), fmt, std::make_format_args(v...));
+    }, values);
+}
+
+/// @brief Fixed part of every record in a thread ring.
+struct record_header {
+    int64_t        time_ns;
+    format_fn      format;
+    const char*    fmt;
+    uint32_t       fmt_size;
+    severity       level;
+    const channel* source;
+};
+
+/// @brief One thread's ring; outlives the thread until drained.
+struct thread_ring {
+    thread_ring(size_t capacity, uint32_t index) : ring{capacity}, thread{index} {}
+
+    spsc_ring         ring;
+    uint32_t          thread;
+    std::atomic<bool> retired{false};
+};
+
+/// @brief The calling thread's rings, one per logger it has logged to.
+struct thread_rings {
+    std::vector<std::pair<uint64_t, std::shared_ptr<thread_ring>>> rings;
+
+    ~thread_rings() {
+        for (auto& [id, ring] : rings) {
+            ring->retired.store(true, std::memory_order_release);
+        }
+    }
+};
+
+inline thread_local thread_rings t_rings;
+
+inline std::atomic<uint64_t> g_next_logger_id{1};
+
+}  // namespace detail
+
+// ============================================================================
+// Channels
+// ============================================================================
+
+/// @class channel
+/// @brief A named message source with its own level and rate limit.
+///
+/// Channels are created by logger::get() and live as long as their logger.
+/// Every method is safe to call from any thread.
+class channel {
+public:
+    channel(const channel&) = delete;
+    channel& operator=(const channel&) = delete;
+
+    /// @brief Logs a message if its severity passes and the rate limit allows.
+    ///
+    /// The format string is checked at compile time; arguments must be
+    /// strings or trivially copyable, and are formatted later on the
+    /// flusher thread.
+    template <typename... Args>
+    void log(severity level, std::format_string<detail::stored_t<Args>...> fmt, Args&&... args);
+
+    template <typename... Args>
+    void trace(std::format_string<detail::stored_t<Args>...> fmt, Args&&... args) {
+        log(severity::trace, fmt, std::forward<Args>(args)...);
+    }
+    template <typename... Args>
+    void debug(std::format_string<detail::stored_t<Args>...> fmt, Args&&... args) {
+        log(severity::debug, fmt, std::forward<Args>(args)...);
+    }
+    template <typename... Args>
+    void info(std::format_string<detail::stored_t<Args>...> fmt, Args&&... args) {
+        log(severity::info, fmt, std::forward<Args>(args)...);
+    }
+    template <typename... Args>
+    void warn(std::format_string<detail::stored_t<Args>...> fmt, Args&&... args) {
+        log(severity::warn, fmt, std::forward<Args>(args)...);
+    }
+    template <typename... Args>
+    void error(std::format_string<detail::stored_t<Args>...> fmt, Args&&... args) {
+        log(severity::error, fmt, std::forward<Args>(args)...);
+    }
+
+    /// @brief Logs an already formatted message (copied).
+    void write(severity level, std::string_view message) {
+        log(level, "{}", message);
+    }
+
+    /// @brief Checks whether a message of @p level would be recorded.
+    [[nodiscard]] bool enabled(severity level) const noexcept;
+
+    /// @brief Sets this channel's minimum severity (the logger's level also applies).
+    void set_level(severity level) noexcept {
+        level_.store(level, std::memory_order_relaxed);
+    }
+
+    /// @brief Returns this channel's minimum severity.
+    [[nodiscard]] severity level() const noexcept {
+        return level_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Allows at most @p max_messages per @p period; zero means unlimited.
+    void set_rate_limit(uint32_t max_messages, std::chrono::nanoseconds period) noexcept {
+        limiter_.set_limit(max_messages, period);
+    }
+
+    /// @brief Returns the messages refused by the rate limit so far.
+    [[nodiscard]] uint64_t suppressed() const noexcept {
+        return limiter_.suppressed();
+    }
+
+    /// @brief Returns the channel name.
+    [[nodiscard]] std::string_view name() const noexcept {
+        return name_;
+    }
+
+private:
+    friend class logger;
+
+    channel(logger& owner, std::string name) : owner_{owner}, name_{std::move(name)} {}
+
+    logger&               owner_;
+    std::string           name_;
+    std::atomic<severity> level_{severity::trace};
+    rate_limiter          limiter_;
+    uint64_t              reported_suppressed_ = 0;  ///< Flusher side.
+};
+
+// ============================================================================
+// Logger
+// ============================================================================
+
+/// @brief Construction options for logger.
+struct logger_options {
+    severity                  level = severity::info;  ///< Minimum severity for every channel.
+    std::chrono::milliseconds flush_interval{10};      ///< Flusher wake-up period.
+    size_t                    ring_capacity = 256 * 1024;  ///< Bytes per logging thread.
+    bool                      background = true;  ///< Start a flusher thread; else only flush() writes.
+};
+
+/// @class logger
+/// @brief Owns the channels, the per-thread rings and the flusher.
+class logger {
+public:
+    /// @brief Creates a logger writing to @p out.
+    explicit logger(logger_options options = {}, sink out = stdio_sink)
+        : options_{options}
+        , sink_{std::move(out)}
+        , level_{options.level} {
+        if (options_.background) {
+            flusher_ = std::thread{[this] { flusher_loop(); }};
+        }
+    }
+
+    /// @brief Stops the flusher and writes everything still queued.
+    ~logger() {
+        if (flusher_.joinable()) {
+            {
+                std::lock_guard lock{wake_mutex_};
+                stopping_ = true;
+            }
+            wake_cv_.notify_all();
+            flusher_.join();
+        }
+        flush();
+    }
+
+    logger(const logger&) = delete;
+    logger& operator=(const logger&) = delete;
+
+    /// @brief Returns the channel called @p name, creating it on first use.
+    ///
+    /// Cache the reference; lookup takes a lock.
+    [[nodiscard]] channel& get(std::string_view name) {
+        std::lock_guard lock{channels_mutex_};
+        for (auto& c : channels_) {
+            if (c->name() == name) {
+                return *c;
+            }
+        }
+        channels_.push_back(std::unique_ptr<channel>{new channel{*this, std::string{name}}});
+        return *channels_.back();
+    }
+
+    /// @brief Sets the minimum severity for all channels.
+    void set_level(severity level) noexcept {
+        level_.store(level, std::memory_order_relaxed);
+    }
+
+    /// @brief Returns the minimum severity for all channels.
+    [[nodiscard]] severity level() const noexcept {
+        return level_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Replaces the sink; takes effect from the next flush.
+    void set_sink(sink out) {
+        std::lock_guard lock{drain_mutex_};
+        sink_ = std::move(out);
+    }
+
+    /// @brief Formats and writes everything logged before this call, on the calling thread.
+    void flush() {
+        std::lock_guard lock{drain_mutex_};
+        drain();
+    }
+
+    /// @brief Returns the messages dropped because a thread's ring was full.
+    [[nodiscard]] uint64_t dropped() const noexcept {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Nanoseconds since this logger was created.
+    [[nodiscard]] int64_t now_ns() const noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch_).count();
+    }
+
+private:
+    friend class channel;
+
+    /// @brief Copies a record into the calling thread's ring, or drops it.
+    template <typename... Args>
+    void push(const channel& source, severity level, int64_t time_ns, std::string_view fmt,
+              detail::format_fn format, const Args&... args) {
+        detail::thread_ring& tr = ring_for_this_thread();
+        size_t size = sizeof(detail::record_header) + (size_t{0} + ... + detail::encoded_size(args));
+        std::byte* slot = tr.ring.try_reserve(size);
+        if (!slot) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        detail::record_header h{time_ns, format, fmt.data(), static_cast<uint32_t>(fmt.size()),
+                                level, &source};
+        std::memcpy(slot, &h, sizeof(h));
+        [[maybe_unused]] std::byte* out = slot + sizeof(h);
+        (detail::encode(out, args), ...);
+        tr.ring.commit();
+    }
+
+    detail::thread_ring& ring_for_this_thread() {
+        for (auto& [id, ring] : detail::t_rings.rings) {
+            if (id == id_) {
+                return *ring;
+            }
+        }
+        std::lock_guard lock{rings_mutex_};
+        auto ring = std::make_shared<detail::thread_ring>(options_.ring_capacity, next_thread_++);
+        rings_.push_back(ring);
+        detail::t_rings.rings.emplace_back(id_, ring);
+        return *ring;
+    }
+
+    /// @brief A formatted record awaiting the sink.
+    struct pending {
+        int64_t        time_ns;
+        uint32_t       thread;
+        severity       level;
+        std::string_view channel_name;
+        std::string    message;
+    };
+
+    /// @brief Empties every ring into the sink. Caller holds drain_mutex_.
+    void drain() {
+        std::vector<std::shared_ptr<detail::thread_ring>> rings;
+        {
+            std::lock_guard lock{rings_mutex_};
+            // Retired rings are dropped once empty; their thread is gone.
+            std::erase_if(rings_, [](const auto& r) {
+                return r->retired.load(std::memory_order_acquire) && r->ring.empty();
+            });
+            rings = rings_;
+        }
+
+        std::vector<pending> batch;
+        for (auto& tr : rings) {
+            for (auto record = tr->ring.front(); !record.empty(); record = tr->ring.front()) {
+                detail::record_header h;
+                std::memcpy(&h, record.data(), sizeof(h));
+                pending p{h.time_ns, tr->thread, h.level, h.source->name(), {}};
+                try {
+                    h.format({h.fmt, h.fmt_size}, record.data() + sizeof(h), p.message);
+                } catch (const std::exception& e) {
+                    p.message = std::format("<format error: {}>", e.what());
+                }
+                batch.push_back(std::move(p));
+                tr->ring.pop();
+            }
+        }
+
+        int64_t now = now_ns();
+        {
+            std::lock_guard lock{channels_mutex_};
+            for (auto& c : channels_) {
+                uint64_t total = c->suppressed();
+                if (total != c->reported_suppressed_) {
+                    batch.push_back({now, 0, severity::warn, c->name(),
+                                     std::format("{} messages suppressed by rate limit",
+                                                 total - c->reported_suppressed_)});
+                    c->reported_suppressed_ = total;
+                }
+            }
+        }
+        if (uint64_t total = dropped(); total != reported_dropped_) {
+            batch.push_back({now, 0, severity::warn, "log",
+                             std::format("{} messages dropped (log buffer full)", total - reported_dropped_)});
+            reported_dropped_ = total;
+        }
+
+        std::stable_sort(batch.begin(), batch.end(),
+                         [](const pending& a, const pending& b) { return a.time_ns < b.time_ns; });
+        if (!sink_) {
+            return;
+        }
+        for (const auto& p : batch) {
+            try {
+                sink_(entry{p.level, p.channel_name, std::chrono::nanoseconds{p.time_ns}, p.thread, p.message});
+            } catch (...) {
+                // A failing sink must not take the flusher down.
+            }
+        }
+    }
+
+    void flusher_loop() {
+        std::unique_lock lock{wake_mutex_};
+        while (!stopping_) {
+            wake_cv_.wait_for(lock, options_.flush_interval, [this] { return stopping_; });
+            lock.unlock();
+            flush();
+            lock.lock();
+        }
+    }
+
+    logger_options options_;
+    sink           sink_;
+    uint64_t       id_ = detail::g_next_logger_id.fetch_add(1);
+    std::chrono::steady_clock::time_point epoch_ = std::chrono::steady_clock::now();
+
+    std::atomic<severity> level_;
+    std::atomic<uint64_t> dropped_{0};
+    uint64_t              reported_dropped_ = 0;  ///< Under drain_mutex_.
+
+    std::mutex                             channels_mutex_;
+    std::vector<std::unique_ptr<channel>>  channels_;
+
+    std::mutex                                        rings_mutex_;
+    std::vector<std::shared_ptr<detail::thread_ring>> rings_;
+    uint32_t                                          next_thread_ = 0;
+
+    std::mutex              drain_mutex_;
+    std::mutex              wake_mutex_;
+    std::condition_variable wake_cv_;
+    bool                    stopping_ = false;
+    std::thread             flusher_;
+};
+
+// ============================================================================
+// Channel Implementation
+// ============================================================================
+
+template <typename... Args>
+void channel::log(severity level, std::format_string<detail::stored_t<Args>...> fmt, Args&&... args) {
+    if (!enabled(level)) {
+        return;
+    }
+    int64_t now = owner_.now_ns();
+    if (!limiter_.allow(now)) {
+        return;
+    }
+    owner_.push(*this, level, now, fmt.get(), &detail::format_record<detail::stored_t<Args>...>, args...);
+}
+
+inline bool channel::enabled(severity level) const noexcept {
+    return level != severity::off && level >= level_.load(std::memory_order_relaxed) &&
+           level >= owner_.level();
+}
+
+/// @brief Returns the process-wide logger; its level comes from Q_LOG_LEVEL if set.
+[[nodiscard]] inline logger& default_logger() {
+    static logger instance{[] {
+        logger_options options;
+        if (const char* env = std::getenv(k_log_level_env_var)) {
+            options.level = parse_severity(env).value_or(options.level);
+        }
+        return options;
+    }()};
+    return instance;
+}
+
+}  // namespace Q::log
@@ -0,0 +1,164 @@
+/// @file ring_buffer.hpp
+/// @brief Lock-free single-producer single-consumer ring of variable-size records.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+
+namespace Q::log {
+
+/// @class spsc_ring
+/// @brief A byte ring holding variable-size records, one writer and one reader.
+///
+/// The producer reserves a contiguous slot, fills it and commits it; the
+/// consumer reads the oldest record in place and pops it. Neither side
+/// blocks or allocates: a push that does not fit fails, and the caller
+/// decides whether to drop. A record that would straddle the end of the
+/// buffer is preceded by a padding record, so every record is contiguous.
+///
+/// Example usage:
+/// @code
+/// spsc_ring ring{64 * 1024};
+///
+/// // Producer thread
+/// if (std::byte* slot = ring.try_reserve(sizeof(value))) {
+///     std::memcpy(slot, &value, sizeof(value));
+///     ring.commit();
+/// }
+///
+/// // Consumer thread
+/// while (auto record = ring.front(); !record.empty()) {
+///     consume(record);
+///     ring.pop();
+/// }
+/// @endcode
+class spsc_ring {
+public:
+    /// @brief Creates a ring of at least @p capacity bytes (rounded up to a power of two).
+    explicit spsc_ring(size_t capacity)
+        : capacity_{std::bit_ceil(std::max<size_t>(capacity, 256))}
+        , data_{std::make_unique<std::byte[]>(capacity_)} {}
+
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    /// @brief Returns the buffer size in bytes.
+    [[nodiscard]] size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    /// @brief Largest record payload that can ever fit.
+    [[nodiscard]] size_t max_record_size() const noexcept {
+        return capacity_ / 2 - sizeof(header);
+    }
+
+    /// @brief Producer: reserves a contiguous slot of @p size bytes.
+    /// @return The slot (8-byte aligned), or nullptr if the ring is too full.
+    [[nodiscard]] std::byte* try_reserve(size_t size) noexcept {
+        if (size > max_record_size()) {
+            return nullptr;
+        }
+        uint64_t total = record_size(size);
+        uint64_t head  = head_.load(std::memory_order_relaxed);
+        uint64_t pos   = head & (capacity_ - 1);
+        uint64_t pad   = pos + total > capacity_ ? capacity_ - pos : 0;
+
+        if (head + pad + total - cached_tail_ > capacity_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head + pad + total - cached_tail_ > capacity_) {
+                return nullptr;
+            }
+        }
+
+        if (pad > 0) {
+            write_header(pos, header{static_cast<uint32_t>(pad), k_padding});
+            head += pad;
+            pos = 0;
+        }
+        write_header(pos, header{static_cast<uint32_t>(total), 0});
+        // Padding becomes visible together with the record at commit().
+        pending_head_ = head + total;
+        return data_.get() + pos + sizeof(header);
+    }
+
+    /// @brief Producer: publishes the slot returned by the last try_reserve().
+    void commit() noexcept {
+        head_.store(pending_head_, std::memory_order_release);
+    }
+
+    /// @brief Consumer: returns the oldest record, or an empty span if none.
+    ///
+    /// The span is rounded up to 8 bytes, so records carry their own lengths.
+    [[nodiscard]] std::span<const std::byte> front() noexcept {
+        for (;;) {
+            uint64_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail == cached_head_) {
+                cached_head_ = head_.load(std::memory_order_acquire);
+                if (tail == cached_head_) {
+                    return {};
+                }
+            }
+            uint64_t pos = tail & (capacity_ - 1);
+            header h = read_header(pos);
+            if (h.flags & k_padding) {
+                tail_.store(tail + h.size, std::memory_order_release);
+                continue;
+            }
+            return {data_.get() + pos + sizeof(header), h.size - sizeof(header)};
+        }
+    }
+
+    /// @brief Consumer: releases the record returned by front().
+    void pop() noexcept {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        header h = read_header(tail & (capacity_ - 1));
+        tail_.store(tail + h.size, std::memory_order_release);
+    }
+
+    /// @brief Checks whether the ring is empty (consumer side).
+    [[nodiscard]] bool empty() const noexcept {
+        return tail_.load(std::memory_order_relaxed) == head_.load(std::memory_order_acquire);
+    }
+
+private:
+    struct header {
+        uint32_t size;   ///< Whole record including this header, 8-byte aligned.
+        uint32_t flags;
+    };
+    static constexpr uint32_t k_padding = 1;
+
+    [[nodiscard]] static uint64_t record_size(size_t payload) noexcept {
+        return (sizeof(header) + payload + 7) & ~uint64_t{7};
+    }
+
+    void write_header(uint64_t pos, header h) noexcept {
+        std::memcpy(data_.get() + pos, &h, sizeof(h));
+    }
+
+    [[nodiscard]] header read_header(uint64_t pos) const noexcept {
+        header h;
+        std::memcpy(&h, data_.get() + pos, sizeof(h));
+        return h;
+    }
+
+    size_t                       capacity_;
+    std::unique_ptr<std::byte[]> data_;
+
+    // Producer side.
+    alignas(64) std::atomic<uint64_t> head_{0};
+    uint64_t pending_head_ = 0;
+    uint64_t cached_tail_  = 0;
+
+    // Consumer side.
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    uint64_t cached_head_ = 0;
+};
+
+}  // namespace Q::log
@@ -0,0 +1,97 @@
+/// @file aabb.hpp
+/// @brief Axis-aligned bounding box for spatial queries.
+
+#pragma once
+
+#include <quasi/math/vec.hpp>
+#include <quasi/math/ray.hpp>
+
+#include <limits>
+
+namespace Q::math {
+
+struct aabb {
+    vec3 min = vec3{ std::numeric_limits<float>::infinity()};
+    vec3 max = vec3{-std::numeric_limits<float>::infinity()};
+
+    constexpr aabb() = default;
+    constexpr aabb(vec3 min, vec3 max) : min{min}, max{max} {}
+
+    /// @brief Returns true if the box contains no points.
+    constexpr bool empty() const {
+        return min.x > max.x || min.y > max.y || min.z > max.z;
+    }
+
+    /// @brief Grows the box to contain a point.
+    constexpr void expand(vec3 p) {
+        min = math::min(min, p);
+        max = math::max(max, p);
+    }
+
+    /// @brief Grows the box to contain another box.
+    constexpr void expand(const aabb& b) {
+        min = math::min(min, b.min);
+        max = math::max(max, b.max);
+    }
+
+    constexpr vec3 extent() const { return max - min; }
+    constexpr vec3 centroid() const { return (min + max) * 0.5f; }
+
+    /// @brief Returns the axis (0, 1, 2) along which the box is widest.
+    constexpr int largest_axis() const {
+        vec3 e = extent();
+        if (e.x >= e.y && e.x >= e.z) return 0;
+        return e.y >= e.z ? 1 : 2;
+    }
+
+    /// @brief Returns the surface area, or 0 for an empty box.
+    constexpr float surface_area() const {
+        if (empty()) return 0.0f;
+        vec3 e = extent();
+        return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+    }
+};
+
+/// @brief Returns the union of two boxes.
+constexpr aabb merge(const aabb& a, const aabb& b) {
+    return {min(a.min, b.min), max(a.max, b.max)};
+}
+
+/// @brief Returns the overlap of two boxes (empty if disjoint).
+constexpr aabb intersection(const aabb& a, const aabb& b) {
+    return {max(a.min, b.min), min(a.max, b.max)};
+}
+
+/// @brief Slab test against a box.
+/// @param b The box to test.
+/// @param origin Ray origin.
+/// @param inv_dir Component-wise reciprocal of the ray direction.
+/// @param t_min Minimum valid t value.
+/// @param t_max Maximum valid t value.
+/// @return Entry distance if the ray overlaps the box in [t_min, t_max],
+///         or +infinity on a miss.
+constexpr float intersect(const aabb& b, vec3 origin, vec3 inv_dir, float t_min, float t_max) {
+    for (int axis = 0; axis < 3; ++axis) {
+        float t0 = (b.min[axis] - origin[axis]) * inv_dir[axis];
+        float t1 = (b.max[axis] - origin[axis]) * inv_dir[axis];
+        if (t0 > t1) {
+            float tmp = t0;
+            t0 = t1;
+            t1 = tmp;
+        }
+        // Written so that NaN (0 * inf on a slab boundary) keeps the old bound.
+        t_min = t0 > t_min ? t0 : t_min;
+        t_max = t1 < t_max ? t1 : t_max;
+        if (t_max < t_min) {
+            return std::numeric_limits<float>::infinity();
+        }
+    }
+    return t_min;
+}
+
+/// @brief Returns the component-wise reciprocal of a ray direction.
+inline vec3 inverse_direction(const ray& r) {
+    return {1.0f / r.direction.x, 1.0f / r.direction.y, 1.0f / r.direction.z};
+}
+
+}  // namespace Q::math
@@ -0,0 +1,288 @@
+/// @file fast_math.hpp
+/// @brief Bounded-error polynomial approximations of transcendental functions.
+///
+/// libm calls are opaque to the vectorizer, so a loop that samples
+/// directions or tonemaps pixels stays scalar as soon as it calls std::sin
+/// or std::pow. These functions are branch-free straight-line code (range
+/// reduction, a polynomial, exponent bit manipulation) that inlines and
+/// vectorizes. Each comes as a scalar overload, component-wise vector
+/// overloads where shading code needs them, and span overloads for batch
+/// loops.
+///
+/// Maximum errors, measured against double-precision libm over the stated
+/// domains (1 ulp = spacing of floats at the exact result):
+///
+/// | Function    | Domain              | Max error                  |
+/// |-------------|---------------------|----------------------------|
+/// | fast_sincos | |x| <= 4            | 2 ulp                      |
+/// | fast_sincos | |x| <= 8192         | 1e-7 absolute              |
+/// | fast_tan    | |x| <= 1.5          | 4 ulp                      |
+/// | fast_acos   | [-1, 1]             | 2 ulp                      |
+/// | fast_exp2   | [-150, 128)         | 2 ulp (denormals included) |
+/// | fast_log2   | (0, inf)            | 1 ulp, or 1e-7 absolute    |
+/// | fast_pow    | x >= 0              | (2 + |y log2 x|) ulp       |
+///
+/// The absolute log2 bound applies near x = 1, where the result approaches
+/// zero. fast_pow inherits float rounding of y * log2(x); for display
+/// gamma on [0, 1] that stays far below 8-bit quantization. Special
+/// cases: fast_exp2 returns 0 below -150 and +inf from 128; fast_log2
+/// returns -inf for 0, NaN for negative input and +inf for +inf;
+/// fast_pow(0, y) is 0 for y > 0.
+
+#pragma once
+
+#include <quasi/math/vec.hpp>
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+namespace Q::math {
+
+inline constexpr float k_pi = 3.14159265358979323846f;
+
+/// @brief Branch-free select: c ? a : b.
+///
+/// A plain ternary lets the compiler sink the computation of an operand
+/// into a branch, and with trapping math it may not speculate it back out,
+/// which blocks vectorization. Blending bit patterns keeps both operands
+/// unconditionally live. Combine conditions with & and | rather
+/// than && and || for the same reason.
+[[nodiscard]] inline float select(bool c, float a, float b) {
+    uint32_t mask = 0u - static_cast<uint32_t>(c);
+    return std::bit_cast<float>((std::bit_cast<uint32_t>(a) & mask) |
+                                (std::bit_cast<uint32_t>(b) & ~mask));
+}
+
+/// @brief Sine and cosine of the same angle.
+template <typename T>
+struct sin_cos {
+    T sin;
+    T cos;
+};
+
+namespace detail {
+
+inline constexpr float k_half_pi   = 1.57079632679489661923f;
+inline constexpr float k_two_by_pi = 0.63661977236758134308f;
+
+// pi/2 in three parts; the first two have few enough mantissa bits that
+// q * part is exact for |q| < 2^13 (Cody-Waite reduction).
+inline constexpr float k_pio2_a = 1.5703125f;
+inline constexpr float k_pio2_b = 4.837512969970703125e-4f;
+inline constexpr float k_pio2_c = 7.54978995489188216e-8f;
+
+// Adding 1.5 * 2^23 rounds any |v| < 2^22 to the nearest integer, which
+// then sits in the low mantissa bits. Unlike std::nearbyint this always
+// inlines, and reading the integer back is a bit_cast, never a
+// float-to-int conversion that could be undefined for NaN.
+inline constexpr float   k_round_magic      = 12582912.0f;
+inline constexpr int32_t k_round_magic_bits = 0x4B400000;
+
+}  // namespace detail
+
+// ============================================================================
+// Scalar
+// ============================================================================
+
+/// @brief Computes sin(x) and cos(x) together.
+[[nodiscard]] inline sin_cos<float> fast_sincos(float x) {
+    using namespace detail;
+
+    float shifted = x * k_two_by_pi + k_round_magic;
+    float q = shifted - k_round_magic;
+    float r = ((x - q * k_pio2_a) - q * k_pio2_b) - q * k_pio2_c;
+    int32_t quadrant = std::bit_cast<int32_t>(shifted);
+
+    // Minimax polynomials on [-pi/4, pi/4].
+    float r2 = r * r;
+    float s = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+    float c = 1.0f - 0.5f * r2 +
+              r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+
+    bool swap = (quadrant & 1) != 0;
+    float sin_v = select(swap, c, s);
+    float cos_v = select(swap, s, c);
+    sin_v = select((quadrant & 2) != 0, -sin_v, sin_v);
+    cos_v = select(((quadrant + 1) & 2) != 0, -cos_v, cos_v);
+    return {sin_v, cos_v};
+}
+
+/// @brief Computes tan(x).
+[[nodiscard]] inline float fast_tan(float x) {
+    auto [s, c] = fast_sincos(x);
+    return s / c;
+}
+
+/// @brief Computes acos(x) for x in [-1, 1].
+[[nodiscard]] inline float fast_acos(float x) {
+    using namespace detail;
+
+    // acos(a) = 2 asin(sqrt((1 - a) / 2)) for a > 0.5, else pi/2 - asin(a).
+    float a = std::abs(x);
+    bool big = a > 0.5f;
+    float z = select(big, 0.5f * (1.0f - a), a * a);
+    float s = select(big, std::sqrt(z), a);
+
+    float p = 4.2163199048e-2f;
+    p = p * z + 2.4181311049e-2f;
+    p = p * z + 4.5470025998e-2f;
+    p = p * z + 7.4953002686e-2f;
+    p = p * z + 1.6666752422e-1f;
+    float asin_s = s + s * z * p;
+
+    float r = select(big, 2.0f * asin_s, k_half_pi - asin_s);
+    return select(x < 0.0f, k_pi - r, r);
+}
+
+/// @brief Computes 2^x.
+[[nodiscard]] inline float fast_exp2(float x) {
+    using namespace detail;
+
+    float clamped = select(x >= -150.0f, x, -150.0f);  // Also maps NaN to -150.
+    clamped = select(clamped <= 128.0f, clamped, 128.0f);
+    float shifted = clamped + k_round_magic;
+    float n = shifted - k_round_magic;
+    float f = clamped - n;  // [-0.5, 0.5]
+
+    // Taylor series of e^(f ln 2); the degree-7 remainder is below 2^-27.
+    float p = 1.5252733804e-5f;
+    p = p * f + 1.5403530393e-4f;
+    p = p * f + 1.3333558146e-3f;
+    p = p * f + 9.6181291076e-3f;
+    p = p * f + 5.5504108665e-2f;
+    p = p * f + 2.4022650696e-1f;
+    p = p * f + 6.9314718056e-1f;
+    p = p * f + 1.0f;
+
+    // Scale by 2^n as 2^a * 2^b so both factors stay normal over the whole
+    // range, including results that underflow gradually into denormals.
+    int32_t n_int = std::bit_cast<int32_t>(shifted) - k_round_magic_bits;
+    int32_t a = n_int >> 1;
+    int32_t b = n_int - a;
+    float scale_a = std::bit_cast<float>(static_cast<uint32_t>(a + 127) << 23);
+    float scale_b = std::bit_cast<float>(static_cast<uint32_t>(b + 127) << 23);
+    float result = p * scale_a * scale_b;
+    result = select(x >= 128.0f, std::numeric_limits<float>::infinity(), result);
+    result = select(x < -150.0f, 0.0f, result);
+    return select(x != x, x, result);
+}
+
+/// @brief Computes log2(x).
+[[nodiscard]] inline float fast_log2(float x) {
+    // Scale denormals into the normal range first.
+    using namespace detail;
+
+    bool denormal = x < std::numeric_limits<float>::min();
+    float v = select(denormal, x * 8388608.0f, x);  // 2^23
+    auto bits = std::bit_cast<uint32_t>(v);
+
+    // Split into exponent and mantissa m in [sqrt(1/2), sqrt(2)).
+    auto e = static_cast<int32_t>(bits >> 23) - 127;
+    float m = std::bit_cast<float>((bits & 0x007FFFFFu) | 0x3F800000u);
+    bool high = m > 1.41421356f;
+    m = select(high, 0.5f * m, m);
+    e += static_cast<int32_t>(high);
+    e -= 23 * static_cast<int32_t>(denormal);
+
+    // ln(1 + f) - f as f^2 times a polynomial, f in [-0.29, 0.41].
+    float f = m - 1.0f;
+    float f2 = f * f;
+    float p = 7.0376836292e-2f;
+    p = p * f - 1.1514610310e-1f;
+    p = p * f + 1.1676998740e-1f;
+    p = p * f - 1.2420140846e-1f;
+    p = p * f + 1.4249322787e-1f;
+    p = p * f - 1.6668057665e-1f;
+    p = p * f + 2.0000714765e-1f;
+    p = p * f - 2.4999993993e-1f;
+    p = p * f + 3.3333331174e-1f;
+    float y = f * f2 * p - 0.5f * f2;
+
+    // Multiply by log2(e) = 1 + k_log2e_minus_1, keeping the f and y terms
+    // separate so the large parts add exactly.
+    constexpr float k_log2e_minus_1 = 0.44269504088896340736f;
+    float result = y * k_log2e_minus_1;
+    result += f * k_log2e_minus_1;
+    result += y;
+    result += f;
+    result += static_cast<float>(e);
+
+    result = select(x == 0.0f, -std::numeric_limits<float>::infinity(), result);
+    result = select(x == std::numeric_limits<float>::infinity(), x, result);
+    return select((x < 0.0f) | (x != x), std::numeric_limits<float>::quiet_NaN(), result);
+}
+
+/// @brief Computes x^y for x >= 0.
+[[nodiscard]] inline float fast_pow(float x, float y) {
+    float result = fast_exp2(y * fast_log2(x));
+    return select((x == 0.0f) & (y > 0.0f), 0.0f, result);
+}
+
+// ============================================================================
+// Component-wise vectors
+// ============================================================================
+
+[[nodiscard]] inline sin_cos<vec2> fast_sincos(vec2 x) {
+    auto a = fast_sincos(x.x);
+    auto b = fast_sincos(x.y);
+    return {{a.sin, b.sin}, {a.cos, b.cos}};
+}
+
+[[nodiscard]] inline sin_cos<vec3> fast_sincos(vec3 x) {
+    auto a = fast_sincos(x.x);
+    auto b = fast_sincos(x.y);
+    auto c = fast_sincos(x.z);
+    return {{a.sin, b.sin, c.sin}, {a.cos, b.cos, c.cos}};
+}
+
+[[nodiscard]] inline vec3 fast_tan(vec3 x) { return {fast_tan(x.x), fast_tan(x.y), fast_tan(x.z)}; }
+[[nodiscard]] inline vec3 fast_acos(vec3 x) { return {fast_acos(x.x), fast_acos(x.y), fast_acos(x.z)}; }
+[[nodiscard]] inline vec3 fast_exp2(vec3 x) { return {fast_exp2(x.x), fast_exp2(x.y), fast_exp2(x.z)}; }
+[[nodiscard]] inline vec3 fast_log2(vec3 x) { return {fast_log2(x.x), fast_log2(x.y), fast_log2(x.z)}; }
+
+[[nodiscard]] inline vec3 fast_pow(vec3 x, float y) {
+    return {fast_pow(x.x, y), fast_pow(x.y, y), fast_pow(x.z, y)};
+}
+
+[[nodiscard]] inline vec4 fast_pow(vec4 x, float y) {
+    return {fast_pow(x.x, y), fast_pow(x.y, y), fast_pow(x.z, y), fast_pow(x.w, y)};
+}
+
+// ============================================================================
+// Batches
+// ============================================================================
+//
+// Plain index loops over contiguous floats; with the scalar functions
+// inlined the compiler emits SIMD code for the whole body. Output spans must
+// be at least as long as the input and may alias it.
+
+inline void fast_sincos(std::span<const float> x, std::span<float> sin_out, std::span<float> cos_out) {
+    for (size_t i = 0; i < x.size(); ++i) {
+        auto [s, c] = fast_sincos(x[i]);
+        sin_out[i] = s;
+        cos_out[i] = c;
+    }
+}
+
+inline void fast_exp2(std::span<const float> x, std::span<float> out) {
+    for (size_t i = 0; i < x.size(); ++i) {
+        out[i] = fast_exp2(x[i]);
+    }
+}
+
+inline void fast_log2(std::span<const float> x, std::span<float> out) {
+    for (size_t i = 0; i < x.size(); ++i) {
+        out[i] = fast_log2(x[i]);
+    }
+}
+
+inline void fast_pow(std::span<const float> x, float y, std::span<float> out) {
+    for (size_t i = 0; i < x.size(); ++i) {
+        out[i] = fast_pow(x[i], y);
+    }
+}
+
+}  // namespace Q::math
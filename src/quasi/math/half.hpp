@@ -0,0 +1,88 @@
+/// @file half.hpp
+/// @brief IEEE 754 binary16 conversion.
+///
+/// Branch-free bit manipulation (round to nearest even, NaN and infinity
+/// preserved, denormals handled), so batch loops vectorize with integer
+/// SIMD on any ISA. Compilers targeting F16C may further fold the loops
+/// into hardware conversions.
+
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <span>
+
+namespace Q::math {
+
+namespace detail {
+
+[[nodiscard]] inline uint32_t select_bits(bool c, uint32_t a, uint32_t b) {
+    uint32_t mask = 0u - static_cast<uint32_t>(c);
+    return (a & mask) | (b & ~mask);
+}
+
+}  // namespace detail
+
+/// @brief Converts a float to binary16 bits, rounding to nearest even.
+[[nodiscard]] inline uint16_t to_half(float x) {
+    constexpr uint32_t f32_inf      = 255u << 23;
+    constexpr uint32_t f16_max      = (127u + 16u) << 23;  // First float that overflows.
+    constexpr uint32_t f16_min_norm = 113u << 23;          // 2^-14.
+    constexpr uint32_t denorm_magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+    uint32_t f    = std::bit_cast<uint32_t>(x);
+    uint32_t sign = f & 0x80000000u;
+    f ^= sign;
+
+    // Overflow to infinity; NaN stays a quiet NaN.
+    uint32_t overflow = detail::select_bits(f > f32_inf, 0x7E00u, 0x7C00u);
+
+    // Denormals: let the FPU align and round the mantissa by adding 0.5.
+    uint32_t denorm = std::bit_cast<uint32_t>(std::bit_cast<float>(f) +
+                                              std::bit_cast<float>(denorm_magic)) -
+                      denorm_magic;
+
+    // Normals: rebias the exponent and round the dropped 13 bits to even.
+    uint32_t mant_odd = (f >> 13) & 1u;
+    uint32_t normal   = (f + (static_cast<uint32_t>(15 - 127) << 23) + 0xFFFu + mant_odd) >> 13;
+
+    uint32_t h = detail::select_bits(f < f16_min_norm, denorm, normal);
+    h = detail::select_bits(f >= f16_max, overflow, h);
+    return static_cast<uint16_t>(h | (sign >> 16));
+}
+
+/// @brief Converts binary16 bits to a float (exact).
+[[nodiscard]] inline float from_half(uint16_t h) {
+    constexpr uint32_t shifted_exp = 0x7C00u << 13;
+    constexpr float    denorm_bias = std::bit_cast<float>(113u << 23);
+
+    uint32_t bits = (static_cast<uint32_t>(h) & 0x7FFFu) << 13;
+    uint32_t exp  = bits & shifted_exp;
+    bits += (127u - 15u) << 23;
+
+    // Infinity and NaN: push the exponent the rest of the way to 255.
+    uint32_t inf_nan = bits + ((128u - 16u) << 23);
+
+    // Denormals: renormalize through the FPU.
+    uint32_t denorm = std::bit_cast<uint32_t>(std::bit_cast<float>(bits + (1u << 23)) - denorm_bias);
+
+    bits = detail::select_bits(exp == shifted_exp, inf_nan, bits);
+    bits = detail::select_bits(exp == 0u, denorm, bits);
+    return std::bit_cast<float>(bits | ((static_cast<uint32_t>(h) & 0x8000u) << 16));
+}
+
+/// @brief Converts a batch of floats to binary16.
+inline void to_half(std::span<const float> in, std::span<uint16_t> out) {
+    for (size_t i = 0; i < in.size(); ++i) {
+        out[i] = to_half(in[i]);
+    }
+}
+
+/// @brief Converts a batch of binary16 values to floats.
+inline void from_half(std::span<const uint16_t> in, std::span<float> out) {
+    for (size_t i = 0; i < in.size(); ++i) {
+        out[i] = from_half(in[i]);
+    }
+}
+
+}  // namespace Q::math
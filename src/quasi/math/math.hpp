@@ -5,3 +5,8 @@
 
 #include <quasi/math/vec.hpp>
 #include <quasi/math/ray.hpp>
+#include <quasi/math/aabb.hpp>
+#include <quasi/math/ray_cone.hpp>
+#include <quasi/math/octahedral.hpp>
+#include <quasi/math/fast_math.hpp>
+#include <quasi/math/half.hpp>
@@ -0,0 +1,32 @@
+/// @file ray_cone.hpp
+/// @brief Ray cone footprint tracking for level-of-detail selection.
+///
+/// A ray cone approximates the pixel footprint carried by a ray: a width at
+/// the ray origin and a spread angle that widens it with distance. Camera
+/// rays start with zero width and the pixel's angular size.
+
+#pragma once
+
+namespace Q::math {
+
+struct ray_cone {
+    float width        = 0.0f;  // Footprint width at the ray origin.
+    float spread_angle = 0.0f;  // Full cone angle in radians.
+
+    /// @brief Returns the footprint width at distance t along the ray.
+    ///
+    /// Uses the small-angle approximation tan(a) ~ a, which holds for
+    /// per-pixel spreads.
+    constexpr float width_at(float t) const {
+        return width + spread_angle * t;
+    }
+
+    /// @brief Returns the cone continuing from a hit at distance t.
+    /// @param t Distance to the hit.
+    /// @param surface_spread Extra spread added by surface curvature or roughness.
+    constexpr ray_cone propagate(float t, float surface_spread = 0.0f) const {
+        return {width_at(t), spread_angle + surface_spread};
+    }
+};
+
+}  // namespace Q::math
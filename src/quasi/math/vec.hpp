@@ -39,6 +39,10 @@ struct vec3 {
     constexpr vec3(float x, float y, float z) : x{x}, y{y}, z{z} {}
     constexpr explicit vec3(float s) : x{s}, y{s}, z{s} {}
 
+    /// @brief Component access by axis index (0 = x, 1 = y, 2 = z).
+    constexpr float operator[](int i) const { return i == 0 ? x : (i == 1 ? y : z); }
+    constexpr float& operator[](int i) { return i == 0 ? x : (i == 1 ? y : z); }
+
     constexpr vec3 operator+(vec3 v) const { return {x + v.x, y + v.y, z + v.z}; }
     constexpr vec3 operator-(vec3 v) const { return {x - v.x, y - v.y, z - v.z}; }
     constexpr vec3 operator*(float s) const { return {x * s, y * s, z * s}; }
@@ -110,6 +114,14 @@ inline vec2 normalize(vec2 v) { return v / length(v); }
 inline vec3 normalize(vec3 v) { return v / length(v); }
 inline vec4 normalize(vec4 v) { return v / length(v); }
 
+constexpr vec3 min(vec3 a, vec3 b) {
+    return {a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y, a.z < b.z ? a.z : b.z};
+}
+
+constexpr vec3 max(vec3 a, vec3 b) {
+    return {a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y, a.z > b.z ? a.z : b.z};
+}
+
 constexpr vec3 reflect(vec3 v, vec3 n) {
     return v - 2.0f * dot(v, n) * n;
 }
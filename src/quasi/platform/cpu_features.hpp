@@ -0,0 +1,187 @@
+/// @file cpu_features.hpp
+/// @brief Runtime CPU feature detection.
+///
+/// Queries CPUID once per process, checks with XGETBV that the OS saves the
+/// wider register state, and condenses the result into an isa level that
+/// kernel dispatch keys on (see kernel_registry.hpp).
+
+#pragma once
+
+#include <quasi/platform.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <cpuid.h>
+    #define Q_ARCH_X86 1
+#elif defined(__aarch64__)
+    #define Q_ARCH_ARM64 1
+#endif
+
+namespace Q::platform {
+
+/// @brief Instruction set levels that kernels are compiled for, lowest first.
+enum class isa : uint8_t {
+    scalar,  ///< The build's baseline (SSE2 on x86-64, NEON on arm64).
+    sse4_2,  ///< SSE4.2 + POPCNT.
+    avx2,    ///< AVX2 + FMA + F16C + BMI2 (x86-64-v3).
+    avx512,  ///< AVX-512 F/BW/DQ/VL (x86-64-v4).
+};
+
+/// @brief Number of isa levels.
+inline constexpr size_t k_isa_count = 4;
+
+/// @brief Converts an isa level to its canonical name.
+[[nodiscard]] inline constexpr std::string_view to_string(isa level) noexcept {
+    switch (level) {
+        case isa::scalar: return "scalar";
+        case isa::sse4_2: return "sse4.2";
+        case isa::avx2:   return "avx2";
+        case isa::avx512: return "avx512";
+    }
+    return "unknown";
+}
+
+/// @brief Parses a canonical isa name, as printed by to_string().
+[[nodiscard]] inline constexpr std::optional<isa> parse_isa(std::string_view name) noexcept {
+    for (size_t i = 0; i < k_isa_count; ++i) {
+        auto level = static_cast<isa>(i);
+        if (name == to_string(level)) {
+            return level;
+        }
+    }
+    return std::nullopt;
+}
+
+/// @brief Instruction set extensions usable by this process.
+///
+/// A flag is only set when both the CPU reports it and the OS has enabled
+/// the register state it needs.
+struct cpu_features {
+    std::string vendor;  ///< CPUID vendor string, e.g. "GenuineIntel".
+    std::string brand;   ///< Processor brand string, if reported.
+
+    bool sse4_2   = false;
+    bool popcnt   = false;
+    bool avx      = false;
+    bool avx2     = false;
+    bool fma      = false;
+    bool f16c     = false;
+    bool bmi2     = false;
+    bool avx512f  = false;
+    bool avx512bw = false;
+    bool avx512dq = false;
+    bool avx512vl = false;
+    bool neon     = false;
+
+    /// @brief Checks whether every extension of an isa level is usable.
+    [[nodiscard]] bool supports(isa level) const noexcept {
+        switch (level) {
+            case isa::scalar: return true;
+            case isa::sse4_2: return sse4_2 && popcnt;
+            case isa::avx2:   return supports(isa::sse4_2) && avx && avx2 && fma && f16c && bmi2;
+            case isa::avx512: return supports(isa::avx2) && avx512f && avx512bw && avx512dq && avx512vl;
+        }
+        return false;
+    }
+
+    /// @brief Returns the highest isa level this CPU supports.
+    [[nodiscard]] isa best_isa() const noexcept {
+        isa best = isa::scalar;
+        for (size_t i = 1; i < k_isa_count; ++i) {
+            if (supports(static_cast<isa>(i))) {
+                best = static_cast<isa>(i);
+            }
+        }
+        return best;
+    }
+};
+
+namespace detail {
+
+#if defined(Q_ARCH_X86)
+
+/// @brief Reads an extended control register (XGETBV, without requiring -mxsave).
+[[nodiscard]] inline uint64_t xgetbv(uint32_t index) {
+    uint32_t lo = 0;
+    uint32_t hi = 0;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(index));
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+
+#endif
+
+}  // namespace detail
+
+/// @brief Queries the CPU. Prefer host_cpu(), which caches the result.
+[[nodiscard]] inline cpu_features detect_cpu_features() {
+    cpu_features f;
+
+#if defined(Q_ARCH_X86)
+    uint32_t eax = 0, ebx = 0, ecx = 0, edx = 0;
+    uint32_t max_leaf = __get_cpuid_max(0, nullptr);
+
+    __cpuid(0, eax, ebx, ecx, edx);
+    char vendor[13] = {};
+    std::memcpy(vendor + 0, &ebx, 4);
+    std::memcpy(vendor + 4, &edx, 4);
+    std::memcpy(vendor + 8, &ecx, 4);
+    f.vendor = vendor;
+
+    if (max_leaf >= 1) {
+        __cpuid(1, eax, ebx, ecx, edx);
+        f.sse4_2 = (ecx >> 20) & 1;
+        f.popcnt = (ecx >> 23) & 1;
+
+        // AVX state must be enabled by the OS (XMM and YMM bits of XCR0).
+        bool osxsave = (ecx >> 27) & 1;
+        uint64_t xcr0 = osxsave ? detail::xgetbv(0) : 0;
+        bool ymm_state = (xcr0 & 0x06) == 0x06;
+        bool zmm_state = (xcr0 & 0xE6) == 0xE6;  // Plus opmask and upper ZMM.
+
+        f.avx  = ymm_state && ((ecx >> 28) & 1);
+        f.fma  = ymm_state && ((ecx >> 12) & 1);
+        f.f16c = ymm_state && ((ecx >> 29) & 1);
+
+        if (max_leaf >= 7) {
+            __cpuid_count(7, 0, eax, ebx, ecx, edx);
+            f.avx2     = ymm_state && ((ebx >> 5) & 1);
+            f.bmi2     = (ebx >> 8) & 1;
+            f.avx512f  = zmm_state && ((ebx >> 16) & 1);
+            f.avx512dq = zmm_state && ((ebx >> 17) & 1);
+            f.avx512bw = zmm_state && ((ebx >> 30) & 1);
+            f.avx512vl = zmm_state && ((ebx >> 31) & 1);
+        }
+    }
+
+    if (__get_cpuid_max(0x80000000u, nullptr) >= 0x80000004u) {
+        char brand[49] = {};
+        for (uint32_t i = 0; i < 3; ++i) {
+            __cpuid(0x80000002u + i, eax, ebx, ecx, edx);
+            std::memcpy(brand + i * 16 + 0, &eax, 4);
+            std::memcpy(brand + i * 16 + 4, &ebx, 4);
+            std::memcpy(brand + i * 16 + 8, &ecx, 4);
+            std::memcpy(brand + i * 16 + 12, &edx, 4);
+        }
+        std::string_view b{brand};
+        auto first = b.find_first_not_of(' ');
+        f.brand = first == std::string_view::npos ? std::string{} : std::string{b.substr(first)};
+    }
+#elif defined(Q_ARCH_ARM64)
+    f.neon = true;  // Mandatory in AArch64.
+#endif
+
+    return f;
+}
+
+/// @brief Returns the features of the CPU this process runs on.
+[[nodiscard]] inline const cpu_features& host_cpu() {
+    static const cpu_features features = detect_cpu_features();
+    return features;
+}
+
+}  // namespace Q::platform
@@ -0,0 +1,118 @@
+/// @file kernel_registry.hpp
+/// @brief Multi-ISA kernel dispatch.
+///
+/// Hot kernels are compiled several times inside one library, once per isa
+/// level, by wrapping a shared generic body in functions tagged with
+/// Q_TARGET_* attributes. The attributes enable the level's extensions for
+/// that function and flatten every call into it, so header-only helpers
+/// (math, accel, scene) are inlined and vectorized for the level while
+/// their out-of-line copies stay at the build baseline. This keeps a single
+/// plugin binary hot-reloadable across a mixed fleet.
+///
+/// A registry maps each compiled level to a table of function pointers.
+/// Plugins select a table once at create time:
+/// @code
+/// struct my_kernels { void (*scale)(std::span<float>, float); };
+///
+/// Q_TARGET_AVX2 void scale_avx2(std::span<float> v, float s) { scale_body(v, s); }
+/// ...
+/// kernel_registry<my_kernels> registry;
+/// registry.add(isa::scalar, {scale_scalar});
+/// registry.add(isa::avx2, {scale_avx2});
+///
+/// auto chosen = registry.select(host_cpu(), isa_override_from_env());
+/// chosen.table->scale(values, 2.0f);
+/// @endcode
+
+#pragma once
+
+#include <quasi/platform.hpp>
+#include <quasi/platform/cpu_features.hpp>
+
+#include <array>
+#include <cstdlib>
+#include <optional>
+
+// ============================================================================
+// Per-ISA Function Attributes
+// ============================================================================
+
+#if defined(Q_ARCH_X86) && (defined(Q_COMPILER_GCC) || defined(Q_COMPILER_CLANG))
+    #define Q_HAS_ISA_DISPATCH 1
+    #define Q_TARGET_SSE4_2 [[gnu::target("sse4.2,popcnt"), gnu::flatten]]
+    #define Q_TARGET_AVX2   [[gnu::target("avx2,fma,f16c,bmi2"), gnu::flatten]]
+    #define Q_TARGET_AVX512 [[gnu::target("avx512f,avx512bw,avx512dq,avx512vl,avx2,fma,f16c,bmi2"), gnu::flatten]]
+#endif
+
+#if defined(Q_COMPILER_GCC) || defined(Q_COMPILER_CLANG)
+    #define Q_TARGET_SCALAR [[gnu::flatten]]
+#else
+    #define Q_TARGET_SCALAR
+#endif
+
+namespace Q::platform {
+
+/// @brief Environment variable that overrides kernel selection, e.g. Q_ISA=sse4.2.
+inline constexpr const char* k_isa_env_var = "Q_ISA";
+
+/// @brief Reads the isa override from the environment.
+/// @return The requested level, or nullopt if unset or unrecognized.
+[[nodiscard]] inline std::optional<isa> isa_override_from_env() {
+    const char* value = std::getenv(k_isa_env_var);
+    if (!value) {
+        return std::nullopt;
+    }
+    return parse_isa(value);
+}
+
+/// @class kernel_registry
+/// @brief Maps isa levels to kernel tables and picks the best usable one.
+/// @tparam Table A struct of kernel function pointers.
+template <typename Table>
+class kernel_registry {
+public:
+    /// @brief The outcome of select().
+    struct selection {
+        isa          level;  ///< Level of the chosen table.
+        const Table* table;  ///< The chosen table; null only if scalar is unregistered.
+    };
+
+    /// @brief Registers (or replaces) the table compiled for a level.
+    void add(isa level, Table table) {
+        tables_[static_cast<size_t>(level)] = table;
+    }
+
+    /// @brief Checks whether a level has a registered table.
+    [[nodiscard]] bool has(isa level) const noexcept {
+        return tables_[static_cast<size_t>(level)].has_value();
+    }
+
+    /// @brief Returns the table registered for a level, or nullptr.
+    [[nodiscard]] const Table* get(isa level) const noexcept {
+        const auto& slot = tables_[static_cast<size_t>(level)];
+        return slot ? &*slot : nullptr;
+    }
+
+    /// @brief Picks the highest registered level the CPU supports.
+    /// @param cpu Features of the CPU that will run the kernels.
+    /// @param request Optional ceiling, for benchmarking a lower level. A
+    ///        request the CPU or build cannot satisfy falls back to the best
+    ///        usable level below it.
+    [[nodiscard]] selection select(const cpu_features& cpu,
+                                   std::optional<isa> request = std::nullopt) const {
+        isa ceiling = request.value_or(isa::avx512);
+        selection out{isa::scalar, get(isa::scalar)};
+        for (size_t i = 1; i < k_isa_count; ++i) {
+            auto level = static_cast<isa>(i);
+            if (level <= ceiling && has(level) && cpu.supports(level)) {
+                out = {level, get(level)};
+            }
+        }
+        return out;
+    }
+
+private:
+    std::array<std::optional<Table>, k_isa_count> tables_{};
+};
+
+}  // namespace Q::platform
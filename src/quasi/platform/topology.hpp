@@ -0,0 +1,404 @@
+/// @file topology.hpp
+/// @brief CPU topology, container quotas, worker placement and pinning.
+///
+/// std::thread::hardware_concurrency() reports every CPU of the machine,
+/// not what a container may use: a node with 64 CPUs and a 4-CPU cgroup
+/// quota then runs 64 workers that the kernel throttles in turn. This module
+/// reads what the process can actually use:
+///
+/// - the affinity mask and cgroup v2 cpuset (which CPUs),
+/// - the cgroup v2 cpu.max quota, most restrictive along the hierarchy
+///   (how much CPU time),
+/// - sysfs topology: SMT siblings, shared L3 caches and NUMA nodes,
+///
+/// and turns it into a worker placement plan for thread pools. On platforms
+/// without sysfs the topology is flat (one core per hardware thread).
+
+#pragma once
+
+#include <quasi/platform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(Q_PLATFORM_LINUX)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace Q::platform {
+
+/// @brief Marks a worker that is not pinned to a CPU.
+inline constexpr uint32_t k_unpinned = 0xFFFFFFFFu;
+
+/// @brief One logical CPU (hardware thread) usable by this process.
+struct logical_cpu {
+    uint32_t id        = 0;  ///< OS CPU number.
+    uint32_t core      = 0;  ///< Dense physical core index.
+    uint32_t smt_index = 0;  ///< Rank among the core's hardware threads (0 = first).
+    uint32_t l3        = 0;  ///< Dense index of the L3 cache it shares.
+    uint32_t numa_node = 0;  ///< Dense NUMA node index.
+};
+
+/// @brief Usable CPUs of this process and how they share hardware.
+struct cpu_topology {
+    std::vector<logical_cpu> cpus;  ///< Usable CPUs, ordered by id.
+    uint32_t physical_cores = 0;    ///< Distinct cores among @p cpus.
+    uint32_t l3_domains     = 0;    ///< Distinct L3 caches among @p cpus.
+    uint32_t numa_nodes     = 0;    ///< Distinct NUMA nodes among @p cpus.
+
+    /// @brief cgroup CPU bandwidth limit in CPUs (quota / period), if any.
+    std::optional<double> cpu_quota;
+
+    /// @brief Number of workers the CPU budget sustains without throttling.
+    ///
+    /// The smaller of the usable hardware threads and the quota rounded
+    /// down (at least one).
+    [[nodiscard]] uint32_t cpu_budget() const noexcept {
+        auto budget = static_cast<uint32_t>(cpus.size());
+        if (cpu_quota) {
+            budget = std::min(budget, std::max(1u, static_cast<uint32_t>(std::floor(*cpu_quota))));
+        }
+        return std::max(budget, 1u);
+    }
+};
+
+/// @brief How pool workers map to CPUs.
+enum class pin_policy {
+    none,            ///< One worker per budgeted CPU, left to the OS scheduler.
+    physical_cores,  ///< One pinned worker per physical core; SMT siblings stay idle.
+    logical_cpus,    ///< One pinned worker per hardware thread.
+};
+
+/// @brief Where one pool worker runs.
+struct worker_placement {
+    uint32_t cpu = k_unpinned;  ///< CPU to pin to, or k_unpinned.
+    uint32_t l3  = 0;           ///< L3 domain the worker's tiles come from.
+};
+
+/// @brief Converts a pin policy to a string.
+[[nodiscard]] inline constexpr std::string_view to_string(pin_policy p) noexcept {
+    switch (p) {
+        case pin_policy::none:           return "none";
+        case pin_policy::physical_cores: return "physical_cores";
+        case pin_policy::logical_cpus:   return "logical_cpus";
+    }
+    return "unknown";
+}
+
+// ============================================================================
+// Parsing
+// ============================================================================
+
+/// @brief Parses a kernel CPU list such as "0-3,8,10-11".
+/// @return The listed CPUs in ascending order; empty on malformed input.
+[[nodiscard]] inline std::vector<uint32_t> parse_cpu_list(std::string_view text) {
+    std::vector<uint32_t> out;
+    auto number = [](std::string_view s, uint32_t& value) {
+        if (s.empty()) return false;
+        value = 0;
+        for (char c : s) {
+            if (c < '0' || c > '9') return false;
+            value = value * 10 + static_cast<uint32_t>(c - '0');
+        }
+        return true;
+    };
+
+    while (!text.empty() && (text.back() == '\n' || text.back() == ' ')) {
+        text.remove_suffix(1);
+    }
+    while (!text.empty()) {
+        auto comma = text.find(',');
+        std::string_view item = text.substr(0, comma);
+        text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+
+        auto dash = item.find('-');
+        uint32_t lo = 0;
+        uint32_t hi = 0;
+        if (!number(item.substr(0, dash), lo) ||
+            !number(dash == std::string_view::npos ? item : item.substr(dash + 1), hi) || hi < lo) {
+            return {};
+        }
+        for (uint32_t c = lo; c <= hi; ++c) {
+            out.push_back(c);
+        }
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+/// @brief Parses a cgroup v2 cpu.max file ("<quota> <period>" or "max <period>").
+/// @return The quota in CPUs, or nullopt when unlimited or malformed.
+[[nodiscard]] inline std::optional<double> parse_cgroup_cpu_max(std::string_view text) {
+    std::istringstream in{std::string{text}};
+    std::string quota;
+    double period = 0.0;
+    if (!(in >> quota >> period) || quota == "max" || period <= 0.0) {
+        return std::nullopt;
+    }
+    try {
+        double q = std::stod(quota);
+        return q > 0.0 ? std::optional<double>{q / period} : std::nullopt;
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+// ============================================================================
+// Detection
+// ============================================================================
+
+/// @brief Filesystem locations detect_topology() reads; overridable for tests.
+struct topology_sources {
+    std::filesystem::path sysfs_cpu   = "/sys/devices/system/cpu";
+    std::filesystem::path sysfs_node  = "/sys/devices/system/node";
+    std::filesystem::path cgroup_root = "/sys/fs/cgroup";
+    std::filesystem::path proc_cgroup = "/proc/self/cgroup";
+    bool use_affinity = true;  ///< Also restrict to the calling thread's affinity mask.
+};
+
+namespace detail {
+
+[[nodiscard]] inline std::optional<std::string> read_file(const std::filesystem::path& path) {
+    std::ifstream in{path};
+    if (!in) {
+        return std::nullopt;
+    }
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+[[nodiscard]] inline std::optional<uint32_t> read_uint(const std::filesystem::path& path) {
+    auto text = read_file(path);
+    if (!text) {
+        return std::nullopt;
+    }
+    try {
+        return static_cast<uint32_t>(std::stoul(*text));
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+/// @brief The process's cgroup v2 directory, from the "0::" line.
+[[nodiscard]] inline std::optional<std::filesystem::path> cgroup_dir(const topology_sources& src) {
+    auto text = read_file(src.proc_cgroup);
+    if (!text) {
+        return std::nullopt;
+    }
+    std::istringstream in{*text};
+    for (std::string line; std::getline(in, line);) {
+        if (line.starts_with("0::")) {
+            return src.cgroup_root / std::filesystem::path{line.substr(3)}.relative_path();
+        }
+    }
+    return std::nullopt;
+}
+
+/// @brief Dense renumbering of arbitrary keys in first-seen order.
+template <typename Key>
+struct dense_ids {
+    std::map<Key, uint32_t> ids;
+    uint32_t operator()(const Key& key) {
+        return ids.try_emplace(key, static_cast<uint32_t>(ids.size())).first->second;
+    }
+    [[nodiscard]] uint32_t size() const { return static_cast<uint32_t>(ids.size()); }
+};
+
+}  // namespace detail
+
+/// @brief Reads the usable CPUs and their topology.
+/// @param src Where to read from (defaults to the live system).
+[[nodiscard]] inline cpu_topology detect_topology(const topology_sources& src = {}) {
+    namespace fs = std::filesystem;
+    cpu_topology topo;
+
+    // Which CPUs: online, within the cgroup cpuset and the affinity mask.
+    std::vector<uint32_t> ids;
+    if (auto online = detail::read_file(src.sysfs_cpu / "online")) {
+        ids = parse_cpu_list(*online);
+    }
+    if (ids.empty()) {
+        uint32_t n = std::max(1u, std::thread::hardware_concurrency());
+        for (uint32_t i = 0; i < n; ++i) {
+            ids.push_back(i);
+        }
+    }
+
+    auto cgroup = detail::cgroup_dir(src);
+    auto restrict_to = [&ids](const std::vector<uint32_t>& allowed) {
+        if (allowed.empty()) return;
+        std::erase_if(ids, [&](uint32_t c) {
+            return !std::binary_search(allowed.begin(), allowed.end(), c);
+        });
+    };
+    if (cgroup) {
+        if (auto cpuset = detail::read_file(*cgroup / "cpuset.cpus.effective")) {
+            restrict_to(parse_cpu_list(*cpuset));
+        }
+    }
+
+#if defined(Q_PLATFORM_LINUX)
+    if (src.use_affinity) {
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+            std::vector<uint32_t> allowed;
+            for (uint32_t c = 0; c < CPU_SETSIZE; ++c) {
+                if (CPU_ISSET(c, &mask)) allowed.push_back(c);
+            }
+            restrict_to(allowed);
+        }
+    }
+#endif
+
+    // How much CPU time: the tightest cpu.max from the leaf cgroup up.
+    if (cgroup) {
+        for (fs::path dir = *cgroup;; dir = dir.parent_path()) {
+            if (auto text = detail::read_file(dir / "cpu.max")) {
+                if (auto quota = parse_cgroup_cpu_max(*text)) {
+                    topo.cpu_quota = topo.cpu_quota ? std::min(*topo.cpu_quota, *quota) : *quota;
+                }
+            }
+            if (dir == src.cgroup_root || !dir.has_relative_path() || dir == dir.parent_path()) {
+                break;
+            }
+        }
+    }
+
+    // NUMA nodes from nodeN/cpulist.
+    std::map<uint32_t, uint32_t> node_of;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator{src.sysfs_node, ec}) {
+        std::string name = entry.path().filename().string();
+        if (!name.starts_with("node") || name.size() == 4) continue;
+        uint32_t node = 0;
+        try {
+            node = static_cast<uint32_t>(std::stoul(name.substr(4)));
+        } catch (const std::exception&) {
+            continue;
+        }
+        if (auto list = detail::read_file(entry.path() / "cpulist")) {
+            for (uint32_t c : parse_cpu_list(*list)) node_of[c] = node;
+        }
+    }
+
+    // Cores and L3 domains from cpuN/topology and cpuN/cache.
+    detail::dense_ids<std::pair<uint32_t, uint32_t>> core_ids;  // (package, core_id)
+    detail::dense_ids<uint32_t> l3_ids;                         // Lowest CPU sharing the cache.
+    detail::dense_ids<uint32_t> node_ids;
+    std::map<uint32_t, uint32_t> threads_on_core;
+
+    for (uint32_t id : ids) {
+        fs::path cpu_dir = src.sysfs_cpu / ("cpu" + std::to_string(id));
+        uint32_t package = detail::read_uint(cpu_dir / "topology" / "physical_package_id").value_or(0);
+        uint32_t core_id = detail::read_uint(cpu_dir / "topology" / "core_id").value_or(id);
+
+        // No L3 reported: treat the package as the sharing domain.
+        std::optional<uint32_t> l3_key;
+        for (const auto& entry : fs::directory_iterator{cpu_dir / "cache", ec}) {
+            if (detail::read_uint(entry.path() / "level") != 3u) continue;
+            if (auto shared = detail::read_file(entry.path() / "shared_cpu_list")) {
+                auto list = parse_cpu_list(*shared);
+                if (!list.empty()) l3_key = list.front();
+            }
+        }
+
+        logical_cpu cpu;
+        cpu.id        = id;
+        cpu.core      = core_ids({package, core_id});
+        cpu.smt_index = threads_on_core[cpu.core]++;
+        cpu.l3        = l3_ids(l3_key.value_or(0x80000000u | package));
+        cpu.numa_node = node_ids(node_of.contains(id) ? node_of[id] : 0);
+        topo.cpus.push_back(cpu);
+    }
+
+    topo.physical_cores = core_ids.size();
+    topo.l3_domains     = l3_ids.size();
+    topo.numa_nodes     = node_ids.size();
+    return topo;
+}
+
+/// @brief Returns the topology of this process, detected once.
+[[nodiscard]] inline const cpu_topology& host_topology() {
+    static const cpu_topology topo = detect_topology();
+    return topo;
+}
+
+// ============================================================================
+// Placement and Pinning
+// ============================================================================
+
+/// @brief Plans pool workers for a topology.
+///
+/// Workers are filled L3 domain by L3 domain, so a quota smaller than the
+/// machine keeps the pool on as few caches as possible, and the worker count
+/// never exceeds cpu_budget().
+/// @param topo The topology to place workers on.
+/// @param policy Which CPUs get workers and whether they are pinned.
+/// @param max_workers Optional further cap; 0 means none.
+[[nodiscard]] inline std::vector<worker_placement> plan_workers(const cpu_topology& topo,
+                                                                pin_policy policy,
+                                                                uint32_t max_workers = 0) {
+    std::vector<logical_cpu> candidates;
+    for (const auto& cpu : topo.cpus) {
+        if (policy != pin_policy::physical_cores || cpu.smt_index == 0) {
+            candidates.push_back(cpu);
+        }
+    }
+    // Group by L3 domain; within a domain keep first SMT threads first.
+    std::stable_sort(candidates.begin(), candidates.end(), [](const logical_cpu& a, const logical_cpu& b) {
+        if (a.l3 != b.l3) return a.l3 < b.l3;
+        return a.smt_index < b.smt_index;
+    });
+
+    uint32_t count = topo.cpu_budget();
+    count = std::min(count, std::max(1u, static_cast<uint32_t>(candidates.size())));
+    if (max_workers > 0) {
+        count = std::min(count, max_workers);
+    }
+
+    std::vector<worker_placement> out;
+    for (uint32_t i = 0; i < count; ++i) {
+        worker_placement w;
+        if (i < candidates.size()) {
+            w.l3 = candidates[i].l3;
+            if (policy != pin_policy::none) {
+                w.cpu = candidates[i].id;
+            }
+        }
+        out.push_back(w);
+    }
+    return out;
+}
+
+/// @brief Pins the calling thread to one CPU.
+/// @return True on success; always false where pinning is unsupported.
+inline bool pin_current_thread(uint32_t cpu) {
+#if defined(Q_PLATFORM_LINUX)
+    if (cpu == k_unpinned || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    return pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0;
+#else
+    (void)cpu;
+    return false;  // macOS only offers affinity hints (thread_policy_set).
+#endif
+}
+
+}  // namespace Q::platform
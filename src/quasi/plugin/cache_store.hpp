@@ -0,0 +1,447 @@
+/// @file cache_store.hpp
+/// @brief Host side of Q_cache: a content-addressed blob cache.
+///
+/// Values live in memory in a store the host owns, so they survive plugin
+/// reloads; past the memory budget the least recently used are dropped.
+/// With a directory, every put is also written to disk, one file per key
+/// named by the key's hash, and a memory miss falls back to the file, so a
+/// restarted host warm-starts too. Each file holds its full key, which
+/// makes a hash collision read as a miss rather than the wrong value.
+/// Files whose sizes do not match their header are deleted on read.
+///
+/// The directory is kept under its own byte budget: when a put takes it
+/// past the budget, the files used least recently (by modification time,
+/// which a disk hit refreshes) are deleted until it fits again.
+///
+/// File layout (host byte order):
+/// @code
+/// "QCHE" | u32 version | u64 key_size | u64 value_size | key | value
+/// @endcode
+
+#pragma once
+
+#include <quasi/platform.hpp>
+#include <quasi/plugin/plugin_interface.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <unistd.h>
+
+namespace Q::plugin {
+
+/// @brief Configuration of a cache_store.
+struct cache_options {
+    size_t                memory_budget = size_t{256} << 20;  ///< Bytes of values kept in memory.
+    std::filesystem::path directory;  ///< On-disk tier; empty keeps everything in memory only.
+    uint64_t              disk_budget = uint64_t{1} << 30;  ///< Bytes of files kept in directory; 0 for no limit.
+};
+
+/// @brief Counters of a cache_store since it was created.
+struct cache_stats {
+    uint64_t memory_hits    = 0;  ///< Gets served from memory.
+    uint64_t disk_hits      = 0;  ///< Gets served from the on-disk tier.
+    uint64_t misses         = 0;  ///< Gets that found nothing.
+    uint64_t puts           = 0;  ///< Values stored.
+    uint64_t evictions      = 0;  ///< Values dropped from memory to stay in budget.
+    uint64_t disk_evictions = 0;  ///< Files deleted to keep the directory in budget.
+    uint64_t disk_errors    = 0;  ///< Failed writes and unreadable or truncated files.
+    size_t   entries        = 0;  ///< Values in memory now.
+    size_t   memory_bytes   = 0;  ///< Bytes of those values.
+};
+
+/// @class cache_store
+/// @brief Exposes a host blob cache to plugins through Q_plugin_context::cache.
+///
+/// Example usage:
+/// @code
+/// cache_store cache{{.directory = cache_store::default_directory()}};
+///
+/// manager mgr{"libbackend.so"};
+/// mgr.set_cache(&cache);  // The same store serves every reload.
+/// @endcode
+class cache_store {
+public:
+    /// @brief A cached value; stays valid while held, even if evicted.
+    using blob = std::shared_ptr<const std::vector<std::byte>>;
+
+    /// @brief Version of the on-disk file layout.
+    static constexpr uint32_t k_file_version = 1;
+
+    explicit cache_store(cache_options options = {}) : options_{std::move(options)} {
+        table_.host_data = this;
+        table_.get       = &cache_store::get_cb;
+        table_.release   = &cache_store::release_cb;
+        table_.put       = &cache_store::put_cb;
+    }
+
+    cache_store(const cache_store&) = delete;
+    cache_store& operator=(const cache_store&) = delete;
+
+    /// @brief Returns the C table to place in Q_plugin_context::cache.
+    [[nodiscard]] cache_table* table() noexcept {
+        return &table_;
+    }
+
+    /// @brief Returns the value stored under @p key, or null on a miss.
+    [[nodiscard]] blob get(std::span<const std::byte> key) {
+        std::string k = to_key(key);
+        {
+            std::lock_guard lock{mutex_};
+            if (auto it = entries_.find(k); it != entries_.end()) {
+                lru_.splice(lru_.begin(), lru_, it->second.lru);
+                ++stats_.memory_hits;
+                return it->second.value;
+            }
+        }
+
+        blob value = options_.directory.empty() ? nullptr : read_file(key);
+        std::lock_guard lock{mutex_};
+        if (!value) {
+            ++stats_.misses;
+            return nullptr;
+        }
+        ++stats_.disk_hits;
+        insert(std::move(k), value);
+        return value;
+    }
+
+    /// @brief Stores a copy of @p value under @p key, in memory and on disk.
+    void put(std::span<const std::byte> key, std::span<const std::byte> value) {
+        auto stored = std::make_shared<const std::vector<std::byte>>(value.begin(), value.end());
+        {
+            std::lock_guard lock{mutex_};
+            ++stats_.puts;
+            insert(to_key(key), stored);
+        }
+        if (options_.directory.empty()) {
+            return;
+        }
+        if (!write_file(key, value)) {
+            count_disk_error();
+            return;
+        }
+        trim_disk(key, value);
+    }
+
+    /// @brief Convenience overloads for string keys.
+    /// @{
+    [[nodiscard]] blob get(std::string_view key) {
+        return get(std::as_bytes(std::span{key}));
+    }
+    void put(std::string_view key, std::span<const std::byte> value) {
+        put(std::as_bytes(std::span{key}), value);
+    }
+    /// @}
+
+    /// @brief Drops every value from memory; the on-disk tier is kept.
+    void clear_memory() {
+        std::lock_guard lock{mutex_};
+        entries_.clear();
+        lru_.clear();
+        stats_.memory_bytes = 0;
+    }
+
+    /// @brief Returns the counters so far.
+    [[nodiscard]] cache_stats stats() const {
+        std::lock_guard lock{mutex_};
+        cache_stats s = stats_;
+        s.entries = entries_.size();
+        return s;
+    }
+
+    /// @brief Returns the file that holds @p key in the on-disk tier.
+    [[nodiscard]] std::filesystem::path path_for(std::span<const std::byte> key) const {
+        char name[24];
+        std::snprintf(name, sizeof(name), "%016llx.qc", static_cast<unsigned long long>(hash(key)));
+        return options_.directory / name;
+    }
+
+    /// @brief 64-bit FNV-1a hash of a key.
+    [[nodiscard]] static uint64_t hash(std::span<const std::byte> key) noexcept {
+        uint64_t h = 0xcbf29ce484222325ull;
+        for (std::byte b : key) {
+            h = (h ^ static_cast<uint8_t>(b)) * 0x100000001b3ull;
+        }
+        return h;
+    }
+
+    /// @brief The per-user cache directory: $XDG_CACHE_HOME/quasi, or under the home directory.
+    [[nodiscard]] static std::filesystem::path default_directory() {
+        if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+            return std::filesystem::path{xdg} / "quasi";
+        }
+        const char* home = std::getenv("HOME");
+        if (!home || !*home) {
+            return std::filesystem::temp_directory_path() / "quasi-cache";
+        }
+#if defined(Q_PLATFORM_MACOS)
+        return std::filesystem::path{home} / "Library" / "Caches" / "quasi";
+#else
+        return std::filesystem::path{home} / ".cache" / "quasi";
+#endif
+    }
+
+private:
+    struct entry {
+        blob                                    value;
+        std::list<const std::string*>::iterator lru;
+    };
+
+    static std::string to_key(std::span<const std::byte> key) {
+        return std::string{reinterpret_cast<const char*>(key.data()), key.size()};
+    }
+
+    /// @brief Adds or replaces an entry, then evicts down to the budget. Caller holds mutex_.
+    void insert(std::string key, blob value) {
+        if (auto it = entries_.find(key); it != entries_.end()) {
+            stats_.memory_bytes -= it->second.value->size();
+            lru_.erase(it->second.lru);
+            entries_.erase(it);
+        }
+        if (value->size() > options_.memory_budget) {
+            return;  // Disk only.
+        }
+        stats_.memory_bytes += value->size();
+        auto [it, inserted] = entries_.emplace(std::move(key), entry{std::move(value), {}});
+        lru_.push_front(&it->first);
+        it->second.lru = lru_.begin();
+
+        while (stats_.memory_bytes > options_.memory_budget) {
+            auto victim = entries_.find(*lru_.back());
+            stats_.memory_bytes -= victim->second.value->size();
+            lru_.pop_back();
+            entries_.erase(victim);
+            ++stats_.evictions;
+        }
+    }
+
+    /// @brief Bytes of the file header before the key.
+    static constexpr uint64_t k_file_header_size = 4 + sizeof(uint32_t) + 2 * sizeof(uint64_t);
+
+    blob read_file(std::span<const std::byte> key) {
+        auto path = path_for(key);
+        std::ifstream in{path, std::ios::binary};
+        if (!in) {
+            return nullptr;  // Not cached; not an error.
+        }
+        std::error_code ec;
+        uint64_t file_size = std::filesystem::file_size(path, ec);
+        if (ec) {
+            return nullptr;
+        }
+        char magic[4];
+        uint32_t version = 0;
+        uint64_t key_size = 0;
+        uint64_t value_size = 0;
+        in.read(magic, 4);
+        in.read(reinterpret_cast<char*>(&version), sizeof(version));
+        in.read(reinterpret_cast<char*>(&key_size), sizeof(key_size));
+        in.read(reinterpret_cast<char*>(&value_size), sizeof(value_size));
+        // Sizes are checked against the file before anything is allocated,
+        // so a truncated or corrupt file cannot ask for a huge buffer.
+        if (!in || std::memcmp(magic, "QCHE", 4) != 0 || version != k_file_version ||
+            key_size > file_size - k_file_header_size ||
+            value_size != file_size - k_file_header_size - key_size) {
+            in.close();
+            std::filesystem::remove(path, ec);
+            count_disk_error();
+            return nullptr;
+        }
+        if (key_size != key.size()) {
+            return nullptr;  // Another key with the same hash.
+        }
+        std::vector<std::byte> stored_key(key_size);
+        in.read(reinterpret_cast<char*>(stored_key.data()), static_cast<std::streamsize>(key_size));
+        if (!in || std::memcmp(stored_key.data(), key.data(), key_size) != 0) {
+            return nullptr;
+        }
+        auto value = std::make_shared<std::vector<std::byte>>(value_size);
+        in.read(reinterpret_cast<char*>(value->data()), static_cast<std::streamsize>(value_size));
+        if (!in) {
+            count_disk_error();
+            return nullptr;
+        }
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);  // LRU.
+        return value;
+    }
+
+    /// @brief Writes a temporary file and renames it over the entry, so readers never see half a file.
+    bool write_file(std::span<const std::byte> key, std::span<const std::byte> value) {
+        std::error_code ec;
+        std::filesystem::create_directories(options_.directory, ec);
+        if (ec) {
+            return false;
+        }
+        auto path = path_for(key);
+        auto tmp = path;
+        tmp += ".tmp." + std::to_string(getpid()) + "." +
+               std::to_string(temp_counter_.fetch_add(1, std::memory_order_relaxed));
+        {
+            std::ofstream out{tmp, std::ios::binary | std::ios::trunc};
+            uint32_t version = k_file_version;
+            uint64_t key_size = key.size();
+            uint64_t value_size = value.size();
+            out.write("QCHE", 4);
+            out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+            out.write(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
+            out.write(reinterpret_cast<const char*>(&value_size), sizeof(value_size));
+            out.write(reinterpret_cast<const char*>(key.data()), static_cast<std::streamsize>(key.size()));
+            out.write(reinterpret_cast<const char*>(value.data()), static_cast<std::streamsize>(value.size()));
+            if (!out.flush()) {
+                out.close();
+                std::filesystem::remove(tmp, ec);
+                return false;
+            }
+        }
+        std::filesystem::rename(tmp, path, ec);
+        if (ec) {
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+        return true;
+    }
+
+    /// @brief Deletes the least recently used files once the directory is past its budget.
+    ///
+    /// The directory is scanned once, then tracked from the puts; other
+    /// processes sharing it are picked up by the rescan at each trim.
+    void trim_disk(std::span<const std::byte> key, std::span<const std::byte> value) {
+        if (options_.disk_budget == 0) {
+            return;
+        }
+        std::lock_guard lock{disk_mutex_};
+        if (disk_bytes_ == k_disk_unscanned) {
+            disk_bytes_ = 0;
+            for (const auto& f : list_files()) {
+                disk_bytes_ += f.size;
+            }
+        } else {
+            disk_bytes_ += k_file_header_size + key.size() + value.size();
+        }
+        if (disk_bytes_ <= options_.disk_budget) {
+            return;
+        }
+
+        auto files = list_files();
+        std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.time < b.time; });
+        disk_bytes_ = 0;
+        for (const auto& f : files) {
+            disk_bytes_ += f.size;
+        }
+        auto keep = path_for(key);
+        uint64_t evicted = 0;
+        for (const auto& f : files) {
+            if (disk_bytes_ <= options_.disk_budget) {
+                break;
+            }
+            std::error_code ec;
+            if (f.path != keep && std::filesystem::remove(f.path, ec)) {
+                disk_bytes_ -= f.size;
+                ++evicted;
+            }
+        }
+        std::lock_guard stats_lock{mutex_};
+        stats_.disk_evictions += evicted;
+    }
+
+    struct disk_file {
+        std::filesystem::path           path;
+        uint64_t                        size = 0;
+        std::filesystem::file_time_type time;
+    };
+
+    /// @brief Lists the entry files in the directory, skipping temporaries and subdirectories.
+    [[nodiscard]] std::vector<disk_file> list_files() const {
+        std::vector<disk_file> files;
+        std::error_code ec;
+        for (std::filesystem::directory_iterator it{options_.directory, ec}, end; !ec && it != end;
+             it.increment(ec)) {
+            std::error_code file_ec;
+            if (it->path().extension() != ".qc" || !it->is_regular_file(file_ec)) {
+                continue;
+            }
+            disk_file f{it->path(), it->file_size(file_ec), it->last_write_time(file_ec)};
+            if (!file_ec) {
+                files.push_back(std::move(f));
+            }
+        }
+        return files;
+    }
+
+    void count_disk_error() {
+        std::lock_guard lock{mutex_};
+        ++stats_.disk_errors;
+    }
+
+    // Plugins call these through a C table, so nothing may throw out of them;
+    // a failure (e.g. std::bad_alloc) reads as a miss or drops the put.
+    static uint32_t get_cb(void* host_data, const void* key, size_t key_size, Q_cache_blob* out) noexcept {
+        auto* self = static_cast<cache_store*>(host_data);
+        if (!out) {
+            return 0;
+        }
+        *out = {};
+        try {
+            auto value = self->get(std::span{static_cast<const std::byte*>(key), key_size});
+            if (!value) {
+                return 0;
+            }
+            auto* token = new blob{std::move(value)};
+            out->data  = (*token)->data();
+            out->size  = (*token)->size();
+            out->token = token;
+            return 1;
+        } catch (...) {
+            *out = {};
+            return 0;
+        }
+    }
+
+    static void release_cb(void* /*host_data*/, Q_cache_blob* b) noexcept {
+        if (b && b->token) {
+            delete static_cast<blob*>(b->token);
+            *b = {};
+        }
+    }
+
+    static void put_cb(void* host_data, const void* key, size_t key_size, const void* data, size_t size) noexcept {
+        auto* self = static_cast<cache_store*>(host_data);
+        try {
+            self->put(std::span{static_cast<const std::byte*>(key), key_size},
+                      std::span{static_cast<const std::byte*>(data), size});
+        } catch (...) {
+            // The entry is dropped; the plugin rebuilds the value next time.
+        }
+    }
+
+    cache_options options_;
+    cache_table   table_{};
+
+    mutable std::mutex                     mutex_;
+    std::unordered_map<std::string, entry> entries_;
+    std::list<const std::string*>          lru_;  // Most recently used first.
+    cache_stats                            stats_;
+    std::atomic<uint64_t>                  temp_counter_{0};
+
+    static constexpr uint64_t k_disk_unscanned = ~uint64_t{0};
+    std::mutex disk_mutex_;
+    uint64_t   disk_bytes_ = k_disk_unscanned;  // Bytes of entry files in the directory.
+};
+
+}  // namespace Q::plugin
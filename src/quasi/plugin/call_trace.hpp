@@ -0,0 +1,448 @@
+/// @file call_trace.hpp
+/// @brief Recording and replay of the host's per-frame plugin calls.
+///
+/// A call trace holds every Q_plugin_update() and Q_plugin_render() the host
+/// made, with the render frame's size, camera, dirty flag, row band and
+/// sample salt and the time of each call. Replaying it drives any plugin through the identical sequence,
+/// which turns an interactive session into a repeatable benchmark.
+///
+/// File layout (host byte order):
+/// @code
+/// header:  "QCTR" | u32 version | u32 viewport_width | u32 viewport_height
+/// record:  u8 tag | varint ns since previous record | payload
+///   update:  f32 delta_time
+///   render:  [varint width, varint height]   if tag has k_tag_size
+///            [10 x f32 camera]               if tag has k_tag_camera
+///            [varint row_begin, varint row_end,
+///             varint sample_salt]            if tag has k_tag_band (version 2+)
+/// @endcode
+/// Size, camera and band are written only when they differ from the
+/// previous render, so a still camera costs a few bytes per frame. A
+/// version 1 trace has no band: its renders cover every row, unsalted.
+
+#pragma once
+
+#include <quasi/gpu/types.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace Q::plugin {
+
+/// @brief Error codes for reading a call trace.
+enum class trace_error {
+    open_failed,          ///< The file could not be opened.
+    bad_magic,            ///< Not a call trace.
+    unsupported_version,  ///< Written by a newer host, or not a valid version.
+    truncated,            ///< Ended inside a record.
+    bad_record,           ///< Unknown record tag.
+};
+
+/// @brief Converts a trace_error to a human-readable string.
+[[nodiscard]] constexpr const char* to_string(trace_error e) noexcept {
+    switch (e) {
+        case trace_error::open_failed:         return "failed to open trace";
+        case trace_error::bad_magic:           return "not a call trace";
+        case trace_error::unsupported_version: return "unsupported trace version";
+        case trace_error::truncated:           return "trace is truncated";
+        case trace_error::bad_record:          return "unknown record in trace";
+    }
+    return "unknown error";
+}
+
+/// @brief Which plugin function a recorded call went to.
+enum class call_kind : uint8_t {
+    update = 1,  ///< Q_plugin_update().
+    render = 2,  ///< Q_plugin_render().
+};
+
+/// @brief One recorded plugin call.
+struct recorded_call {
+    call_kind kind         = call_kind::update;
+    uint64_t  time_ns      = 0;     ///< Since recording began.
+    float     delta_time   = 0.0f;  ///< Update only.
+    uint32_t  width        = 0;     ///< Render only.
+    uint32_t  height       = 0;     ///< Render only.
+    Q_camera  camera{};             ///< Render only.
+    uint32_t  camera_dirty = 0;     ///< Render only.
+    uint32_t  row_begin    = 0;     ///< Render only.
+    uint32_t  row_end      = 0;     ///< Render only; 0 for every row.
+    uint32_t  sample_salt  = 0;     ///< Render only.
+};
+
+/// @brief A decoded call trace.
+struct call_trace {
+    uint32_t                   viewport_width  = 0;  ///< Context size at plugin creation.
+    uint32_t                   viewport_height = 0;
+    std::vector<recorded_call> calls;
+
+    /// @brief Number of render calls.
+    [[nodiscard]] size_t render_count() const noexcept {
+        size_t n = 0;
+        for (const auto& c : calls) {
+            n += c.kind == call_kind::render ? 1 : 0;
+        }
+        return n;
+    }
+
+    /// @brief Time of the last call.
+    [[nodiscard]] uint64_t duration_ns() const noexcept {
+        return calls.empty() ? 0 : calls.back().time_ns;
+    }
+
+    /// @brief Decodes a trace written by call_recorder.
+    [[nodiscard]] static std::expected<call_trace, trace_error> read(std::istream& in);
+
+    /// @brief Reads and decodes a trace file.
+    [[nodiscard]] static std::expected<call_trace, trace_error> load(const std::filesystem::path& path) {
+        std::ifstream in{path, std::ios::binary};
+        if (!in) {
+            return std::unexpected{trace_error::open_failed};
+        }
+        return read(in);
+    }
+};
+
+namespace detail {
+
+inline constexpr char     k_trace_magic[4]  = {'Q', 'C', 'T', 'R'};
+inline constexpr uint32_t k_trace_version   = 2;
+inline constexpr uint8_t  k_tag_kind_mask   = 0x0F;
+inline constexpr uint8_t  k_tag_dirty       = 0x10;
+inline constexpr uint8_t  k_tag_camera      = 0x20;
+inline constexpr uint8_t  k_tag_size        = 0x40;
+inline constexpr uint8_t  k_tag_band        = 0x80;
+inline constexpr size_t   k_camera_floats   = sizeof(Q_camera) / sizeof(float);
+
+static_assert(sizeof(Q_camera) == k_camera_floats * sizeof(float));
+
+template <typename T>
+void write_raw(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool read_raw(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+inline void write_varint(std::ostream& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.put(static_cast<char>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.put(static_cast<char>(v));
+}
+
+inline bool read_varint(std::istream& in, uint64_t& v) {
+    v = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7) {
+        int c = in.get();
+        if (c == std::char_traits<char>::eof()) {
+            return false;
+        }
+        v |= static_cast<uint64_t>(c & 0x7F) << shift;
+        if ((c & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace detail
+
+/// @class call_recorder
+/// @brief Appends plugin calls to a call trace as they happen.
+///
+/// Call from the thread that calls the plugin. loader::set_recorder()
+/// records every update() and render() made through a loader.
+///
+/// Example usage:
+/// @code
+/// std::ofstream file{"session.qct", std::ios::binary};
+/// call_recorder recorder{file, ctx.viewport_width, ctx.viewport_height};
+/// plugin.set_recorder(&recorder);
+/// // ... interactive session ...
+/// plugin.set_recorder(nullptr);
+/// @endcode
+class call_recorder {
+public:
+    /// @brief Writes the trace header; the stream must outlive the recorder.
+    call_recorder(std::ostream& out, uint32_t viewport_width, uint32_t viewport_height)
+        : out_{out}
+        , epoch_{std::chrono::steady_clock::now()} {
+        out_.write(detail::k_trace_magic, sizeof(detail::k_trace_magic));
+        detail::write_raw(out_, detail::k_trace_version);
+        detail::write_raw(out_, viewport_width);
+        detail::write_raw(out_, viewport_height);
+    }
+
+    call_recorder(const call_recorder&) = delete;
+    call_recorder& operator=(const call_recorder&) = delete;
+
+    /// @brief Records an update() made now.
+    void record_update(float delta_time) {
+        recorded_call c;
+        c.kind       = call_kind::update;
+        c.time_ns    = now_ns();
+        c.delta_time = delta_time;
+        record(c);
+    }
+
+    /// @brief Records a render() of @p frame made now.
+    void record_render(const Q::gpu::render_frame& frame) {
+        recorded_call c;
+        c.kind         = call_kind::render;
+        c.time_ns      = now_ns();
+        c.width        = frame.width;
+        c.height       = frame.height;
+        c.camera       = frame.camera;
+        c.camera_dirty = frame.camera_dirty;
+        c.row_begin    = frame.row_begin;
+        c.row_end      = frame.row_end;
+        c.sample_salt  = frame.sample_salt;
+        record(c);
+    }
+
+    /// @brief Appends @p c as is. Times must not decrease.
+    void record(const recorded_call& c) {
+        uint64_t dt = c.time_ns >= last_time_ns_ ? c.time_ns - last_time_ns_ : 0;
+        last_time_ns_ = std::max(last_time_ns_, c.time_ns);
+        ++calls_;
+
+        if (c.kind == call_kind::update) {
+            out_.put(static_cast<char>(call_kind::update));
+            detail::write_varint(out_, dt);
+            detail::write_raw(out_, c.delta_time);
+            return;
+        }
+
+        bool size_changed   = !has_render_ || c.width != width_ || c.height != height_;
+        bool camera_changed = !has_render_ || std::memcmp(&c.camera, &camera_, sizeof(Q_camera)) != 0;
+        bool band_changed   = c.row_begin != row_begin_ || c.row_end != row_end_ || c.sample_salt != sample_salt_;
+        uint8_t tag = static_cast<uint8_t>(call_kind::render);
+        tag |= c.camera_dirty ? detail::k_tag_dirty : 0;
+        tag |= camera_changed ? detail::k_tag_camera : 0;
+        tag |= size_changed ? detail::k_tag_size : 0;
+        tag |= band_changed ? detail::k_tag_band : 0;
+
+        out_.put(static_cast<char>(tag));
+        detail::write_varint(out_, dt);
+        if (size_changed) {
+            detail::write_varint(out_, c.width);
+            detail::write_varint(out_, c.height);
+        }
+        if (camera_changed) {
+            detail::write_raw(out_, c.camera);
+        }
+        if (band_changed) {
+            detail::write_varint(out_, c.row_begin);
+            detail::write_varint(out_, c.row_end);
+            detail::write_varint(out_, c.sample_salt);
+        }
+
+        has_render_  = true;
+        width_       = c.width;
+        height_      = c.height;
+        camera_      = c.camera;
+        row_begin_   = c.row_begin;
+        row_end_     = c.row_end;
+        sample_salt_ = c.sample_salt;
+    }
+
+    /// @brief Number of calls recorded.
+    [[nodiscard]] uint64_t calls() const noexcept {
+        return calls_;
+    }
+
+    /// @brief Flushes the stream; false if any write failed.
+    bool flush() {
+        out_.flush();
+        return static_cast<bool>(out_);
+    }
+
+private:
+    [[nodiscard]] uint64_t now_ns() const noexcept {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now() - epoch_)
+                                         .count());
+    }
+
+    std::ostream&                         out_;
+    std::chrono::steady_clock::time_point epoch_;
+    uint64_t                              last_time_ns_ = 0;
+    uint64_t                              calls_        = 0;
+
+    bool     has_render_ = false;
+    uint32_t width_      = 0;
+    uint32_t height_     = 0;
+    Q_camera camera_{};
+    uint32_t row_begin_   = 0;
+    uint32_t row_end_     = 0;
+    uint32_t sample_salt_ = 0;
+};
+
+inline std::expected<call_trace, trace_error> call_trace::read(std::istream& in) {
+    char magic[sizeof(detail::k_trace_magic)];
+    if (!in.read(magic, sizeof(magic)) ||
+        std::memcmp(magic, detail::k_trace_magic, sizeof(magic)) != 0) {
+        return std::unexpected{trace_error::bad_magic};
+    }
+    uint32_t version = 0;
+    call_trace trace;
+    if (!detail::read_raw(in, version) || !detail::read_raw(in, trace.viewport_width) ||
+        !detail::read_raw(in, trace.viewport_height)) {
+        return std::unexpected{trace_error::truncated};
+    }
+    if (version == 0 || version > detail::k_trace_version) {
+        return std::unexpected{trace_error::unsupported_version};
+    }
+
+    recorded_call last_render;
+    last_render.kind = call_kind::render;
+    uint64_t time_ns = 0;
+    for (int tag = in.get(); tag != std::char_traits<char>::eof(); tag = in.get()) {
+        uint64_t dt = 0;
+        if (!detail::read_varint(in, dt)) {
+            return std::unexpected{trace_error::truncated};
+        }
+        time_ns += dt;
+
+        auto kind = static_cast<call_kind>(tag & detail::k_tag_kind_mask);
+        if (kind == call_kind::update) {
+            recorded_call c;
+            c.kind    = call_kind::update;
+            c.time_ns = time_ns;
+            if (!detail::read_raw(in, c.delta_time)) {
+                return std::unexpected{trace_error::truncated};
+            }
+            trace.calls.push_back(c);
+        } else if (kind == call_kind::render) {
+            if (tag & detail::k_tag_size) {
+                uint64_t w = 0;
+                uint64_t h = 0;
+                if (!detail::read_varint(in, w) || !detail::read_varint(in, h)) {
+                    return std::unexpected{trace_error::truncated};
+                }
+                last_render.width  = static_cast<uint32_t>(w);
+                last_render.height = static_cast<uint32_t>(h);
+            }
+            if ((tag & detail::k_tag_camera) && !detail::read_raw(in, last_render.camera)) {
+                return std::unexpected{trace_error::truncated};
+            }
+            if (tag & detail::k_tag_band) {
+                uint64_t begin = 0;
+                uint64_t end   = 0;
+                uint64_t salt  = 0;
+                if (!detail::read_varint(in, begin) || !detail::read_varint(in, end) ||
+                    !detail::read_varint(in, salt)) {
+                    return std::unexpected{trace_error::truncated};
+                }
+                last_render.row_begin   = static_cast<uint32_t>(begin);
+                last_render.row_end     = static_cast<uint32_t>(end);
+                last_render.sample_salt = static_cast<uint32_t>(salt);
+            }
+            last_render.time_ns      = time_ns;
+            last_render.camera_dirty = (tag & detail::k_tag_dirty) ? 1 : 0;
+            trace.calls.push_back(last_render);
+        } else {
+            return std::unexpected{trace_error::bad_record};
+        }
+    }
+    return trace;
+}
+
+// ============================================================================
+// Replay
+// ============================================================================
+
+/// @brief How replay() paces the calls.
+enum class replay_timing {
+    full_speed,  ///< Each call as soon as the previous one returns.
+    original,    ///< Each call no earlier than its recorded time.
+};
+
+/// @brief Configuration for replay().
+struct replay_options {
+    replay_timing timing  = replay_timing::full_speed;
+    bool          present = true;  ///< Pass a host-owned RGBA16F drawable; else null.
+};
+
+/// @brief What replay() did.
+struct replay_result {
+    uint64_t updates = 0;
+    uint64_t renders = 0;
+    uint64_t wall_ns = 0;
+    uint64_t max_lag_ns = 0;  ///< Original timing: worst lateness of a call.
+};
+
+/// @brief Drives @p plugin through every call in @p trace.
+///
+/// @p plugin is anything with update(float) and render(Q_render_frame*),
+/// normally a loader. Updates receive the recorded delta time in both
+/// timing modes, so the plugin sees the same inputs either way. Frames
+/// are headless: the drawable is a host-owned RGBA16F image (CPU
+/// backends tonemap into it) and the command buffer is null.
+///
+/// Example usage:
+/// @code
+/// auto trace = call_trace::load("session.qct");
+/// if (!trace) return;
+/// auto result = replay(*trace, plugin, {.timing = replay_timing::original});
+/// @endcode
+template <typename Plugin>
+replay_result replay(const call_trace& trace, Plugin& plugin, replay_options options = {}) {
+    using clock = std::chrono::steady_clock;
+
+    replay_result result;
+    std::vector<uint16_t> image;
+    auto start = clock::now();
+    for (const auto& c : trace.calls) {
+        if (options.timing == replay_timing::original) {
+            auto due = start + std::chrono::nanoseconds{c.time_ns};
+            auto now = clock::now();
+            if (now < due) {
+                std::this_thread::sleep_until(due);
+            } else {
+                auto lag = static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(now - due).count());
+                result.max_lag_ns = std::max(result.max_lag_ns, lag);
+            }
+        }
+
+        if (c.kind == call_kind::update) {
+            plugin.update(c.delta_time);
+            ++result.updates;
+            continue;
+        }
+
+        Q::gpu::render_frame frame{};
+        if (options.present) {
+            image.resize(size_t{c.width} * c.height * 4);
+            frame.drawable = image.data();
+        }
+        frame.width        = c.width;
+        frame.height       = c.height;
+        frame.camera       = c.camera;
+        frame.camera_dirty = c.camera_dirty;
+        frame.row_begin    = c.row_begin;
+        frame.row_end      = c.row_end;
+        frame.sample_salt  = c.sample_salt;
+        plugin.render(&frame);
+        ++result.renders;
+    }
+    result.wall_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+    return result;
+}
+
+}  // namespace Q::plugin
@@ -13,6 +13,14 @@
 #include <string_view>
 #include <utility>
 
+#if defined(Q_PLATFORM_LINUX)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace Q::plugin {
 
 /// @brief Error codes for dynamic library operations.
@@ -21,6 +29,7 @@ enum class library_error {
     load_failed,       ///< dlopen() failed.
     symbol_not_found,  ///< dlsym() could not find the symbol.
     not_loaded,        ///< Operation requires a loaded library.
+    copy_failed,       ///< The library could not be copied into memory.
 };
 
 /// @brief Converts a library_error to a human-readable string.
@@ -32,10 +41,17 @@ enum class library_error {
         case library_error::load_failed:      return "failed to load library";
         case library_error::symbol_not_found: return "symbol not found";
         case library_error::not_loaded:       return "library not loaded";
+        case library_error::copy_failed:      return "failed to copy library into memory";
     }
     return "unknown error";
 }
 
+/// @brief Which dynamic-linker namespace a library is loaded into.
+enum class link_namespace {
+    shared,    ///< The process's default namespace (dlopen).
+    isolated,  ///< A fresh namespace of its own (dlmopen, Linux only).
+};
+
 /// @brief Returns the platform-appropriate shared library extension.
 /// @return ".dylib" on macOS, ".so" on Linux, ".dll" on Windows.
 [[nodiscard]] constexpr std::string_view shared_library_extension() noexcept {
@@ -59,11 +75,122 @@ enum class library_error {
     return result;
 }
 
+#if defined(Q_PLATFORM_LINUX)
+
+/// @class library_image
+/// @brief A library file's bytes in an anonymous memfd (Linux only).
+///
+/// Hot reload must load every build as a distinct copy: dlopen() returns
+/// the already loaded library for a path it has seen, and the build on
+/// disk is overwritten while its copy runs. An image is such a copy, but
+/// in memory: nothing is written to the filesystem and nothing is left
+/// behind if the process dies. dynamic_library::open() maps it through
+/// /proc/self/fd.
+///
+/// Example usage:
+/// @code
+/// auto image = library_image::copy("libquasi_cpu.so");
+/// auto lib = dynamic_library::open(std::move(*image));
+/// @endcode
+class library_image {
+public:
+    library_image() noexcept = default;
+
+    ~library_image() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    library_image(const library_image&) = delete;
+    library_image& operator=(const library_image&) = delete;
+
+    library_image(library_image&& other) noexcept : fd_{std::exchange(other.fd_, -1)} {}
+
+    library_image& operator=(library_image&& other) noexcept {
+        if (this != &other) {
+            if (fd_ >= 0) {
+                ::close(fd_);
+            }
+            fd_ = std::exchange(other.fd_, -1);
+        }
+        return *this;
+    }
+
+    /// @brief Copies @p path into a new memfd.
+    ///
+    /// Uses copy_file_range(), which lets the kernel copy without a trip
+    /// through user space, and falls back to read()/write() where that is
+    /// refused (e.g. across filesystems on older kernels).
+    [[nodiscard]] static std::expected<library_image, library_error> copy(const std::filesystem::path& path) {
+        int src = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (src < 0) {
+            return std::unexpected{errno == ENOENT ? library_error::file_not_found : library_error::copy_failed};
+        }
+        struct stat st{};
+        library_image image;
+        image.fd_ = ::memfd_create(path.filename().c_str(), MFD_CLOEXEC);
+        bool ok = ::fstat(src, &st) == 0 && image.fd_ >= 0 && copy_bytes(src, image.fd_, st.st_size);
+        ::close(src);
+        if (!ok) {
+            return std::unexpected{library_error::copy_failed};
+        }
+        return image;
+    }
+
+    /// @brief Returns the path dlopen() can open the image by.
+    [[nodiscard]] std::filesystem::path proc_path() const {
+        return "/proc/self/fd/" + std::to_string(fd_);
+    }
+
+    [[nodiscard]] int fd() const noexcept { return fd_; }
+
+    /// @brief Gives up ownership of the memfd.
+    [[nodiscard]] int release() noexcept { return std::exchange(fd_, -1); }
+
+private:
+    static bool copy_bytes(int src, int dst, off_t size) {
+        off_t done = 0;
+        while (done < size) {
+            ssize_t n = ::copy_file_range(src, nullptr, dst, nullptr, static_cast<size_t>(size - done), 0);
+            if (n <= 0) {
+                break;
+            }
+            done += n;
+        }
+        char buffer[1 << 16];
+        while (done < size) {
+            ssize_t n = ::pread(src, buffer, sizeof(buffer), done);
+            if (n <= 0 || ::pwrite(dst, buffer, static_cast<size_t>(n), done) != n) {
+                return false;
+            }
+            done += n;
+        }
+        return true;
+    }
+
+    int fd_ = -1;
+};
+
+#endif  // Q_PLATFORM_LINUX
+
 /// @class dynamic_library
 /// @brief RAII wrapper for dynamically loaded libraries.
 ///
 /// Manages the lifetime of a shared library loaded via dlopen(). Automatically
 /// closes the library when destroyed. Move-only to prevent double-close bugs.
+///
+/// RTLD_LOCAL keeps a library's symbols out of the global scope, but
+/// opening the same file twice still returns the same copy, and libraries
+/// the plugin depends on are shared with the host. Opening with
+/// link_namespace::isolated loads the library and all its dependencies
+/// into a new linker namespace through dlmopen(LM_ID_NEWLM), so two builds
+/// of one backend, or two instances of the same build, keep separate
+/// globals, statics and thread-locals. glibc allows only a handful of
+/// namespaces per process (16 including the default one). Communicate
+/// with an isolated plugin only through the C ABI: C++ objects, allocations
+/// and exceptions must not cross the boundary. macOS has no dlmopen, so
+/// there isolated falls back to shared.
 class dynamic_library {
 public:
     using handle_type = void*;
@@ -83,28 +210,39 @@ public:
 
     dynamic_library(dynamic_library&& other) noexcept
         : handle_{std::exchange(other.handle_, nullptr)}
-        , path_{std::move(other.path_)} {}
+        , path_{std::move(other.path_)}
+        , image_fd_{std::exchange(other.image_fd_, -1)} {}
 
     dynamic_library& operator=(dynamic_library&& other) noexcept {
         if (this != &other) {
             close();
-            handle_ = std::exchange(other.handle_, nullptr);
-            path_   = std::move(other.path_);
+            handle_   = std::exchange(other.handle_, nullptr);
+            path_     = std::move(other.path_);
+            image_fd_ = std::exchange(other.image_fd_, -1);
         }
         return *this;
     }
 
     /// @brief Opens a dynamic library.
     /// @param path Path to the library file.
+    /// @param ns Namespace to load it into.
     /// @return The loaded library, or an error.
-    [[nodiscard]] static result<dynamic_library> open(const path_type& path) {
+    [[nodiscard]] static result<dynamic_library> open(const path_type& path,
+                                                      link_namespace ns = link_namespace::shared) {
         if (!std::filesystem::exists(path)) {
             return std::unexpected{library_error::file_not_found};
         }
 
         dlerror();  // Clear previous error
 
+#if defined(Q_PLATFORM_LINUX)
+        handle_type handle = ns == link_namespace::isolated
+                                 ? dlmopen(LM_ID_NEWLM, path.c_str(), RTLD_NOW | RTLD_LOCAL)
+                                 : dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+#else
+        (void)ns;
         handle_type handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
 
         if (handle == nullptr) {
             return std::unexpected{library_error::load_failed};
@@ -116,6 +254,21 @@ public:
         return lib;
     }
 
+#if defined(Q_PLATFORM_LINUX)
+    /// @brief Opens an in-memory copy of a library (Linux only).
+    ///
+    /// The library keeps the image's memfd open while it is loaded, so its
+    /// /proc/self/fd path names no other library meanwhile.
+    [[nodiscard]] static result<dynamic_library> open(library_image image,
+                                                      link_namespace ns = link_namespace::shared) {
+        auto lib = open(image.proc_path(), ns);
+        if (lib) {
+            lib->image_fd_ = image.release();
+        }
+        return lib;
+    }
+#endif
+
     /// @brief Looks up a symbol in the library.
     /// @tparam FuncPtr The function pointer type to cast to.
     /// @param name The symbol name to look up.
@@ -142,6 +295,18 @@ public:
         if (handle_ != nullptr) {
             dlclose(handle_);
             handle_ = nullptr;
+#if defined(Q_PLATFORM_LINUX)
+            if (image_fd_ >= 0) {
+                // A library dlclose() could not unload still answers to its path; keep
+                // the fd, so a later image never reuses the path and gets the old code.
+                if (void* resident = dlopen(path_.c_str(), RTLD_LAZY | RTLD_NOLOAD)) {
+                    dlclose(resident);
+                } else {
+                    ::close(image_fd_);
+                }
+                image_fd_ = -1;
+            }
+#endif
             path_.clear();
         }
     }
@@ -161,6 +326,16 @@ public:
         return path_;
     }
 
+    /// @brief Returns true if the library lives outside the default namespace.
+    [[nodiscard]] bool is_isolated() const noexcept {
+#if defined(Q_PLATFORM_LINUX)
+        Lmid_t id = LM_ID_BASE;
+        return handle_ != nullptr && dlinfo(handle_, RTLD_DI_LMID, &id) == 0 && id != LM_ID_BASE;
+#else
+        return false;
+#endif
+    }
+
     /// @brief Returns the native library handle.
     [[nodiscard]] handle_type native_handle() const noexcept {
         return handle_;
@@ -173,8 +348,9 @@ public:
     }
 
 private:
-    handle_type handle_ = nullptr;
+    handle_type handle_   = nullptr;
     path_type   path_;
+    int         image_fd_ = -1;  ///< memfd of an in-memory library; Linux only.
 };
 
 }  // namespace Q::plugin
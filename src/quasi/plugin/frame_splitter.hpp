@@ -0,0 +1,365 @@
+/// @file frame_splitter.hpp
+/// @brief Splits each frame's rows across several plugins and merges their images.
+///
+/// Every frame, the image rows are cut into one contiguous band per
+/// backend, sized in proportion to the rows per second each backend
+/// rendered over the last frames, so a fast GPU backend takes most of the
+/// frame and a CPU backend the rest. Backends must report
+/// Q_CAPABILITY_ROW_BANDS: they render only the rows they are given and
+/// keep a separate sample count per row.
+///
+/// Since the band boundaries move from frame to frame, a row collects
+/// samples from several backends. The splitter counts the samples each
+/// backend reports putting into each row (Q_render_frame::samples_added)
+/// and composites the readbacks per row, weighting each backend's mean by
+/// its sample count. The result is the same running mean a single backend
+/// would have produced.
+///
+/// Compositing reads back every backend's full image, so it happens only
+/// when the host asks for it (composite() or present()), not per frame.
+
+#pragma once
+
+#include <quasi/gpu/types.hpp>
+#include <quasi/io/tonemap.hpp>
+#include <quasi/math/half.hpp>
+#include <quasi/plugin/loader.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <semaphore>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Q::plugin {
+
+/// @brief Tuning of a frame_splitter.
+struct splitter_options {
+    uint32_t min_rows   = 4;     ///< Fewest rows per backend, so slow backends keep being measured.
+    double   smoothing  = 0.25;  ///< Weight of the newest throughput sample in the moving average.
+    bool     concurrent = true;  ///< Render backends on their own threads instead of in turn.
+};
+
+/// @brief A band of image rows, [begin, end).
+struct row_band {
+    uint32_t begin = 0;
+    uint32_t end   = 0;
+
+    [[nodiscard]] constexpr uint32_t rows() const noexcept { return end - begin; }
+};
+
+/// @class basic_frame_splitter
+/// @brief Renders each frame with several backends and composites one image.
+///
+/// Backend is plugin::loader in the host; tests substitute fakes with the
+/// same render/readback interface. Backend 0 renders on the calling thread
+/// and the others on one thread each. Backends that share a job system
+/// serialize their parallel loops, so for several CPU backends set
+/// splitter_options::concurrent to false.
+///
+/// Example usage:
+/// @code
+/// // Both backends must report Q_CAPABILITY_ROW_BANDS (see supports()).
+/// frame_splitter split{{&cpu_a, &cpu_b}, {.concurrent = false}};
+/// std::vector<uint16_t> image(size_t{width} * height * 4);
+/// for (uint32_t i = 0;; ++i) {
+///     split.render(&frame);
+///     if (i % 16 == 0) {
+///         split.present(image);  // RGBA16F, tonemapped.
+///     }
+/// }
+/// auto hdr = split.composite();  // RGBA32F, width() x height().
+/// @endcode
+template <typename Backend>
+class basic_frame_splitter {
+public:
+    using clock = std::chrono::steady_clock;
+
+    /// @brief Takes the backends to split across; they must outlive the splitter.
+    explicit basic_frame_splitter(std::vector<Backend*> backends, splitter_options options = {})
+        : backends_(std::move(backends))
+        , options_(options)
+        , bands_(backends_.size())
+        , throughput_(backends_.size(), 0.0)
+        , render_ns_(backends_.size(), 0)
+        , added_(backends_.size(), 0)
+        , reset_(backends_.size(), 0)
+        , stale_(backends_.size(), 1) {
+        if (options_.concurrent) {
+            for (size_t i = 1; i < backends_.size(); ++i) {
+                workers_.push_back(std::make_unique<worker>());
+            }
+            for (size_t i = 1; i < backends_.size(); ++i) {
+                workers_[i - 1]->thread = std::jthread{[this, i] { worker_loop(i); }};
+            }
+        }
+    }
+
+    ~basic_frame_splitter() {
+        stopping_.store(true, std::memory_order_relaxed);
+        for (auto& w : workers_) {
+            w->start.release();
+        }
+    }
+
+    basic_frame_splitter(const basic_frame_splitter&) = delete;
+    basic_frame_splitter& operator=(const basic_frame_splitter&) = delete;
+
+    /// @brief Returns true if @p backend can take part in a split.
+    [[nodiscard]] static bool supports(const Backend& backend) {
+        return backend.supports_row_bands() && backend.supports_readback();
+    }
+
+    /// @brief Renders one pass, each backend taking its band of rows.
+    ///
+    /// Every backend renders with the frame's camera, its own band and a
+    /// sample salt derived from the frame's (gpu::derive_salt with the
+    /// backend's index), and as many samples per pixel as it is set up to
+    /// take. frame->drawable is ignored and never passed on: backends do
+    /// not present, and nothing is read back. Use present() for an image.
+    void render(gpu::render_frame* frame) {
+        if (!frame || frame->width == 0 || frame->height == 0 || backends_.empty()) {
+            return;
+        }
+        if (frame->width != width_ || frame->height != height_) {
+            width_  = frame->width;
+            height_ = frame->height;
+            samples_.assign(backends_.size() * height_, 0);
+            std::fill(stale_.begin(), stale_.end(), 1);
+        } else if (frame->camera_dirty) {
+            std::fill(samples_.begin(), samples_.end(), 0);
+            std::fill(stale_.begin(), stale_.end(), 1);
+        }
+
+        partition();
+        frame_ = *frame;
+        if (workers_.empty()) {
+            for (size_t i = 0; i < backends_.size(); ++i) {
+                render_band(i);
+            }
+        } else {
+            for (auto& w : workers_) {
+                w->start.release();
+            }
+            render_band(0);
+            for (auto& w : workers_) {
+                w->done.acquire();
+            }
+        }
+
+        std::exception_ptr error;
+        for (size_t i = 0; i < backends_.size(); ++i) {
+            const auto& band = bands_[i];
+            auto mine = std::span{samples_}.subspan(i * height_, height_);
+            if (reset_[i]) {
+                // The backend dropped every row's samples, not just this band's.
+                std::fill(mine.begin(), mine.end(), 0u);
+            }
+            for (uint32_t y = band.begin; y < band.end; ++y) {
+                mine[y] += added_[i];
+            }
+            if (band.rows() > 0 && render_ns_[i] > 0) {
+                double rate = band.rows() * 1e9 / static_cast<double>(render_ns_[i]);
+                throughput_[i] = throughput_[i] == 0.0
+                                     ? rate
+                                     : throughput_[i] + options_.smoothing * (rate - throughput_[i]);
+            }
+        }
+        for (auto& w : workers_) {
+            if (w->error && !error) {
+                error = std::exchange(w->error, nullptr);
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    /// @brief Reads back every backend and merges them into one HDR image.
+    ///
+    /// Each row is the sample-weighted mean of the backends' rows. Backends
+    /// whose readback fails or has the wrong size are left out. Costs a
+    /// full-image readback per backend, so call it when an image is needed,
+    /// not every frame.
+    /// @return RGBA32F pixels, width() x height(); valid until the next call.
+    std::span<const float> composite() {
+        size_t row_floats = size_t{width_} * 4;
+        accum_.assign(row_floats * height_, 0.0f);
+
+        for (size_t i = 0; i < backends_.size(); ++i) {
+            auto result = backends_[i]->readback();
+            if (result.data && result.width == width_ && result.height == height_ && result.channels == 4) {
+                for (uint32_t y = 0; y < height_; ++y) {
+                    uint32_t total = row_samples(y);
+                    uint32_t mine  = samples_[i * height_ + y];
+                    if (mine == 0) {
+                        continue;
+                    }
+                    float weight = static_cast<float>(mine) / static_cast<float>(total);
+                    float* out = &accum_[y * row_floats];
+                    const float* in = &result.data[y * row_floats];
+                    for (size_t j = 0; j < row_floats; ++j) {
+                        out[j] += weight * in[j];
+                    }
+                }
+            }
+            backends_[i]->readback_free(&result);
+        }
+        return accum_;
+    }
+
+    /// @brief Composites, tonemaps and writes the image as RGBA16F into @p image.
+    /// @param image Host-owned pixels, at least width() * height() * 4 values.
+    /// @return False, leaving @p image untouched, if it is too small or nothing was rendered.
+    bool present(std::span<uint16_t> image) {
+        size_t size = size_t{width_} * height_ * 4;
+        if (size == 0 || image.size() < size) {
+            return false;
+        }
+        auto hdr = composite();
+        display_.assign(hdr.begin(), hdr.end());
+        io::tonemap_reinhard(display_);
+        math::to_half(display_, image.first(size));
+        return true;
+    }
+
+    /// @brief Returns the samples all backends have put into row @p y.
+    [[nodiscard]] uint32_t row_samples(uint32_t y) const noexcept {
+        uint32_t total = 0;
+        for (size_t i = 0; i < backends_.size(); ++i) {
+            total += samples_[i * height_ + y];
+        }
+        return total;
+    }
+
+    /// @brief Returns the band each backend rendered last frame.
+    [[nodiscard]] std::span<const row_band> bands() const noexcept { return bands_; }
+
+    /// @brief Returns each backend's smoothed throughput in rows per second; 0 until measured.
+    [[nodiscard]] std::span<const double> throughput() const noexcept { return throughput_; }
+
+    /// @brief Returns each backend's render time for the last frame.
+    [[nodiscard]] std::span<const uint64_t> render_ns() const noexcept { return render_ns_; }
+
+    [[nodiscard]] uint32_t width() const noexcept { return width_; }
+    [[nodiscard]] uint32_t height() const noexcept { return height_; }
+
+private:
+    /// @brief A helper thread that renders one backend's band per frame.
+    struct worker {
+        std::binary_semaphore start{0};
+        std::binary_semaphore done{0};
+        std::exception_ptr    error;
+        std::jthread          thread;  // Last, so it joins before the semaphores go.
+    };
+
+    void worker_loop(size_t index) {
+        auto& self = *workers_[index - 1];
+        for (;;) {
+            self.start.acquire();
+            if (stopping_.load(std::memory_order_relaxed)) {
+                return;
+            }
+            try {
+                render_band(index);
+            } catch (...) {
+                self.error = std::current_exception();
+            }
+            self.done.release();
+        }
+    }
+
+    /// @brief Cuts the rows into contiguous bands proportional to throughput.
+    void partition() {
+        auto count = static_cast<uint32_t>(backends_.size());
+        uint32_t floor_rows = std::min(std::max(options_.min_rows, 1u), height_ / count);
+        uint32_t spare = height_ - floor_rows * count;
+
+        // Equal shares until every backend has been measured.
+        bool measured = std::all_of(throughput_.begin(), throughput_.end(), [](double t) { return t > 0.0; });
+        double total = 0.0;
+        for (double t : throughput_) {
+            total += measured ? t : 1.0;
+        }
+
+        std::vector<uint32_t> rows(count, floor_rows);
+        uint32_t given = 0;
+        size_t fastest = 0;
+        for (uint32_t i = 0; i < count; ++i) {
+            double share = (measured ? throughput_[i] : 1.0) / total;
+            auto extra = static_cast<uint32_t>(spare * share);
+            rows[i] += extra;
+            given += extra;
+            if (throughput_[i] > throughput_[fastest]) {
+                fastest = i;
+            }
+        }
+        rows[fastest] += spare - given;
+
+        uint32_t begin = 0;
+        for (uint32_t i = 0; i < count; ++i) {
+            bands_[i] = {begin, begin + rows[i]};
+            begin += rows[i];
+        }
+    }
+
+    void render_band(size_t index) {
+        const auto& band = bands_[index];
+        render_ns_[index] = 0;
+        added_[index]     = 0;
+        reset_[index]     = 0;
+        if (band.rows() == 0) {
+            return;  // Stays stale until it gets rows; an empty band would mean every row.
+        }
+        gpu::render_frame frame  = frame_;
+        frame.drawable           = nullptr;
+        frame.camera_dirty       = stale_[index];
+        frame.row_begin          = band.begin;
+        frame.row_end            = band.end;
+        frame.sample_salt        = gpu::derive_salt(frame_.sample_salt, static_cast<uint32_t>(index));
+        frame.samples_added      = 0;
+        frame.accumulation_reset = 0;
+        stale_[index]            = 0;
+
+        auto start = clock::now();
+        backends_[index]->render(&frame);
+        render_ns_[index] = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+
+        // Plugins before ABI v11 do not report; they take one sample per call.
+        added_[index] = frame.samples_added > 0 ? frame.samples_added : 1;
+        reset_[index] = frame.accumulation_reset != 0;
+    }
+
+    std::vector<Backend*> backends_;
+    splitter_options      options_;
+
+    std::vector<row_band> bands_;
+    std::vector<double>   throughput_;
+    std::vector<uint64_t> render_ns_;
+    std::vector<uint32_t> added_;    // Samples per pixel each backend took last frame.
+    std::vector<uint8_t>  reset_;    // Backend discarded its accumulation last frame.
+    std::vector<uint8_t>  stale_;    // Backend must restart accumulation on its next band.
+    std::vector<uint32_t> samples_;  // [backend * height + row] samples taken.
+
+    std::vector<float> accum_;
+    std::vector<float> display_;
+
+    gpu::render_frame frame_{};
+    uint32_t     width_  = 0;
+    uint32_t     height_ = 0;
+
+    std::atomic<bool>                    stopping_{false};
+    std::vector<std::unique_ptr<worker>> workers_;
+};
+
+/// @brief Splits frames across loaded plugins.
+using frame_splitter = basic_frame_splitter<loader>;
+
+}  // namespace Q::plugin
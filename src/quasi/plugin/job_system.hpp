@@ -0,0 +1,120 @@
+/// @file job_system.hpp
+/// @brief Host side of Q_job_system, backed by an async::thread_pool.
+
+#pragma once
+
+#include <quasi/async/thread_pool.hpp>
+#include <quasi/plugin/plugin_interface.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+/// @brief A submitted job: completion flag plus one reference for the
+///        worker and one for the waiter, so either may finish last.
+struct Q_job {
+    std::atomic<uint32_t> done{0};
+    std::atomic<uint32_t> refs{2};
+};
+
+namespace Q::plugin {
+
+/// @class job_system
+/// @brief Exposes a host thread pool to plugins through Q_plugin_context::jobs.
+///
+/// Example usage:
+/// @code
+/// async::thread_pool pool{platform::host_topology(), platform::pin_policy::physical_cores};
+/// job_system jobs{pool};
+///
+/// manager mgr{"libbackend.so"};
+/// mgr.set_job_system(&jobs);  // Quiesces the pool around every unload.
+/// @endcode
+class job_system {
+public:
+    /// @brief Wraps a pool; the pool must outlive this object.
+    explicit job_system(async::thread_pool& pool) : pool_{pool} {
+        table_.host_data    = this;
+        table_.worker_count = pool.size();
+        table_.submit       = &job_system::submit_cb;
+        table_.wait         = &job_system::wait_cb;
+        table_.parallel_for = &job_system::parallel_for_cb;
+    }
+
+    job_system(const job_system&) = delete;
+    job_system& operator=(const job_system&) = delete;
+
+    /// @brief Returns the C table to place in Q_plugin_context::jobs.
+    [[nodiscard]] job_system_table* table() noexcept {
+        return &table_;
+    }
+
+    /// @brief Returns the backing pool.
+    [[nodiscard]] async::thread_pool& pool() noexcept {
+        return pool_;
+    }
+
+    /// @brief Blocks until every job submitted through any plugin has finished.
+    ///
+    /// Call before destroying a plugin and before unloading its library.
+    void quiesce() {
+        pool_.wait_idle();
+    }
+
+private:
+    static void release(Q_job* job) {
+        if (job->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete job;
+        }
+    }
+
+    static Q_job* submit_cb(void* host_data, Q_job_fn fn, void* user_data) {
+        if (!host_data || !fn) {
+            return nullptr;
+        }
+        auto* self = static_cast<job_system*>(host_data);
+        auto* job = new Q_job{};
+        self->pool_.submit([fn, user_data, job] {
+            fn(user_data);
+            job->done.store(1, std::memory_order_release);
+            job->done.notify_all();
+            release(job);
+        });
+        return job;
+    }
+
+    static void wait_cb(void* host_data, Q_job* job) {
+        if (!host_data || !job) {
+            return;
+        }
+        auto* self = static_cast<job_system*>(host_data);
+        // Help while the job may still be queued; once every queue is
+        // empty it is running elsewhere, so park until it finishes.
+        while (job->done.load(std::memory_order_acquire) == 0) {
+            if (!self->pool_.run_pending()) {
+                job->done.wait(0, std::memory_order_acquire);
+            }
+        }
+        release(job);
+    }
+
+    static void parallel_for_cb(void* host_data, uint32_t count, uint32_t grain,
+                                Q_job_range_fn fn, void* user_data) {
+        if (!host_data || !fn || count == 0) {
+            return;
+        }
+        auto* self = static_cast<job_system*>(host_data);
+        grain = std::max(grain, 1u);
+        uint32_t chunks = (count - 1) / grain + 1;
+        self->pool_.parallel_for(chunks, [&](uint32_t chunk, uint32_t worker) {
+            uint32_t begin = chunk * grain;
+            auto end = static_cast<uint32_t>(std::min<uint64_t>(uint64_t{begin} + grain, count));
+            fn(user_data, begin, end, worker);
+        });
+    }
+
+    async::thread_pool& pool_;
+    job_system_table    table_{};
+};
+
+}  // namespace Q::plugin
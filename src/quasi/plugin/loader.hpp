@@ -4,12 +4,19 @@
 #pragma once
 
 #include <quasi/plugin/plugin_interface.hpp>
+#include <quasi/plugin/call_trace.hpp>
 #include <quasi/plugin/dynamic_library.hpp>
+#include <quasi/profile/profiler.hpp>
 
+#include <chrono>
+#include <cstdint>
 #include <expected>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
 
 namespace Q::plugin {
 
@@ -44,6 +51,12 @@ public:
     template <typename T>
     using result = std::expected<T, error>;
 
+    /// @brief Where load() spent its time, for reload statistics.
+    struct timings {
+        uint64_t resolve_ns = 0;  ///< Symbol lookup and ABI check.
+        uint64_t create_ns  = 0;  ///< Q_plugin_create().
+    };
+
     /// @brief Function pointer types matching the C interface.
     /// @{
     using abi_version_fn   = uint32_t (*)();
@@ -56,16 +69,23 @@ public:
     using readback_free_fn     = void (*)(readback_result*);
     using readback_aov_fn      = readback_aov_result (*)(plugin_handle*);
     using readback_aov_free_fn = void (*)(readback_aov_result*);
+    using capabilities_fn      = uint32_t (*)();
+    using params_fn            = const param_desc* (*)(uint32_t*);
+    using set_param_fn         = void (*)(plugin_handle*, uint32_t, double);
     /// @}
 
     /// @brief Loads a plugin from a dynamic library.
     /// @param library The library containing the plugin.
     /// @param context Host-provided context for the plugin.
+    /// @param times If non-null, receives the time spent in each step.
     /// @return The loaded plugin wrapper, or an error.
     [[nodiscard]] static result<loader> load(
         dynamic_library& library,
-        plugin_context* context
+        plugin_context* context,
+        timings* times = nullptr
     ) {
+        using clock = std::chrono::steady_clock;
+        auto start = clock::now();
         loader p;
 
         // Resolve all required symbols
@@ -127,8 +147,37 @@ public:
             p.fn_readback_aov_free_ = *sym;
         }
 
+        // Resolve optional capabilities (ABI v8+).
+        if (plugin_abi >= 8) {
+            if (auto sym = library.get_symbol<capabilities_fn>(k_symbol_capabilities)) {
+                p.capabilities_ = (*sym)();
+            }
+        }
+
+        // Resolve optional parameters (ABI v10+).
+        if (plugin_abi >= 10) {
+            auto list = library.get_symbol<params_fn>(k_symbol_params);
+            auto set  = library.get_symbol<set_param_fn>(k_symbol_set_param);
+            if (list && set) {
+                uint32_t count = 0;
+                const param_desc* params = (*list)(&count);
+                if (params && count > 0) {
+                    p.params_ = {params, count};
+                    p.fn_set_param_ = *set;
+                }
+            }
+        }
+
         // Create the plugin instance
+        auto resolved = clock::now();
         p.handle_ = p.fn_create_(context);
+        if (times) {
+            auto ns = [](clock::duration d) {
+                return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+            };
+            times->resolve_ns = ns(resolved - start);
+            times->create_ns  = ns(clock::now() - resolved);
+        }
         if (!p.handle_) {
             return std::unexpected{error::create_failed};
         }
@@ -154,6 +203,11 @@ public:
         , fn_readback_free_{std::exchange(other.fn_readback_free_, nullptr)}
         , fn_readback_aov_{std::exchange(other.fn_readback_aov_, nullptr)}
         , fn_readback_aov_free_{std::exchange(other.fn_readback_aov_free_, nullptr)}
+        , capabilities_{std::exchange(other.capabilities_, 0)}
+        , fn_set_param_{std::exchange(other.fn_set_param_, nullptr)}
+        , params_{std::exchange(other.params_, {})}
+        , profiler_{std::exchange(other.profiler_, nullptr)}
+        , recorder_{std::exchange(other.recorder_, nullptr)}
     {}
 
     loader& operator=(loader&& other) noexcept {
@@ -170,6 +224,11 @@ public:
             fn_readback_free_ = std::exchange(other.fn_readback_free_, nullptr);
             fn_readback_aov_ = std::exchange(other.fn_readback_aov_, nullptr);
             fn_readback_aov_free_ = std::exchange(other.fn_readback_aov_free_, nullptr);
+            capabilities_ = std::exchange(other.capabilities_, 0);
+            fn_set_param_ = std::exchange(other.fn_set_param_, nullptr);
+            params_ = std::exchange(other.params_, {});
+            profiler_ = std::exchange(other.profiler_, nullptr);
+            recorder_ = std::exchange(other.recorder_, nullptr);
         }
         return *this;
     }
@@ -177,10 +236,27 @@ public:
     loader(const loader&) = delete;
     loader& operator=(const loader&) = delete;
 
+    /// @brief Records every plugin call in @p prof, or stops recording if nullptr.
+    ///
+    /// Calls appear as "plugin.update", "plugin.render", "plugin.readback"
+    /// and "plugin.readback_aov". The profiler must outlive the loader.
+    void set_profiler(profile::profiler* prof) noexcept {
+        profiler_ = prof;
+    }
+
+    /// @brief Appends every update() and render() to @p recorder, or stops if nullptr.
+    ///
+    /// The recorder must outlive the loader; see call_trace.hpp for replay.
+    void set_recorder(call_recorder* recorder) noexcept {
+        recorder_ = recorder;
+    }
+
     /// @brief Calls the plugin's update function.
     /// @param delta_time Seconds since the last update.
     void update(float delta_time) {
         if (handle_ && fn_update_) {
+            if (recorder_) recorder_->record_update(delta_time);
+            auto scope = measure("plugin.update");
             fn_update_(handle_, delta_time);
         }
     }
@@ -189,6 +265,8 @@ public:
     /// @param frame Per-frame render data (drawable, command buffer, etc.)
     void render(Q::gpu::render_frame* frame) {
         if (handle_ && fn_render_) {
+            if (recorder_ && frame) recorder_->record_render(*frame);
+            auto scope = measure("plugin.render");
             fn_render_(handle_, frame);
         }
     }
@@ -201,6 +279,7 @@ public:
     /// @brief Reads back the current accumulated HDR framebuffer.
     [[nodiscard]] readback_result readback() {
         if (handle_ && fn_readback_) {
+            auto scope = measure("plugin.readback");
             return fn_readback_(handle_);
         }
         return readback_result{.data = nullptr, .width = 0, .height = 0, .channels = 0};
@@ -221,7 +300,20 @@ public:
     /// @brief Reads back all AOV buffers.
     [[nodiscard]] readback_aov_result readback_aov() {
         if (handle_ && fn_readback_aov_) {
-            return fn_readback_aov_(handle_);
+            auto scope = measure("plugin.readback_aov");
+            auto result = fn_readback_aov_(handle_);
+            uint32_t abi = abi_version();
+            if (abi < 4) {
+                // Before v4 the format field was struct padding.
+                for (auto& buffer : result.buffers) {
+                    buffer.format = Q_AOV_FORMAT_RGBA32F;
+                }
+            }
+            if (abi < 7) {
+                // Older plugins return fewer buffers; the rest is unwritten.
+                result.buffers[Q_AOV_TRAVERSAL] = aov_buffer{};
+            }
+            return result;
         }
         return readback_aov_result{};
     }
@@ -233,6 +325,28 @@ public:
         }
     }
 
+    /// @brief Returns the Q_plugin_capability bits the plugin reported (zero before ABI v8).
+    [[nodiscard]] uint32_t capabilities() const noexcept {
+        return capabilities_;
+    }
+
+    /// @brief Returns true if the plugin renders Q_render_frame row bands.
+    [[nodiscard]] bool supports_row_bands() const noexcept {
+        return (capabilities_ & Q_CAPABILITY_ROW_BANDS) != 0;
+    }
+
+    /// @brief Returns the parameters the plugin declares; empty before ABI v10.
+    [[nodiscard]] std::span<const param_desc> params() const noexcept {
+        return params_;
+    }
+
+    /// @brief Sets parameter @p index; call between frames with a value in its declared range.
+    void set_param(uint32_t index, double value) {
+        if (handle_ && fn_set_param_ && index < params_.size()) {
+            fn_set_param_(handle_, index, value);
+        }
+    }
+
     /// @brief Returns the plugin's metadata.
     [[nodiscard]] plugin_info info() const {
         if (fn_get_info_) {
@@ -268,6 +382,15 @@ public:
     }
 
 private:
+    using optional_scope = std::optional<profile::profiler::scope>;
+
+    [[nodiscard]] optional_scope measure(std::string_view name) {
+        if (!profiler_) {
+            return std::nullopt;
+        }
+        return optional_scope{std::in_place, *profiler_, name};
+    }
+
     plugin_handle* handle_ = nullptr;
 
     abi_version_fn   fn_abi_version_   = nullptr;
@@ -280,6 +403,12 @@ private:
     readback_free_fn     fn_readback_free_     = nullptr;
     readback_aov_fn      fn_readback_aov_      = nullptr;
     readback_aov_free_fn fn_readback_aov_free_ = nullptr;
+    uint32_t             capabilities_         = 0;
+    set_param_fn         fn_set_param_         = nullptr;
+    std::span<const param_desc> params_;
+
+    profile::profiler* profiler_ = nullptr;
+    call_recorder*     recorder_ = nullptr;
 };
 
 /// @brief Converts a loader error to a human-readable string.
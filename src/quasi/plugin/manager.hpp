@@ -3,19 +3,27 @@
 
 #pragma once
 
+#include <quasi/plugin/cache_store.hpp>
 #include <quasi/plugin/dynamic_library.hpp>
+#include <quasi/plugin/job_system.hpp>
 #include <quasi/plugin/plugin_interface.hpp>
 #include <quasi/plugin/loader.hpp>
+#include <quasi/plugin/params.hpp>
 #include <quasi/async/async.hpp>
+#include <quasi/log/logger.hpp>
+#include <quasi/profile/histogram.hpp>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <expected>
 #include <filesystem>
 #include <functional>
-#include <iostream>
 #include <optional>
+#include <ostream>
 #include <string>
+#include <string_view>
 #include <thread>
 
 namespace Q::plugin {
@@ -41,12 +49,72 @@ struct reload_hooks {
         [](const std::string&) {};
 };
 
+/// @brief Steps of a hot reload, in the order they happen.
+enum class reload_phase : uint32_t {
+    detect,       ///< File written until the watcher noticed.
+    unload,       ///< Pre-unload hook, plugin destroy and dlclose.
+    settle,       ///< Wait for the build to finish writing the file.
+    copy,         ///< Copy into a memfd (Linux) or to a unique temporary path.
+    dlopen,       ///< Map the copy.
+    resolve,      ///< Symbol lookup and ABI check.
+    create,       ///< Q_plugin_create().
+    post_load,    ///< Post-load hook.
+    first_frame,  ///< First render() call on the new plugin.
+};
+
+/// @brief Number of reload phases.
+inline constexpr size_t k_reload_phase_count = 9;
+
+/// @brief Returns the phase's name, as used in reports.
+[[nodiscard]] constexpr std::string_view to_string(reload_phase p) noexcept {
+    switch (p) {
+        case reload_phase::detect:      return "detect";
+        case reload_phase::unload:      return "unload";
+        case reload_phase::settle:      return "settle";
+        case reload_phase::copy:        return "copy";
+        case reload_phase::dlopen:      return "dlopen";
+        case reload_phase::resolve:     return "resolve";
+        case reload_phase::create:      return "create";
+        case reload_phase::post_load:   return "post_load";
+        case reload_phase::first_frame: return "first_frame";
+    }
+    return "unknown";
+}
+
 /// @brief Statistics about plugin reloads.
+///
+/// Histograms are in nanoseconds. A phase gets a sample each time a
+/// reload reaches it; detect only for reloads started by the file
+/// watcher. The first frame is timed on the host, so for GPU backends it
+/// covers encoding, not GPU execution.
 struct reload_stats {
     uint64_t reload_count      = 0;  ///< Total reload attempts.
     uint64_t success_count     = 0;  ///< Successful reloads.
     uint64_t failure_count     = 0;  ///< Failed reloads.
     float    last_reload_time  = 0.0f;  ///< Last reload duration in seconds.
+
+    std::array<profile::histogram, k_reload_phase_count> phases;  ///< Per-phase durations.
+
+    /// Sum of every phase of a reload that reached its first frame.
+    profile::histogram edit_to_pixel;
+
+    /// @brief Returns the histogram of one phase.
+    [[nodiscard]] const profile::histogram& phase(reload_phase p) const noexcept {
+        return phases[static_cast<size_t>(p)];
+    }
+
+    /// @brief Writes the counts and histograms as a JSON object.
+    void write_json(std::ostream& out) const {
+        out << "{\"reloads\": " << reload_count << ", \"successes\": " << success_count
+            << ", \"failures\": " << failure_count << ", \"phases\": {";
+        for (size_t i = 0; i < k_reload_phase_count; ++i) {
+            out << (i ? ",\n  " : "\n  ") << '"' << to_string(static_cast<reload_phase>(i)) << "\": ";
+            phases[i].write_json(out);
+        }
+        out << "},\n \"edit_to_pixel\": ";
+        edit_to_pixel.write_json(out);
+        out << '}';
+    }
 };
 
 /// @class manager
@@ -120,7 +188,7 @@ public:
     /// Spawn this on a scheduler to enable automatic hot-reloading.
     /// Runs indefinitely until the scheduler is stopped.
     [[nodiscard]] async::task<void> watch_and_reload_loop() {
-        std::cout << "[plugin::manager] Watching: " << library_path_ << "\n";
+        log_.info("Watching: {}", library_path_.string());
 
         while (true) {
             co_await async::wait_ms(100);  // Throttle filesystem polling
@@ -129,8 +197,8 @@ public:
                 continue;
             }
 
-            std::cout << "\n[plugin::manager] File changed: " << library_path_ << "\n";
-            co_await do_reload_async();
+            log_.info("File changed: {}", library_path_.string());
+            co_await do_reload_async(time_since_write());
         }
     }
 
@@ -151,9 +219,30 @@ public:
     /// @brief Calls the plugin's render function.
     /// @param frame Per-frame render data (drawable, command buffer, etc.)
     void render(Q::gpu::render_frame* frame) {
-        if (plugin_) {
+        if (!plugin_) {
+            return;
+        }
+        if (params_ && params_->pending()) {
+            params_->apply(*plugin_);
+        }
+        if (!first_frame_pending_) {
             plugin_->render(frame);
+            return;
         }
+        auto start = clock::now();
+        plugin_->render(frame);
+        uint64_t ns = elapsed_ns(start);
+        first_frame_pending_ = false;
+        record(reload_phase::first_frame, ns);
+        stats_.edit_to_pixel.add(pending_reload_ns_ + ns);
+    }
+
+    /// @brief Sets how long a reload waits for the build to finish writing.
+    ///
+    /// Defaults to 300 ms. Build tools that replace the file atomically
+    /// (write elsewhere, then rename) can use zero.
+    void set_settle_time(std::chrono::milliseconds settle) {
+        settle_time_ = settle;
     }
 
     /// @brief Sets the viewport dimensions in the plugin context.
@@ -182,6 +271,38 @@ public:
         context_.log = fn;
     }
 
+    /// @brief Shares a host job system with the plugin.
+    ///
+    /// The manager quiesces it before destroying the plugin and again
+    /// before unloading the library. Takes effect on the next load.
+    /// @param jobs Job system that outlives the manager, or nullptr.
+    void set_job_system(job_system* jobs) {
+        jobs_ = jobs;
+        context_.jobs = jobs ? jobs->table() : nullptr;
+    }
+
+    /// @brief Shares a host cache with the plugin.
+    ///
+    /// The store belongs to the host, so whatever a plugin puts in it is
+    /// there for the next instance after a reload. Takes effect on the next
+    /// load.
+    /// @param cache Cache that outlives the manager, or nullptr.
+    void set_cache(cache_store* cache) {
+        context_.cache = cache ? cache->table() : nullptr;
+    }
+
+    /// @brief Passes host parameter values to the plugin.
+    ///
+    /// Changed values are applied before the next render, and all of them
+    /// after every load, so a reloaded plugin starts with the same settings.
+    /// @param params Registry that outlives the manager, or nullptr.
+    void set_params(param_registry* params) {
+        params_ = params;
+        if (params_ && plugin_) {
+            params_->apply(*plugin_, true);
+        }
+    }
+
     /// @brief Checks if a plugin is currently loaded and valid.
     [[nodiscard]] bool is_loaded() const noexcept {
         return plugin_.has_value() && plugin_->is_valid();
@@ -206,103 +327,112 @@ public:
     }
 
 private:
-    async::task<result<void>> do_reload_async() {
-        using clock = std::chrono::steady_clock;
+    using clock = std::chrono::steady_clock;
+
+    [[nodiscard]] static uint64_t elapsed_ns(clock::time_point since) noexcept {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - since).count());
+    }
+
+    /// @brief Age of the library file, or nullopt if it cannot be read.
+    [[nodiscard]] std::optional<uint64_t> time_since_write() const {
+        std::error_code ec;
+        auto written = std::filesystem::last_write_time(library_path_, ec);
+        if (ec) {
+            return std::nullopt;
+        }
+        auto age = std::chrono::file_clock::now() - written;
+        return static_cast<uint64_t>(
+            std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::nanoseconds>(age).count()));
+    }
+
+    /// @brief Adds one sample to a phase; phases reached so far also add up
+    ///        toward edit_to_pixel.
+    void record(reload_phase phase, uint64_t ns) {
+        stats_.phases[static_cast<size_t>(phase)].add(ns);
+        pending_reload_ns_ += ns;
+    }
+
+    async::task<result<void>> do_reload_async(std::optional<uint64_t> detect_ns = std::nullopt) {
         auto start_time = clock::now();
 
         ++stats_.reload_count;
+        first_frame_pending_ = false;
+        pending_reload_ns_   = 0;
+        if (detect_ns) {
+            record(reload_phase::detect, *detect_ns);
+        }
 
-        std::cout << "[plugin::manager] Starting reload...\n";
+        log_.info("Starting reload...");
 
         // Run pre-unload hook
-        std::cout << "[plugin::manager] Pre-unload hook...\n";
-        {
-            auto task = hooks_.pre_unload();
-            while (!task.done()) {
-                task.resume();
-            }
-        }
+        log_.info("Pre-unload hook...");
+        auto phase_start = clock::now();
+        async::sync_wait(hooks_.pre_unload());
 
         unload_current();
+        record(reload_phase::unload, elapsed_ns(phase_start));
 
         // Wait for filesystem to settle
-        std::cout << "[plugin::manager] Waiting for filesystem...\n";
-        std::this_thread::sleep_for(std::chrono::milliseconds{300});
+        log_.info("Waiting for filesystem...");
+        phase_start = clock::now();
+        std::this_thread::sleep_for(settle_time_);
+        record(reload_phase::settle, elapsed_ns(phase_start));
 
         // Load new plugin
-        std::cout << "[plugin::manager] Loading new library...\n";
+        log_.info("Loading new library...");
         result<void> load_result;
         try {
-            load_result = do_load();
+            load_result = do_load(true);
         } catch (const std::exception& e) {
-            std::cerr << "[plugin::manager] Exception: " << e.what() << "\n";
+            log_.error("Exception: {}", e.what());
             load_result = std::unexpected{error::load_failed};
         }
 
         if (!load_result) {
             ++stats_.failure_count;
             hooks_.on_error("Load failed");
-            std::cerr << "[plugin::manager] Reload failed!\n";
+            log_.error("Reload failed!");
             co_return std::unexpected{load_result.error()};
         }
 
         // Run post-load hook
-        std::cout << "[plugin::manager] Post-load hook...\n";
-        {
-            auto task = hooks_.post_load();
-            while (!task.done()) {
-                task.resume();
-            }
-        }
+        log_.info("Post-load hook...");
+        phase_start = clock::now();
+        async::sync_wait(hooks_.post_load());
+        record(reload_phase::post_load, elapsed_ns(phase_start));
+        first_frame_pending_ = true;
 
         ++stats_.success_count;
         auto elapsed = clock::now() - start_time;
         stats_.last_reload_time = std::chrono::duration<float>(elapsed).count();
 
-        std::cout << "[plugin::manager] Reload complete in "
-                  << (stats_.last_reload_time * 1000.0f) << " ms\n";
+        log_.info("Reload complete in {} ms", stats_.last_reload_time * 1000.0f);
 
         watcher_.refresh_timestamp();
 
         co_return result<void>{};
     }
 
-    result<void> do_load() {
+    /// @param timed Record the copy, dlopen, resolve and create phases.
+    result<void> do_load(bool timed = false) {
         // Clean up previous temp file before creating a new one.
         cleanup_temp_file();
 
-        auto temp_path = make_temp_library_path();
-
-        try {
-            if (std::filesystem::exists(temp_path)) {
-                std::filesystem::remove(temp_path);
-            }
-            std::filesystem::copy_file(
-                library_path_,
-                temp_path,
-                std::filesystem::copy_options::overwrite_existing
-            );
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "[plugin::manager] Copy failed: " << e.what() << "\n";
-            return std::unexpected{error::load_failed};
-        }
-
-        // Track this temp file for cleanup.
-        temp_path_ = temp_path;
-
-        auto lib_result = dynamic_library::open(temp_path);
+        auto lib_result = open_copy(timed);
         if (!lib_result) {
-            std::cerr << "[plugin::manager] dlopen failed: "
-                      << dynamic_library::last_error() << "\n";
-            return std::unexpected{error::load_failed};
+            return std::unexpected{lib_result.error()};
         }
-
         library_ = std::move(*lib_result);
 
-        auto loader_result = loader::load(library_, &context_);
+        loader::timings times;
+        auto loader_result = loader::load(library_, &context_, &times);
+        if (timed && times.resolve_ns > 0) {  // Zero if load() stopped before create.
+            record(reload_phase::resolve, times.resolve_ns);
+            record(reload_phase::create, times.create_ns);
+        }
         if (!loader_result) {
-            std::cerr << "[plugin::manager] Plugin load failed: "
-                      << to_string(loader_result.error()) << "\n";
+            log_.error("Plugin load failed: {}", to_string(loader_result.error()));
             library_.close();
 
             switch (loader_result.error()) {
@@ -317,18 +447,80 @@ private:
         }
 
         plugin_ = std::move(*loader_result);
+        if (params_) {
+            params_->apply(*plugin_, true);
+        }
 
         if (auto i = info()) {
-            std::cout << "[plugin::manager] Loaded: " << i->name
-                      << " v" << i->version.major
-                      << "." << i->version.minor
-                      << "." << i->version.patch << "\n";
+            log_.info("Loaded: {} v{}.{}.{}", i->name, i->version.major, i->version.minor,
+                      i->version.patch);
         }
 
         watcher_.refresh_timestamp();
         return {};
     }
 
+    /// @brief Loads a private copy of the library, so the build on disk can be replaced.
+    ///
+    /// On Linux the copy is a memfd: no disk writes, and no files left
+    /// behind by a crash. Elsewhere, or if the memfd cannot be created or
+    /// opened, it is a uniquely named file in the temporary directory.
+    result<dynamic_library> open_copy(bool timed) {
+        auto phase_start = clock::now();
+#if defined(Q_PLATFORM_LINUX)
+        if (auto image = library_image::copy(library_path_)) {
+            if (timed) {
+                record(reload_phase::copy, elapsed_ns(phase_start));
+            }
+            phase_start = clock::now();
+            if (auto lib = dynamic_library::open(std::move(*image))) {
+                if (timed) {
+                    record(reload_phase::dlopen, elapsed_ns(phase_start));
+                }
+                return std::move(*lib);
+            }
+            log_.warn("dlopen of in-memory copy failed ({}); using a temporary file",
+                      dynamic_library::last_error());
+        } else if (image.error() == library_error::file_not_found) {
+            log_.error("Copy failed: {} not found", library_path_.string());
+            return std::unexpected{error::load_failed};
+        }
+        phase_start = clock::now();
+#endif
+
+        auto temp_path = make_temp_library_path();
+        try {
+            if (std::filesystem::exists(temp_path)) {
+                std::filesystem::remove(temp_path);
+            }
+            std::filesystem::copy_file(
+                library_path_,
+                temp_path,
+                std::filesystem::copy_options::overwrite_existing
+            );
+        } catch (const std::filesystem::filesystem_error& e) {
+            log_.error("Copy failed: {}", e.what());
+            return std::unexpected{error::load_failed};
+        }
+
+        // Track this temp file for cleanup.
+        temp_path_ = temp_path;
+        if (timed) {
+            record(reload_phase::copy, elapsed_ns(phase_start));
+        }
+
+        phase_start = clock::now();
+        auto lib_result = dynamic_library::open(temp_path);
+        if (!lib_result) {
+            log_.error("dlopen failed: {}", dynamic_library::last_error());
+            return std::unexpected{error::load_failed};
+        }
+        if (timed) {
+            record(reload_phase::dlopen, elapsed_ns(phase_start));
+        }
+        return std::move(*lib_result);
+    }
+
     [[nodiscard]] path_type make_temp_library_path() const {
         auto filename = library_path_.filename().string();
         auto temp_dir = std::filesystem::temp_directory_path();
@@ -348,14 +540,25 @@ private:
     }
 
     void unload_current() {
+        // Jobs may still reference plugin state, and run plugin code.
         if (plugin_) {
-            std::cout << "[plugin::manager] Destroying plugin...\n";
+            quiesce_jobs();
+            log_.info("Destroying plugin...");
             plugin_->destroy();
             plugin_.reset();
         }
         if (library_.is_loaded()) {
+            quiesce_jobs();
+            // Queued records may point into the library (format strings).
+            log::default_logger().flush();
             library_.close();
-            std::cout << "[plugin::manager] Library unloaded.\n";
+            log_.info("Library unloaded.");
+        }
+    }
+
+    void quiesce_jobs() {
+        if (jobs_) {
+            jobs_->quiesce();
         }
     }
 
@@ -365,7 +568,13 @@ private:
     async::file_watcher     watcher_;
     reload_hooks            hooks_;
     reload_stats            stats_;
+    std::chrono::milliseconds settle_time_{300};
+    uint64_t                pending_reload_ns_   = 0;  ///< Phases so far of the latest reload.
+    bool                    first_frame_pending_ = false;
     plugin_context          context_{};
+    job_system*             jobs_ = nullptr;
+    param_registry*         params_ = nullptr;
+    log::channel&           log_ = log::default_logger().get("plugin::manager");
     std::optional<loader>   plugin_;
 };
 
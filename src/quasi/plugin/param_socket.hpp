@@ -0,0 +1,284 @@
+/// @file param_socket.hpp
+/// @brief Local control socket for setting plugin parameters on a running host.
+///
+/// A Unix domain stream socket that takes one command per line and answers
+/// each with one or more lines, the last being "ok" or "error: <reason>":
+/// @code
+/// $ echo max_bounces=8 | nc -U /tmp/quasi.params
+/// ok
+/// $ printf 'get max_bounces\nlist\n' | nc -U /tmp/quasi.params
+/// max_bounces=8
+/// ok
+/// max_bounces=8 int [1, 16] Longest path, in bounces.
+/// ...
+/// ok
+/// @endcode
+/// The socket never blocks: the render loop calls poll() once per frame
+/// and the values it sets are applied before that frame renders.
+
+#pragma once
+
+#include <quasi/platform.hpp>
+#include <quasi/plugin/params.hpp>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace Q::plugin {
+
+/// @brief Clears the way for a Unix socket at @p addr, removing only a stale socket.
+///
+/// A socket file nobody listens on (connect() is refused) was left by a
+/// process that exited and is unlinked. A live socket, or a path that is
+/// not a socket at all, is left alone and reported, so a second instance
+/// cannot steal a running one's socket or delete a file by mistake.
+/// @return Success if nothing is at the path now.
+[[nodiscard]] inline std::expected<void, param_error> remove_stale_socket(const sockaddr_un& addr) {
+    struct stat st{};
+    if (::lstat(addr.sun_path, &st) != 0) {
+        if (errno == ENOENT) {
+            return {};
+        }
+        return std::unexpected{param_error::socket_failed};
+    }
+    if (!S_ISSOCK(st.st_mode)) {
+        return std::unexpected{param_error::path_exists};
+    }
+
+    int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe < 0) {
+        return std::unexpected{param_error::socket_failed};
+    }
+    int result = ::connect(probe, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+    int error = result == 0 ? 0 : errno;
+    ::close(probe);
+    if (error == ENOENT) {
+        return {};  // Removed since the lstat.
+    }
+    if (error != ECONNREFUSED) {
+        return std::unexpected{param_error::socket_in_use};
+    }
+    if (::unlink(addr.sun_path) != 0 && errno != ENOENT) {
+        return std::unexpected{param_error::socket_failed};
+    }
+    return {};
+}
+
+/// @class param_socket
+/// @brief Serves param_registry commands over a Unix domain socket.
+///
+/// Example usage:
+/// @code
+/// auto control = param_socket::listen("/tmp/quasi.params");
+/// for (;;) {
+///     if (control) {
+///         control->poll(params);
+///     }
+///     params.apply(plugin);
+///     plugin.render(&frame);
+/// }
+/// @endcode
+class param_socket {
+public:
+    /// @brief Bytes a client may send without a newline before it is dropped.
+    static constexpr size_t k_max_line = 4096;
+
+    /// @brief Creates the socket at @p path, replacing a stale one (see remove_stale_socket()).
+    [[nodiscard]] static std::expected<param_socket, param_error> listen(std::filesystem::path path) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.native().size() >= sizeof(addr.sun_path)) {
+            return std::unexpected{param_error::socket_failed};
+        }
+        std::memcpy(addr.sun_path, path.c_str(), path.native().size());
+        if (auto cleared = remove_stale_socket(addr); !cleared) {
+            return std::unexpected{cleared.error()};
+        }
+
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return std::unexpected{param_error::socket_failed};
+        }
+        if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 4) != 0 ||
+            !set_nonblocking(fd)) {
+            ::close(fd);
+            return std::unexpected{param_error::socket_failed};
+        }
+        return param_socket{fd, std::move(path)};
+    }
+
+    param_socket(param_socket&& other) noexcept
+        : fd_{std::exchange(other.fd_, -1)}
+        , path_{std::move(other.path_)}
+        , clients_{std::move(other.clients_)} {
+        other.path_.clear();
+    }
+
+    param_socket& operator=(param_socket&& other) noexcept {
+        if (this != &other) {
+            close();
+            fd_      = std::exchange(other.fd_, -1);
+            path_    = std::move(other.path_);
+            clients_ = std::move(other.clients_);
+            other.path_.clear();
+        }
+        return *this;
+    }
+
+    param_socket(const param_socket&) = delete;
+    param_socket& operator=(const param_socket&) = delete;
+
+    ~param_socket() {
+        close();
+    }
+
+    /// @brief Accepts new clients and runs every complete command received.
+    /// @return The number of commands run.
+    size_t poll(param_registry& params) {
+        for (;;) {
+            int client = ::accept(fd_, nullptr, nullptr);
+            if (client < 0) {
+                break;
+            }
+            if (!set_nonblocking(client)) {
+                ::close(client);
+                continue;
+            }
+#if defined(Q_PLATFORM_MACOS)
+            int one = 1;
+            ::setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+            clients_.push_back({client, {}});
+        }
+
+        size_t commands = 0;
+        for (auto& c : clients_) {
+            bool open = read_available(c);
+            size_t start = 0;
+            for (size_t end; (end = c.input.find('\n', start)) != std::string::npos; start = end + 1) {
+                send(c.fd, run(params, std::string_view{c.input}.substr(start, end - start)));
+                ++commands;
+            }
+            c.input.erase(0, start);
+            if (!open || c.input.size() > k_max_line) {
+                ::close(c.fd);
+                c.fd = -1;
+            }
+        }
+        std::erase_if(clients_, [](const client& c) { return c.fd < 0; });
+        return commands;
+    }
+
+    /// @brief Runs one command and returns the reply, newline-terminated.
+    [[nodiscard]] static std::string run(param_registry& params, std::string_view command) {
+        command = detail::trim(command);
+        if (command.empty()) {
+            return "ok\n";
+        }
+        if (command == "list") {
+            std::string reply;
+            for (const auto& d : params.declared()) {
+                reply += format_value(d.name, params.get(d.name).value_or(d.default_value));
+                reply += ' ';
+                reply += to_string(d.type);
+                char range[64];
+                std::snprintf(range, sizeof(range), " [%g, %g] ", d.min_value, d.max_value);
+                reply += range;
+                reply += d.description;
+                reply += '\n';
+            }
+            return reply + "ok\n";
+        }
+        if (command.starts_with("get ")) {
+            auto name = detail::trim(command.substr(4));
+            auto value = params.get(name);
+            if (!value) {
+                return "error: " + std::string{to_string(param_error::unknown_param)} + '\n';
+            }
+            return format_value(name, *value) + "\nok\n";
+        }
+        auto result = params.set(command);
+        if (!result) {
+            return "error: " + std::string{to_string(result.error())} + '\n';
+        }
+        return "ok\n";
+    }
+
+    /// @brief Returns the socket's path.
+    [[nodiscard]] const std::filesystem::path& path() const noexcept {
+        return path_;
+    }
+
+private:
+    struct client {
+        int         fd = -1;
+        std::string input;
+    };
+
+    param_socket(int fd, std::filesystem::path path) : fd_{fd}, path_{std::move(path)} {}
+
+    static bool set_nonblocking(int fd) {
+        int flags = ::fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    static std::string format_value(std::string_view name, double value) {
+        char text[64];
+        std::snprintf(text, sizeof(text), "=%g", value);
+        return std::string{name} + text;
+    }
+
+    /// @brief Appends what the client has sent; false once it has hung up.
+    static bool read_available(client& c) {
+        char buffer[512];
+        for (;;) {
+            ssize_t n = ::read(c.fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                c.input.append(buffer, static_cast<size_t>(n));
+                continue;
+            }
+            return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+        }
+    }
+
+    static void send(int fd, const std::string& reply) {
+#if defined(MSG_NOSIGNAL)
+        constexpr int flags = MSG_NOSIGNAL;
+#else
+        constexpr int flags = 0;  // SO_NOSIGPIPE is set on accept.
+#endif
+        // Replies are short; one that does not fit the socket buffer is cut off.
+        (void)::send(fd, reply.data(), reply.size(), flags);
+    }
+
+    void close() {
+        for (auto& c : clients_) {
+            ::close(c.fd);
+        }
+        clients_.clear();
+        if (fd_ >= 0) {
+            ::close(fd_);
+            ::unlink(path_.c_str());
+            fd_ = -1;
+        }
+    }
+
+    int                   fd_ = -1;
+    std::filesystem::path path_;
+    std::vector<client>   clients_;
+};
+
+}  // namespace Q::plugin
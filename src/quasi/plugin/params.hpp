@@ -0,0 +1,341 @@
+/// @file params.hpp
+/// @brief Host side of plugin parameters: typed values set without a reload.
+///
+/// Plugins declare their tunables through Q_plugin_params() (ABI v10+).
+/// The host keeps the values the user has set in a param_registry, fed
+/// from the command line, a watched file or a param_socket, and hands
+/// changes to the plugin between frames through Q_plugin_set_param(). The
+/// plugin keeps its scene, BVH and pipelines, so trying another bounce
+/// depth costs one frame instead of a rebuild and hot reload.
+///
+/// Values outlive the plugin: after a reload the registry applies all of
+/// them to the new instance. Parameter files hold one assignment per line:
+/// @code
+/// # quality.params
+/// max_bounces = 8
+/// samples_per_frame = 4
+/// @endcode
+
+#pragma once
+
+#include <quasi/plugin/plugin_interface.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Q::plugin {
+
+/// @brief Error codes for parameter operations.
+enum class param_error {
+    bad_syntax,     ///< Not of the form "name=value".
+    bad_value,      ///< The value is not a number or boolean.
+    unknown_param,  ///< The plugin declares no parameter of that name.
+    open_failed,    ///< The parameter file could not be read.
+    socket_failed,  ///< The control socket could not be created.
+    socket_in_use,  ///< Another process is listening on the socket path.
+    path_exists,    ///< The socket path is taken by something that is not a socket.
+};
+
+/// @brief Converts a param_error to a human-readable string.
+/// @param err The error code.
+/// @return String description of the error.
+[[nodiscard]] constexpr std::string_view to_string(param_error err) noexcept {
+    switch (err) {
+        case param_error::bad_syntax:    return "expected name=value";
+        case param_error::bad_value:     return "bad value";
+        case param_error::unknown_param: return "unknown parameter";
+        case param_error::open_failed:   return "failed to open parameter file";
+        case param_error::socket_failed: return "failed to create parameter socket";
+        case param_error::socket_in_use: return "another process is listening on the socket";
+        case param_error::path_exists:   return "socket path exists and is not a socket";
+    }
+    return "unknown error";
+}
+
+/// @brief Returns the name of a parameter type.
+[[nodiscard]] constexpr std::string_view to_string(Q_param_type type) noexcept {
+    switch (type) {
+        case Q_PARAM_FLOAT: return "float";
+        case Q_PARAM_INT:   return "int";
+        case Q_PARAM_BOOL:  return "bool";
+    }
+    return "unknown";
+}
+
+/// @brief A parameter name and value.
+struct param_assignment {
+    std::string name;
+    double      value = 0.0;
+};
+
+namespace detail {
+
+[[nodiscard]] inline std::string_view trim(std::string_view s) noexcept {
+    auto first = s.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    auto last = s.find_last_not_of(" \t\r\n");
+    return s.substr(first, last - first + 1);
+}
+
+}  // namespace detail
+
+/// @brief Parses a value: a number, or true/false, on/off, yes/no.
+[[nodiscard]] inline std::expected<double, param_error> parse_param_value(std::string_view text) {
+    text = detail::trim(text);
+    if (text == "true" || text == "on" || text == "yes") {
+        return 1.0;
+    }
+    if (text == "false" || text == "off" || text == "no") {
+        return 0.0;
+    }
+    double value = 0.0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (text.empty() || ec != std::errc{} || end != text.data() + text.size() || !std::isfinite(value)) {
+        return std::unexpected{param_error::bad_value};
+    }
+    return value;
+}
+
+/// @brief Parses "name=value" or "name value".
+[[nodiscard]] inline std::expected<param_assignment, param_error> parse_assignment(std::string_view text) {
+    text = detail::trim(text);
+    auto split = text.find('=');
+    if (split == std::string_view::npos) {
+        split = text.find_first_of(" \t");
+    }
+    if (split == std::string_view::npos) {
+        return std::unexpected{param_error::bad_syntax};
+    }
+    auto name = detail::trim(text.substr(0, split));
+    if (name.empty()) {
+        return std::unexpected{param_error::bad_syntax};
+    }
+    auto value = parse_param_value(text.substr(split + 1));
+    if (!value) {
+        return std::unexpected{value.error()};
+    }
+    return param_assignment{std::string{name}, *value};
+}
+
+/// @brief Clamps @p value to the declared range and rounds it to the declared type.
+[[nodiscard]] inline double coerce(const param_desc& desc, double value) noexcept {
+    switch (desc.type) {
+        case Q_PARAM_BOOL:
+            return value != 0.0 ? 1.0 : 0.0;
+        case Q_PARAM_INT:
+            value = std::round(value);
+            break;
+        case Q_PARAM_FLOAT:
+            break;
+    }
+    return std::clamp(value, desc.min_value, desc.max_value);
+}
+
+/// @class param_registry
+/// @brief Holds the parameter values the user has set and applies them to a plugin.
+///
+/// Until a plugin is attached any name is accepted, so command-line values
+/// can be collected before the first load. Afterwards names are checked
+/// against the plugin's declarations and values are coerced to them. Not
+/// thread-safe: set, poll and apply from the render thread.
+///
+/// Example usage:
+/// @code
+/// param_registry params;
+/// params.set("max_bounces=8");
+/// params.watch_file("quality.params");
+///
+/// for (;;) {
+///     params.poll_file();
+///     params.apply(plugin);  // Only values that changed since the last apply.
+///     plugin.render(&frame);
+/// }
+/// @endcode
+class param_registry {
+public:
+    param_registry() = default;
+    param_registry(const param_registry&) = delete;
+    param_registry& operator=(const param_registry&) = delete;
+    param_registry(param_registry&&) = default;
+    param_registry& operator=(param_registry&&) = default;
+
+    /// @brief Sets a value, to be passed to the plugin at the next apply().
+    std::expected<void, param_error> set(std::string_view name, double value) {
+        if (!std::isfinite(value)) {
+            return std::unexpected{param_error::bad_value};
+        }
+        if (!declared_.empty()) {
+            const param_desc* desc = find(name);
+            if (!desc) {
+                return std::unexpected{param_error::unknown_param};
+            }
+            value = coerce(*desc, value);
+        }
+        auto [it, inserted] = values_.try_emplace(std::string{name});
+        it->second.dirty = it->second.dirty || inserted || it->second.value != value;
+        it->second.value = value;
+        return {};
+    }
+
+    /// @brief Sets a value from "name=value".
+    std::expected<void, param_error> set(std::string_view assignment) {
+        auto parsed = parse_assignment(assignment);
+        if (!parsed) {
+            return std::unexpected{parsed.error()};
+        }
+        return set(parsed->name, parsed->value);
+    }
+
+    /// @brief Sets every assignment in a file; blank lines and '#' comments are skipped.
+    ///
+    /// Nothing is set unless every line parses.
+    /// @return The number of values set.
+    std::expected<size_t, param_error> load_file(const std::filesystem::path& path) {
+        std::ifstream in{path};
+        if (!in) {
+            return std::unexpected{param_error::open_failed};
+        }
+        std::vector<param_assignment> assignments;
+        std::string line;
+        while (std::getline(in, line)) {
+            std::string_view text = line;
+            text = detail::trim(text.substr(0, text.find('#')));
+            if (text.empty()) {
+                continue;
+            }
+            auto parsed = parse_assignment(text);
+            if (!parsed) {
+                return std::unexpected{parsed.error()};
+            }
+            assignments.push_back(std::move(*parsed));
+        }
+        for (const auto& a : assignments) {
+            if (auto r = set(a.name, a.value); !r) {
+                return std::unexpected{r.error()};
+            }
+        }
+        return assignments.size();
+    }
+
+    /// @brief Loads @p path now and again whenever poll_file() sees it modified.
+    std::expected<size_t, param_error> watch_file(std::filesystem::path path) {
+        watched_ = std::move(path);
+        std::error_code ec;
+        watched_time_ = std::filesystem::last_write_time(watched_, ec);
+        return load_file(watched_);
+    }
+
+    /// @brief Reloads the watched file if it changed since the last load.
+    /// @return True if it was reloaded.
+    std::expected<bool, param_error> poll_file() {
+        if (watched_.empty()) {
+            return false;
+        }
+        std::error_code ec;
+        auto written = std::filesystem::last_write_time(watched_, ec);
+        if (ec || written == watched_time_) {
+            return false;  // A missing file keeps the values it last held.
+        }
+        watched_time_ = written;
+        auto loaded = load_file(watched_);
+        if (!loaded) {
+            return std::unexpected{loaded.error()};
+        }
+        return true;
+    }
+
+    /// @brief Passes values to @p plugin through set_param().
+    ///
+    /// Also records the plugin's declarations; call it with @p all after
+    /// every load, since a new build may declare different parameters.
+    /// Values for names the plugin does not declare are kept for later.
+    /// @param all Apply every value, not only those changed since the last apply.
+    /// @return The number of values applied.
+    template <typename Plugin>
+    size_t apply(Plugin& plugin, bool all = false) {
+        declare(plugin.params());
+        size_t applied = 0;
+        for (uint32_t i = 0; i < declared_.size(); ++i) {
+            auto it = values_.find(declared_[i].name);
+            if (it == values_.end() || !(all || it->second.dirty)) {
+                continue;
+            }
+            it->second.value = coerce(declared_[i], it->second.value);
+            plugin.set_param(i, it->second.value);
+            ++applied;
+        }
+        for (auto& [name, v] : values_) {
+            v.dirty = false;
+        }
+        return applied;
+    }
+
+    /// @brief Returns the value set for @p name, else its declared default.
+    [[nodiscard]] std::optional<double> get(std::string_view name) const {
+        if (auto it = values_.find(name); it != values_.end()) {
+            return it->second.value;
+        }
+        if (const param_desc* desc = find(name)) {
+            return desc->default_value;
+        }
+        return std::nullopt;
+    }
+
+    /// @brief Returns the declarations of the plugin last applied to.
+    [[nodiscard]] std::span<const param_desc> declared() const noexcept {
+        return declared_;
+    }
+
+    /// @brief Returns true if a value changed since the last apply().
+    [[nodiscard]] bool pending() const noexcept {
+        return std::any_of(values_.begin(), values_.end(), [](const auto& v) { return v.second.dirty; });
+    }
+
+private:
+    struct entry {
+        double value = 0.0;
+        bool   dirty = false;
+    };
+
+    /// @brief Copies declarations, strings included, so they outlive the library.
+    void declare(std::span<const param_desc> params) {
+        strings_.clear();
+        strings_.reserve(params.size() * 2);
+        declared_.assign(params.begin(), params.end());
+        for (auto& d : declared_) {
+            d.name        = strings_.emplace_back(d.name ? d.name : "").c_str();
+            d.description = strings_.emplace_back(d.description ? d.description : "").c_str();
+        }
+    }
+
+    [[nodiscard]] const param_desc* find(std::string_view name) const noexcept {
+        for (const auto& d : declared_) {
+            if (d.name && name == d.name) {
+                return &d;
+            }
+        }
+        return nullptr;
+    }
+
+    std::map<std::string, entry, std::less<>> values_;
+    std::vector<param_desc>                   declared_;
+    std::vector<std::string>                  strings_;  // Names and descriptions in declared_.
+
+    std::filesystem::path           watched_;
+    std::filesystem::file_time_type watched_time_{};
+};
+
+}  // namespace Q::plugin
@@ -7,9 +7,18 @@
 #pragma once
 
 #include <quasi/plugin/plugin_interface.hpp>
+#include <quasi/plugin/cache_store.hpp>
+#include <quasi/plugin/call_trace.hpp>
 #include <quasi/plugin/dynamic_library.hpp>
+#include <quasi/plugin/frame_splitter.hpp>
+#include <quasi/plugin/job_system.hpp>
 #include <quasi/plugin/loader.hpp>
 #include <quasi/plugin/manager.hpp>
+#include <quasi/plugin/param_socket.hpp>
+#include <quasi/plugin/params.hpp>
+#include <quasi/plugin/profiler_bridge.hpp>
+#include <quasi/plugin/render_server.hpp>
+#include <quasi/plugin/result_cache.hpp>
 
 namespace Q::plugin {
 
@@ -41,6 +41,98 @@ struct Q_plugin_info {
     const char*       author;       ///< Author or organization.
 };
 
+/// @brief Opaque handle to one job submitted through Q_job_system::submit.
+struct Q_job;
+
+/// @brief Job body: runs once on a host worker.
+typedef void (*Q_job_fn)(void* user_data);
+
+/// @brief Range body for Q_job_system::parallel_for.
+/// @param begin First index of the chunk.
+/// @param end One past the last index of the chunk.
+/// @param worker Index of the running worker, in [0, worker_count).
+typedef void (*Q_job_range_fn)(void* user_data, uint32_t begin, uint32_t end, uint32_t worker);
+
+/// @brief Host-owned worker pool shared by every plugin (ABI v5+).
+///
+/// Plugins must not start threads of their own: all plugins then share one
+/// pool sized to the machine, and no plugin code runs on a thread the host
+/// cannot account for when it unloads the library. Before destroying a
+/// plugin and again before unloading its library, the host waits until
+/// every submitted job has finished.
+///
+/// Job bodies must not throw and must not outlive the plugin instance:
+/// wait for every job submitted before returning from Q_plugin_destroy().
+struct Q_job_system {
+    void*    host_data;     ///< Passed back to every callback.
+    uint32_t worker_count;  ///< Number of workers; size per-worker scratch with this.
+
+    /// @brief Queues fn(user_data) to run on a worker.
+    /// @return A handle that must be passed to wait() exactly once.
+    Q_job* (*submit)(void* host_data, Q_job_fn fn, void* user_data);
+
+    /// @brief Blocks until a submitted job finishes, then releases its handle.
+    ///
+    /// The calling thread runs other queued jobs while it waits, so jobs
+    /// may wait for jobs they submit.
+    void (*wait)(void* host_data, Q_job* job);
+
+    /// @brief Calls fn over [0, count) in chunks of at most grain and waits.
+    ///
+    /// Neighbouring chunks tend to run on workers sharing a cache. Called
+    /// from inside a job, the loop runs inline on the calling worker.
+    void (*parallel_for)(void* host_data, uint32_t count, uint32_t grain,
+                         Q_job_range_fn fn, void* user_data);
+};
+
+/// @brief Host profiler for plugin-internal stages (ABI v6+).
+///
+/// Scopes nest per thread and must be closed on the thread that opened
+/// them. The host records wall time and, where the machine allows,
+/// hardware counters for each scope, so a backend's own stages show up in
+/// the host's benchmark and trace output next to the plugin calls. The
+/// name must stay valid until the scope ends; string literals are fine.
+struct Q_profiler {
+    void* host_data;  ///< Passed back to every callback.
+
+    /// @brief Opens a scope named @p name on the calling thread.
+    void (*begin)(void* host_data, const char* name);
+
+    /// @brief Closes the calling thread's innermost open scope.
+    void (*end)(void* host_data);
+};
+
+/// @brief A value read from the host cache; see Q_cache::get.
+struct Q_cache_blob {
+    const void* data;   ///< Read-only bytes, valid until released.
+    size_t      size;   ///< Size of data in bytes.
+    void*       token;  ///< Host bookkeeping for Q_cache::release.
+};
+
+/// @brief Host key-value cache for the results of expensive setup (ABI v9+).
+///
+/// Meant for anything a plugin would otherwise rebuild on every create:
+/// compiled shaders, acceleration structures, sampling tables. Keys are
+/// content addresses: derive each key from every input of the value
+/// (source text, compile options, scene data, a format version), so an
+/// entry never goes stale and nothing is ever invalidated. The host keeps
+/// entries in memory across plugin reloads, evicting the least recently
+/// used, and may also keep them on disk across runs. Callbacks are thread
+/// safe. Bytes are stored as given: keep values free of pointers.
+struct Q_cache {
+    void* host_data;  ///< Passed back to every callback.
+
+    /// @brief Looks up @p key and, if present, fills @p blob.
+    /// @return Non-zero on a hit; every hit must be released.
+    uint32_t (*get)(void* host_data, const void* key, size_t key_size, Q_cache_blob* blob);
+
+    /// @brief Releases a blob returned by get().
+    void (*release)(void* host_data, Q_cache_blob* blob);
+
+    /// @brief Stores a copy of @p size bytes under @p key, replacing any previous value.
+    void (*put)(void* host_data, const void* key, size_t key_size, const void* data, size_t size);
+};
+
 /// @brief Host-provided context passed to plugins.
 ///
 /// Plugins receive this during creation and can use it to communicate
@@ -56,6 +148,15 @@ struct Q_plugin_context {
 
     /// @brief Callback to request graceful shutdown.
     void (*request_shutdown)(void* host_data);
+
+    /// @brief Host job system, or nullptr if the host provides none (ABI v5+).
+    Q_job_system* jobs;
+
+    /// @brief Host profiler, or nullptr when the host is not profiling (ABI v6+).
+    Q_profiler* profiler;
+
+    /// @brief Host cache, or nullptr if the host keeps none (ABI v9+).
+    Q_cache* cache;
 };
 
 /// @brief CPU-side framebuffer data returned by Q_plugin_readback().
@@ -75,15 +176,60 @@ enum Q_aov_type : uint32_t {
     Q_AOV_ALBEDO = 1,  ///< First-hit surface albedo.
     Q_AOV_NORMAL = 2,  ///< First-hit world-space normal.
     Q_AOV_DEPTH  = 3,  ///< First-hit ray distance.
-    Q_AOV_COUNT  = 4,  ///< Number of AOV types.
+
+    /// Ray-traversal heat map (ABI v7+), mean per sample: R = BVH nodes
+    /// visited, G = primitives tested, B = rays traced along the path. Only from
+    /// backends built with traversal statistics.
+    Q_AOV_TRAVERSAL = 4,
+
+    Q_AOV_COUNT  = 5,  ///< Number of AOV types.
+};
+
+/// @brief Optional features reported by Q_plugin_capabilities() (ABI v8+).
+enum Q_plugin_capability : uint32_t {
+    Q_CAPABILITY_ROW_BANDS = 1u << 0,  ///< Honors Q_render_frame::row_begin/row_end and sample_salt.
+};
+
+/// @brief Value type of a plugin parameter (ABI v10+).
+enum Q_param_type : uint32_t {
+    Q_PARAM_FLOAT = 0,  ///< Any value in [min_value, max_value].
+    Q_PARAM_INT   = 1,  ///< Whole numbers in [min_value, max_value].
+    Q_PARAM_BOOL  = 2,  ///< 0 or 1.
+};
+
+/// @brief A tunable a plugin declares through Q_plugin_params() (ABI v10+).
+///
+/// Parameters replace compile-time constants the user may want to trade
+/// off live, such as bounce depth or samples per frame. The host sets them
+/// between frames without recreating the plugin.
+struct Q_param_desc {
+    const char*  name;           ///< Identifier, unique within the plugin, e.g. "max_bounces".
+    const char*  description;    ///< One line for help output.
+    Q_param_type type;           ///< How values are rounded.
+    double       default_value;  ///< Value until the host sets another.
+    double       min_value;      ///< Smallest allowed value.
+    double       max_value;      ///< Largest allowed value.
+};
+
+/// @brief Pixel encoding of an AOV buffer.
+enum Q_aov_format : uint32_t {
+    Q_AOV_FORMAT_RGBA32F  = 0,  ///< Four floats per pixel.
+    Q_AOV_FORMAT_OCT16X2  = 1,  ///< One uint32 per pixel: octahedral unit vector, 2x16-bit snorm.
 };
 
 /// @brief Single AOV buffer from readback.
+///
+/// Packed formats are decoded by the host only when needed (e.g. at EXR
+/// export); see Q::math::oct_normal for Q_AOV_FORMAT_OCT16X2.
 struct Q_aov_buffer {
-    float*   data;      ///< Pixel data (RGBA float, row-major). nullptr if unavailable.
+    union {
+        float*    data;    ///< Float pixel data, row-major. nullptr if unavailable.
+        uint32_t* packed;  ///< Packed pixel data, row-major (packed formats).
+    };
     uint32_t width;     ///< Image width in pixels.
     uint32_t height;    ///< Image height in pixels.
-    uint32_t channels;  ///< Number of channels (always 4 for RGBA).
+    uint32_t channels;  ///< Number of channels (4 for RGBA32F, 1 for packed formats).
+    uint32_t format;    ///< Q_aov_format. Zero (RGBA32F) from ABI v3 plugins.
 };
 
 /// @brief Result of reading back all AOV buffers.
@@ -147,6 +293,22 @@ Q_readback_aov_result Q_plugin_readback_aov(Q_plugin_handle* handle);
 /// @param result The AOV readback result to free.
 void Q_plugin_readback_aov_free(Q_readback_aov_result* result);
 
+/// @brief Optional (ABI v8+): returns the Q_plugin_capability bits the plugin supports.
+uint32_t Q_plugin_capabilities(void);
+
+/// @brief Optional (ABI v10+): returns the plugin's parameters.
+/// @param count Receives the number of parameters.
+/// @return Array that stays valid while the library is loaded.
+const Q_param_desc* Q_plugin_params(uint32_t* count);
+
+/// @brief Optional (ABI v10+): sets a parameter between frames.
+///
+/// Called on the render thread, never during Q_plugin_render(). The host
+/// has already clamped the value to the declared range and rounded it to
+/// the declared type.
+/// @param index Index into the array from Q_plugin_params().
+void Q_plugin_set_param(Q_plugin_handle* handle, uint32_t index, double value);
+
 /// @}
 
 }  // extern "C"
@@ -159,9 +321,14 @@ using plugin_handle  = Q_plugin_handle;
 using plugin_version = Q_plugin_version;
 using plugin_info    = Q_plugin_info;
 using plugin_context = Q_plugin_context;
+using job_system_table = Q_job_system;
+using profiler_table   = Q_profiler;
+using cache_table      = Q_cache;
+using param_desc       = Q_param_desc;
 using readback_result     = Q_readback_result;
 using aov_type            = Q_aov_type;
 using aov_buffer          = Q_aov_buffer;
+using aov_format          = Q_aov_format;
 using readback_aov_result = Q_readback_aov_result;
 /// @}
 
@@ -177,10 +344,13 @@ inline constexpr const char* k_symbol_readback          = "Q_plugin_readback";
 inline constexpr const char* k_symbol_readback_free     = "Q_plugin_readback_free";
 inline constexpr const char* k_symbol_readback_aov      = "Q_plugin_readback_aov";
 inline constexpr const char* k_symbol_readback_aov_free = "Q_plugin_readback_aov_free";
+inline constexpr const char* k_symbol_capabilities      = "Q_plugin_capabilities";
+inline constexpr const char* k_symbol_params            = "Q_plugin_params";
+inline constexpr const char* k_symbol_set_param         = "Q_plugin_set_param";
 /// @}
 
 /// @brief Current ABI version. Increment when the interface changes.
-inline constexpr uint32_t k_plugin_abi_version = 3;
+inline constexpr uint32_t k_plugin_abi_version = 11;
 
 /// @brief Equality comparison for plugin versions.
 [[nodiscard]] constexpr bool operator==(plugin_version a, plugin_version b) noexcept {
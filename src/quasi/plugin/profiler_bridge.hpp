@@ -0,0 +1,61 @@
+/// @file profiler_bridge.hpp
+/// @brief Host side of Q_profiler, backed by a profile::profiler.
+
+#pragma once
+
+#include <quasi/plugin/plugin_interface.hpp>
+#include <quasi/profile/profiler.hpp>
+
+namespace Q::plugin {
+
+/// @class profiler_bridge
+/// @brief Exposes a host profiler to plugins through Q_plugin_context::profiler.
+///
+/// Example usage:
+/// @code
+/// profile::profiler prof;
+/// profiler_bridge bridge{prof};
+///
+/// plugin_context ctx{.viewport_width = 1920, .viewport_height = 1080};
+/// ctx.profiler = bridge.table();
+/// @endcode
+class profiler_bridge {
+public:
+    /// @brief Wraps a profiler; the profiler must outlive this object.
+    explicit profiler_bridge(profile::profiler& prof) : profiler_{prof} {
+        table_.host_data = this;
+        table_.begin     = &profiler_bridge::begin_cb;
+        table_.end       = &profiler_bridge::end_cb;
+    }
+
+    profiler_bridge(const profiler_bridge&) = delete;
+    profiler_bridge& operator=(const profiler_bridge&) = delete;
+
+    /// @brief Returns the C table to place in Q_plugin_context::profiler.
+    [[nodiscard]] profiler_table* table() noexcept {
+        return &table_;
+    }
+
+    /// @brief Returns the backing profiler.
+    [[nodiscard]] profile::profiler& profiler() noexcept {
+        return profiler_;
+    }
+
+private:
+    static void begin_cb(void* host_data, const char* name) {
+        if (host_data && name) {
+            static_cast<profiler_bridge*>(host_data)->profiler_.begin(name);
+        }
+    }
+
+    static void end_cb(void* host_data) {
+        if (host_data) {
+            static_cast<profiler_bridge*>(host_data)->profiler_.end();
+        }
+    }
+
+    profile::profiler& profiler_;
+    profiler_table     table_{};
+};
+
+}  // namespace Q::plugin
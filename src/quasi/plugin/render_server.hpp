@@ -0,0 +1,264 @@
+/// @file render_server.hpp
+/// @brief Render jobs for a resident render server: the request format and
+///        the LRU of warm plugin instances.
+///
+/// A batch render pays process start, dlopen, plugin create and scene
+/// setup (BVH build, pipeline compile) before its first sample. A server
+/// keeps prepared plugin instances resident instead, so a job that finds
+/// its instance warm starts tracing at once. Jobs arrive one per line:
+/// @code
+/// render id=shot1 plugin=libquasi_cpu.so size=512x512 spp=64 out=/tmp/shot1.exr
+///        eye=0,1,3.5 target=0,1,0 fov=40 param.max_bounces=8 progress=16
+/// @endcode
+/// Keys are whitespace-separated, so paths may not contain spaces.
+
+#pragma once
+
+#include <quasi/gpu/types.hpp>
+#include <quasi/plugin/params.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <expected>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Q::plugin {
+
+/// @brief Error codes for render job requests.
+enum class job_error {
+    bad_syntax,      ///< Not "render key=value ...".
+    unknown_key,     ///< A key the server does not understand.
+    bad_value,       ///< A value that does not parse or is out of range.
+    missing_plugin,  ///< No plugin named and the server has no default.
+};
+
+/// @brief Converts a job_error to a human-readable string.
+[[nodiscard]] constexpr std::string_view to_string(job_error err) noexcept {
+    switch (err) {
+        case job_error::bad_syntax:     return "expected render key=value ...";
+        case job_error::unknown_key:    return "unknown key";
+        case job_error::bad_value:      return "bad value";
+        case job_error::missing_plugin: return "no plugin given";
+    }
+    return "unknown error";
+}
+
+/// @brief One render request.
+struct render_job {
+    std::string                   id;               ///< Echoed in every reply line; may be empty.
+    std::filesystem::path         plugin;           ///< Backend library; empty for the server default.
+    uint32_t                      width    = 256;
+    uint32_t                      height   = 256;
+    uint32_t                      spp      = 16;    ///< Samples per pixel.
+    Q_camera                      camera{};         ///< fov 0 keeps the plugin's own camera.
+    std::vector<param_assignment> params;           ///< Plugin parameters; the rest take defaults.
+    std::filesystem::path         output;           ///< EXR to write; empty renders without saving.
+    bool                          aovs     = false;  ///< Write every AOV layer, not only beauty.
+    uint32_t                      progress = 0;      ///< Report every N samples; 0 only at the end.
+    uint32_t                      seed     = 0;      ///< Sample salt of the first pass.
+    bool                          cache    = true;   ///< Reuse and store the result in the result cache.
+};
+
+namespace detail {
+
+/// @brief Parses "x,y,z" into @p out.
+[[nodiscard]] inline bool parse_vec3(std::string_view text, float out[3]) {
+    for (int i = 0; i < 3; ++i) {
+        auto comma = text.find(',');
+        if ((comma == std::string_view::npos) != (i == 2)) {
+            return false;
+        }
+        auto value = parse_param_value(text.substr(0, comma));
+        if (!value) {
+            return false;
+        }
+        out[i] = static_cast<float>(*value);
+        text = i < 2 ? text.substr(comma + 1) : std::string_view{};
+    }
+    return true;
+}
+
+/// @brief Parses a whole number in [lo, hi].
+[[nodiscard]] inline bool parse_count(std::string_view text, uint32_t lo, uint32_t hi, uint32_t& out) {
+    auto value = parse_param_value(text);
+    if (!value || *value != static_cast<double>(static_cast<int64_t>(*value)) || *value < lo || *value > hi) {
+        return false;
+    }
+    out = static_cast<uint32_t>(*value);
+    return true;
+}
+
+}  // namespace detail
+
+/// @brief Parses a "render key=value ..." request line.
+///
+/// Keys: id, plugin, size=WxH, spp, eye=x,y,z, target=x,y,z, up=x,y,z, fov,
+/// out, aovs=0|1, progress=N, seed=N, cache=0|1 and param.NAME=value. A camera needs eye and
+/// target; up defaults to +Y and fov to 40 degrees.
+[[nodiscard]] inline std::expected<render_job, job_error> parse_render_job(std::string_view line) {
+    line = detail::trim(line);
+    if (!line.starts_with("render") || (line.size() > 6 && line[6] != ' ' && line[6] != '\t')) {
+        return std::unexpected{job_error::bad_syntax};
+    }
+    line.remove_prefix(6);
+
+    render_job job;
+    bool has_eye = false;
+    bool has_target = false;
+    job.camera.up[1] = 1.0f;
+    float fov = 40.0f;
+
+    while (!(line = detail::trim(line)).empty()) {
+        auto end = line.find_first_of(" \t");
+        auto token = line.substr(0, end);
+        line = end == std::string_view::npos ? std::string_view{} : line.substr(end);
+
+        auto eq = token.find('=');
+        if (eq == std::string_view::npos || eq == 0) {
+            return std::unexpected{job_error::bad_syntax};
+        }
+        auto key = token.substr(0, eq);
+        auto value = token.substr(eq + 1);
+        bool ok = true;
+
+        if (key == "id") {
+            job.id = value;
+        } else if (key == "plugin") {
+            job.plugin = value;
+        } else if (key == "size") {
+            unsigned w = 0;
+            unsigned h = 0;
+            char tail = 0;
+            std::string text{value};
+            ok = std::sscanf(text.c_str(), "%ux%u%c", &w, &h, &tail) == 2 && w > 0 && h > 0 && w <= 16384 &&
+                 h <= 16384;
+            job.width = w;
+            job.height = h;
+        } else if (key == "spp") {
+            ok = detail::parse_count(value, 1, 1u << 20, job.spp);
+        } else if (key == "progress") {
+            ok = detail::parse_count(value, 0, 1u << 20, job.progress);
+        } else if (key == "seed") {
+            ok = detail::parse_count(value, 0, UINT32_MAX, job.seed);
+        } else if (key == "cache") {
+            auto v = parse_param_value(value);
+            ok = v.has_value();
+            job.cache = ok && *v != 0.0;
+        } else if (key == "eye") {
+            ok = has_eye = detail::parse_vec3(value, job.camera.position);
+        } else if (key == "target") {
+            ok = has_target = detail::parse_vec3(value, job.camera.target);
+        } else if (key == "up") {
+            ok = detail::parse_vec3(value, job.camera.up);
+        } else if (key == "fov") {
+            auto v = parse_param_value(value);
+            ok = v && *v > 0.0 && *v < 180.0;
+            fov = ok ? static_cast<float>(*v) : fov;
+        } else if (key == "out") {
+            job.output = value;
+        } else if (key == "aovs") {
+            auto v = parse_param_value(value);
+            ok = v.has_value();
+            job.aovs = ok && *v != 0.0;
+        } else if (key.starts_with("param.") && key.size() > 6) {
+            auto v = parse_param_value(value);
+            ok = v.has_value();
+            if (ok) {
+                job.params.push_back({std::string{key.substr(6)}, *v});
+            }
+        } else {
+            return std::unexpected{job_error::unknown_key};
+        }
+        if (!ok) {
+            return std::unexpected{job_error::bad_value};
+        }
+    }
+
+    if (has_eye != has_target) {
+        return std::unexpected{job_error::bad_value};  // Half a camera.
+    }
+    if (has_eye) {
+        job.camera.fov = fov;
+    }
+    return job;
+}
+
+/// @class instance_lru
+/// @brief Keeps the most recently used prepared instances resident.
+///
+/// Instance is whatever the server keeps warm per key (in the server, a
+/// loaded plugin with its scene and BVH built). Destroying an Instance
+/// must release everything it holds.
+///
+/// Example usage:
+/// @code
+/// instance_lru<resident> warm{4};
+/// resident* r = warm.acquire(key, [&] { return load_resident(job); });
+/// @endcode
+template <typename Instance>
+class instance_lru {
+public:
+    /// @param capacity Instances kept at most; at least one.
+    explicit instance_lru(size_t capacity) : capacity_{capacity > 0 ? capacity : 1} {}
+
+    /// @brief Returns the instance for @p key, creating it with @p make on a miss.
+    ///
+    /// On a miss the least recently used instances beyond capacity are
+    /// destroyed before @p make runs, so their memory is free for the new one.
+    /// @param make Returns std::unique_ptr<Instance>; null on failure.
+    /// @return The instance, valid until the next acquire(); null if @p make failed.
+    template <typename Make>
+    Instance* acquire(const std::string& key, Make&& make) {
+        if (auto it = index_.find(key); it != index_.end()) {
+            order_.splice(order_.begin(), order_, it->second);
+            ++hits_;
+            return order_.front().second.get();
+        }
+        ++misses_;
+        while (order_.size() >= capacity_) {
+            index_.erase(order_.back().first);
+            order_.pop_back();
+            ++evictions_;
+        }
+        std::unique_ptr<Instance> created = std::forward<Make>(make)();
+        if (!created) {
+            return nullptr;
+        }
+        order_.emplace_front(key, std::move(created));
+        index_[key] = order_.begin();
+        return order_.front().second.get();
+    }
+
+    /// @brief Destroys every instance, most recently used last.
+    void clear() {
+        while (!order_.empty()) {
+            order_.pop_back();
+        }
+        index_.clear();
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return order_.size(); }
+    [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+    [[nodiscard]] uint64_t hits() const noexcept { return hits_; }
+    [[nodiscard]] uint64_t misses() const noexcept { return misses_; }
+    [[nodiscard]] uint64_t evictions() const noexcept { return evictions_; }
+
+private:
+    using entry = std::pair<std::string, std::unique_ptr<Instance>>;
+
+    size_t                                                        capacity_;
+    std::list<entry>                                              order_;  // Most recently used first.
+    std::unordered_map<std::string, typename std::list<entry>::iterator> index_;
+    uint64_t                                                      hits_      = 0;
+    uint64_t                                                      misses_    = 0;
+    uint64_t                                                      evictions_ = 0;
+};
+
+}  // namespace Q::plugin
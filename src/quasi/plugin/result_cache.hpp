@@ -0,0 +1,182 @@
+/// @file result_cache.hpp
+/// @brief Memoized render results, keyed by everything that determines the image.
+///
+/// Batch pipelines re-request identical renders, such as unchanged shots in
+/// a re-run. A result_cache stores each finished beauty image in a
+/// cache_store under a key built from the plugin build (a hash of the
+/// library file, which also covers the scene the plugin builds), the
+/// resolution, camera, sampler seed and parameter values. The sample count
+/// is stored with the image, not in the key. A request for at most that
+/// many samples is served at once. A request for more resumes: only the
+/// missing samples are rendered, with a different sample salt, and merged
+/// into the cached mean.
+///
+/// Entries live wherever the cache_store keeps them; with a directory they
+/// outlive the process. Value layout (host byte order):
+/// @code
+/// u32 width | u32 height | u32 samples | u32 reserved | f32 rgba[width * height * 4]
+/// @endcode
+
+#pragma once
+
+#include <quasi/gpu/types.hpp>
+#include <quasi/plugin/cache_store.hpp>
+#include <quasi/plugin/params.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Q::plugin {
+
+/// @brief Everything that determines a render's image, except its sample count.
+struct render_inputs {
+    uint64_t                      build  = 0;  ///< result_cache::build_hash() of the plugin library.
+    uint32_t                      width  = 0;
+    uint32_t                      height = 0;
+    Q_camera                      camera{};
+    uint32_t                      seed   = 0;  ///< Q_render_frame::sample_salt of the first pass.
+    std::vector<param_assignment> params;      ///< Effective values of every parameter that affects the image.
+};
+
+/// @brief A cached beauty image and the samples averaged into it.
+struct cached_render {
+    uint32_t           width   = 0;
+    uint32_t           height  = 0;
+    uint32_t           samples = 0;
+    std::vector<float> rgba;  ///< RGBA32F, width * height * 4.
+};
+
+/// @class result_cache
+/// @brief Looks up and stores render results in a cache_store.
+///
+/// Example usage:
+/// @code
+/// result_cache results{store};
+/// auto key = result_cache::key(inputs);
+/// auto hit = results.find(key);
+/// if (hit && hit->samples >= spp) {
+///     return *hit;  // No rendering at all.
+/// }
+/// uint32_t have = hit ? hit->samples : 0;
+/// // Render spp - have samples with salt result_cache::resume_salt(seed, have)...
+/// @endcode
+class result_cache {
+public:
+    /// @brief Version of the key and value layout; bump to orphan old entries.
+    static constexpr uint32_t k_format_version = 1;
+
+    explicit result_cache(cache_store& store) : store_{store} {}
+
+    /// @brief Builds the cache key for @p inputs; parameter order does not matter.
+    [[nodiscard]] static std::string key(const render_inputs& inputs) {
+        std::string k = "quasi.render.v" + std::to_string(k_format_version);
+        append(k, inputs.build);
+        append(k, inputs.width);
+        append(k, inputs.height);
+        append(k, inputs.camera);
+        append(k, inputs.seed);
+        std::map<std::string_view, double> sorted;
+        for (const auto& p : inputs.params) {
+            sorted[p.name] = p.value;
+        }
+        for (const auto& [name, value] : sorted) {
+            k += name;
+            k += '=';
+            append(k, value);
+        }
+        return k;
+    }
+
+    /// @brief Returns the cached image for @p key, or nullopt.
+    [[nodiscard]] std::optional<cached_render> find(std::string_view key) const {
+        auto blob = store_.get(key);
+        if (!blob || blob->size() < k_header_size) {
+            return std::nullopt;
+        }
+        cached_render r;
+        uint32_t header[4];
+        std::memcpy(header, blob->data(), k_header_size);
+        r.width   = header[0];
+        r.height  = header[1];
+        r.samples = header[2];
+        size_t floats = size_t{r.width} * r.height * 4;
+        if (r.samples == 0 || blob->size() != k_header_size + floats * sizeof(float)) {
+            return std::nullopt;
+        }
+        r.rgba.resize(floats);
+        std::memcpy(r.rgba.data(), blob->data() + k_header_size, floats * sizeof(float));
+        return r;
+    }
+
+    /// @brief Stores @p render under @p key, replacing what was there.
+    void store(std::string_view key, const cached_render& render) {
+        std::vector<std::byte> value(k_header_size + render.rgba.size() * sizeof(float));
+        uint32_t header[4] = {render.width, render.height, render.samples, 0};
+        std::memcpy(value.data(), header, k_header_size);
+        std::memcpy(value.data() + k_header_size, render.rgba.data(), render.rgba.size() * sizeof(float));
+        store_.put(key, value);
+    }
+
+    /// @brief Sample salt for the pass that extends a render of @p samples samples.
+    ///
+    /// Zero samples gives @p seed itself, so a first render is the same
+    /// whether or not the cache is used. Otherwise the sample count is
+    /// hashed on its own before it meets the seed, so no (seed, samples)
+    /// pair lands on another seed's salt by simple arithmetic.
+    [[nodiscard]] static constexpr uint32_t resume_salt(uint32_t seed, uint32_t samples) noexcept {
+        return samples == 0 ? seed : gpu::derive_salt(seed, samples);
+    }
+
+    /// @brief Merges @p added, the mean of @p added_samples new samples, into @p into.
+    static void merge(cached_render& into, std::span<const float> added, uint32_t added_samples) {
+        if (added.size() != into.rgba.size() || added_samples == 0) {
+            return;
+        }
+        uint32_t total = into.samples + added_samples;
+        float keep = static_cast<float>(into.samples) / static_cast<float>(total);
+        float take = static_cast<float>(added_samples) / static_cast<float>(total);
+        for (size_t i = 0; i < added.size(); ++i) {
+            into.rgba[i] = keep * into.rgba[i] + take * added[i];
+        }
+        into.samples = total;
+    }
+
+    /// @brief FNV-1a hash of a file's contents; identifies a plugin build.
+    /// @return Zero if the file cannot be read.
+    [[nodiscard]] static uint64_t build_hash(const std::filesystem::path& path) {
+        std::ifstream in{path, std::ios::binary};
+        if (!in) {
+            return 0;
+        }
+        uint64_t h = 0xcbf29ce484222325ull;
+        char buffer[1 << 16];
+        while (in.read(buffer, sizeof(buffer)) || in.gcount() > 0) {
+            for (std::streamsize i = 0; i < in.gcount(); ++i) {
+                h = (h ^ static_cast<uint8_t>(buffer[i])) * 0x100000001b3ull;
+            }
+        }
+        return h;
+    }
+
+private:
+    static constexpr size_t k_header_size = 4 * sizeof(uint32_t);
+
+    template <typename T>
+    static void append(std::string& k, const T& value) {
+        k.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    cache_store& store_;
+};
+
+}  // namespace Q::plugin
@@ -0,0 +1,152 @@
+/// @file histogram.hpp
+/// @brief Fixed-size log-linear histogram of unsigned integer samples.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <format>
+#include <ostream>
+#include <string>
+
+namespace Q::profile {
+
+/// @class histogram
+/// @brief Counts samples in buckets that widen with magnitude.
+///
+/// Values below 8 get a bucket each; above that every power of two is
+/// split into 8 buckets, so any value is placed within 12.5% of itself
+/// across the whole uint64 range with no configuration. Adding is a few
+/// instructions and never allocates. Not thread-safe: keep one per thread
+/// and merge().
+///
+/// Example usage:
+/// @code
+/// histogram h;
+/// for (auto ns : frame_times) h.add(ns);
+/// std::printf("p50 %llu p99 %llu\n", h.percentile(0.5), h.percentile(0.99));
+/// @endcode
+class histogram {
+public:
+    static constexpr uint32_t k_sub_bits    = 3;
+    static constexpr uint32_t k_sub_buckets = 1u << k_sub_bits;
+    static constexpr size_t   k_bucket_count = (64 - k_sub_bits + 1) * k_sub_buckets;
+
+    /// @brief Returns the bucket holding @p value.
+    [[nodiscard]] static constexpr size_t bucket_of(uint64_t value) noexcept {
+        if (value < k_sub_buckets) {
+            return static_cast<size_t>(value);
+        }
+        uint32_t e   = static_cast<uint32_t>(std::bit_width(value)) - 1;  // >= k_sub_bits
+        uint64_t sub = (value >> (e - k_sub_bits)) & (k_sub_buckets - 1);
+        return (e - k_sub_bits + 1) * k_sub_buckets + static_cast<size_t>(sub);
+    }
+
+    /// @brief Smallest value in bucket @p b.
+    [[nodiscard]] static constexpr uint64_t bucket_lower(size_t b) noexcept {
+        if (b < k_sub_buckets) {
+            return b;
+        }
+        uint32_t e   = static_cast<uint32_t>(b / k_sub_buckets) + k_sub_bits - 1;
+        uint64_t sub = b % k_sub_buckets;
+        return (k_sub_buckets + sub) << (e - k_sub_bits);
+    }
+
+    /// @brief Largest value in bucket @p b.
+    [[nodiscard]] static constexpr uint64_t bucket_upper(size_t b) noexcept {
+        return b + 1 < k_bucket_count ? bucket_lower(b + 1) - 1 : UINT64_MAX;
+    }
+
+    /// @brief Records @p n samples of @p value.
+    void add(uint64_t value, uint64_t n = 1) noexcept {
+        if (n == 0) return;
+        buckets_[bucket_of(value)] += n;
+        count_ += n;
+        sum_ += value * n;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+
+    /// @brief Adds every sample of @p other.
+    void merge(const histogram& other) noexcept {
+        for (size_t i = 0; i < k_bucket_count; ++i) {
+            buckets_[i] += other.buckets_[i];
+        }
+        count_ += other.count_;
+        sum_ += other.sum_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    /// @brief Removes every sample.
+    void clear() noexcept {
+        *this = histogram{};
+    }
+
+    [[nodiscard]] uint64_t count() const noexcept { return count_; }
+    [[nodiscard]] uint64_t sum() const noexcept { return sum_; }
+    [[nodiscard]] uint64_t min() const noexcept { return count_ ? min_ : 0; }
+    [[nodiscard]] uint64_t max() const noexcept { return max_; }
+    [[nodiscard]] uint64_t bucket(size_t b) const noexcept { return buckets_[b]; }
+
+    [[nodiscard]] double mean() const noexcept {
+        return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0;
+    }
+
+    /// @brief Estimates the value below which a fraction @p p of samples fall.
+    ///
+    /// Interpolates inside the bucket, clamped to the observed min and max.
+    [[nodiscard]] uint64_t percentile(double p) const noexcept {
+        if (count_ == 0) return 0;
+        double rank = std::clamp(p, 0.0, 1.0) * static_cast<double>(count_);
+        uint64_t seen = 0;
+        for (size_t b = 0; b < k_bucket_count; ++b) {
+            if (buckets_[b] == 0) continue;
+            if (static_cast<double>(seen + buckets_[b]) >= rank) {
+                double within = (rank - static_cast<double>(seen)) / static_cast<double>(buckets_[b]);
+                double lo = static_cast<double>(bucket_lower(b));
+                double hi = static_cast<double>(bucket_upper(b));
+                auto v = static_cast<uint64_t>(lo + (hi - lo) * within);
+                return std::clamp(v, min(), max_);
+            }
+            seen += buckets_[b];
+        }
+        return max_;
+    }
+
+    /// @brief One-line summary: "n 1200 mean 23 p50 22 p90 31 p99 40 max 61".
+    [[nodiscard]] std::string summary() const {
+        return std::format("n {} mean {} p50 {} p90 {} p99 {} max {}", count_,
+                           static_cast<uint64_t>(mean() + 0.5), percentile(0.5), percentile(0.9),
+                           percentile(0.99), max_);
+    }
+
+    /// @brief Writes the statistics and non-empty buckets as a JSON object.
+    ///
+    /// Buckets are [lower, upper, count] triples in increasing order.
+    void write_json(std::ostream& out) const {
+        out << "{\"count\": " << count_ << ", \"sum\": " << sum_ << ", \"min\": " << min()
+            << ", \"max\": " << max_ << ", \"p50\": " << percentile(0.5)
+            << ", \"p90\": " << percentile(0.9) << ", \"p99\": " << percentile(0.99)
+            << ", \"buckets\": [";
+        bool first = true;
+        for (size_t b = 0; b < k_bucket_count; ++b) {
+            if (buckets_[b] == 0) continue;
+            out << (first ? "" : ", ") << '[' << bucket_lower(b) << ", " << bucket_upper(b) << ", "
+                << buckets_[b] << ']';
+            first = false;
+        }
+        out << "]}";
+    }
+
+private:
+    std::array<uint64_t, k_bucket_count> buckets_{};
+    uint64_t count_ = 0;
+    uint64_t sum_   = 0;
+    uint64_t min_   = UINT64_MAX;
+    uint64_t max_   = 0;
+};
+
+}  // namespace Q::profile
@@ -0,0 +1,220 @@
+/// @file perf_counters.hpp
+/// @brief Per-thread hardware performance counters (Linux perf_event_open).
+///
+/// Wall-clock time says that something got slower, not why. These counters
+/// tell cache misses, branch mispredicts and low IPC apart. Each thread
+/// opens its own counters, measuring only itself in user space, so reads
+/// are cheap and need no privileges beyond perf_event_paranoid <= 2.
+///
+/// Counters the kernel or the machine cannot provide (VMs often expose no
+/// PMU; other platforms have no perf_event_open) are simply unavailable:
+/// the valid mask says which values mean anything.
+
+#pragma once
+
+#include <quasi/platform.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#if defined(Q_PLATFORM_LINUX)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace Q::profile {
+
+/// @brief The events a perf_counters set tries to open.
+enum class counter : uint8_t {
+    cycles,         ///< Core cycles.
+    instructions,   ///< Retired instructions.
+    l1d_misses,     ///< L1 data cache read misses.
+    llc_misses,     ///< Last-level cache misses.
+    branch_misses,  ///< Mispredicted branches.
+    task_clock,     ///< Nanoseconds on CPU (software event; available wherever perf is).
+};
+
+/// @brief Number of counter values.
+inline constexpr size_t k_counter_count = 6;
+
+/// @brief Returns the counter's name as used in reports.
+[[nodiscard]] inline constexpr std::string_view to_string(counter c) noexcept {
+    switch (c) {
+        case counter::cycles:        return "cycles";
+        case counter::instructions:  return "instructions";
+        case counter::l1d_misses:    return "l1d_misses";
+        case counter::llc_misses:    return "llc_misses";
+        case counter::branch_misses: return "branch_misses";
+        case counter::task_clock:    return "task_clock_ns";
+    }
+    return "unknown";
+}
+
+/// @brief A snapshot or difference of every counter.
+struct counter_values {
+    std::array<uint64_t, k_counter_count> value{};
+    uint32_t valid = 0;  ///< Bit i set if value[i] was measured.
+
+    [[nodiscard]] bool has(counter c) const noexcept {
+        return (valid >> static_cast<size_t>(c)) & 1u;
+    }
+
+    [[nodiscard]] uint64_t operator[](counter c) const noexcept {
+        return value[static_cast<size_t>(c)];
+    }
+
+    /// @brief Difference of two snapshots; valid where both are.
+    [[nodiscard]] friend counter_values operator-(const counter_values& a, const counter_values& b) noexcept {
+        counter_values d;
+        d.valid = a.valid & b.valid;
+        for (size_t i = 0; i < k_counter_count; ++i) {
+            d.value[i] = a.value[i] - b.value[i];
+        }
+        return d;
+    }
+
+    /// @brief Accumulates a difference. Validity only narrows once set.
+    counter_values& operator+=(const counter_values& d) noexcept {
+        valid = valid == 0 ? d.valid : (valid & d.valid);
+        for (size_t i = 0; i < k_counter_count; ++i) {
+            value[i] += d.value[i];
+        }
+        return *this;
+    }
+};
+
+/// @class perf_counters
+/// @brief The calling thread's counters. Use this_thread(); one set per thread.
+class perf_counters {
+public:
+    perf_counters() {
+#if defined(Q_PLATFORM_LINUX)
+        // Hardware events share one group so a single read() returns them
+        // together and they are scheduled onto the PMU together.
+        struct event {
+            counter  id;
+            uint32_t type;
+            uint64_t config;
+        };
+        constexpr uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D |
+                                           (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        constexpr event hardware[] = {
+            {counter::cycles,        PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {counter::instructions,  PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {counter::l1d_misses,    PERF_TYPE_HW_CACHE, l1d_read_miss},
+            {counter::llc_misses,    PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {counter::branch_misses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        };
+        for (const auto& e : hardware) {
+            int fd = open_event(e.type, e.config, group_fd_,
+                                PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                                    PERF_FORMAT_TOTAL_TIME_RUNNING);
+            if (fd < 0) {
+                continue;
+            }
+            if (group_fd_ < 0) {
+                group_fd_ = fd;
+            } else {
+                member_fds_[group_size_ - 1] = fd;
+            }
+            group_ids_[group_size_++] = e.id;
+        }
+        if (group_fd_ >= 0) {
+            ioctl(group_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+
+        task_clock_fd_ = open_event(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, -1, 0);
+        if (task_clock_fd_ >= 0) {
+            ioctl(task_clock_fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    ~perf_counters() {
+#if defined(Q_PLATFORM_LINUX)
+        for (size_t i = 0; i + 1 < group_size_; ++i) {
+            close(member_fds_[i]);
+        }
+        if (group_fd_ >= 0) close(group_fd_);
+        if (task_clock_fd_ >= 0) close(task_clock_fd_);
+#endif
+    }
+
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+
+    /// @brief Returns the counters of the calling thread, opened on first use.
+    [[nodiscard]] static perf_counters& this_thread() {
+        thread_local perf_counters counters;
+        return counters;
+    }
+
+    /// @brief Bit mask of the counters that opened (see counter_values::valid).
+    [[nodiscard]] uint32_t available() const noexcept {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < group_size_; ++i) {
+            mask |= 1u << static_cast<size_t>(group_ids_[i]);
+        }
+        if (task_clock_fd_ >= 0) {
+            mask |= 1u << static_cast<size_t>(counter::task_clock);
+        }
+        return mask;
+    }
+
+    /// @brief Reads every available counter.
+    ///
+    /// Values are scaled up when the kernel multiplexed the group with
+    /// other users of the PMU.
+    [[nodiscard]] counter_values read() const noexcept {
+        counter_values out;
+#if defined(Q_PLATFORM_LINUX)
+        if (group_fd_ >= 0) {
+            // { nr, time_enabled, time_running, value[nr] }
+            uint64_t buf[3 + k_counter_count] = {};
+            if (::read(group_fd_, buf, sizeof(buf)) > 0 && buf[0] == group_size_) {
+                double scale = buf[2] > 0 ? static_cast<double>(buf[1]) / static_cast<double>(buf[2]) : 0.0;
+                for (size_t i = 0; i < group_size_; ++i) {
+                    auto slot = static_cast<size_t>(group_ids_[i]);
+                    out.value[slot] = static_cast<uint64_t>(static_cast<double>(buf[3 + i]) * scale);
+                    out.valid |= 1u << slot;
+                }
+            }
+        }
+        if (task_clock_fd_ >= 0) {
+            uint64_t value = 0;
+            if (::read(task_clock_fd_, &value, sizeof(value)) == sizeof(value)) {
+                out.value[static_cast<size_t>(counter::task_clock)] = value;
+                out.valid |= 1u << static_cast<size_t>(counter::task_clock);
+            }
+        }
+#endif
+        return out;
+    }
+
+private:
+#if defined(Q_PLATFORM_LINUX)
+    static int open_event(uint32_t type, uint64_t config, int group_fd, uint64_t read_format) {
+        perf_event_attr attr{};
+        attr.size           = sizeof(attr);
+        attr.type           = type;
+        attr.config         = config;
+        attr.read_format    = read_format;
+        attr.disabled       = group_fd < 0 ? 1 : 0;  // Members follow the leader.
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+    }
+#endif
+
+    int                                     group_fd_ = -1;
+    std::array<int, k_counter_count>        member_fds_{};
+    std::array<counter, k_counter_count>    group_ids_{};
+    size_t                                  group_size_ = 0;
+    int                                     task_clock_fd_ = -1;
+};
+
+}  // namespace Q::profile
@@ -0,0 +1,24 @@
+/// @file profile.hpp
+/// @brief Main header for the profiling module.
+///
+/// This header includes all profiling module components. For finer-grained
+/// control, include individual headers directly.
+
+#pragma once
+
+#include <quasi/profile/histogram.hpp>
+#include <quasi/profile/perf_counters.hpp>
+#include <quasi/profile/profiler.hpp>
+
+namespace Q::profile {
+
+/// @brief Major version of the profiling module.
+inline constexpr int k_version_major = 0;
+
+/// @brief Minor version of the profiling module.
+inline constexpr int k_version_minor = 1;
+
+/// @brief Patch version of the profiling module.
+inline constexpr int k_version_patch = 0;
+
+}  // namespace Q::profile
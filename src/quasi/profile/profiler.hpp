@@ -0,0 +1,336 @@
+/// @file profiler.hpp
+/// @brief Named-scope profiler with per-stage counter totals and trace output.
+
+#pragma once
+
+#include <quasi/profile/perf_counters.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Q::profile {
+
+/// @brief Configuration for a profiler.
+struct profiler_options {
+    bool   counters         = true;     ///< Read perf counters around each scope.
+    size_t max_trace_events = 1 << 20;  ///< Later events are counted but not kept.
+};
+
+/// @brief Totals for every scope recorded under one name.
+struct stage_stats {
+    std::string    name;
+    uint64_t       calls   = 0;
+    uint64_t       wall_ns = 0;
+    uint64_t       min_ns  = UINT64_MAX;
+    uint64_t       max_ns  = 0;
+    counter_values counters;  ///< Sums; valid bits are the counters every call measured.
+};
+
+/// @brief One recorded scope, for the trace.
+struct trace_event {
+    uint32_t       stage;     ///< Index into the profiler's stage list.
+    uint32_t       thread;    ///< Small per-thread id, stable for the process.
+    uint64_t       start_ns;  ///< Relative to profiler construction.
+    uint64_t       duration_ns;
+    counter_values counters;
+};
+
+namespace detail {
+
+[[nodiscard]] inline uint32_t profile_thread_id() noexcept {
+    static std::atomic<uint32_t> next{1};
+    thread_local uint32_t id = next.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+/// @brief Writes @p s as a JSON string literal.
+inline void write_json_string(std::ostream& out, std::string_view s) {
+    out << '"';
+    for (char c : s) {
+        switch (c) {
+            case '"':  out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out << "\\u00" << "0123456789abcdef"[(c >> 4) & 0xF] << "0123456789abcdef"[c & 0xF];
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+}
+
+/// @brief Writes {"cycles": n, ...}; unmeasured counters are null.
+inline void write_counters(std::ostream& out, const counter_values& v) {
+    out << '{';
+    for (size_t i = 0; i < k_counter_count; ++i) {
+        auto c = static_cast<counter>(i);
+        out << (i ? ", " : "") << '"' << to_string(c) << "\": ";
+        if (v.has(c)) {
+            out << v[c];
+        } else {
+            out << "null";
+        }
+    }
+    out << '}';
+}
+
+}  // namespace detail
+
+/// @class profiler
+/// @brief Aggregates wall time and perf counters per named scope.
+///
+/// Scopes nest and may be opened on any thread; counters measure the
+/// opening thread only. Work fanned out over a thread pool is measured by
+/// opening the scope inside each job, where samples from every worker add
+/// up under the one name. Names must stay valid until their scope ends.
+///
+/// Example usage:
+/// @code
+/// profiler prof;
+/// for (int frame = 0; frame < 100; ++frame) {
+///     auto s = prof.measure("frame");
+///     render();
+/// }
+/// prof.write_stages_json(std::cout);  // Benchmark report.
+/// prof.write_trace(trace_file);       // chrome://tracing / Perfetto.
+/// @endcode
+class profiler {
+public:
+    /// @brief RAII scope returned by measure().
+    class scope {
+    public:
+        scope(profiler& p, std::string_view name) : profiler_{&p} {
+            p.begin(name);
+        }
+        ~scope() {
+            if (profiler_) profiler_->end();
+        }
+        scope(scope&& other) noexcept : profiler_{std::exchange(other.profiler_, nullptr)} {}
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+        scope& operator=(scope&&) = delete;
+
+    private:
+        profiler* profiler_;
+    };
+
+    explicit profiler(profiler_options options = {})
+        : options_{options}
+        , epoch_{std::chrono::steady_clock::now()} {}
+
+    profiler(const profiler&) = delete;
+    profiler& operator=(const profiler&) = delete;
+
+    /// @brief Opens a scope on the calling thread.
+    void begin(std::string_view name) {
+        open_scope s{this, name, 0, {}};
+        if (options_.counters) {
+            s.counters = perf_counters::this_thread().read();
+        }
+        s.start_ns = now_ns();  // Last, so the counter read is not timed.
+        open_scopes().push_back(s);
+    }
+
+    /// @brief Closes the innermost scope this profiler opened on the calling thread.
+    void end() {
+        uint64_t end_ns = now_ns();
+        counter_values end_counters;
+        if (options_.counters) {
+            end_counters = perf_counters::this_thread().read();
+        }
+
+        auto& stack = open_scopes();
+        auto it = std::find_if(stack.rbegin(), stack.rend(),
+                               [this](const open_scope& s) { return s.owner == this; });
+        if (it == stack.rend()) {
+            return;
+        }
+        open_scope s = *it;
+        stack.erase(std::next(it).base());
+
+        counter_values delta = end_counters - s.counters;
+        uint64_t duration = end_ns - s.start_ns;
+
+        std::lock_guard lock{mutex_};
+        uint32_t index = stage_index(s.name);
+        auto& stats = stages_[index];
+        ++stats.calls;
+        stats.wall_ns += duration;
+        stats.min_ns = std::min(stats.min_ns, duration);
+        stats.max_ns = std::max(stats.max_ns, duration);
+        stats.counters += delta;
+
+        if (events_.size() < options_.max_trace_events) {
+            events_.push_back(trace_event{index, detail::profile_thread_id(), s.start_ns, duration, delta});
+        } else {
+            ++dropped_events_;
+        }
+    }
+
+    /// @brief Opens a scope closed when the returned object is destroyed.
+    [[nodiscard]] scope measure(std::string_view name) {
+        return scope{*this, name};
+    }
+
+    /// @brief Returns a copy of the per-stage totals, in first-seen order.
+    [[nodiscard]] std::vector<stage_stats> stages() const {
+        std::lock_guard lock{mutex_};
+        return stages_;
+    }
+
+    /// @brief Returns a copy of the recorded scopes.
+    [[nodiscard]] std::vector<trace_event> events() const {
+        std::lock_guard lock{mutex_};
+        return events_;
+    }
+
+    /// @brief Scopes not kept in the trace because max_trace_events was reached.
+    [[nodiscard]] uint64_t dropped_events() const {
+        std::lock_guard lock{mutex_};
+        return dropped_events_;
+    }
+
+    /// @brief Counters available on the calling thread (zero when counters are off).
+    [[nodiscard]] uint32_t available_counters() const {
+        return options_.counters ? perf_counters::this_thread().available() : 0;
+    }
+
+    /// @brief Discards every recorded scope and total.
+    void reset() {
+        std::lock_guard lock{mutex_};
+        stages_.clear();
+        index_.clear();
+        events_.clear();
+        dropped_events_ = 0;
+    }
+
+    /// @brief Writes the per-stage totals as a JSON array, for benchmark reports.
+    ///
+    /// Each element holds calls, wall-time totals and extremes, counter sums
+    /// (null where unmeasured) and, when cycles and instructions were both
+    /// measured, the IPC.
+    void write_stages_json(std::ostream& out) const {
+        auto stats = stages();
+        auto flags = out.flags();
+        out << '[';
+        for (size_t i = 0; i < stats.size(); ++i) {
+            const auto& s = stats[i];
+            out << (i ? ",\n " : "\n ") << "{\"name\": ";
+            detail::write_json_string(out, s.name);
+            out << ", \"calls\": " << s.calls
+                << ", \"wall_ns\": " << s.wall_ns
+                << ", \"mean_ns\": " << (s.calls ? s.wall_ns / s.calls : 0)
+                << ", \"min_ns\": " << (s.calls ? s.min_ns : 0)
+                << ", \"max_ns\": " << s.max_ns
+                << ", \"counters\": ";
+            detail::write_counters(out, s.counters);
+            out << ", \"ipc\": ";
+            if (s.counters.has(counter::cycles) && s.counters.has(counter::instructions) &&
+                s.counters[counter::cycles] > 0) {
+                out << std::fixed << std::setprecision(3)
+                    << static_cast<double>(s.counters[counter::instructions]) /
+                           static_cast<double>(s.counters[counter::cycles]);
+                out.flags(flags);
+            } else {
+                out << "null";
+            }
+            out << '}';
+        }
+        out << "\n]";
+    }
+
+    /// @brief Writes every recorded scope in Chrome trace-event JSON.
+    ///
+    /// Load the file in chrome://tracing or ui.perfetto.dev; the counters
+    /// of each scope appear as its arguments.
+    void write_trace(std::ostream& out) const {
+        std::vector<stage_stats> stats;
+        std::vector<trace_event> events;
+        {
+            std::lock_guard lock{mutex_};
+            stats  = stages_;
+            events = events_;
+        }
+        auto flags = out.flags();
+        out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+        out << std::fixed << std::setprecision(3);
+        for (size_t i = 0; i < events.size(); ++i) {
+            const auto& e = events[i];
+            out << (i ? ",\n" : "\n") << "{\"name\": ";
+            detail::write_json_string(out, stats[e.stage].name);
+            out << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e.thread
+                << ", \"ts\": " << static_cast<double>(e.start_ns) / 1000.0
+                << ", \"dur\": " << static_cast<double>(e.duration_ns) / 1000.0
+                << ", \"args\": ";
+            detail::write_counters(out, e.counters);
+            out << '}';
+        }
+        out << "\n]}\n";
+        out.flags(flags);
+    }
+
+private:
+    struct open_scope {
+        const profiler*  owner;
+        std::string_view name;
+        uint64_t         start_ns;
+        counter_values   counters;
+    };
+
+    struct name_hash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const noexcept {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+
+    [[nodiscard]] static std::vector<open_scope>& open_scopes() {
+        thread_local std::vector<open_scope> stack;
+        return stack;
+    }
+
+    [[nodiscard]] uint64_t now_ns() const noexcept {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now() - epoch_)
+                                         .count());
+    }
+
+    /// @brief Finds or adds a stage. Caller holds mutex_.
+    uint32_t stage_index(std::string_view name) {
+        if (auto it = index_.find(name); it != index_.end()) {
+            return it->second;
+        }
+        auto index = static_cast<uint32_t>(stages_.size());
+        stage_stats stats;
+        stats.name = std::string{name};
+        stages_.push_back(std::move(stats));
+        index_.emplace(std::string{name}, index);
+        return index;
+    }
+
+    profiler_options                      options_;
+    std::chrono::steady_clock::time_point epoch_;
+
+    mutable std::mutex                                             mutex_;
+    std::vector<stage_stats>                                       stages_;
+    std::unordered_map<std::string, uint32_t, name_hash, std::equal_to<>> index_;
+    std::vector<trace_event>                                       events_;
+    uint64_t                                                       dropped_events_ = 0;
+};
+
+}  // namespace Q::profile
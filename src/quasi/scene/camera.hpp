@@ -5,6 +5,7 @@
 
 #include <quasi/math/vec.hpp>
 #include <quasi/math/ray.hpp>
+#include <quasi/math/fast_math.hpp>
 
 #include <cmath>
 
@@ -35,7 +36,7 @@ struct camera {
     /// @return Ray from camera through the screen point.
     [[nodiscard]] math::ray get_ray(float u, float v) const {
         float theta = fov * 3.14159265359f / 180.0f;
-        float h = std::tan(theta / 2.0f);
+        float h = math::fast_tan(theta / 2.0f);
         float viewport_height = 2.0f * h;
         float viewport_width = aspect * viewport_height;
 
@@ -50,6 +51,13 @@ struct camera {
         math::vec3 target = lower_left + u * horizontal + v * vertical;
         return {position, math::normalize(target - position)};
     }
+
+    /// @brief Returns the ray cone spread angle of one pixel.
+    /// @param image_height Image height in pixels.
+    [[nodiscard]] float pixel_spread_angle(int image_height) const {
+        float theta = fov * 3.14159265359f / 180.0f;
+        return std::atan(2.0f * math::fast_tan(theta / 2.0f) / static_cast<float>(image_height));
+    }
 };
 
 }  // namespace Q::scene
@@ -5,6 +5,8 @@
 
 #include <quasi/math/vec.hpp>
 
+#include <span>
+
 namespace Q::scene {
 
 /// @brief Simple material for raytracing.
@@ -15,6 +17,32 @@ struct material {
     float metallic      = 0.0f;                 // 0 = dielectric, 1 = metal.
 };
 
+/// @brief Blends materials into one, e.g. for an aggregate LOD proxy.
+/// @param mats Materials to blend.
+/// @param weights Per-material weights, typically surface area.
+/// @return The weighted average, or a default material if all weights are zero.
+inline material average(std::span<const material> mats, std::span<const float> weights) {
+    material out{.albedo = {}, .roughness = 0.0f, .emission = {}, .metallic = 0.0f};
+    float total = 0.0f;
+    for (size_t i = 0; i < mats.size() && i < weights.size(); ++i) {
+        float w = weights[i];
+        out.albedo    += mats[i].albedo * w;
+        out.roughness += mats[i].roughness * w;
+        out.emission  += mats[i].emission * w;
+        out.metallic  += mats[i].metallic * w;
+        total += w;
+    }
+    if (total <= 0.0f) {
+        return {};
+    }
+    float inv = 1.0f / total;
+    out.albedo    *= inv;
+    out.roughness *= inv;
+    out.emission  *= inv;
+    out.metallic  *= inv;
+    return out;
+}
+
 /// @brief Predefined materials.
 namespace materials {
 
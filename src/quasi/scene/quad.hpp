@@ -5,7 +5,10 @@
 
 #include <quasi/math/vec.hpp>
 #include <quasi/math/ray.hpp>
+#include <quasi/math/aabb.hpp>
+#include <quasi/math/octahedral.hpp>
 
+#include <array>
 #include <cmath>
 #include <optional>
 
@@ -30,13 +33,94 @@ struct quad {
     [[nodiscard]] float area() const {
         return math::length(math::cross(u, v));
     }
+
+    /// @brief Computes the bounding box of the quad.
+    ///
+    /// Axis-aligned quads have zero thickness along one axis, so the box is
+    /// padded slightly to keep slab tests robust.
+    [[nodiscard]] math::aabb bounds() const {
+        math::aabb b;
+        b.expand(origin);
+        b.expand(origin + u);
+        b.expand(origin + v);
+        b.expand(origin + u + v);
+        b.min -= math::vec3{1e-4f};
+        b.max += math::vec3{1e-4f};
+        return b;
+    }
+
+    /// @brief Computes the bounding box of the part of the quad inside a slab.
+    ///
+    /// Clips the quad polygon against lo <= p[axis] <= hi. Used by spatial
+    /// split BVH builders to tighten the bounds of straddling references.
+    /// @param axis Slab axis (0 = x, 1 = y, 2 = z).
+    /// @param lo Lower slab plane.
+    /// @param hi Upper slab plane.
+    /// @return Padded bounds of the clipped polygon, or an empty box.
+    [[nodiscard]] math::aabb clipped_bounds(int axis, float lo, float hi) const {
+        // Each clip against a plane adds at most one vertex.
+        math::vec3 poly[6] = {origin, origin + u, origin + u + v, origin + v};
+        int count = 4;
+
+        auto clip = [&](float plane, float sign) {
+            math::vec3 out[6];
+            int n = 0;
+            for (int i = 0; i < count; ++i) {
+                math::vec3 a = poly[i];
+                math::vec3 b = poly[(i + 1) % count];
+                float da = (a[axis] - plane) * sign;
+                float db = (b[axis] - plane) * sign;
+                if (da >= 0.0f) {
+                    out[n++] = a;
+                }
+                if ((da >= 0.0f) != (db >= 0.0f)) {
+                    out[n++] = a + (b - a) * (da / (da - db));
+                }
+            }
+            count = n;
+            for (int i = 0; i < n; ++i) {
+                poly[i] = out[i];
+            }
+        };
+
+        clip(lo, 1.0f);
+        clip(hi, -1.0f);
+
+        math::aabb b;
+        for (int i = 0; i < count; ++i) {
+            b.expand(poly[i]);
+        }
+        if (!b.empty()) {
+            b.min -= math::vec3{1e-4f};
+            b.max += math::vec3{1e-4f};
+        }
+        return b;
+    }
 };
 
+/// @brief Builds the six outward-facing faces of a box.
+///
+/// Used as the coarsest stand-in for distant geometry (an aggregate LOD proxy).
+inline std::array<quad, 6> box_quads(const math::aabb& b) {
+    math::vec3 d = b.extent();
+    math::vec3 dx{d.x, 0.0f, 0.0f};
+    math::vec3 dy{0.0f, d.y, 0.0f};
+    math::vec3 dz{0.0f, 0.0f, d.z};
+    return {{
+        {b.min, dz, dy},                              // -x
+        {{b.max.x, b.min.y, b.min.z}, dy, dz},        // +x
+        {b.min, dx, dz},                              // -y
+        {{b.min.x, b.max.y, b.min.z}, dz, dx},        // +y
+        {b.min, dy, dx},                              // -z
+        {{b.min.x, b.min.y, b.max.z}, dx, dy},        // +z
+    }};
+}
+
 /// @brief Result of a ray-quad intersection.
 struct quad_hit_record {
     float t;              // Ray parameter at hit point.
     math::vec3 point;     // World-space hit point.
-    math::vec3 normal;    // Surface normal at hit.
+    math::oct_normal normal;  // Packed surface normal at hit.
     bool front_face;      // True if ray hit from front.
     float u_coord;        // Parametric u coordinate [0,1].
     float v_coord;        // Parametric v coordinate [0,1].
@@ -83,14 +167,14 @@ inline std::optional<quad_hit_record> intersect(
     math::vec3 planar = p - q.origin;
 
     // Project onto quad's local coordinates using the inverse of [u, v, n] matrix.
-    // We use the formula: alpha = (n x v) . planar / (n . (u x v))
-    //                     beta  = (u x n) . planar / (n . (u x v))
+    // We use the formula: alpha = n . (planar x v) / (n . (u x v))
+    //                     beta  = n . (u x planar) / (n . (u x v))
     // Since n = u x v, we have n . (u x v) = |u x v|^2 = area_sq
 
     math::vec3 w = n / area_sq;  // n / |n|^2
 
-    float alpha = math::dot(math::cross(w, q.v), planar);
-    float beta  = math::dot(math::cross(q.u, w), planar);
+    float alpha = math::dot(w, math::cross(planar, q.v));
+    float beta  = math::dot(w, math::cross(q.u, planar));
 
     // Check if point is inside quad.
     if (alpha < 0.0f || alpha > 1.0f || beta < 0.0f || beta > 1.0f) {
@@ -103,7 +187,7 @@ inline std::optional<quad_hit_record> intersect(
     rec.u_coord = alpha;
     rec.v_coord = beta;
     rec.front_face = denom < 0.0f;
-    rec.normal = rec.front_face ? normal : -normal;
+    rec.normal = math::oct_normal::encode(rec.front_face ? normal : -normal);
 
     return rec;
 }
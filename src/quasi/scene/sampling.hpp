@@ -0,0 +1,52 @@
+/// @file sampling.hpp
+/// @brief Direction sampling for path tracing.
+///
+/// CPU counterparts of the shader sampling routines. They use the
+/// polynomial approximations from fast_math.hpp, so batch loops over many
+/// samples vectorize.
+
+#pragma once
+
+#include <quasi/math/fast_math.hpp>
+#include <quasi/math/vec.hpp>
+
+#include <cmath>
+#include <span>
+
+namespace Q::scene {
+
+/// @brief Samples a cosine-weighted direction around a normal.
+/// @param normal Unit surface normal.
+/// @param u1 Uniform random number in [0, 1), drives azimuth.
+/// @param u2 Uniform random number in [0, 1), drives elevation.
+/// @return Unit direction in the hemisphere around @p normal.
+[[nodiscard]] inline math::vec3 cosine_sample_hemisphere(math::vec3 normal, float u1, float u2) {
+    auto [sin_phi, cos_phi] = math::fast_sincos(2.0f * math::k_pi * u1);
+    float cos_theta = std::sqrt(1.0f - u2);
+    float sin_theta = std::sqrt(u2);
+
+    // Orthonormal basis around the normal (same construction as the shader).
+    math::vec3 w = normal;
+    bool near_x = std::abs(w.x) > 0.9f;
+    math::vec3 a{math::select(near_x, 0.0f, 1.0f), math::select(near_x, 1.0f, 0.0f), 0.0f};
+    math::vec3 v = math::normalize(math::cross(w, a));
+    math::vec3 u = math::cross(w, v);
+
+    return u * (cos_phi * sin_theta) + v * (sin_phi * sin_theta) + w * cos_theta;
+}
+
+/// @brief Samples cosine-weighted directions for a batch of normals.
+/// @param normals Unit surface normals.
+/// @param u1 Azimuth random numbers, one per normal.
+/// @param u2 Elevation random numbers, one per normal.
+/// @param out Sampled directions, one per normal.
+inline void cosine_sample_hemisphere(std::span<const math::vec3> normals,
+                                     std::span<const float> u1,
+                                     std::span<const float> u2,
+                                     std::span<math::vec3> out) {
+    for (size_t i = 0; i < normals.size(); ++i) {
+        out[i] = cosine_sample_hemisphere(normals[i], u1[i], u2[i]);
+    }
+}
+
+}  // namespace Q::scene
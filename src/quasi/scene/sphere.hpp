@@ -5,6 +5,7 @@
 
 #include <quasi/math/vec.hpp>
 #include <quasi/math/ray.hpp>
+#include <quasi/math/octahedral.hpp>
 
 #include <cmath>
 #include <optional>
@@ -25,7 +26,7 @@ struct sphere {
 struct hit_record {
     float t;              // Ray parameter at hit point.
     math::vec3 point;     // World-space hit point.
-    math::vec3 normal;    // Surface normal at hit (facing ray origin).
+    math::oct_normal normal;  // Packed surface normal at hit (facing ray origin).
     bool front_face;      // True if ray hit from outside.
 };
 
@@ -69,7 +70,7 @@ inline std::optional<hit_record> intersect(
 
     math::vec3 outward_normal = (rec.point - s.center) / s.radius;
     rec.front_face = math::dot(r.direction, outward_normal) < 0.0f;
-    rec.normal = rec.front_face ? outward_normal : -outward_normal;
+    rec.normal = math::oct_normal::encode(rec.front_face ? outward_normal : -outward_normal);
 
     return rec;
 }
@@ -0,0 +1,578 @@
+/// @file accel_test.cpp
+/// @brief Unit tests for the acceleration structure module.
+
+#include <quasi/accel/accel.hpp>
+#include <quasi/scene/cornell_box.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace Q;
+using namespace Q::accel;
+
+namespace {
+
+/// @brief Generates small random quads scattered through a unit cube.
+std::vector<scene::quad> make_random_quads(uint32_t count, uint32_t seed) {
+    std::mt19937 rng{seed};
+    std::uniform_real_distribution<float> pos{-1.0f, 1.0f};
+    std::uniform_real_distribution<float> edge{-0.1f, 0.1f};
+
+    std::vector<scene::quad> quads;
+    for (uint32_t i = 0; i < count; ++i) {
+        quads.push_back({
+            {pos(rng), pos(rng), pos(rng)},
+            {edge(rng), edge(rng), edge(rng)},
+            {edge(rng), edge(rng), edge(rng)},
+        });
+    }
+    return quads;
+}
+
+std::vector<scene::quad> cornell_quads() {
+    std::vector<scene::quad> quads;
+    for (const auto& q : scene::make_cornell_box().quads) {
+        quads.push_back(q.geometry);
+    }
+    return quads;
+}
+
+/// @brief Axis-aligned walls, floors and ceilings spanning the scene, plus clutter.
+std::vector<scene::quad> make_architectural_quads(uint32_t clutter, uint32_t seed) {
+    std::vector<scene::quad> quads;
+    for (int i = 0; i <= 8; ++i) {
+        float c = -1.0f + 0.25f * static_cast<float>(i);
+        quads.push_back({{c, -1.0f, -1.0f}, {0.0f, 0.0f, 2.0f}, {0.0f, 2.0f, 0.0f}});
+        quads.push_back({{-1.0f, -1.0f, c}, {2.0f, 0.0f, 0.0f}, {0.0f, 2.0f, 0.0f}});
+        quads.push_back({{-1.0f, c, -1.0f}, {2.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 2.0f}});
+    }
+    auto small = make_random_quads(clutter, seed);
+    quads.insert(quads.end(), small.begin(), small.end());
+    return quads;
+}
+
+std::vector<math::aabb> bounds_of(const std::vector<scene::quad>& quads) {
+    std::vector<math::aabb> bounds;
+    for (const auto& q : quads) {
+        bounds.push_back(q.bounds());
+    }
+    return bounds;
+}
+
+std::vector<math::ray> make_random_rays(uint32_t count, uint32_t seed) {
+    std::mt19937 rng{seed};
+    std::uniform_real_distribution<float> pos{-1.5f, 1.5f};
+    std::uniform_real_distribution<float> dir{-1.0f, 1.0f};
+
+    std::vector<math::ray> rays;
+    for (uint32_t i = 0; i < count; ++i) {
+        math::vec3 d{dir(rng), dir(rng), dir(rng)};
+        if (math::length_squared(d) < 1e-4f) {
+            d = {0.0f, 0.0f, -1.0f};
+        }
+        rays.push_back({{pos(rng), pos(rng), pos(rng)}, math::normalize(d)});
+    }
+    return rays;
+}
+
+/// @brief Closest-hit distance by testing every quad.
+std::optional<float> brute_force(const math::ray& r, const std::vector<scene::quad>& quads) {
+    std::optional<float> closest;
+    float t_max = 1e30f;
+    for (const auto& q : quads) {
+        if (auto hit = scene::intersect(r, q, 0.001f, t_max)) {
+            t_max = hit->t;
+            closest = hit->t;
+        }
+    }
+    return closest;
+}
+
+/// @brief Closest-hit distance through an acceleration structure.
+template <typename Tree>
+std::optional<float> trace(const Tree& tree, const math::ray& r, const std::vector<scene::quad>& quads,
+                           uint64_t* prim_tests = nullptr) {
+    float t_max = 1e30f;
+    bool hit = tree.intersect(r, t_max, [&](uint32_t prim, float& t) {
+        if (prim_tests) ++*prim_tests;
+        auto rec = scene::intersect(r, quads[prim], 0.001f, t);
+        if (rec) t = rec->t;
+        return rec.has_value();
+    });
+    return hit ? std::optional<float>{t_max} : std::nullopt;
+}
+
+}  // namespace
+
+// ============================================================================
+// aabb tests
+// ============================================================================
+
+TEST_CASE("aabb expand and surface area", "[accel][aabb]") {
+    math::aabb b;
+    REQUIRE(b.empty());
+    REQUIRE(b.surface_area() == 0.0f);
+
+    b.expand({0.0f, 0.0f, 0.0f});
+    b.expand({1.0f, 2.0f, 3.0f});
+    REQUIRE_FALSE(b.empty());
+    REQUIRE(b.surface_area() == 2.0f * (2.0f + 6.0f + 3.0f));
+    REQUIRE(b.largest_axis() == 2);
+}
+
+TEST_CASE("aabb slab test", "[accel][aabb]") {
+    math::aabb b{{-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}};
+
+    math::ray toward{{0.0f, 0.0f, 5.0f}, {0.0f, 0.0f, -1.0f}};
+    REQUIRE(math::intersect(b, toward.origin, math::inverse_direction(toward), 0.0f, 100.0f) == 4.0f);
+
+    math::ray away{{0.0f, 0.0f, 5.0f}, {0.0f, 0.0f, 1.0f}};
+    REQUIRE(math::intersect(b, away.origin, math::inverse_direction(away), 0.0f, 100.0f) > 100.0f);
+}
+
+// ============================================================================
+// bvh tests
+// ============================================================================
+
+TEST_CASE("bvh references every primitive exactly once", "[accel][bvh]") {
+    auto quads = make_random_quads(300, 1);
+    auto tree = bvh::build(bounds_of(quads));
+
+    std::vector<int> seen(quads.size(), 0);
+    for (const auto& node : tree.nodes()) {
+        if (node.is_leaf()) {
+            for (uint32_t i = 0; i < node.count; ++i) {
+                ++seen[tree.primitive_indices()[node.offset + i]];
+            }
+        }
+    }
+    for (int count : seen) {
+        REQUIRE(count == 1);
+    }
+}
+
+TEST_CASE("bvh closest hit matches brute force", "[accel][bvh]") {
+    SECTION("random quads") {
+        auto quads = make_random_quads(500, 2);
+        auto tree = bvh::build(bounds_of(quads));
+        for (const auto& r : make_random_rays(2000, 3)) {
+            REQUIRE(trace(tree, r, quads) == brute_force(r, quads));
+        }
+    }
+
+    SECTION("cornell box") {
+        auto quads = cornell_quads();
+        auto tree = bvh::build(bounds_of(quads), {.max_leaf_size = 1});
+        for (const auto& r : make_random_rays(2000, 4)) {
+            REQUIRE(trace(tree, r, quads) == brute_force(r, quads));
+        }
+    }
+}
+
+TEST_CASE("bvh instrumented traversal finds the same hits and counts its work", "[accel][bvh]") {
+    auto quads = make_random_quads(500, 5);
+    auto tree = bvh::build(bounds_of(quads));
+    auto rays = make_random_rays(500, 6);
+
+    traversal_stats total;
+    for (const auto& r : rays) {
+        uint64_t callbacks = 0;
+        auto test = [&](uint32_t prim, float& t) {
+            ++callbacks;
+            auto rec = scene::intersect(r, quads[prim], 0.001f, t);
+            if (rec) t = rec->t;
+            return rec.has_value();
+        };
+        traversal_stats stats;
+        float t_plain = 1e30f;
+        float t_instrumented = 1e30f;
+        bool plain = tree.intersect(r, t_plain, test);
+        callbacks = 0;
+        bool instrumented = tree.intersect_instrumented(r, t_instrumented, test, stats);
+
+        REQUIRE(plain == instrumented);
+        REQUIRE(t_plain == t_instrumented);
+        REQUIRE(stats.rays == 1);
+        REQUIRE(stats.nodes_visited >= 1);
+        REQUIRE(stats.prims_tested == callbacks);
+        REQUIRE(stats.leaves_visited <= stats.nodes_visited);
+        total += stats;
+    }
+    REQUIRE(total.rays == rays.size());
+    REQUIRE(total.line_accesses == 0);  // No cache model for plain bvh.
+}
+
+TEST_CASE("bvh handles empty input", "[accel][bvh]") {
+    auto tree = bvh::build({});
+    REQUIRE(tree.empty());
+
+    float t_max = 1e30f;
+    REQUIRE_FALSE(tree.intersect({{0, 0, 0}, {0, 0, -1}}, t_max, [](uint32_t, float&) { return true; }));
+}
+
+TEST_CASE("bvh builders stop splitting at the depth limit", "[accel][bvh]") {
+    auto quads = make_random_quads(500, 10);
+    auto bounds = bounds_of(quads);
+    auto rays = make_random_rays(500, 11);
+    build_options options{.max_leaf_size = 1, .max_depth = 3};
+
+    auto tree = bvh::build(bounds, options);
+    uint32_t deepest = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> stack{{0u, 0u}};
+    while (!stack.empty()) {
+        auto [index, depth] = stack.back();
+        stack.pop_back();
+        const auto& node = tree.nodes()[index];
+        deepest = std::max(deepest, depth);
+        if (!node.is_leaf()) {
+            stack.push_back({node.offset, depth + 1});
+            stack.push_back({node.offset + 1, depth + 1});
+        }
+    }
+    REQUIRE(deepest == 3);
+    REQUIRE(tree.nodes().size() == 15);
+
+    auto lazy = lazy_bvh::build(bounds, {.build = options, .eager_depth = 0});
+    lazy.expand_all();
+    REQUIRE(lazy.is_fully_built());
+    REQUIRE(lazy.node_count() == 15);
+
+    for (const auto& r : rays) {
+        auto expected = brute_force(r, quads);
+        REQUIRE(trace(tree, r, quads) == expected);
+        REQUIRE(trace(lazy, r, quads) == expected);
+    }
+
+    // Requests past the traversal stack are clamped.
+    REQUIRE(detail::depth_limit({.max_depth = 1000}) == k_max_depth);
+}
+
+// ============================================================================
+// lazy_bvh tests
+// ============================================================================
+
+TEST_CASE("lazy_bvh builds only the top levels up front", "[accel][lazy_bvh]") {
+    auto quads = make_random_quads(2000, 5);
+    auto bounds = bounds_of(quads);
+
+    auto eager = bvh::build(bounds);
+    auto lazy = lazy_bvh::build(bounds, {.eager_depth = 2});
+
+    REQUIRE(lazy.node_count() == 7);
+    REQUIRE(lazy.pending_count() > 0);
+    REQUIRE_FALSE(lazy.is_fully_built());
+    REQUIRE(lazy.node_count() < eager.nodes().size());
+
+    // A single ray only expands the nodes along its path.
+    math::ray r{{0.0f, 0.0f, 3.0f}, {0.0f, 0.0f, -1.0f}};
+    REQUIRE(trace(lazy, r, quads) == brute_force(r, quads));
+    REQUIRE(lazy.node_count() < eager.nodes().size());
+
+    lazy.expand_all();
+    REQUIRE(lazy.is_fully_built());
+    REQUIRE(lazy.node_count() == eager.nodes().size());
+}
+
+TEST_CASE("lazy_bvh closest hit matches brute force", "[accel][lazy_bvh]") {
+    auto quads = make_random_quads(500, 6);
+    auto lazy = lazy_bvh::build(bounds_of(quads), {.eager_depth = 0});
+
+    for (const auto& r : make_random_rays(2000, 7)) {
+        REQUIRE(trace(lazy, r, quads) == brute_force(r, quads));
+    }
+}
+
+TEST_CASE("lazy_bvh expands safely from concurrent traversals", "[accel][lazy_bvh]") {
+    auto quads = make_random_quads(3000, 8);
+    auto lazy = lazy_bvh::build(bounds_of(quads), {.eager_depth = 1});
+    auto rays = make_random_rays(1000, 9);
+
+    std::vector<std::optional<float>> expected;
+    for (const auto& r : rays) {
+        expected.push_back(brute_force(r, quads));
+    }
+
+    constexpr int k_threads = 4;
+    std::vector<int> mismatches(k_threads, 0);
+    {
+        std::vector<std::jthread> threads;
+        for (int t = 0; t < k_threads; ++t) {
+            threads.emplace_back([&, t] {
+                for (size_t i = 0; i < rays.size(); ++i) {
+                    if (trace(lazy, rays[i], quads) != expected[i]) {
+                        ++mismatches[t];
+                    }
+                }
+            });
+        }
+        threads.emplace_back([&] { lazy.expand_all(); });
+    }
+
+    for (int m : mismatches) {
+        REQUIRE(m == 0);
+    }
+    REQUIRE(lazy.is_fully_built());
+}
+
+// ============================================================================
+// sbvh tests
+// ============================================================================
+
+namespace {
+
+auto quad_clipper(const std::vector<scene::quad>& quads) {
+    return [&quads](uint32_t prim, int axis, float lo, float hi) {
+        return quads[prim].clipped_bounds(axis, lo, hi);
+    };
+}
+
+}  // namespace
+
+TEST_CASE("quad clipped_bounds", "[accel][sbvh]") {
+    scene::quad floor{{-1.0f, 0.0f, -1.0f}, {2.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 2.0f}};
+
+    auto half = floor.clipped_bounds(0, 0.0f, 0.5f);
+    REQUIRE(half.min.x > -1e-3f);
+    REQUIRE(half.max.x < 0.5f + 1e-3f);
+    REQUIRE(half.min.z < -0.99f);
+    REQUIRE(half.max.z > 0.99f);
+
+    REQUIRE(floor.clipped_bounds(1, 0.5f, 1.0f).empty());
+
+    // A diagonal quad clipped in x also shrinks in z.
+    scene::quad diagonal{{-1.0f, 0.0f, -1.0f}, {2.0f, 0.0f, 2.0f}, {0.0f, 1.0f, 0.0f}};
+    auto corner = diagonal.clipped_bounds(0, -1.0f, 0.0f);
+    REQUIRE(corner.max.z < 0.01f);
+}
+
+TEST_CASE("sbvh closest hit matches brute force", "[accel][sbvh]") {
+    SECTION("cornell box") {
+        auto quads = cornell_quads();
+        auto tree = build_sbvh(bounds_of(quads), quad_clipper(quads), {.build = {.max_leaf_size = 1}});
+        for (const auto& r : make_random_rays(2000, 10)) {
+            REQUIRE(trace(tree, r, quads) == brute_force(r, quads));
+        }
+    }
+
+    SECTION("architectural") {
+        auto quads = make_architectural_quads(300, 11);
+        auto tree = build_sbvh(bounds_of(quads), quad_clipper(quads));
+        for (const auto& r : make_random_rays(2000, 12)) {
+            REQUIRE(trace(tree, r, quads) == brute_force(r, quads));
+        }
+    }
+}
+
+TEST_CASE("sbvh respects the duplication budget", "[accel][sbvh]") {
+    auto quads = make_architectural_quads(300, 13);
+    auto bounds = bounds_of(quads);
+
+    auto none = build_sbvh(bounds, quad_clipper(quads), {.duplication_budget = 0.0f});
+    REQUIRE(none.primitive_indices().size() == quads.size());
+
+    auto some = build_sbvh(bounds, quad_clipper(quads), {.duplication_budget = 0.25f});
+    REQUIRE(some.primitive_indices().size() > quads.size());
+    REQUIRE(some.primitive_indices().size() <= quads.size() + quads.size() / 4);
+}
+
+TEST_CASE("sbvh reduces primitive tests for large overlapping quads", "[accel][sbvh]") {
+    auto quads = make_architectural_quads(1000, 14);
+    auto bounds = bounds_of(quads);
+
+    auto object_split  = bvh::build(bounds);
+    auto spatial_split = build_sbvh(bounds, quad_clipper(quads));
+
+    uint64_t object_tests = 0;
+    uint64_t spatial_tests = 0;
+    for (const auto& r : make_random_rays(2000, 15)) {
+        trace(object_split, r, quads, &object_tests);
+        trace(spatial_split, r, quads, &spatial_tests);
+    }
+    REQUIRE(spatial_tests < object_tests);
+}
+
+// ============================================================================
+// layout tests
+// ============================================================================
+
+TEST_CASE("reorder preserves closest hits in every order", "[accel][layout]") {
+    auto quads = make_random_quads(1500, 16);
+    auto tree = bvh::build(bounds_of(quads));
+
+    for (auto order : {node_order::breadth_first, node_order::depth_first,
+                       node_order::van_emde_boas, node_order::treelet}) {
+        auto ordered = reorder(tree, {.order = order, .treelet_bytes = 512});
+        REQUIRE(ordered.hot_nodes().size() == tree.nodes().size());
+        REQUIRE(ordered.primitive_indices().size() == tree.primitive_indices().size());
+
+        for (const auto& r : make_random_rays(300, 17)) {
+            auto expected = brute_force(r, quads);
+            auto actual = trace(ordered, r, quads);
+            REQUIRE(expected.has_value() == actual.has_value());
+            if (expected) {
+                REQUIRE(*actual == *expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("reorder links hot and cold nodes consistently", "[accel][layout]") {
+    auto quads = make_random_quads(500, 18);
+    auto ordered = reorder(bvh::build(bounds_of(quads)), {.order = node_order::depth_first});
+
+    auto hot = ordered.hot_nodes();
+    auto cold = ordered.cold_nodes();
+    uint32_t leaf_prims = 0;
+    for (uint32_t i = 0; i < hot.size(); ++i) {
+        if (hot[i].left == k_leaf_flag) {
+            leaf_prims += cold[i].count;
+            continue;
+        }
+        // Depth-first order places the left child directly after its parent.
+        REQUIRE(hot[i].left == i + 1);
+        REQUIRE(cold[hot[i].left].parent == i);
+        REQUIRE(cold[hot[i].right].parent == i);
+        REQUIRE(cold[hot[i].right].depth == cold[i].depth + 1);
+    }
+    REQUIRE(leaf_prims == quads.size());
+}
+
+TEST_CASE("cache-friendly orders reduce simulated cache misses", "[accel][layout]") {
+    auto quads = make_random_quads(20000, 19);
+    auto tree = bvh::build(bounds_of(quads));
+    auto rays = make_random_rays(2000, 20);
+
+    auto misses = [&](node_order order) {
+        auto ordered = reorder(tree, {.order = order});
+        cache_model cache{64, 16, 4};  // 4 KiB, small enough to thrash.
+        traversal_stats stats;
+        for (const auto& r : rays) {
+            float t_max = 1e30f;
+            ordered.intersect_instrumented(r, t_max, [&](uint32_t prim, float& t) {
+                auto rec = scene::intersect(r, quads[prim], 0.001f, t);
+                if (rec) t = rec->t;
+                return rec.has_value();
+            }, stats, cache);
+        }
+        REQUIRE(stats.rays == rays.size());
+        REQUIRE(stats.cache_misses <= stats.line_accesses);
+        INFO(to_string(order) << ": " << to_string(stats));
+        return stats.cache_misses;
+    };
+
+    uint64_t bfs = misses(node_order::breadth_first);
+    REQUIRE(misses(node_order::depth_first) < bfs);
+    REQUIRE(misses(node_order::van_emde_boas) < bfs);
+    REQUIRE(misses(node_order::treelet) < bfs);
+}
+
+// ============================================================================
+// lod tests
+// ============================================================================
+
+namespace {
+
+/// @brief A unit plate at z = 0 in three levels: a 16x16 quad grid, a single
+///        quad, and a box proxy.
+struct plate_levels {
+    std::vector<std::vector<scene::quad>> quads;
+    lod_geometry geometry;
+};
+
+plate_levels make_plate() {
+    plate_levels p;
+    constexpr int n = 16;
+    constexpr float cell = 1.0f / n;
+
+    std::vector<scene::quad> fine;
+    for (int y = 0; y < n; ++y) {
+        for (int x = 0; x < n; ++x) {
+            fine.push_back({{x * cell, y * cell, 0.0f}, {cell, 0.0f, 0.0f}, {0.0f, cell, 0.0f}});
+        }
+    }
+    std::vector<scene::quad> coarse{{{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}}};
+    auto box = scene::box_quads({{0.0f, 0.0f, -0.01f}, {1.0f, 1.0f, 0.01f}});
+    std::vector<scene::quad> proxy(box.begin(), box.end());
+
+    p.quads = {fine, coarse, proxy};
+    p.geometry.levels.push_back({bvh::build(bounds_of(fine)), 0.0f});
+    p.geometry.levels.push_back({bvh::build(bounds_of(coarse)), cell});
+    p.geometry.levels.push_back({bvh::build(bounds_of(proxy)), 1.0f});
+    return p;
+}
+
+}  // namespace
+
+TEST_CASE("select_level picks the coarsest level within the footprint", "[accel][lod]") {
+    auto plate = make_plate();
+    REQUIRE(select_level(plate.geometry, 0.0f) == 0);
+    REQUIRE(select_level(plate.geometry, 0.01f) == 0);
+    REQUIRE(select_level(plate.geometry, 0.1f) == 1);
+    REQUIRE(select_level(plate.geometry, 5.0f) == 2);
+}
+
+TEST_CASE("box_quads faces point outward", "[accel][lod]") {
+    math::aabb box{{-1.0f, -2.0f, -3.0f}, {1.0f, 2.0f, 3.0f}};
+    for (const auto& face : scene::box_quads(box)) {
+        math::vec3 center = face.origin + face.u * 0.5f + face.v * 0.5f;
+        REQUIRE(math::dot(face.normal(), center - box.centroid()) > 0.0f);
+    }
+}
+
+TEST_CASE("instance_bvh selects coarser levels for distant instances", "[accel][lod]") {
+    auto plate = make_plate();
+
+    // A 20x20 field of plates receding from the camera.
+    std::vector<lod_instance> instances;
+    for (int row = 0; row < 20; ++row) {
+        for (int col = 0; col < 20; ++col) {
+            instances.push_back({0, {col * 1.5f - 15.0f, -2.0f, -2.0f - row * 12.0f}, 1.0f});
+        }
+    }
+
+    auto lod = instance_bvh::build({plate.geometry}, instances);
+    auto full = instance_bvh::build({plate.geometry}, instances, {.lod_bias = 0.0f});
+
+    auto cam = scene::camera::look_at({0.0f, 0.0f, 0.0f}, {0.0f, -0.4f, -10.0f});
+    cam.aspect = 1.0f;
+    constexpr int res = 96;
+    math::ray_cone cone{0.0f, cam.pixel_spread_angle(res)};
+
+    uint64_t lod_tests = 0;
+    uint64_t full_tests = 0;
+    uint32_t levels_used[3] = {};
+    int agree = 0;
+    int hits = 0;
+
+    auto shoot = [&](const instance_bvh& tree, const math::ray& r, uint64_t& tests, bool record) {
+        float t_max = 1e30f;
+        return tree.intersect(r, cone, t_max, [&](const lod_candidate& c, float& t) {
+            ++tests;
+            if (record) ++levels_used[c.level];
+            auto rec = scene::intersect(c.object_ray, plate.quads[c.level][c.prim], 0.001f, t);
+            if (rec) t = rec->t;
+            return rec.has_value();
+        });
+    };
+
+    for (int y = 0; y < res; ++y) {
+        for (int x = 0; x < res; ++x) {
+            auto r = cam.get_ray((x + 0.5f) / res, (y + 0.5f) / res);
+            bool a = shoot(lod, r, lod_tests, true);
+            bool b = shoot(full, r, full_tests, false);
+            agree += a == b;
+            hits += b;
+        }
+    }
+
+    REQUIRE(hits > 0);
+    REQUIRE(levels_used[0] > 0);
+    REQUIRE(levels_used[1] + levels_used[2] > 0);
+    REQUIRE(lod_tests < full_tests);
+    // Coverage barely changes: only sub-pixel edge differences are allowed.
+    REQUIRE(agree >= res * res * 98 / 100);
+}
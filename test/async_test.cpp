@@ -5,8 +5,27 @@
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstring>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
+#if defined(Q_PLATFORM_LINUX)
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
 using namespace Q::async;
 
 // ============================================================================
@@ -192,6 +211,127 @@ TEST_CASE("wait_until suspends until predicate is true", "[async][awaitables]")
     REQUIRE(completed);
 }
 
+TEST_CASE("scheduler leaves awaited tasks to their awaiter", "[async][scheduler]") {
+    scheduler sched;
+    int finished = 0;
+
+    // The inner task yields, so the scheduler resumes it directly; the
+    // outer task's frame still owns it and destroys it.
+    auto inner = [&]() -> task<void> {
+        co_await yield();
+        ++finished;
+    };
+    auto outer = [&]() -> task<void> {
+        co_await inner();
+        co_await inner();
+        ++finished;
+    };
+    sched.spawn(outer());
+    sched.run_until_empty();
+    REQUIRE(finished == 3);
+}
+
+TEST_CASE("scheduler destroys spawned tasks as they finish", "[async][scheduler]") {
+    // Counts live coroutine frames through a local that each frame destroys.
+    struct frame_counter {
+        int& live;
+        explicit frame_counter(int& l) : live{l} { ++live; }
+        ~frame_counter() { --live; }
+    };
+    int live = 0;
+    auto worker = [&](int yields) -> task<void> {
+        frame_counter counter{live};
+        for (int i = 0; i < yields; ++i) {
+            co_await yield();
+        }
+    };
+
+    {
+        scheduler sched;
+        for (int i = 0; i < 1000; ++i) {
+            sched.spawn(worker(i % 10));
+        }
+        sched.tick();
+        REQUIRE(live == 900);  // A tenth never yields; their frames are gone.
+        for (int t = 1; t < 5; ++t) {
+            sched.tick();
+            REQUIRE(live == 900 - 100 * t);
+        }
+
+        // Unfinished tasks go with the scheduler.
+        sched.spawn(worker(1000));
+    }
+    REQUIRE(live == 0);
+}
+
+// ============================================================================
+// sync_wait tests
+// ============================================================================
+
+TEST_CASE("sync_wait returns results and rethrows", "[async][sync_wait]") {
+    auto value = []() -> task<int> {
+        co_await yield();
+        co_return 42;
+    };
+    auto fail = []() -> task<void> {
+        co_await yield();
+        throw std::runtime_error{"failed"};
+    };
+    REQUIRE(sync_wait(value()) == 42);
+    REQUIRE_THROWS_AS(sync_wait(fail()), std::runtime_error);
+}
+
+TEST_CASE("sync_wait keeps nested yields off the caller's scheduler", "[async][sync_wait]") {
+    scheduler sched;
+    int inner_steps = 0;
+    size_t queued_meanwhile = 0;
+
+    auto inner = [&]() -> task<void> {
+        for (int i = 0; i < 3; ++i) {
+            ++inner_steps;
+            co_await yield();
+        }
+    };
+    auto outer = [&]() -> task<void> {
+        sync_wait(inner());
+        queued_meanwhile = sched.size();
+        co_return;
+    };
+    sched.spawn(outer());
+    sched.tick();  // The whole sync_wait runs inside this one tick.
+    REQUIRE(inner_steps == 3);
+    REQUIRE(queued_meanwhile == 0);
+    REQUIRE(sched.empty());
+}
+
+TEST_CASE("sync_wait parks until another thread completes the task", "[async][sync_wait]") {
+    // Resumes the awaiting coroutine on a new thread after a delay.
+    struct resume_elsewhere {
+        std::thread& thread;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            thread = std::thread{[h] {
+                std::this_thread::sleep_for(std::chrono::milliseconds{20});
+                h.resume();
+            }};
+        }
+        void await_resume() const noexcept {}
+    };
+
+    std::thread worker;
+    auto main_id = std::this_thread::get_id();
+    std::thread::id finished_on;
+    auto hop = [&]() -> task<int> {
+        co_await resume_elsewhere{worker};
+        finished_on = std::this_thread::get_id();
+        co_return 7;
+    };
+    REQUIRE(sync_wait(hop()) == 7);
+    worker.join();
+    REQUIRE(finished_on != main_id);
+}
+
 // ============================================================================
 // file_watcher tests
 // ============================================================================
@@ -219,3 +359,420 @@ TEST_CASE("multi_file_watcher basic operations", "[async][file_watcher]") {
     // No files exist, so no changes
     REQUIRE_FALSE(watcher.poll_change().has_value());
 }
+
+// ============================================================================
+// thread_pool tests
+// ============================================================================
+
+TEST_CASE("thread_pool parallel_for covers every index once", "[async][thread_pool]") {
+    // Two fake L3 domains, unpinned.
+    thread_pool pool{{{Q::platform::k_unpinned, 0}, {Q::platform::k_unpinned, 0},
+                      {Q::platform::k_unpinned, 7}}};
+    REQUIRE(pool.size() == 3);
+    REQUIRE(pool.domain_count() == 2);
+
+    for (uint32_t grain : {1u, 4u, 1000u}) {
+        std::vector<std::atomic<int>> hits(1001);
+        std::atomic<bool> bad_worker{false};
+        pool.parallel_for(static_cast<uint32_t>(hits.size()), [&](uint32_t i, uint32_t worker) {
+            hits[i].fetch_add(1);
+            if (worker >= pool.size()) bad_worker = true;
+        }, grain);
+
+        for (const auto& h : hits) {
+            REQUIRE(h.load() == 1);
+        }
+        REQUIRE_FALSE(bad_worker.load());
+    }
+}
+
+TEST_CASE("thread_pool rethrows worker exceptions", "[async][thread_pool]") {
+    thread_pool pool{Q::platform::host_topology(), Q::platform::pin_policy::none, 2};
+    REQUIRE(pool.size() >= 1);
+
+    REQUIRE_THROWS_AS(pool.parallel_for(64, [](uint32_t i, uint32_t) {
+        if (i == 17) throw std::runtime_error{"boom"};
+    }), std::runtime_error);
+
+    // Still usable afterwards.
+    std::atomic<uint32_t> sum{0};
+    pool.parallel_for(10, [&](uint32_t i, uint32_t) { sum += i; });
+    REQUIRE(sum == 45);
+}
+
+TEST_CASE("thread_pool submit, wait_idle and nested parallel_for", "[async][thread_pool]") {
+    thread_pool pool{{{Q::platform::k_unpinned, 0}, {Q::platform::k_unpinned, 1}}};
+    REQUIRE_FALSE(pool.current_worker().has_value());
+
+    std::atomic<int> tasks{0};
+    std::atomic<int> inner{0};
+    std::atomic<bool> on_worker{true};
+    for (int i = 0; i < 50; ++i) {
+        pool.submit([&] {
+            on_worker = on_worker && pool.current_worker().has_value();
+            // From a worker, parallel_for runs inline instead of deadlocking.
+            pool.parallel_for(4, [&](uint32_t, uint32_t) { inner.fetch_add(1); });
+            tasks.fetch_add(1);
+        });
+    }
+    pool.wait_idle();
+    REQUIRE(tasks == 50);
+    REQUIRE(inner == 200);
+    REQUIRE(on_worker.load());
+    REQUIRE_FALSE(pool.run_pending());
+}
+
+// ============================================================================
+// task_graph tests
+// ============================================================================
+
+TEST_CASE("task_graph runs nodes after their predecessors", "[async][task_graph]") {
+    thread_pool pool{Q::platform::host_topology(), Q::platform::pin_policy::none, 4};
+    graph_executor executor{pool};
+
+    // A diamond: build -> {left, right} -> join.
+    std::atomic<int> clock{0};
+    int build_at = -1, left_at = -1, right_at = -1, join_at = -1;
+    task_graph graph;
+    auto build = graph.add("build", [&] { build_at = clock.fetch_add(1); });
+    auto left  = graph.add("left", [&] { left_at = clock.fetch_add(1); });
+    auto right = graph.add("right", [&] { right_at = clock.fetch_add(1); });
+    auto join  = graph.add("join", [&] { join_at = clock.fetch_add(1); });
+    REQUIRE(graph.precede(build, left).has_value());
+    REQUIRE(graph.precede(build, right).has_value());
+    REQUIRE(graph.precede(left, join).has_value());
+    REQUIRE(graph.precede(right, join).has_value());
+
+    auto run = executor.launch(graph);
+    REQUIRE(run.has_value());
+    run->wait();
+    REQUIRE(run->done());
+    REQUIRE(build_at == 0);
+    REQUIRE(left_at > build_at);
+    REQUIRE(right_at > build_at);
+    REQUIRE(join_at == 3);
+
+    REQUIRE(graph.precede(join, 7).error() == graph_error::bad_node);
+    REQUIRE(graph.precede(join, join).error() == graph_error::self_edge);
+    REQUIRE(graph.precede(join, build).has_value());
+    REQUIRE(executor.launch(graph).error() == graph_error::cycle);
+
+    task_graph empty;
+    auto nothing = executor.launch(empty);
+    REQUIRE(nothing.has_value());
+    REQUIRE(nothing->done());
+}
+
+TEST_CASE("task_graph runs overlap except at serial nodes", "[async][task_graph]") {
+    thread_pool pool{{{Q::platform::k_unpinned, 0}, {Q::platform::k_unpinned, 0}}};
+    graph_executor executor{pool};
+
+    // Run 0's denoise waits until run 1 has traced, which only overlap allows.
+    std::atomic<bool> traced_next{false};
+    std::atomic<bool> overlapped{false};
+    std::vector<uint64_t> accumulated;  // Serial, so no lock.
+    task_graph frame;
+    auto trace = frame.add("trace", [&](uint64_t run) {
+        if (run == 1) {
+            traced_next = true;
+        }
+    });
+    auto accumulate = frame.add("accumulate", [&](uint64_t run) { accumulated.push_back(run); }, true);
+    auto denoise = frame.add("denoise", [&](uint64_t run) {
+        if (run == 0) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+            while (!traced_next && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+            overlapped = traced_next.load();
+        }
+    });
+    REQUIRE(frame.precede(trace, accumulate).has_value());
+    REQUIRE(frame.precede(accumulate, denoise).has_value());
+
+    std::vector<graph_run> runs;
+    for (int i = 0; i < 16; ++i) {
+        runs.push_back(*executor.launch(frame));
+    }
+    for (auto& r : runs) {
+        r.wait();
+    }
+    REQUIRE(overlapped.load());
+    REQUIRE(runs[5].index() == 5);
+    REQUIRE(accumulated.size() == 16);
+    for (uint64_t i = 0; i < accumulated.size(); ++i) {
+        REQUIRE(accumulated[i] == i);
+    }
+}
+
+TEST_CASE("task_graph skips the rest of a failed run", "[async][task_graph]") {
+    thread_pool pool{Q::platform::host_topology(), Q::platform::pin_policy::none, 2};
+    graph_executor executor{pool};
+
+    std::atomic<int> after{0};
+    task_graph graph;
+    auto fail = graph.add("fail", [](uint64_t run) {
+        if (run == 0) {
+            throw std::runtime_error{"boom"};
+        }
+    });
+    auto next = graph.add("next", [&] { after.fetch_add(1); }, true);
+    REQUIRE(graph.precede(fail, next).has_value());
+
+    auto first = executor.launch(graph);
+    auto second = executor.launch(graph);
+    REQUIRE_THROWS_AS(first->wait(), std::runtime_error);
+    second->wait();  // Serial nodes are still released by a failed run.
+    REQUIRE(after == 1);
+}
+
+// ============================================================================
+// task_group tests
+// ============================================================================
+
+TEST_CASE("task_group bounds its running children", "[async][task_group]") {
+    scheduler sched;
+    int running = 0;
+    int most = 0;
+    int finished = 0;
+    bool joined = false;
+
+    auto child = [&](int ticks) -> task<void> {
+        most = std::max(most, ++running);
+        for (int i = 0; i < ticks; ++i) {
+            co_await yield();
+        }
+        --running;
+        ++finished;
+    };
+    auto parent = [&]() -> task<void> {
+        task_group group{3, error_policy::run_all, &sched};
+        for (int i = 0; i < 10; ++i) {
+            co_await group.submit(child(1 + i % 4));
+            REQUIRE(group.running() + group.queued() <= 3);
+        }
+        co_await group.join();
+        REQUIRE(group.peak() == 3);
+        REQUIRE(group.completed() == 10);
+        joined = true;
+    };
+
+    sched.spawn(parent());
+    sched.run_until_empty();
+    REQUIRE(joined);
+    REQUIRE(finished == 10);
+    REQUIRE(most == 3);
+}
+
+TEST_CASE("task_group join rethrows the first child error", "[async][task_group]") {
+    scheduler sched;
+    int finished = 0;
+    bool caught = false;
+    bool saw_cancel = false;
+
+    auto child = [&](task_group& group, int id) -> task<void> {
+        co_await yield();
+        if (id == 1) {
+            throw std::runtime_error{"child failed"};
+        }
+        co_await yield();
+        saw_cancel = saw_cancel || group.cancelled();
+        ++finished;
+    };
+    auto parent = [&](error_policy policy) -> task<void> {
+        task_group group{2, policy, &sched};
+        for (int i = 0; i < 6; ++i) {
+            group.spawn(child(group, i));
+        }
+        try {
+            co_await group.join();
+        } catch (const std::runtime_error&) {
+            caught = true;
+        }
+    };
+
+    sched.spawn(parent(error_policy::run_all));
+    sched.run_until_empty();
+    REQUIRE(caught);
+    REQUIRE(finished == 5);
+    REQUIRE_FALSE(saw_cancel);
+
+    // Child 0 was running alongside child 1 and sees the cancel; 2..5 never start.
+    finished = 0;
+    caught = false;
+    sched.spawn(parent(error_policy::cancel_on_error));
+    sched.run_until_empty();
+    REQUIRE(caught);
+    REQUIRE(finished == 1);
+    REQUIRE(saw_cancel);
+}
+
+// ============================================================================
+// reactor tests
+// ============================================================================
+
+#if defined(Q_PLATFORM_LINUX)
+
+namespace {
+
+std::span<const std::byte> bytes_of(std::string_view text) {
+    return std::as_bytes(std::span{text.data(), text.size()});
+}
+
+}  // namespace
+
+TEST_CASE("reactor resumes readers and sleepers", "[async][reactor]") {
+    scheduler sched;
+    reactor io{sched};
+    REQUIRE(io.valid());
+
+    int fds[2];
+    REQUIRE(::pipe2(fds, O_NONBLOCK | O_CLOEXEC) == 0);
+    std::string received;
+    std::vector<int> woke;
+
+    auto reader = [&]() -> task<void> {
+        std::byte buffer[64];
+        for (;;) {
+            auto n = co_await io.read_some(fds[0], buffer);
+            REQUIRE(n.has_value());
+            if (*n == 0) {
+                break;
+            }
+            received.append(reinterpret_cast<const char*>(buffer), *n);
+        }
+        io.close(fds[0]);
+    };
+    auto writer = [&]() -> task<void> {
+        co_await io.sleep_for(std::chrono::milliseconds{10});
+        auto n = co_await io.write_all(fds[1], bytes_of("hello"));
+        REQUIRE(n == 5u);
+        io.close(fds[1]);  // The reader sees end of file.
+    };
+    auto sleeper = [&](int id, int ms) -> task<void> {
+        co_await io.sleep_for(std::chrono::milliseconds{ms});
+        woke.push_back(id);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    sched.spawn(reader());
+    sched.spawn(writer());
+    sched.spawn(sleeper(2, 30));
+    sched.spawn(sleeper(1, 20));
+    io.run_until_idle();
+
+    REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds{30});
+    REQUIRE(received == "hello");
+    REQUIRE(woke == std::vector<int>{1, 2});
+    REQUIRE(io.waiting() == 0);
+}
+
+TEST_CASE("reactor accepts and streams through full socket buffers", "[async][reactor]") {
+    scheduler sched;
+    reactor io{sched};
+
+    auto path = std::filesystem::temp_directory_path() / "quasi_reactor_test.sock";
+    ::unlink(path.c_str());
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.native().size());
+    int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    REQUIRE(::bind(listener, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0);
+    REQUIRE(::listen(listener, 4) == 0);
+
+    // Far more than a socket buffer holds, so the writer must wait for the reader.
+    std::vector<std::byte> payload(4 << 20);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<std::byte>(i * 31);
+    }
+    std::vector<std::byte> received;
+
+    auto server = [&]() -> task<void> {
+        auto client = co_await io.accept(listener);
+        REQUIRE(client.has_value());
+        auto n = co_await io.write_all(*client, payload);
+        REQUIRE(n == payload.size());
+        io.close(*client);
+    };
+    auto client = [&]() -> task<void> {
+        int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        REQUIRE(::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0);
+        std::vector<std::byte> buffer(64 << 10);
+        for (;;) {
+            auto n = co_await io.read_some(fd, buffer);
+            REQUIRE(n.has_value());
+            if (*n == 0) {
+                break;
+            }
+            received.insert(received.end(), buffer.begin(), buffer.begin() + static_cast<ptrdiff_t>(*n));
+        }
+        io.close(fd);
+    };
+
+    sched.spawn(server());
+    sched.spawn(client());
+    io.run_until_idle();
+    io.close(listener);
+    ::unlink(path.c_str());
+    REQUIRE(received == payload);
+}
+
+TEST_CASE("reactor sleeps while connections are idle and wakes from other threads", "[async][reactor]") {
+    scheduler sched;
+    reactor io{sched};
+
+    // A few hundred readers that never get data.
+    std::vector<int> pipes;
+    auto idle_reader = [&](int fd) -> task<void> {
+        std::byte b[1];
+        (void)co_await io.read_some(fd, b);
+    };
+    for (int i = 0; i < 256; ++i) {
+        int fds[2];
+        REQUIRE(::pipe2(fds, O_NONBLOCK | O_CLOEXEC) == 0);
+        pipes.insert(pipes.end(), {fds[0], fds[1]});
+        sched.spawn(idle_reader(fds[0]));
+    }
+
+    // Hops to another thread, which posts it back after a while.
+    struct via_thread {
+        reactor&     io;
+        std::thread& thread;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            thread = std::thread{[this, h] {
+                std::this_thread::sleep_for(std::chrono::milliseconds{100});
+                io.post(h);
+            }};
+        }
+        void await_resume() const noexcept {}
+    };
+    std::thread helper;
+    bool back = false;
+    auto hop = [&]() -> task<void> {
+        co_await via_thread{io, helper};
+        back = true;
+        io.stop();
+    };
+    sched.spawn(hop());
+
+    timespec cpu_before{};
+    timespec cpu_after{};
+    ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_before);
+    io.run();
+    ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_after);
+    helper.join();
+
+    REQUIRE(back);
+    REQUIRE(io.waiting() == 256);
+    double cpu_ms = (cpu_after.tv_sec - cpu_before.tv_sec) * 1e3 + (cpu_after.tv_nsec - cpu_before.tv_nsec) / 1e6;
+    REQUIRE(cpu_ms < 50.0);  // Blocked in epoll_wait for the 100 ms, not spinning.
+
+    for (int fd : pipes) {
+        io.close(fd);
+    }
+    REQUIRE(io.waiting() == 0);
+}
+
+#endif  // Q_PLATFORM_LINUX
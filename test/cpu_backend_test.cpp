@@ -0,0 +1,558 @@
+/// @file cpu_backend_test.cpp
+/// @brief Tests for the CPU backend: per-isa kernel agreement and headless rendering.
+
+#include "backends/cpu/kernels.hpp"
+
+#include <quasi/accel/layout.hpp>
+#include <quasi/accel/sbvh.hpp>
+#include <quasi/math/half.hpp>
+#include <quasi/plugin/cache_store.hpp>
+#include <quasi/plugin/job_system.hpp>
+#include <quasi/plugin/plugin_interface.hpp>
+#include <quasi/plugin/profiler_bridge.hpp>
+#include <quasi/scene/cornell_box.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string_view>
+#include <vector>
+
+using namespace Q;
+using platform::isa;
+
+namespace {
+
+/// @brief Tables the test machine can run, lowest first.
+std::vector<std::pair<isa, const cpu::kernel_table*>> runnable_tables() {
+    std::vector<std::pair<isa, const cpu::kernel_table*>> out;
+    for (size_t i = 0; i < platform::k_isa_count; ++i) {
+        auto level = static_cast<isa>(i);
+        if (const auto* table = cpu::kernel_registry().get(level);
+            table && platform::host_cpu().supports(level)) {
+            out.emplace_back(level, table);
+        }
+    }
+    return out;
+}
+
+}  // namespace
+
+// ============================================================================
+// Kernel tests
+// ============================================================================
+
+TEST_CASE("CPU kernel registry always has a scalar table", "[cpu][kernels]") {
+    REQUIRE(cpu::kernel_registry().has(isa::scalar));
+    auto chosen = cpu::kernel_registry().select(platform::host_cpu());
+    REQUIRE(chosen.table != nullptr);
+    REQUIRE(platform::host_cpu().supports(chosen.level));
+}
+
+TEST_CASE("CPU kernels agree across isa levels", "[cpu][kernels]") {
+    std::mt19937 rng{11};
+    std::uniform_real_distribution<float> unit{0.0f, 1.0f};
+    std::uniform_real_distribution<float> hdr{0.0f, 20.0f};
+
+    constexpr size_t n = 1027;  // Not a multiple of any vector width.
+    std::vector<float> values(n * 4), sample(n * 4), u1(n), u2(n);
+    std::vector<math::vec3> normals(n);
+    for (auto& v : values) v = hdr(rng);
+    for (auto& v : sample) v = hdr(rng);
+    for (size_t i = 0; i < n; ++i) {
+        u1[i] = unit(rng);
+        u2[i] = unit(rng);
+        normals[i] = math::normalize(math::vec3{unit(rng) - 0.5f, unit(rng) - 0.5f, unit(rng) - 0.5f});
+    }
+
+    auto box = scene::make_cornell_box();
+    std::vector<scene::quad> quads;
+    std::vector<math::aabb> bounds;
+    for (const auto& q : box.quads) {
+        quads.push_back(q.geometry);
+        bounds.push_back(q.geometry.bounds());
+    }
+    auto tree = accel::bvh::build(bounds);
+    std::vector<math::ray> rays;
+    for (size_t i = 0; i < n; ++i) {
+        rays.push_back(box.cam.get_ray(unit(rng), unit(rng)));
+    }
+
+    const auto& reference = *cpu::kernel_registry().get(isa::scalar);
+    std::vector<float> ref_tonemap = values;
+    reference.tonemap(ref_tonemap);
+    std::vector<uint16_t> ref_half(values.size());
+    reference.to_half(values, ref_half);
+    std::vector<float> ref_accum = values;
+    reference.accumulate(ref_accum, sample, 3);
+    std::vector<math::vec3> ref_dirs(n);
+    reference.sample_hemisphere(normals, u1, u2, ref_dirs);
+    std::vector<cpu::ray_hit> ref_hits(n);
+    reference.intersect({&tree, quads}, rays, ref_hits);
+
+    for (auto [level, table] : runnable_tables()) {
+        INFO("isa " << platform::to_string(level));
+
+        std::vector<float> tm = values;
+        table->tonemap(tm);
+        std::vector<uint16_t> half(values.size());
+        table->to_half(values, half);
+        std::vector<float> accum = values;
+        table->accumulate(accum, sample, 3);
+        std::vector<math::vec3> dirs(n);
+        table->sample_hemisphere(normals, u1, u2, dirs);
+        std::vector<cpu::ray_hit> hits(n);
+        table->intersect({&tree, quads}, rays, hits);
+
+        // FMA contraction may move results by an ulp or two.
+        for (size_t i = 0; i < values.size(); ++i) {
+            REQUIRE(std::abs(tm[i] - ref_tonemap[i]) <= 1e-6f);
+            REQUIRE(half[i] == ref_half[i]);
+            REQUIRE(std::abs(accum[i] - ref_accum[i]) <= 1e-5f * std::abs(ref_accum[i]));
+        }
+        for (size_t i = 0; i < n; ++i) {
+            REQUIRE(math::length(dirs[i] - ref_dirs[i]) < 1e-5f);
+            REQUIRE((hits[i].prim == cpu::k_no_hit) == (ref_hits[i].prim == cpu::k_no_hit));
+            REQUIRE(std::abs(hits[i].t - ref_hits[i].t) < 1e-4f);
+        }
+    }
+}
+
+TEST_CASE("intersect kernel matches scene::intersect", "[cpu][kernels]") {
+    auto box = scene::make_cornell_box();
+    std::vector<scene::quad> quads;
+    std::vector<math::aabb> bounds;
+    for (const auto& q : box.quads) {
+        quads.push_back(q.geometry);
+        bounds.push_back(q.geometry.bounds());
+    }
+    auto tree = accel::bvh::build(bounds);
+    auto lazy = accel::lazy_bvh::build(bounds, {.eager_depth = 0});
+    auto sbvh = accel::build_sbvh(bounds, [&](uint32_t prim, int axis, float lo, float hi) {
+        return quads[prim].clipped_bounds(axis, lo, hi);
+    });
+
+    std::vector<math::ray> rays;
+    for (int y = 0; y < 32; ++y) {
+        for (int x = 0; x < 32; ++x) {
+            rays.push_back(box.cam.get_ray((x + 0.5f) / 32.0f, (y + 0.5f) / 32.0f));
+        }
+    }
+
+    auto ordered = accel::reorder(tree);
+
+    for (cpu::accel_tree structure : {cpu::accel_tree{&tree}, cpu::accel_tree{&lazy}, cpu::accel_tree{&sbvh},
+                                      cpu::accel_tree{&ordered}}) {
+        std::vector<cpu::ray_hit> hits(rays.size());
+        cpu::kernel_registry().select(platform::host_cpu()).table->intersect({structure, quads}, rays, hits);
+
+        for (size_t i = 0; i < rays.size(); ++i) {
+            float best = 1e30f;
+            uint32_t prim = cpu::k_no_hit;
+            for (uint32_t q = 0; q < quads.size(); ++q) {
+                if (auto rec = scene::intersect(rays[i], quads[q], 0.001f, best)) {
+                    best = rec->t;
+                    prim = q;
+                }
+            }
+            // Rays into a corner may report either wall at the same distance.
+            REQUIRE((hits[i].prim == cpu::k_no_hit) == (prim == cpu::k_no_hit));
+            if (prim != cpu::k_no_hit) {
+                REQUIRE(std::abs(hits[i].t - best) < 1e-4f);
+            }
+        }
+    }
+}
+
+TEST_CASE("instrumented intersect kernel agrees with intersect on every isa", "[cpu][kernels]") {
+    auto box = scene::make_cornell_box();
+    std::vector<scene::quad> quads;
+    std::vector<math::aabb> bounds;
+    for (const auto& q : box.quads) {
+        quads.push_back(q.geometry);
+        bounds.push_back(q.geometry.bounds());
+    }
+    auto tree = accel::bvh::build(bounds);
+
+    std::vector<math::ray> rays;
+    for (int i = 0; i < 256; ++i) {
+        rays.push_back(box.cam.get_ray((i % 16 + 0.5f) / 16.0f, (i / 16 + 0.5f) / 16.0f));
+    }
+
+    for (auto [level, table] : runnable_tables()) {
+        INFO(platform::to_string(level));
+        std::vector<cpu::ray_hit> plain(rays.size());
+        std::vector<cpu::ray_hit> instrumented(rays.size());
+        std::vector<accel::traversal_stats> stats(rays.size());
+        table->intersect({&tree, quads}, rays, plain);
+        table->intersect_instrumented({&tree, quads}, rays, instrumented, stats);
+        for (size_t i = 0; i < rays.size(); ++i) {
+            REQUIRE(plain[i].prim == instrumented[i].prim);
+            REQUIRE(stats[i].rays == 1);
+            REQUIRE(stats[i].nodes_visited >= 1);
+            if (plain[i].prim != cpu::k_no_hit) {
+                REQUIRE(stats[i].prims_tested >= 1);
+            }
+        }
+    }
+}
+
+// ============================================================================
+// Plugin tests
+// ============================================================================
+
+TEST_CASE("CPU plugin renders and presents headless", "[cpu][plugin]") {
+    Q_plugin_context ctx{};
+    ctx.viewport_width = 32;
+    ctx.viewport_height = 24;
+
+    Q_plugin_handle* handle = Q_plugin_create(&ctx);
+    REQUIRE(handle != nullptr);
+
+    std::vector<uint16_t> image(32 * 24 * 4, 0);
+    Q_render_frame frame{};
+    frame.drawable = image.data();
+    frame.width = 32;
+    frame.height = 24;
+    for (int i = 0; i < 4; ++i) {
+        Q_plugin_render(handle, &frame);
+    }
+
+    Q_readback_aov_result rb = Q_plugin_readback_aov(handle);
+    REQUIRE(rb.buffers[Q_AOV_BEAUTY].data != nullptr);
+    REQUIRE(rb.buffers[Q_AOV_BEAUTY].width == 32);
+    REQUIRE(rb.buffers[Q_AOV_NORMAL].format == Q_AOV_FORMAT_OCT16X2);
+
+    // The light sits at the top centre of the default view.
+    const float* beauty = rb.buffers[Q_AOV_BEAUTY].data;
+    float sum = 0.0f;
+    for (size_t i = 0; i < 32 * 24 * 4; i += 4) {
+        REQUIRE(std::isfinite(beauty[i]));
+        sum += beauty[i];
+    }
+    REQUIRE(sum > 0.0f);
+
+    // Presented pixels are tonemapped into [0, 1].
+    bool any_lit = false;
+    for (size_t i = 0; i < image.size(); ++i) {
+        float v = math::from_half(image[i]);
+        REQUIRE(v >= 0.0f);
+        REQUIRE(v <= 1.0f);
+        any_lit = any_lit || (i % 4 != 3 && v > 0.0f);
+    }
+    REQUIRE(any_lit);
+
+    Q_plugin_readback_aov_free(&rb);
+    Q_plugin_destroy(handle);
+}
+
+TEST_CASE("CPU plugin renders identically on the host job system", "[cpu][plugin][jobs]") {
+    auto render = [](Q_job_system* jobs) {
+        Q_plugin_context ctx{};
+        ctx.viewport_width = 32;
+        ctx.viewport_height = 24;
+        ctx.jobs = jobs;
+
+        Q_plugin_handle* handle = Q_plugin_create(&ctx);
+        REQUIRE(handle != nullptr);
+        Q_render_frame frame{};
+        frame.width = 32;
+        frame.height = 24;
+        for (int i = 0; i < 2; ++i) {
+            Q_plugin_render(handle, &frame);
+        }
+        Q_readback_result rb = Q_plugin_readback(handle);
+        std::vector<float> beauty(rb.data, rb.data + 32 * 24 * 4);
+        Q_plugin_readback_free(&rb);
+        Q_plugin_destroy(handle);
+        return beauty;
+    };
+
+    async::thread_pool pool{{{platform::k_unpinned, 0}, {platform::k_unpinned, 0},
+                             {platform::k_unpinned, 1}}};
+    plugin::job_system jobs{pool};
+
+    // Each pixel seeds its own RNG, so the worker layout cannot matter.
+    REQUIRE(render(jobs.table()) == render(nullptr));
+    jobs.quiesce();
+}
+
+TEST_CASE("CPU plugin renders row bands like one full frame", "[cpu][plugin][bands]") {
+    REQUIRE((Q_plugin_capabilities() & Q_CAPABILITY_ROW_BANDS) != 0);
+
+    auto render = [](bool split) {
+        Q_plugin_context ctx{};
+        ctx.viewport_width = 16;
+        ctx.viewport_height = 12;
+
+        Q_plugin_handle* handle = Q_plugin_create(&ctx);
+        REQUIRE(handle != nullptr);
+        Q_render_frame frame{};
+        frame.width = 16;
+        frame.height = 12;
+        for (int i = 0; i < 3; ++i) {
+            if (split) {
+                // Move the boundary every frame; each row still gets one sample per frame.
+                frame.row_begin = 0;
+                frame.row_end = 3 + i * 3;
+                Q_plugin_render(handle, &frame);
+                frame.row_begin = frame.row_end;
+                frame.row_end = 12;
+            }
+            Q_plugin_render(handle, &frame);
+        }
+        Q_readback_result rb = Q_plugin_readback(handle);
+        std::vector<float> beauty(rb.data, rb.data + 16 * 12 * 4);
+        Q_plugin_readback_free(&rb);
+        Q_plugin_destroy(handle);
+        return beauty;
+    };
+    REQUIRE(render(true) == render(false));
+}
+
+TEST_CASE("CPU plugin renders the same image through every acceleration structure", "[cpu][plugin][accel]") {
+    auto render = [](const char* structure) {
+        setenv("Q_ACCEL", structure, 1);
+        Q_plugin_context ctx{};
+        ctx.viewport_width = 16;
+        ctx.viewport_height = 12;
+
+        Q_plugin_handle* handle = Q_plugin_create(&ctx);
+        unsetenv("Q_ACCEL");
+        REQUIRE(handle != nullptr);
+        Q_render_frame frame{};
+        frame.width = 16;
+        frame.height = 12;
+        for (int i = 0; i < 2; ++i) {
+            Q_plugin_render(handle, &frame);
+        }
+        Q_readback_result rb = Q_plugin_readback(handle);
+        std::vector<float> beauty(rb.data, rb.data + 16 * 12 * 4);
+        Q_plugin_readback_free(&rb);
+        Q_plugin_destroy(handle);
+        return beauty;
+    };
+
+    auto reference = render("bvh");
+    REQUIRE(render("lazy") == reference);  // Same splits, built on demand.
+
+    // Other trees may visit two walls meeting at a corner in the other order.
+    for (const char* structure : {"sbvh", "ordered"}) {
+        auto image = render(structure);
+        REQUIRE(image.size() == reference.size());
+        size_t differing = 0;
+        for (size_t i = 0; i < image.size(); ++i) {
+            differing += image[i] != reference[i];
+        }
+        INFO(structure << ": " << differing << " differing channels");
+        REQUIRE(differing * 100 < reference.size());
+    }
+    REQUIRE(render("no-such-structure") == reference);  // Ignored; falls back to bvh.
+}
+
+TEST_CASE("CPU plugin reuses its BVH from the host cache", "[cpu][plugin][cache]") {
+    plugin::cache_store cache;
+    auto render = [&] {
+        Q_plugin_context ctx{};
+        ctx.viewport_width = 16;
+        ctx.viewport_height = 12;
+        ctx.cache = cache.table();
+
+        Q_plugin_handle* handle = Q_plugin_create(&ctx);
+        REQUIRE(handle != nullptr);
+        Q_render_frame frame{};
+        frame.width = 16;
+        frame.height = 12;
+        Q_plugin_render(handle, &frame);
+        Q_readback_result rb = Q_plugin_readback(handle);
+        std::vector<float> beauty(rb.data, rb.data + 16 * 12 * 4);
+        Q_plugin_readback_free(&rb);
+        Q_plugin_destroy(handle);
+        return beauty;
+    };
+
+    auto cold = render();
+    REQUIRE(cache.stats().puts == 1);
+    REQUIRE(cache.stats().misses == 1);
+
+    auto warm = render();  // As after a reload.
+    REQUIRE(cache.stats().memory_hits == 1);
+    REQUIRE(cache.stats().puts == 1);
+    REQUIRE(warm == cold);
+}
+
+TEST_CASE("CPU plugin rebuilds a damaged cached BVH", "[cpu][plugin][cache]") {
+    auto dir = std::filesystem::temp_directory_path() / "quasi_cpu_bvh_cache_test";
+    std::filesystem::remove_all(dir);
+    plugin::cache_store cache{plugin::cache_options{.directory = dir}};
+    auto render = [&] {
+        Q_plugin_context ctx{};
+        ctx.viewport_width = 16;
+        ctx.viewport_height = 12;
+        ctx.cache = cache.table();
+
+        Q_plugin_handle* handle = Q_plugin_create(&ctx);
+        REQUIRE(handle != nullptr);
+        Q_render_frame frame{};
+        frame.width = 16;
+        frame.height = 12;
+        Q_plugin_render(handle, &frame);
+        Q_readback_result rb = Q_plugin_readback(handle);
+        std::vector<float> beauty(rb.data, rb.data + 16 * 12 * 4);
+        Q_plugin_readback_free(&rb);
+        Q_plugin_destroy(handle);
+        return beauty;
+    };
+
+    auto cold = render();
+    REQUIRE(cache.stats().puts == 1);
+
+    // Point the last primitive index past the scene; the file itself stays well formed.
+    std::filesystem::path file;
+    for (const auto& entry : std::filesystem::directory_iterator{dir}) {
+        file = entry.path();
+    }
+    REQUIRE(!file.empty());
+    {
+        std::fstream f{file, std::ios::binary | std::ios::in | std::ios::out};
+        f.seekp(-static_cast<std::streamoff>(sizeof(uint32_t)), std::ios::end);
+        uint32_t bad = 0xFFFFFFFFu;
+        f.write(reinterpret_cast<const char*>(&bad), sizeof(bad));
+    }
+    cache.clear_memory();
+
+    auto rebuilt = render();
+    REQUIRE(cache.stats().disk_hits == 1);
+    REQUIRE(cache.stats().puts == 2);  // Replaced with a good tree.
+    REQUIRE(rebuilt == cold);
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("CPU plugin takes parameters between frames", "[cpu][plugin][params]") {
+    uint32_t count = 0;
+    const Q_param_desc* params = Q_plugin_params(&count);
+    REQUIRE(count == 4);
+    auto index = [&](std::string_view name) {
+        for (uint32_t i = 0; i < count; ++i) {
+            if (name == params[i].name) {
+                return i;
+            }
+        }
+        FAIL("no parameter " << name);
+        return count;
+    };
+
+    // frames x samples_per_frame samples; with bounces set before the first frame.
+    auto render = [&](int frames, double spp, double bounces) {
+        Q_plugin_context ctx{};
+        ctx.viewport_width = 16;
+        ctx.viewport_height = 12;
+        Q_plugin_handle* handle = Q_plugin_create(&ctx);
+        REQUIRE(handle != nullptr);
+        Q_plugin_set_param(handle, index("samples_per_frame"), spp);
+        Q_plugin_set_param(handle, index("max_bounces"), bounces);
+        Q_render_frame frame{};
+        frame.width = 16;
+        frame.height = 12;
+        for (int i = 0; i < frames; ++i) {
+            Q_plugin_render(handle, &frame);
+        }
+        Q_readback_result rb = Q_plugin_readback(handle);
+        std::vector<float> beauty(rb.data, rb.data + 16 * 12 * 4);
+        Q_plugin_readback_free(&rb);
+        Q_plugin_destroy(handle);
+        return beauty;
+    };
+
+    REQUIRE(render(1, 4, 5) == render(4, 1, 5));  // Same samples, fewer calls.
+    REQUIRE(render(2, 1, 1) != render(2, 1, 5));
+
+    // Changing the bounce depth mid-run restarts accumulation without a new plugin.
+    Q_plugin_context ctx{};
+    ctx.viewport_width = 16;
+    ctx.viewport_height = 12;
+    Q_plugin_handle* handle = Q_plugin_create(&ctx);
+    Q_render_frame frame{};
+    frame.width = 16;
+    frame.height = 12;
+    Q_plugin_render(handle, &frame);
+    Q_plugin_render(handle, &frame);
+    Q_plugin_set_param(handle, index("max_bounces"), 1);
+    Q_plugin_render(handle, &frame);
+    Q_plugin_render(handle, &frame);
+    Q_readback_result rb = Q_plugin_readback(handle);
+    std::vector<float> beauty(rb.data, rb.data + 16 * 12 * 4);
+    Q_plugin_readback_free(&rb);
+    Q_plugin_destroy(handle);
+    REQUIRE(beauty == render(2, 1, 1));
+}
+
+TEST_CASE("CPU plugin reports its stages to the host profiler", "[cpu][plugin][profile]") {
+    profile::profiler prof{profile::profiler_options{.counters = false}};
+    plugin::profiler_bridge bridge{prof};
+
+    Q_plugin_context ctx{};
+    ctx.viewport_width = 16;
+    ctx.viewport_height = 8;
+    ctx.profiler = bridge.table();
+
+    Q_plugin_handle* handle = Q_plugin_create(&ctx);
+    REQUIRE(handle != nullptr);
+    std::vector<uint16_t> image(16 * 8 * 4, 0);
+    Q_render_frame frame{};
+    frame.drawable = image.data();
+    frame.width = 16;
+    frame.height = 8;
+    for (int i = 0; i < 3; ++i) {
+        Q_plugin_render(handle, &frame);
+    }
+    Q_plugin_destroy(handle);
+
+    auto calls = [&](std::string_view name) -> uint64_t {
+        for (const auto& s : prof.stages()) {
+            if (s.name == name) return s.calls;
+        }
+        return 0;
+    };
+    REQUIRE(calls("cpu.trace") == 3);
+    REQUIRE(calls("cpu.trace_row") == 3 * 8);  // Recorded on the workers.
+    REQUIRE(calls("cpu.accumulate") == 3);
+    REQUIRE(calls("cpu.present") == 3);
+}
+
+TEST_CASE("CPU plugin exports a traversal heat map only when built for it", "[cpu][plugin][traversal]") {
+    Q_plugin_context ctx{};
+    ctx.viewport_width = 16;
+    ctx.viewport_height = 16;
+
+    Q_plugin_handle* handle = Q_plugin_create(&ctx);
+    REQUIRE(handle != nullptr);
+    Q_render_frame frame{};
+    frame.width = 16;
+    frame.height = 16;
+    for (int i = 0; i < 2; ++i) {
+        Q_plugin_render(handle, &frame);
+    }
+
+    Q_readback_aov_result rb = Q_plugin_readback_aov(handle);
+    const Q_aov_buffer& heat = rb.buffers[Q_AOV_TRAVERSAL];
+#if defined(Q_TRAVERSAL_STATS)
+    REQUIRE(heat.data != nullptr);
+    REQUIRE(heat.format == Q_AOV_FORMAT_RGBA32F);
+    for (size_t p = 0; p < 16 * 16; ++p) {
+        const float* px = &heat.data[p * 4];
+        REQUIRE(px[0] >= 1.0f);  // Every path visits at least the root.
+        REQUIRE(px[2] >= 1.0f);  // And traces at least its camera ray.
+        REQUIRE(px[2] <= 5.0f);
+    }
+#else
+    REQUIRE(heat.data == nullptr);
+#endif
+
+    Q_plugin_readback_aov_free(&rb);
+    Q_plugin_destroy(handle);
+}
@@ -2,6 +2,7 @@
 /// @brief Tests for the EXR writer module.
 
 #include <quasi/io/exr_writer.hpp>
+#include <quasi/math/octahedral.hpp>
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -73,10 +74,10 @@ TEST_CASE("write_exr AOV writes multi-layer file", "[io][exr][aov]") {
     float depth[]  = {2.5f,0,0,1, 3.0f,0,0,1, 2.8f,0,0,1, 3.2f,0,0,1};
 
     Q_readback_aov_result result{};
-    result.buffers[Q_AOV_BEAUTY] = {beauty, 2, 2, 4};
-    result.buffers[Q_AOV_ALBEDO] = {albedo, 2, 2, 4};
-    result.buffers[Q_AOV_NORMAL] = {normal, 2, 2, 4};
-    result.buffers[Q_AOV_DEPTH]  = {depth,  2, 2, 4};
+    result.buffers[Q_AOV_BEAUTY] = {beauty, 2, 2, 4, Q_AOV_FORMAT_RGBA32F};
+    result.buffers[Q_AOV_ALBEDO] = {albedo, 2, 2, 4, Q_AOV_FORMAT_RGBA32F};
+    result.buffers[Q_AOV_NORMAL] = {normal, 2, 2, 4, Q_AOV_FORMAT_RGBA32F};
+    result.buffers[Q_AOV_DEPTH]  = {depth,  2, 2, 4, Q_AOV_FORMAT_RGBA32F};
 
     auto path = std::filesystem::temp_directory_path() / "quasi_test_aov.exr";
     auto r = Q::io::write_exr(path, result);
@@ -90,7 +91,7 @@ TEST_CASE("write_exr AOV handles partial data (beauty only)", "[io][exr][aov]")
     float beauty[] = {1,0,0,1, 0,1,0,1, 0,0,1,1, 1,1,1,1};
 
     Q_readback_aov_result result{};
-    result.buffers[Q_AOV_BEAUTY] = {beauty, 2, 2, 4};
+    result.buffers[Q_AOV_BEAUTY] = {beauty, 2, 2, 4, Q_AOV_FORMAT_RGBA32F};
 
     auto path = std::filesystem::temp_directory_path() / "quasi_test_aov_partial.exr";
     auto r = Q::io::write_exr(path, result);
@@ -98,3 +99,42 @@ TEST_CASE("write_exr AOV handles partial data (beauty only)", "[io][exr][aov]")
     REQUIRE(std::filesystem::exists(path));
     std::filesystem::remove(path);
 }
+
+TEST_CASE("write_exr AOV decodes packed octahedral normals", "[io][exr][aov]") {
+    float beauty[] = {1,0,0,1, 0,1,0,1, 0,0,1,1, 1,1,1,1};
+    uint32_t normal[] = {
+        Q::math::oct_normal::encode({0, 0, 1}).bits,
+        Q::math::oct_normal::encode({0, 1, 0}).bits,
+        Q::math::oct_normal::encode({-1, 0, 0}).bits,
+        Q::math::oct_normal::k_none,
+    };
+
+    Q_readback_aov_result result{};
+    result.buffers[Q_AOV_BEAUTY] = {beauty, 2, 2, 4, Q_AOV_FORMAT_RGBA32F};
+    result.buffers[Q_AOV_NORMAL].packed   = normal;
+    result.buffers[Q_AOV_NORMAL].width    = 2;
+    result.buffers[Q_AOV_NORMAL].height   = 2;
+    result.buffers[Q_AOV_NORMAL].channels = 1;
+    result.buffers[Q_AOV_NORMAL].format   = Q_AOV_FORMAT_OCT16X2;
+
+    auto path = std::filesystem::temp_directory_path() / "quasi_test_aov_oct.exr";
+    auto r = Q::io::write_exr(path, result);
+    REQUIRE(r.has_value());
+    REQUIRE(std::filesystem::exists(path));
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("write_exr AOV writes the traversal heat map as float layers", "[io][exr][aov]") {
+    float beauty[] = {1,0,0,1, 0,1,0,1, 0,0,1,1, 1,1,1,1};
+    float traversal[] = {12,3,1,1, 40,9,3,1, 7,2,1,1, 300,64,5,1};
+
+    Q_readback_aov_result result{};
+    result.buffers[Q_AOV_BEAUTY]    = {beauty, 2, 2, 4, Q_AOV_FORMAT_RGBA32F};
+    result.buffers[Q_AOV_TRAVERSAL] = {traversal, 2, 2, 4, Q_AOV_FORMAT_RGBA32F};
+
+    auto path = std::filesystem::temp_directory_path() / "quasi_test_aov_traversal.exr";
+    auto r = Q::io::write_exr(path, result);
+    REQUIRE(r.has_value());
+    REQUIRE(std::filesystem::exists(path));
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,218 @@
+/// @file log_test.cpp
+/// @brief Unit tests for the logging module.
+
+#include <quasi/log/log.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Q::log;
+
+namespace {
+
+/// Collects entries; only the flusher (or flush()) calls it.
+struct capture {
+    std::vector<std::string> lines;
+
+    sink make() {
+        return [this](const entry& e) {
+            lines.push_back(std::string{e.channel} + ":" + std::string{e.message});
+        };
+    }
+
+    [[nodiscard]] size_t count_prefix(std::string_view prefix) const {
+        return static_cast<size_t>(std::count_if(lines.begin(), lines.end(), [&](const std::string& l) {
+            return l.starts_with(prefix);
+        }));
+    }
+};
+
+logger_options manual() {
+    logger_options options;
+    options.background = false;
+    return options;
+}
+
+}  // namespace
+
+// ============================================================================
+// spsc_ring tests
+// ============================================================================
+
+TEST_CASE("spsc_ring round-trips variable records across wrap-around", "[log][ring]") {
+    spsc_ring ring{256};
+    REQUIRE(ring.capacity() == 256);
+    REQUIRE(ring.front().empty());
+
+    uint32_t next_write = 0;
+    uint32_t next_read = 0;
+    for (int round = 0; round < 200; ++round) {
+        // Fill until full with records of varying size.
+        for (;;) {
+            size_t size = sizeof(uint32_t) + (next_write % 5) * 8;
+            std::byte* slot = ring.try_reserve(size);
+            if (!slot) break;
+            std::memcpy(slot, &next_write, sizeof(next_write));
+            ring.commit();
+            ++next_write;
+        }
+        // Drain about half.
+        for (int i = 0; i < 3; ++i) {
+            auto record = ring.front();
+            if (record.empty()) break;
+            uint32_t value = 0;
+            std::memcpy(&value, record.data(), sizeof(value));
+            REQUIRE(value == next_read++);
+            ring.pop();
+        }
+    }
+    REQUIRE(next_write > 200);
+    REQUIRE(ring.try_reserve(ring.max_record_size() + 1) == nullptr);
+}
+
+TEST_CASE("spsc_ring hands records across threads in order", "[log][ring]") {
+    spsc_ring ring{1024};
+    constexpr uint32_t k_count = 100000;
+
+    std::thread producer{[&] {
+        for (uint32_t i = 0; i < k_count;) {
+            if (std::byte* slot = ring.try_reserve(sizeof(i))) {
+                std::memcpy(slot, &i, sizeof(i));
+                ring.commit();
+                ++i;
+            }
+        }
+    }};
+
+    uint32_t expected = 0;
+    while (expected < k_count) {
+        auto record = ring.front();
+        if (record.empty()) continue;
+        uint32_t value = 0;
+        std::memcpy(&value, record.data(), sizeof(value));
+        REQUIRE(value == expected++);
+        ring.pop();
+    }
+    producer.join();
+}
+
+// ============================================================================
+// logger tests
+// ============================================================================
+
+TEST_CASE("severity names round-trip", "[log][severity]") {
+    for (auto s : {severity::trace, severity::debug, severity::info, severity::warn,
+                   severity::error, severity::off}) {
+        REQUIRE(parse_severity(to_string(s)) == s);
+    }
+    REQUIRE_FALSE(parse_severity("loud").has_value());
+}
+
+TEST_CASE("logger formats deferred arguments on flush", "[log][logger]") {
+    capture out;
+    logger log{manual(), out.make()};
+    auto& ch = log.get("test");
+    REQUIRE(&log.get("test") == &ch);
+
+    std::string owned = "copied";
+    ch.info("int {} float {} str {} {}", 42, 1.5, owned, "literal");
+    owned = "changed";  // The record holds its own copy.
+    ch.write(severity::info, "preformatted");
+    REQUIRE(out.lines.empty());  // Nothing is formatted before a flush.
+
+    log.flush();
+    REQUIRE(out.lines.size() == 2);
+    REQUIRE(out.lines[0] == "test:int 42 float 1.5 str copied literal");
+    REQUIRE(out.lines[1] == "test:preformatted");
+}
+
+TEST_CASE("logger filters by logger and channel severity", "[log][logger]") {
+    capture out;
+    logger log{manual(), out.make()};
+    auto& a = log.get("a");
+    auto& b = log.get("b");
+
+    a.debug("hidden by the logger level");
+    a.info("shown");
+    b.set_level(severity::error);
+    b.warn("hidden by the channel level");
+    b.error("shown");
+    REQUIRE_FALSE(b.enabled(severity::warn));
+
+    log.set_level(severity::off);
+    a.error("hidden when off");
+
+    log.flush();
+    REQUIRE(out.lines == std::vector<std::string>{"a:shown", "b:shown"});
+}
+
+TEST_CASE("logger rate limits per channel and reports suppression", "[log][logger]") {
+    capture out;
+    logger log{manual(), out.make()};
+    auto& chatty = log.get("chatty");
+    chatty.set_rate_limit(5, std::chrono::hours{1});
+
+    for (int i = 0; i < 50; ++i) {
+        chatty.info("message {}", i);
+    }
+    REQUIRE(chatty.suppressed() == 45);
+
+    log.flush();
+    REQUIRE(out.count_prefix("chatty:message") == 5);
+    REQUIRE(out.count_prefix("chatty:45 messages suppressed") == 1);
+
+    // Reported once.
+    log.flush();
+    REQUIRE(out.count_prefix("chatty:45 messages suppressed") == 1);
+}
+
+TEST_CASE("logger drops instead of blocking when a ring is full", "[log][logger]") {
+    capture out;
+    logger_options options = manual();
+    options.ring_capacity = 1024;
+    logger log{options, out.make()};
+    auto& ch = log.get("full");
+
+    for (int i = 0; i < 1000; ++i) {
+        ch.info("value {}", i);
+    }
+    REQUIRE(log.dropped() > 0);
+
+    log.flush();
+    REQUIRE(out.count_prefix("full:value") == 1000 - log.dropped());
+    REQUIRE(out.count_prefix("log:") == 1);
+}
+
+TEST_CASE("logger keeps each thread's messages in order", "[log][logger]") {
+    capture out;
+    logger_options options;
+    options.flush_interval = std::chrono::milliseconds{1};
+    logger log{options, out.make()};
+    auto& ch = log.get("mt");
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 500; ++i) {
+                ch.info("{} {}", t, i);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    log.flush();
+
+    REQUIRE(log.dropped() == 0);
+    REQUIRE(out.lines.size() == 2000);
+    std::vector<int> next(4, 0);
+    for (const auto& line : out.lines) {
+        int t = line[3] - '0';
+        REQUIRE(line == "mt:" + std::to_string(t) + " " + std::to_string(next[t]++));
+    }
+}
@@ -0,0 +1,263 @@
+/// @file math_test.cpp
+/// @brief Unit tests for the math module.
+
+#include <quasi/io/image_compare.hpp>
+#include <quasi/io/tonemap.hpp>
+#include <quasi/math/math.hpp>
+#include <quasi/scene/sampling.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace Q::math;
+
+// ============================================================================
+// oct_normal tests
+// ============================================================================
+
+TEST_CASE("oct_normal round-trips axis directions exactly", "[math][octahedral]") {
+    for (vec3 n : {vec3{1, 0, 0}, vec3{-1, 0, 0}, vec3{0, 1, 0},
+                   vec3{0, -1, 0}, vec3{0, 0, 1}, vec3{0, 0, -1}}) {
+        vec3 d = oct_normal::encode(n).decode();
+        REQUIRE(d.x == n.x);
+        REQUIRE(d.y == n.y);
+        REQUIRE(d.z == n.z);
+    }
+}
+
+TEST_CASE("oct_normal angular error stays below 0.005 degrees", "[math][octahedral]") {
+    std::mt19937 rng{42};
+    std::normal_distribution<float> g;
+    float worst = 0.0f;
+    for (int i = 0; i < 100000; ++i) {
+        vec3 n = normalize(vec3{g(rng), g(rng), g(rng)});
+        vec3 d = oct_normal::encode(n).decode();
+        REQUIRE(std::abs(length(d) - 1.0f) < 1e-5f);
+        float angle = std::atan2(length(cross(n, d)), dot(n, d));
+        worst = std::max(worst, angle);
+    }
+    REQUIRE(worst * 180.0f / 3.14159265f < 0.005f);
+}
+
+TEST_CASE("oct_normal sentinel decodes to zero", "[math][octahedral]") {
+    oct_normal none;
+    REQUIRE_FALSE(none.has_value());
+    REQUIRE(length(none.decode()) == 0.0f);
+    REQUIRE_FALSE(oct_normal::encode({0, 0, 0}).has_value());
+
+    // Every real encoding differs from the sentinel.
+    REQUIRE(oct_normal::encode({-1, -1, -1}).has_value());
+    REQUIRE(oct_normal::encode({0, 0, -1}).has_value());
+}
+
+// ============================================================================
+// ray_cone tests
+// ============================================================================
+
+TEST_CASE("ray_cone widens linearly with distance", "[math][ray_cone]") {
+    ray_cone cone{0.5f, 0.01f};
+    REQUIRE(cone.width_at(0.0f) == 0.5f);
+    REQUIRE(std::abs(cone.width_at(100.0f) - 1.5f) < 1e-6f);
+
+    auto next = cone.propagate(100.0f, 0.02f);
+    REQUIRE(std::abs(next.width - 1.5f) < 1e-6f);
+    REQUIRE(std::abs(next.spread_angle - 0.03f) < 1e-6f);
+}
+
+// ============================================================================
+// fast_math tests
+// ============================================================================
+
+namespace {
+
+float ulp_error(float approx, double exact) {
+    float e = static_cast<float>(exact);
+    float ulp = std::nextafter(std::abs(e), std::numeric_limits<float>::infinity()) - std::abs(e);
+    return static_cast<float>(std::abs(approx - exact) / ulp);
+}
+
+}  // namespace
+
+TEST_CASE("fast_sincos stays within 2 ulp on [-4, 4]", "[math][fast_math]") {
+    for (int i = 0; i <= 100000; ++i) {
+        float x = -4.0f + 8.0f * static_cast<float>(i) / 100000.0f;
+        auto [s, c] = fast_sincos(x);
+        double sd = std::sin(static_cast<double>(x));
+        double cd = std::cos(static_cast<double>(x));
+        REQUIRE((ulp_error(s, sd) <= 2.0f || std::abs(s - sd) < 1e-7));
+        REQUIRE((ulp_error(c, cd) <= 2.0f || std::abs(c - cd) < 1e-7));
+    }
+}
+
+TEST_CASE("fast_exp2 and fast_log2 stay within 2 ulp", "[math][fast_math]") {
+    for (int i = 0; i <= 100000; ++i) {
+        float x = -140.0f + 267.0f * static_cast<float>(i) / 100000.0f;
+        REQUIRE(ulp_error(fast_exp2(x), std::exp2(static_cast<double>(x))) <= 2.0f);
+    }
+    std::mt19937 rng{7};
+    std::uniform_real_distribution<float> exponent{-120.0f, 120.0f};
+    for (int i = 0; i < 100000; ++i) {
+        float x = std::exp2(exponent(rng));
+        double ref = std::log2(static_cast<double>(x));
+        float got = fast_log2(x);
+        REQUIRE((ulp_error(got, ref) <= 1.0f || std::abs(got - ref) < 1e-7));
+    }
+}
+
+TEST_CASE("fast_tan stays within 4 ulp on [-1.5, 1.5]", "[math][fast_math]") {
+    for (int i = 0; i <= 100000; ++i) {
+        float x = -1.5f + 3.0f * static_cast<float>(i) / 100000.0f;
+        REQUIRE(ulp_error(fast_tan(x), std::tan(static_cast<double>(x))) <= 4.0f);
+    }
+}
+
+TEST_CASE("fast_acos stays within 2 ulp on [-1, 1]", "[math][fast_math]") {
+    for (int i = 0; i <= 100000; ++i) {
+        float x = -1.0f + 2.0f * static_cast<float>(i) / 100000.0f;
+        REQUIRE(ulp_error(fast_acos(x), std::acos(static_cast<double>(x))) <= 2.0f);
+    }
+    // Near +-1 the slope is steepest; step through the last floats below 1.
+    for (float x = 1.0f, lo = 1.0f - 1e-3f; x > lo; x = std::nextafter(x, 0.0f)) {
+        REQUIRE(ulp_error(fast_acos(x), std::acos(static_cast<double>(x))) <= 2.0f);
+        REQUIRE(ulp_error(fast_acos(-x), std::acos(-static_cast<double>(x))) <= 2.0f);
+    }
+}
+
+TEST_CASE("fast_pow stays within (2 + |y log2 x|) ulp", "[math][fast_math]") {
+    std::mt19937 rng{11};
+    // |y log2 x| < 120 keeps the result a normal float.
+    std::uniform_real_distribution<float> exponent{-15.0f, 15.0f};
+    std::uniform_real_distribution<float> power{-8.0f, 8.0f};
+    for (int i = 0; i < 100000; ++i) {
+        float x = std::exp2(exponent(rng));
+        float y = power(rng);
+        double ref = std::pow(static_cast<double>(x), static_cast<double>(y));
+        double bound = 2.0 + std::abs(y * std::log2(static_cast<double>(x)));
+        INFO("x = " << x << ", y = " << y);
+        REQUIRE(ulp_error(fast_pow(x, y), ref) <= bound);
+    }
+    // Display gamma over [0, 1].
+    for (int i = 1; i <= 100000; ++i) {
+        float x = static_cast<float>(i) / 100000.0f;
+        double ref = std::pow(static_cast<double>(x), 1.0 / 2.2);
+        double bound = 2.0 + std::abs(std::log2(static_cast<double>(x)) / 2.2);
+        REQUIRE(ulp_error(fast_pow(x, 1.0f / 2.2f), ref) <= bound);
+    }
+}
+
+TEST_CASE("fast_math handles special values", "[math][fast_math]") {
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    REQUIRE(fast_exp2(-200.0f) == 0.0f);
+    REQUIRE(fast_exp2(200.0f) == inf);
+    REQUIRE(std::isnan(fast_exp2(std::nanf(""))));
+    REQUIRE(fast_log2(0.0f) == -inf);
+    REQUIRE(fast_log2(inf) == inf);
+    REQUIRE(std::isnan(fast_log2(-1.0f)));
+    REQUIRE(std::abs(fast_log2(1e-40f) - std::log2(1e-40f)) < 1e-4f);
+    REQUIRE(fast_pow(0.0f, 2.0f) == 0.0f);
+    REQUIRE(fast_acos(1.0f) == 0.0f);
+    REQUIRE(std::abs(fast_acos(-1.0f) - k_pi) < 1e-6f);
+}
+
+TEST_CASE("fast_math batch forms match scalar forms", "[math][fast_math]") {
+    std::vector<float> in(1000), a(1000), b(1000);
+    for (size_t i = 0; i < in.size(); ++i) {
+        in[i] = 0.01f * static_cast<float>(i) - 3.0f;
+    }
+    fast_sincos(in, a, b);
+    for (size_t i = 0; i < in.size(); ++i) {
+        auto [s, c] = fast_sincos(in[i]);
+        REQUIRE(a[i] == s);
+        REQUIRE(b[i] == c);
+    }
+    fast_exp2(in, a);
+    fast_pow(a, 1.0f / 2.2f, b);
+    for (size_t i = 0; i < in.size(); ++i) {
+        REQUIRE(a[i] == fast_exp2(in[i]));
+        REQUIRE(b[i] == fast_pow(a[i], 1.0f / 2.2f));
+    }
+}
+
+TEST_CASE("cosine_sample_hemisphere returns unit vectors around the normal", "[math][sampling]") {
+    vec3 normal = normalize(vec3{0.3f, -0.5f, 0.8f});
+    std::mt19937 rng{3};
+    std::uniform_real_distribution<float> u{0.0f, 1.0f};
+    float mean_cos = 0.0f;
+    constexpr int n = 20000;
+    for (int i = 0; i < n; ++i) {
+        vec3 d = Q::scene::cosine_sample_hemisphere(normal, u(rng), u(rng));
+        REQUIRE(std::abs(length(d) - 1.0f) < 1e-4f);
+        REQUIRE(dot(d, normal) >= -1e-4f);
+        mean_cos += dot(d, normal);
+    }
+    // E[cos theta] under a cosine-weighted hemisphere is 2/3.
+    REQUIRE(std::abs(mean_cos / n - 2.0f / 3.0f) < 0.01f);
+}
+
+TEST_CASE("tonemap_reinhard matches the reference curve", "[math][tonemap]") {
+    std::vector<float> rgba{0.0f, 0.5f, 4.0f, 0.25f, -1.0f, std::nanf(""), 100.0f, 1.0f};
+    std::vector<float> original = rgba;
+    Q::io::tonemap_reinhard(rgba);
+    for (size_t i = 0; i < rgba.size(); ++i) {
+        if (i % 4 == 3) {
+            REQUIRE(rgba[i] == original[i]);
+            continue;
+        }
+        float v = original[i] > 0.0f ? original[i] : 0.0f;
+        float ref = std::pow(v / (v + 1.0f), 1.0f / Q::io::k_display_gamma);
+        REQUIRE(std::abs(rgba[i] - ref) < 1e-5f);
+    }
+}
+
+TEST_CASE("compare_images reports error figures and non-finite channels", "[math][image_compare]") {
+    std::vector<float> a{0.5f, 0.5f, 0.5f, 1.0f, 0.25f, 0.0f, 0.0f, 1.0f};
+    auto same = Q::io::compare_images(a, a);
+    REQUIRE(same.max_abs == 0.0);
+    REQUIRE(same.differing_pixels == 0);
+    REQUIRE(std::isinf(same.psnr));
+
+    auto b = a;
+    b[0] = 0.6f;           // Pixel 0 off by 0.1.
+    b[5] = std::nanf("");  // Pixel 1 non-finite in one image only.
+    auto d = Q::io::compare_images(a, b);
+    REQUIRE(std::abs(d.max_abs - 0.1) < 1e-6);
+    REQUIRE(d.differing_pixels == 2);
+    REQUIRE(d.nonfinite == 1);
+    REQUIRE(std::abs(d.mean_abs - 0.1 / 8.0) < 1e-6);
+    REQUIRE(std::abs(d.rmse - std::sqrt(0.01 / 8.0)) < 1e-6);
+    REQUIRE(std::abs(d.psnr - (-20.0 * std::log10(d.rmse))) < 1e-9);
+
+    auto tolerant = Q::io::compare_images(a, b, 4, 0.2f);
+    REQUIRE(tolerant.differing_pixels == 1);  // Only the non-finite pixel.
+}
+
+// ============================================================================
+// half tests
+// ============================================================================
+
+TEST_CASE("half round-trips every binary16 value", "[math][half]") {
+    for (uint32_t h = 0; h < 0x10000; ++h) {
+        auto bits = static_cast<uint16_t>(h);
+        float f = from_half(bits);
+        if ((bits & 0x7C00) == 0x7C00 && (bits & 0x03FF) != 0) {
+            REQUIRE(std::isnan(f));
+            continue;
+        }
+        REQUIRE(to_half(f) == bits);
+    }
+}
+
+TEST_CASE("to_half rounds to nearest even and saturates", "[math][half]") {
+    REQUIRE(to_half(1.0f) == 0x3C00);
+    REQUIRE(to_half(1.0f + 0x1p-11f) == 0x3C00);           // Tie, rounds down to even.
+    REQUIRE(to_half(1.0f + 3.0f * 0x1p-11f) == 0x3C02);    // Tie, rounds up to even.
+    REQUIRE(to_half(65520.0f) == 0x7C00);                  // Rounds past the max to infinity.
+    REQUIRE(to_half(-std::numeric_limits<float>::infinity()) == 0xFC00);
+    REQUIRE(to_half(0x1p-24f) == 0x0001);                  // Smallest denormal.
+    REQUIRE(to_half(0x1p-26f) == 0x0000);
+    REQUIRE(std::isnan(from_half(to_half(std::nanf("")))));
+}
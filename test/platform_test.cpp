@@ -0,0 +1,211 @@
+/// @file platform_test.cpp
+/// @brief Unit tests for CPU feature detection, topology and kernel dispatch.
+
+#include <quasi/platform/cpu_features.hpp>
+#include <quasi/platform/kernel_registry.hpp>
+#include <quasi/platform/topology.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <set>
+
+using namespace Q::platform;
+
+// ============================================================================
+// isa tests
+// ============================================================================
+
+TEST_CASE("isa names round-trip", "[platform][isa]") {
+    for (size_t i = 0; i < k_isa_count; ++i) {
+        auto level = static_cast<isa>(i);
+        REQUIRE(parse_isa(to_string(level)) == level);
+    }
+    REQUIRE_FALSE(parse_isa("avx3").has_value());
+    REQUIRE_FALSE(parse_isa("").has_value());
+}
+
+TEST_CASE("isa levels are nested", "[platform][isa]") {
+    cpu_features f;
+    f.sse4_2 = f.popcnt = true;
+    f.avx = f.avx2 = f.fma = f.f16c = true;
+    REQUIRE(f.supports(isa::sse4_2));
+    REQUIRE_FALSE(f.supports(isa::avx2));  // No BMI2.
+    REQUIRE(f.best_isa() == isa::sse4_2);
+
+    f.bmi2 = true;
+    f.avx512f = f.avx512bw = f.avx512dq = f.avx512vl = true;
+    f.popcnt = false;
+    REQUIRE(f.best_isa() == isa::scalar);  // Every level above needs SSE4.2.
+}
+
+TEST_CASE("host_cpu reports a usable best isa", "[platform][isa]") {
+    const cpu_features& cpu = host_cpu();
+    REQUIRE(&cpu == &host_cpu());
+    REQUIRE(cpu.supports(cpu.best_isa()));
+#if defined(Q_ARCH_X86)
+    REQUIRE_FALSE(cpu.vendor.empty());
+#endif
+}
+
+// ============================================================================
+// kernel_registry tests
+// ============================================================================
+
+namespace {
+
+struct test_table {
+    int id;
+};
+
+cpu_features avx2_cpu() {
+    cpu_features f;
+    f.sse4_2 = f.popcnt = true;
+    f.avx = f.avx2 = f.fma = f.f16c = f.bmi2 = true;
+    return f;
+}
+
+}  // namespace
+
+TEST_CASE("kernel_registry selects the best supported level", "[platform][kernel_registry]") {
+    kernel_registry<test_table> registry;
+    registry.add(isa::scalar, {0});
+    registry.add(isa::sse4_2, {1});
+    registry.add(isa::avx2, {2});
+    registry.add(isa::avx512, {3});
+
+    auto chosen = registry.select(avx2_cpu());
+    REQUIRE(chosen.level == isa::avx2);
+    REQUIRE(chosen.table->id == 2);
+
+    REQUIRE(registry.select(cpu_features{}).level == isa::scalar);
+}
+
+TEST_CASE("kernel_registry honors overrides as a ceiling", "[platform][kernel_registry]") {
+    kernel_registry<test_table> registry;
+    registry.add(isa::scalar, {0});
+    registry.add(isa::sse4_2, {1});
+    registry.add(isa::avx512, {3});
+
+    REQUIRE(registry.select(avx2_cpu(), isa::sse4_2).table->id == 1);
+    REQUIRE(registry.select(avx2_cpu(), isa::scalar).table->id == 0);
+
+    // Unsupported by the CPU, and avx2 was not compiled: best level below.
+    auto chosen = registry.select(avx2_cpu(), isa::avx512);
+    REQUIRE(chosen.level == isa::sse4_2);
+    REQUIRE(chosen.table->id == 1);
+}
+
+// ============================================================================
+// topology tests
+// ============================================================================
+
+namespace {
+
+void write_file(const std::filesystem::path& path, std::string_view text) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream{path} << text;
+}
+
+/// 2 packages x 2 cores x 2 SMT threads, one L3 and NUMA node per package,
+/// in a cgroup limited to 3 CPUs by its parent.
+topology_sources fake_machine(const std::filesystem::path& root) {
+    std::filesystem::remove_all(root);
+    write_file(root / "cpu/online", "0-7\n");
+    for (int c = 0; c < 8; ++c) {
+        auto dir = root / "cpu" / ("cpu" + std::to_string(c));
+        int package = c / 4;
+        write_file(dir / "topology/physical_package_id", std::to_string(package));
+        write_file(dir / "topology/core_id", std::to_string(c % 2));  // Siblings: c, c + 2.
+        write_file(dir / "cache/index0/level", "1");
+        write_file(dir / "cache/index0/shared_cpu_list", std::to_string(c));
+        write_file(dir / "cache/index3/level", "3");
+        write_file(dir / "cache/index3/shared_cpu_list", package == 0 ? "0-3" : "4-7");
+    }
+    write_file(root / "node/node0/cpulist", "0-3");
+    write_file(root / "node/node1/cpulist", "4-7");
+    write_file(root / "cgroup/app/render/cpu.max", "max 100000\n");
+    write_file(root / "cgroup/app/cpu.max", "300000 100000\n");
+    write_file(root / "proc_cgroup", "0::/app/render\n");
+
+    topology_sources src;
+    src.sysfs_cpu    = root / "cpu";
+    src.sysfs_node   = root / "node";
+    src.cgroup_root  = root / "cgroup";
+    src.proc_cgroup  = root / "proc_cgroup";
+    src.use_affinity = false;
+    return src;
+}
+
+}  // namespace
+
+TEST_CASE("parse_cpu_list handles ranges and singles", "[platform][topology]") {
+    REQUIRE(parse_cpu_list("0-3,8,10-11\n") == std::vector<uint32_t>{0, 1, 2, 3, 8, 10, 11});
+    REQUIRE(parse_cpu_list("5") == std::vector<uint32_t>{5});
+    REQUIRE(parse_cpu_list("").empty());
+    REQUIRE(parse_cpu_list("3-1").empty());
+    REQUIRE(parse_cpu_list("a-b").empty());
+}
+
+TEST_CASE("parse_cgroup_cpu_max reads quota over period", "[platform][topology]") {
+    REQUIRE_FALSE(parse_cgroup_cpu_max("max 100000").has_value());
+    REQUIRE(parse_cgroup_cpu_max("200000 100000\n") == 2.0);
+    REQUIRE(parse_cgroup_cpu_max("50000 100000") == 0.5);
+    REQUIRE_FALSE(parse_cgroup_cpu_max("garbage").has_value());
+}
+
+TEST_CASE("detect_topology reads sysfs and the cgroup hierarchy", "[platform][topology]") {
+    auto src = fake_machine(std::filesystem::temp_directory_path() / "quasi_topology_test");
+    auto topo = detect_topology(src);
+
+    REQUIRE(topo.cpus.size() == 8);
+    REQUIRE(topo.physical_cores == 4);
+    REQUIRE(topo.l3_domains == 2);
+    REQUIRE(topo.numa_nodes == 2);
+    REQUIRE(topo.cpu_quota == 3.0);  // The parent's limit applies to the leaf.
+    REQUIRE(topo.cpu_budget() == 3);
+
+    REQUIRE(topo.cpus[0].core == topo.cpus[2].core);
+    REQUIRE(topo.cpus[0].smt_index == 0);
+    REQUIRE(topo.cpus[2].smt_index == 1);
+    REQUIRE(topo.cpus[0].l3 != topo.cpus[4].l3);
+    REQUIRE(topo.cpus[5].numa_node == topo.cpus[4].numa_node);
+
+    std::filesystem::remove_all(std::filesystem::temp_directory_path() / "quasi_topology_test");
+}
+
+TEST_CASE("plan_workers respects policy and budget", "[platform][topology]") {
+    auto src = fake_machine(std::filesystem::temp_directory_path() / "quasi_topology_plan");
+    auto topo = detect_topology(src);
+    std::filesystem::remove_all(std::filesystem::temp_directory_path() / "quasi_topology_plan");
+
+    // Quota of 3: three workers, filling the first L3 domain first.
+    auto physical = plan_workers(topo, pin_policy::physical_cores);
+    REQUIRE(physical.size() == 3);
+    std::set<uint32_t> cores;
+    for (const auto& w : physical) {
+        REQUIRE(w.cpu != k_unpinned);
+        cores.insert(topo.cpus[w.cpu].core);
+    }
+    REQUIRE(cores.size() == 3);  // No two workers on SMT siblings.
+    REQUIRE(physical[0].l3 == physical[1].l3);
+
+    topo.cpu_quota.reset();
+    REQUIRE(plan_workers(topo, pin_policy::physical_cores).size() == 4);
+    REQUIRE(plan_workers(topo, pin_policy::logical_cpus).size() == 8);
+    REQUIRE(plan_workers(topo, pin_policy::logical_cpus, 2).size() == 2);
+
+    auto unpinned = plan_workers(topo, pin_policy::none);
+    REQUIRE(unpinned.size() == 8);
+    REQUIRE(unpinned[0].cpu == k_unpinned);
+}
+
+TEST_CASE("host_topology is usable", "[platform][topology]") {
+    const auto& topo = host_topology();
+    REQUIRE_FALSE(topo.cpus.empty());
+    REQUIRE(topo.physical_cores >= 1);
+    REQUIRE(topo.physical_cores <= topo.cpus.size());
+    REQUIRE(topo.cpu_budget() >= 1);
+    REQUIRE_FALSE(plan_workers(topo, pin_policy::physical_cores).empty());
+}
@@ -2,11 +2,34 @@
 /// @brief Unit tests for the plugin module.
 
 #include <quasi/plugin/plugin_interface.hpp>
+#include <quasi/plugin/cache_store.hpp>
+#include <quasi/plugin/call_trace.hpp>
 #include <quasi/plugin/dynamic_library.hpp>
+#include <quasi/plugin/frame_splitter.hpp>
+#include <quasi/plugin/job_system.hpp>
+#include <quasi/plugin/manager.hpp>
+#include <quasi/plugin/param_socket.hpp>
+#include <quasi/plugin/params.hpp>
+#include <quasi/plugin/render_server.hpp>
+#include <quasi/plugin/result_cache.hpp>
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 using namespace Q::plugin;
 
@@ -46,6 +69,7 @@ TEST_CASE("library_error to_string", "[plugin][error]") {
     REQUIRE(to_string(library_error::load_failed) == "failed to load library");
     REQUIRE(to_string(library_error::symbol_not_found) == "symbol not found");
     REQUIRE(to_string(library_error::not_loaded) == "library not loaded");
+    REQUIRE(to_string(library_error::copy_failed) == "failed to copy library into memory");
 }
 
 // ============================================================================
@@ -76,6 +100,70 @@ TEST_CASE("dynamic_library move semantics", "[plugin][dynamic_library]") {
     REQUIRE_FALSE(lib2.is_loaded());
 }
 
+TEST_CASE("dynamic_library isolated namespaces hold separate copies", "[plugin][dynamic_library]") {
+    REQUIRE(dynamic_library::open("/nonexistent/library.so", link_namespace::isolated).error() ==
+            library_error::file_not_found);
+    REQUIRE_FALSE(dynamic_library{}.is_isolated());
+
+#if defined(Q_PLATFORM_LINUX)
+    // libm is present wherever the tests run; find it through a symbol.
+    Dl_info info{};
+    auto* cos_fn = static_cast<double (*)(double)>(&::cos);
+    REQUIRE(dladdr(reinterpret_cast<void*>(cos_fn), &info) != 0);
+    std::filesystem::path libm = info.dli_fname;
+
+    auto a = dynamic_library::open(libm);
+    auto b = dynamic_library::open(libm);
+    REQUIRE(a);
+    REQUIRE(b);
+    REQUIRE(a->native_handle() == b->native_handle());  // One copy, reference counted.
+    REQUIRE_FALSE(a->is_isolated());
+
+    auto c = dynamic_library::open(libm, link_namespace::isolated);
+    auto d = dynamic_library::open(libm, link_namespace::isolated);
+    REQUIRE(c);
+    REQUIRE(d);
+    REQUIRE(c->is_isolated());
+    REQUIRE(c->native_handle() != d->native_handle());
+
+    auto cos_c = c->get_symbol<double (*)(double)>("cos");
+    auto cos_d = d->get_symbol<double (*)(double)>("cos");
+    REQUIRE(cos_c);
+    REQUIRE(cos_d);
+    REQUIRE(*cos_c != *cos_d);
+    REQUIRE((*cos_c)(0.0) == 1.0);
+#endif
+}
+
+#if defined(Q_PLATFORM_LINUX)
+TEST_CASE("dynamic_library opens in-memory copies", "[plugin][dynamic_library]") {
+    REQUIRE(library_image::copy("/nonexistent/library.so").error() == library_error::file_not_found);
+
+    Dl_info info{};
+    auto* cos_fn = static_cast<double (*)(double)>(&::cos);
+    REQUIRE(dladdr(reinterpret_cast<void*>(cos_fn), &info) != 0);
+    std::filesystem::path libm = info.dli_fname;
+
+    auto image = library_image::copy(libm);
+    REQUIRE(image);
+    REQUIRE(std::filesystem::file_size(image->proc_path()) == std::filesystem::file_size(libm));
+    int fd = image->fd();
+
+    // A memfd is a new inode, so even a library already loaded is mapped again.
+    auto shared = dynamic_library::open(libm);
+    auto copy = dynamic_library::open(std::move(*image));
+    REQUIRE(copy);
+    REQUIRE(copy->path().string().starts_with("/proc/self/fd/"));
+    REQUIRE(copy->native_handle() != shared->native_handle());
+    auto cos_copy = copy->get_symbol<double (*)(double)>("cos");
+    REQUIRE(cos_copy);
+    REQUIRE(*cos_copy != cos_fn);
+    REQUIRE((*cos_copy)(0.0) == 1.0);
+    REQUIRE(::fcntl(fd, F_GETFD) >= 0);  // Held by the library while loaded.
+    REQUIRE(image->fd() < 0);
+}
+#endif
+
 TEST_CASE("dynamic_library get_symbol on unloaded library", "[plugin][dynamic_library]") {
     dynamic_library lib;
 
@@ -136,7 +224,1021 @@ TEST_CASE("plugin interface constants", "[plugin][interface]") {
     REQUIRE(k_symbol_destroy == std::string_view{"Q_plugin_destroy"});
     REQUIRE(k_symbol_update == std::string_view{"Q_plugin_update"});
     REQUIRE(k_symbol_render == std::string_view{"Q_plugin_render"});
+    REQUIRE(k_symbol_params == std::string_view{"Q_plugin_params"});
+    REQUIRE(k_symbol_set_param == std::string_view{"Q_plugin_set_param"});
 
     // ABI version should be positive
     REQUIRE(k_plugin_abi_version > 0);
 }
+
+// ============================================================================
+// job_system tests
+// ============================================================================
+
+namespace {
+
+Q::async::thread_pool make_test_pool() {
+    return Q::async::thread_pool{{{Q::platform::k_unpinned, 0}, {Q::platform::k_unpinned, 0},
+                                  {Q::platform::k_unpinned, 1}}};
+}
+
+}  // namespace
+
+TEST_CASE("job_system submit and wait through the C table", "[plugin][jobs]") {
+    auto pool = make_test_pool();
+    job_system jobs{pool};
+    Q_job_system* table = jobs.table();
+    REQUIRE(table->worker_count == 3);
+
+    std::atomic<int> counter{0};
+    auto increment = [](void* user) { static_cast<std::atomic<int>*>(user)->fetch_add(1); };
+
+    std::vector<Q_job*> handles;
+    for (int i = 0; i < 100; ++i) {
+        handles.push_back(table->submit(table->host_data, increment, &counter));
+    }
+    for (Q_job* job : handles) {
+        table->wait(table->host_data, job);
+    }
+    REQUIRE(counter == 100);
+
+    REQUIRE(table->submit(table->host_data, nullptr, nullptr) == nullptr);
+    table->wait(table->host_data, nullptr);  // No-op.
+}
+
+TEST_CASE("job_system jobs can wait for jobs they submit", "[plugin][jobs]") {
+    auto pool = make_test_pool();
+    job_system jobs{pool};
+
+    struct nested {
+        Q_job_system*    table;
+        std::atomic<int> leaves{0};
+    } state{jobs.table(), {}};
+
+    auto parent = [](void* user) {
+        auto* s = static_cast<nested*>(user);
+        std::vector<Q_job*> children;
+        for (int i = 0; i < 8; ++i) {
+            children.push_back(s->table->submit(s->table->host_data, [](void* u) {
+                static_cast<nested*>(u)->leaves.fetch_add(1);
+            }, s));
+        }
+        for (Q_job* child : children) {
+            s->table->wait(s->table->host_data, child);
+        }
+    };
+
+    std::vector<Q_job*> parents;
+    for (int i = 0; i < 6; ++i) {
+        parents.push_back(state.table->submit(state.table->host_data, parent, &state));
+    }
+    for (Q_job* job : parents) {
+        state.table->wait(state.table->host_data, job);
+    }
+    REQUIRE(state.leaves == 48);
+}
+
+TEST_CASE("job_system parallel_for covers the range in chunks", "[plugin][jobs]") {
+    auto pool = make_test_pool();
+    job_system jobs{pool};
+    Q_job_system* table = jobs.table();
+
+    struct coverage {
+        std::vector<std::atomic<int>> hits = std::vector<std::atomic<int>>(1000);
+        std::atomic<bool>             bad{false};
+    } cov;
+
+    table->parallel_for(table->host_data, 1000, 64, [](void* user, uint32_t begin, uint32_t end,
+                                                       uint32_t worker) {
+        auto* c = static_cast<coverage*>(user);
+        if (end - begin > 64 || worker >= 3) c->bad = true;
+        for (uint32_t i = begin; i < end; ++i) c->hits[i].fetch_add(1);
+    }, &cov);
+
+    REQUIRE_FALSE(cov.bad.load());
+    for (const auto& h : cov.hits) {
+        REQUIRE(h.load() == 1);
+    }
+}
+
+TEST_CASE("job_system quiesce waits for unwaited jobs", "[plugin][jobs]") {
+    auto pool = make_test_pool();
+    job_system jobs{pool};
+    Q_job_system* table = jobs.table();
+
+    std::atomic<int> finished{0};
+    std::vector<Q_job*> handles;
+    for (int i = 0; i < 16; ++i) {
+        handles.push_back(table->submit(table->host_data, [](void* user) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{2});
+            static_cast<std::atomic<int>*>(user)->fetch_add(1);
+        }, &finished));
+    }
+
+    jobs.quiesce();
+    REQUIRE(finished == 16);
+    for (Q_job* job : handles) {
+        table->wait(table->host_data, job);  // Already done; only releases.
+    }
+}
+
+// ============================================================================
+// cache_store tests
+// ============================================================================
+
+namespace {
+
+std::vector<std::byte> bytes_of(std::string_view text) {
+    auto b = std::as_bytes(std::span{text});
+    return {b.begin(), b.end()};
+}
+
+}  // namespace
+
+TEST_CASE("cache_store keeps values in memory by key", "[plugin][cache]") {
+    cache_store cache;
+    REQUIRE(cache.get("missing") == nullptr);
+
+    cache.put("bvh", bytes_of("nodes"));
+    auto hit = cache.get("bvh");
+    REQUIRE(hit != nullptr);
+    REQUIRE(*hit == bytes_of("nodes"));
+
+    cache.put("bvh", bytes_of("other nodes"));
+    REQUIRE(*cache.get("bvh") == bytes_of("other nodes"));
+    REQUIRE(*hit == bytes_of("nodes"));  // Held blobs stay valid.
+
+    auto stats = cache.stats();
+    REQUIRE(stats.memory_hits == 2);
+    REQUIRE(stats.misses == 1);
+    REQUIRE(stats.puts == 2);
+    REQUIRE(stats.entries == 1);
+    REQUIRE(stats.memory_bytes == 11);
+}
+
+TEST_CASE("cache_store evicts the least recently used past its budget", "[plugin][cache]") {
+    cache_store cache{cache_options{.memory_budget = 10, .directory = {}}};
+    cache.put("a", bytes_of("1234"));
+    cache.put("b", bytes_of("1234"));
+    REQUIRE(cache.get("a") != nullptr);  // Now b is the oldest.
+    cache.put("c", bytes_of("1234"));
+
+    REQUIRE(cache.get("a") != nullptr);
+    REQUIRE(cache.get("b") == nullptr);
+    REQUIRE(cache.get("c") != nullptr);
+    REQUIRE(cache.stats().evictions == 1);
+
+    cache.put("huge", bytes_of("far too large"));
+    REQUIRE(cache.get("huge") == nullptr);  // Larger than the budget; memory only here.
+    REQUIRE(cache.stats().memory_bytes == 8);
+}
+
+TEST_CASE("cache_store on-disk tier outlives the store", "[plugin][cache]") {
+    auto dir = std::filesystem::temp_directory_path() / "quasi_cache_test";
+    std::filesystem::remove_all(dir);
+    {
+        cache_store cache{cache_options{.directory = dir}};
+        cache.put("shader", bytes_of("compiled"));
+    }
+
+    cache_store cache{cache_options{.directory = dir}};
+    auto hit = cache.get("shader");
+    REQUIRE(hit != nullptr);
+    REQUIRE(*hit == bytes_of("compiled"));
+    REQUIRE(cache.stats().disk_hits == 1);
+    REQUIRE(cache.get("shader") != nullptr);
+    REQUIRE(cache.stats().memory_hits == 1);  // Promoted to memory.
+
+    // A damaged file is a miss, not a wrong value.
+    cache.clear_memory();
+    auto path = cache.path_for(std::as_bytes(std::span{std::string_view{"shader"}}));
+    REQUIRE(std::filesystem::exists(path));
+    std::ofstream{path, std::ios::binary} << "junk";
+    REQUIRE(cache.get("shader") == nullptr);
+    REQUIRE(cache.stats().disk_errors == 1);
+    REQUIRE_FALSE(std::filesystem::exists(path));  // Deleted, so it is rewritten next time.
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("cache_store rejects files whose sizes disagree with their header", "[plugin][cache]") {
+    auto dir = std::filesystem::temp_directory_path() / "quasi_cache_size_test";
+    std::filesystem::remove_all(dir);
+    cache_store cache{cache_options{.directory = dir}};
+    cache.put("bvh", bytes_of("nodes"));
+    auto path = cache.path_for(std::as_bytes(std::span{std::string_view{"bvh"}}));
+
+    // A header claiming a huge value must not be allocated.
+    for (uint64_t value_size : {uint64_t{1} << 60, uint64_t{4}, uint64_t{6}}) {
+        cache.clear_memory();
+        {
+            std::fstream f{path, std::ios::binary | std::ios::in | std::ios::out};
+            f.seekp(16);
+            f.write(reinterpret_cast<const char*>(&value_size), sizeof(value_size));
+        }
+        REQUIRE(cache.get("bvh") == nullptr);
+        REQUIRE_FALSE(std::filesystem::exists(path));
+        cache.put("bvh", bytes_of("nodes"));
+    }
+    REQUIRE(cache.stats().disk_errors == 3);
+
+    cache.clear_memory();
+    REQUIRE(*cache.get("bvh") == bytes_of("nodes"));
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("cache_store keeps its directory within the disk budget", "[plugin][cache]") {
+    auto dir = std::filesystem::temp_directory_path() / "quasi_cache_budget_test";
+    std::filesystem::remove_all(dir);
+    std::string value(100, 'v');
+    auto file_size = 24 + 1 + value.size();  // Header, one-byte key, value.
+    cache_store cache{cache_options{.directory = dir, .disk_budget = 3 * file_size}};
+    auto path_of = [&](std::string_view key) { return cache.path_for(std::as_bytes(std::span{key})); };
+
+    auto now = std::filesystem::file_time_type::clock::now();
+    for (std::string_view key : {"a", "b", "c"}) {
+        cache.put(key, bytes_of(value));
+    }
+    std::filesystem::last_write_time(path_of("a"), now - std::chrono::seconds{30});
+    std::filesystem::last_write_time(path_of("b"), now - std::chrono::seconds{20});
+    std::filesystem::last_write_time(path_of("c"), now - std::chrono::seconds{10});
+    REQUIRE(cache.stats().disk_evictions == 0);
+
+    // A disk hit makes "a" the most recently used, so "b" goes first.
+    cache.clear_memory();
+    REQUIRE(cache.get("a") != nullptr);
+    cache.put("d", bytes_of(value));
+    REQUIRE(std::filesystem::exists(path_of("a")));
+    REQUIRE_FALSE(std::filesystem::exists(path_of("b")));
+    REQUIRE(std::filesystem::exists(path_of("c")));
+    REQUIRE(std::filesystem::exists(path_of("d")));
+    REQUIRE(cache.stats().disk_evictions == 1);
+
+    // Files of another store (or another process) count once it rescans.
+    cache_store other{cache_options{.directory = dir, .disk_budget = 2 * file_size}};
+    other.put("e", bytes_of(value));
+    size_t files = 0;
+    for ([[maybe_unused]] const auto& f : std::filesystem::directory_iterator{dir}) {
+        ++files;
+    }
+    REQUIRE(files == 2);
+    REQUIRE(std::filesystem::exists(path_of("e")));
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("cache_store serves plugins through the C table", "[plugin][cache]") {
+    cache_store cache;
+    Q_cache* table = cache.table();
+    std::string_view key = "tables";
+    std::string_view value = "cdf";
+
+    Q_cache_blob blob{};
+    REQUIRE(table->get(table->host_data, key.data(), key.size(), &blob) == 0);
+    table->put(table->host_data, key.data(), key.size(), value.data(), value.size());
+    REQUIRE(table->get(table->host_data, key.data(), key.size(), &blob) == 1);
+    REQUIRE(std::string_view{static_cast<const char*>(blob.data), blob.size} == value);
+    table->release(table->host_data, &blob);
+    REQUIRE(blob.token == nullptr);
+
+    // Exceptions must not cross the C boundary: a put too large to copy is dropped.
+    table->put(table->host_data, "huge", 4, value.data(), size_t{1} << 63);
+    REQUIRE(table->get(table->host_data, "huge", 4, &blob) == 0);
+    REQUIRE(blob.token == nullptr);
+}
+
+// ============================================================================
+// param_registry tests
+// ============================================================================
+
+namespace {
+
+/// @brief Declares two parameters and records what the host sets.
+struct param_plugin {
+    static constexpr param_desc k_params[] = {
+        {"max_bounces", "Bounces.", Q_PARAM_INT, 5, 1, 16},
+        {"exposure", "Exposure.", Q_PARAM_FLOAT, 1.0, 0.01, 100.0},
+    };
+    std::vector<std::pair<uint32_t, double>> sets;
+
+    [[nodiscard]] std::span<const param_desc> params() const noexcept { return k_params; }
+    void set_param(uint32_t index, double value) { sets.emplace_back(index, value); }
+};
+
+}  // namespace
+
+TEST_CASE("parse_assignment accepts numbers and booleans", "[plugin][params]") {
+    auto a = parse_assignment(" max_bounces = 8 ");
+    REQUIRE(a.has_value());
+    REQUIRE(a->name == "max_bounces");
+    REQUIRE(a->value == 8.0);
+    REQUIRE(parse_assignment("exposure 0.5")->value == 0.5);
+    REQUIRE(parse_assignment("denoise=on")->value == 1.0);
+    REQUIRE(parse_assignment("denoise=no")->value == 0.0);
+
+    REQUIRE(parse_assignment("max_bounces").error() == param_error::bad_syntax);
+    REQUIRE(parse_assignment("=3").error() == param_error::bad_syntax);
+    REQUIRE(parse_assignment("max_bounces=lots").error() == param_error::bad_value);
+    REQUIRE(parse_assignment("max_bounces=3x").error() == param_error::bad_value);
+    REQUIRE(to_string(param_error::unknown_param) == "unknown parameter");
+}
+
+TEST_CASE("param_registry applies changed values, coerced to their declarations", "[plugin][params]") {
+    param_registry params;
+    REQUIRE(params.set("max_bounces=7.6").has_value());  // Any name before a plugin is seen.
+    REQUIRE(params.set("later", 1.0).has_value());
+
+    param_plugin plugin;
+    REQUIRE(params.apply(plugin, true) == 1);
+    REQUIRE(plugin.sets == std::vector<std::pair<uint32_t, double>>{{0, 8.0}});
+    REQUIRE(params.get("max_bounces") == 8.0);
+    REQUIRE(params.get("exposure") == 1.0);  // Declared default.
+    REQUIRE_FALSE(params.get("nope").has_value());
+
+    // Only changes are applied, clamped to the declared range.
+    REQUIRE(params.set("exposure", 500.0).has_value());
+    REQUIRE(params.set("max_bounces", 8.0).has_value());  // Unchanged.
+    REQUIRE(params.pending());
+    REQUIRE(params.apply(plugin) == 1);
+    REQUIRE(plugin.sets.back() == std::pair<uint32_t, double>{1, 100.0});
+    REQUIRE_FALSE(params.pending());
+    REQUIRE(params.apply(plugin) == 0);
+
+    REQUIRE(params.set("bogus", 1.0).error() == param_error::unknown_param);
+
+    // A reloaded plugin gets every value again.
+    param_plugin reloaded;
+    REQUIRE(params.apply(reloaded, true) == 2);
+}
+
+TEST_CASE("param_registry reloads a watched file when it changes", "[plugin][params]") {
+    auto path = std::filesystem::temp_directory_path() / "quasi_params_test.params";
+    std::ofstream{path} << "# Quality\nmax_bounces = 3\n\nexposure = 2  # brighter\n";
+
+    param_registry params;
+    REQUIRE(params.watch_file(path) == 2);
+    REQUIRE(params.get("max_bounces") == 3.0);
+    REQUIRE(params.poll_file() == false);
+
+    std::ofstream{path} << "max_bounces = 12\n";
+    std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds{1});
+    REQUIRE(params.poll_file() == true);
+    REQUIRE(params.get("max_bounces") == 12.0);
+
+    // A bad line leaves every value as it was.
+    std::ofstream{path} << "max_bounces = 4\nexposure\n";
+    std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds{2});
+    REQUIRE(params.poll_file().error() == param_error::bad_syntax);
+    REQUIRE(params.get("max_bounces") == 12.0);
+
+    REQUIRE(params.load_file(path.string() + ".missing").error() == param_error::open_failed);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("param_socket sets and lists values for local clients", "[plugin][params]") {
+    auto path = std::filesystem::temp_directory_path() / "quasi_params_test.sock";
+    auto control = param_socket::listen(path);
+    REQUIRE(control.has_value());
+
+    param_registry params;
+    param_plugin plugin;
+    params.apply(plugin, true);
+
+    int client = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(client >= 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    REQUIRE(::connect(client, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0);
+    std::string_view commands = "max_bounces=9\nbogus=1\nget max_bounces\nlist\n";
+    REQUIRE(::write(client, commands.data(), commands.size()) == static_cast<ssize_t>(commands.size()));
+    ::shutdown(client, SHUT_WR);
+
+    REQUIRE(control->poll(params) == 4);
+    REQUIRE(params.apply(plugin) == 1);
+    REQUIRE(plugin.sets.back() == std::pair<uint32_t, double>{0, 9.0});
+
+    std::string reply;
+    char buffer[256];
+    for (ssize_t n; (n = ::read(client, buffer, sizeof(buffer))) > 0;) {
+        reply.append(buffer, static_cast<size_t>(n));
+    }
+    ::close(client);
+    REQUIRE(reply ==
+            "ok\n"
+            "error: unknown parameter\n"
+            "max_bounces=9\nok\n"
+            "max_bounces=9 int [1, 16] Bounces.\n"
+            "exposure=1 float [0.01, 100] Exposure.\n"
+            "ok\n");
+
+    control = std::unexpected{param_error::socket_failed};  // Closes and removes the socket.
+    REQUIRE_FALSE(std::filesystem::exists(path));
+}
+
+TEST_CASE("param_socket replaces only a stale socket", "[plugin][params]") {
+    auto path = std::filesystem::temp_directory_path() / "quasi_params_stale_test.sock";
+    std::filesystem::remove(path);
+
+    // A live socket belongs to another host and is left alone.
+    auto first = param_socket::listen(path);
+    REQUIRE(first.has_value());
+    REQUIRE(param_socket::listen(path).error() == param_error::socket_in_use);
+
+    // A socket whose listener is gone is replaced.
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    first = std::unexpected{param_error::socket_failed};
+    int orphan = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(::bind(orphan, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0);
+    ::close(orphan);  // Leaves the file behind, as a crashed host would.
+    REQUIRE(std::filesystem::is_socket(path));
+    auto second = param_socket::listen(path);
+    REQUIRE(second.has_value());
+    second = std::unexpected{param_error::socket_failed};
+
+    // Any other file is never deleted.
+    std::ofstream{path} << "notes";
+    REQUIRE(param_socket::listen(path).error() == param_error::path_exists);
+    REQUIRE(std::filesystem::is_regular_file(path));
+    std::filesystem::remove(path);
+}
+
+// ============================================================================
+// render_server tests
+// ============================================================================
+
+TEST_CASE("parse_render_job reads every key", "[plugin][server]") {
+    auto job = parse_render_job(
+        "render id=shot1 plugin=/lib/cpu.so size=320x240 spp=64 eye=0,1,3.5 target=0,1,0 fov=35 "
+        "out=/tmp/shot1.exr aovs=1 progress=16 param.max_bounces=8");
+    REQUIRE(job.has_value());
+    REQUIRE(job->id == "shot1");
+    REQUIRE(job->plugin == "/lib/cpu.so");
+    REQUIRE(job->width == 320);
+    REQUIRE(job->height == 240);
+    REQUIRE(job->spp == 64);
+    REQUIRE(job->camera.position[2] == 3.5f);
+    REQUIRE(job->camera.target[1] == 1.0f);
+    REQUIRE(job->camera.up[1] == 1.0f);
+    REQUIRE(job->camera.fov == 35.0f);
+    REQUIRE(job->output == "/tmp/shot1.exr");
+    REQUIRE(job->aovs);
+    REQUIRE(job->progress == 16);
+    REQUIRE(job->params.size() == 1);
+    REQUIRE(job->params[0].name == "max_bounces");
+    REQUIRE(job->params[0].value == 8.0);
+
+    auto defaults = parse_render_job("render");
+    REQUIRE(defaults.has_value());
+    REQUIRE(defaults->camera.fov == 0.0f);  // The plugin's own camera.
+    REQUIRE(defaults->output.empty());
+    REQUIRE(defaults->seed == 0);
+    REQUIRE(defaults->cache);
+
+    auto uncached = parse_render_job("render seed=7 cache=0");
+    REQUIRE(uncached.has_value());
+    REQUIRE(uncached->seed == 7);
+    REQUIRE_FALSE(uncached->cache);
+
+    REQUIRE(parse_render_job("rendering").error() == job_error::bad_syntax);
+    REQUIRE(parse_render_job("render spp").error() == job_error::bad_syntax);
+    REQUIRE(parse_render_job("render color=red").error() == job_error::unknown_key);
+    REQUIRE(parse_render_job("render spp=0").error() == job_error::bad_value);
+    REQUIRE(parse_render_job("render spp=2.5").error() == job_error::bad_value);
+    REQUIRE(parse_render_job("render size=64").error() == job_error::bad_value);
+    REQUIRE(parse_render_job("render eye=0,1").error() == job_error::bad_value);
+    REQUIRE(parse_render_job("render eye=0,1,3").error() == job_error::bad_value);  // No target.
+}
+
+TEST_CASE("instance_lru keeps the most recently used instances", "[plugin][server]") {
+    int alive = 0;
+    struct instance {
+        int& alive;
+        std::string key;
+        instance(int& a, std::string k) : alive{a}, key{std::move(k)} { ++alive; }
+        ~instance() { --alive; }
+    };
+    instance_lru<instance> warm{2};
+    auto make = [&](std::string key) { return [&alive, key] { return std::make_unique<instance>(alive, key); }; };
+
+    REQUIRE(warm.acquire("a", make("a"))->key == "a");
+    REQUIRE(warm.acquire("b", make("b"))->key == "b");
+    REQUIRE(warm.acquire("a", make("a")) != nullptr);  // Now b is the oldest.
+    REQUIRE(warm.acquire("c", make("c"))->key == "c");
+    REQUIRE(alive == 2);
+    REQUIRE(warm.hits() == 1);
+    REQUIRE(warm.misses() == 3);
+    REQUIRE(warm.evictions() == 1);
+
+    warm.acquire("a", make("a"));
+    REQUIRE(warm.hits() == 2);  // a survived; b went.
+    REQUIRE(warm.acquire("b", [] { return std::unique_ptr<instance>{}; }) == nullptr);
+    REQUIRE(warm.size() == 1);  // Room was made before the failed create.
+
+    warm.clear();
+    REQUIRE(alive == 0);
+}
+
+// ============================================================================
+// result_cache tests
+// ============================================================================
+
+TEST_CASE("result_cache keys cover every input but parameter order", "[plugin][results]") {
+    render_inputs inputs{
+        .build  = 0x1234,
+        .width  = 64,
+        .height = 32,
+        .camera = {},
+        .seed   = 0,
+        .params = {{"max_bounces", 8.0}, {"exposure", 2.0}},
+    };
+    auto key = result_cache::key(inputs);
+
+    auto reordered = inputs;
+    std::swap(reordered.params[0], reordered.params[1]);
+    REQUIRE(result_cache::key(reordered) == key);
+
+    auto changed = inputs;
+    changed.build = 0x1235;
+    REQUIRE(result_cache::key(changed) != key);
+    changed = inputs;
+    changed.height = 33;
+    REQUIRE(result_cache::key(changed) != key);
+    changed = inputs;
+    changed.camera.fov = 40.0f;
+    REQUIRE(result_cache::key(changed) != key);
+    changed = inputs;
+    changed.seed = 1;
+    REQUIRE(result_cache::key(changed) != key);
+    changed = inputs;
+    changed.params[1].value = 2.5;
+    REQUIRE(result_cache::key(changed) != key);
+}
+
+TEST_CASE("result_cache stores, finds and resumes renders", "[plugin][results]") {
+    cache_store store{cache_options{}};
+    result_cache results{store};
+    REQUIRE_FALSE(results.find("missing").has_value());
+
+    cached_render render{.width = 2, .height = 1, .samples = 4, .rgba = {1, 1, 1, 1, 0, 0, 0, 1}};
+    results.store("k", render);
+    auto hit = results.find("k");
+    REQUIRE(hit.has_value());
+    REQUIRE(hit->width == 2);
+    REQUIRE(hit->samples == 4);
+    REQUIRE(hit->rgba == render.rgba);
+
+    // Four more samples of a different mean land halfway between.
+    std::vector<float> added = {0, 0, 0, 1, 1, 1, 1, 1};
+    result_cache::merge(*hit, added, 4);
+    REQUIRE(hit->samples == 8);
+    REQUIRE(hit->rgba[0] == 0.5f);
+    REQUIRE(hit->rgba[4] == 0.5f);
+    REQUIRE(hit->rgba[3] == 1.0f);
+
+    std::vector<float> wrong_size = {0, 0, 0, 1};
+    result_cache::merge(*hit, wrong_size, 4);
+    REQUIRE(hit->samples == 8);
+
+    REQUIRE(result_cache::resume_salt(7, 0) == 7);
+    REQUIRE(result_cache::resume_salt(7, 8) != result_cache::resume_salt(7, 16));
+    // Not additive: one seed's resumed pass does not reuse another seed's salt.
+    REQUIRE(result_cache::resume_salt(7, 1) != result_cache::resume_salt(7 + 0x9E3779B9u, 0));
+    REQUIRE(result_cache::resume_salt(7, 1) != result_cache::resume_salt(8, 1));
+}
+
+// ============================================================================
+// call_trace tests
+// ============================================================================
+
+namespace {
+
+recorded_call make_render(uint64_t time_ns, uint32_t width, float x, uint32_t dirty) {
+    recorded_call c;
+    c.kind         = call_kind::render;
+    c.time_ns      = time_ns;
+    c.width        = width;
+    c.height       = width / 2;
+    c.camera.position[0] = x;
+    c.camera.fov   = 40.0f;
+    c.camera_dirty = dirty;
+    return c;
+}
+
+/// @brief Stands in for a loader and remembers what it was asked to do.
+struct fake_plugin {
+    std::vector<float>          updates;
+    std::vector<recorded_call>  renders;
+    bool                        had_drawable = true;
+
+    void update(float dt) { updates.push_back(dt); }
+
+    void render(Q_render_frame* frame) {
+        recorded_call c;
+        c.kind         = call_kind::render;
+        c.width        = frame->width;
+        c.height       = frame->height;
+        c.camera       = frame->camera;
+        c.camera_dirty = frame->camera_dirty;
+        c.row_begin    = frame->row_begin;
+        c.row_end      = frame->row_end;
+        c.sample_salt  = frame->sample_salt;
+        renders.push_back(c);
+        had_drawable = had_drawable && frame->drawable != nullptr;
+    }
+};
+
+}  // namespace
+
+TEST_CASE("call_trace round-trips recorded calls", "[plugin][call_trace]") {
+    std::ostringstream out;
+    call_recorder recorder{out, 640, 480};
+
+    recorded_call update;
+    update.time_ns    = 1000;
+    update.delta_time = 0.016f;
+    recorder.record(update);
+    recorder.record(make_render(2000, 640, 1.0f, 1));
+    recorder.record(make_render(300'000'000, 640, 1.0f, 0));  // Same camera and size.
+    recorder.record(make_render(300'000'100, 800, 2.5f, 1));  // Resize and move.
+    REQUIRE(recorder.calls() == 4);
+    REQUIRE(recorder.flush());
+
+    std::istringstream in{out.str()};
+    auto trace = call_trace::read(in);
+    REQUIRE(trace);
+    REQUIRE(trace->viewport_width == 640);
+    REQUIRE(trace->viewport_height == 480);
+    REQUIRE(trace->calls.size() == 4);
+    REQUIRE(trace->render_count() == 3);
+    REQUIRE(trace->duration_ns() == 300'000'100);
+
+    const auto& c = trace->calls;
+    REQUIRE(c[0].kind == call_kind::update);
+    REQUIRE(c[0].time_ns == 1000);
+    REQUIRE(c[0].delta_time == 0.016f);
+    REQUIRE(c[2].kind == call_kind::render);
+    REQUIRE(c[2].time_ns == 300'000'000);
+    REQUIRE(c[2].width == 640);
+    REQUIRE(c[2].height == 320);
+    REQUIRE(c[2].camera.position[0] == 1.0f);
+    REQUIRE(c[2].camera_dirty == 0);
+    REQUIRE(c[3].width == 800);
+    REQUIRE(c[3].camera.position[0] == 2.5f);
+    REQUIRE(c[3].camera_dirty == 1);
+}
+
+TEST_CASE("call_trace round-trips each render's band and salt", "[plugin][call_trace]") {
+    std::ostringstream out;
+    call_recorder recorder{out, 64, 64};
+    auto band = make_render(0, 64, 0.0f, 1);
+    band.row_begin   = 8;
+    band.row_end     = 24;
+    band.sample_salt = 0xDEADBEEF;
+    recorder.record(band);
+    band.time_ns = 10;
+    recorder.record(band);                          // Unchanged band.
+    recorder.record(make_render(20, 64, 0.0f, 0));  // Back to every row, unsalted.
+
+    std::istringstream in{out.str()};
+    auto trace = call_trace::read(in);
+    REQUIRE(trace);
+    REQUIRE(trace->calls.size() == 3);
+    for (size_t i = 0; i < 2; ++i) {
+        REQUIRE(trace->calls[i].row_begin == 8);
+        REQUIRE(trace->calls[i].row_end == 24);
+        REQUIRE(trace->calls[i].sample_salt == 0xDEADBEEF);
+    }
+    REQUIRE(trace->calls[2].row_begin == 0);
+    REQUIRE(trace->calls[2].row_end == 0);
+    REQUIRE(trace->calls[2].sample_salt == 0);
+
+    fake_plugin plugin;
+    replay(*trace, plugin, replay_options{.present = false});
+    REQUIRE(plugin.renders[0].row_begin == 8);
+    REQUIRE(plugin.renders[0].row_end == 24);
+    REQUIRE(plugin.renders[0].sample_salt == 0xDEADBEEF);
+}
+
+TEST_CASE("call_trace stores a still camera in a few bytes", "[plugin][call_trace]") {
+    std::ostringstream out;
+    call_recorder recorder{out, 64, 64};
+    recorder.record(make_render(0, 64, 0.0f, 1));
+    auto first = out.str().size();
+    for (uint64_t i = 1; i <= 100; ++i) {
+        recorder.record(make_render(i * 16'000'000, 64, 0.0f, 0));
+    }
+    REQUIRE(out.str().size() - first <= 100 * 5);
+}
+
+TEST_CASE("call_trace rejects damaged input", "[plugin][call_trace]") {
+    {
+        std::istringstream in{"NOPE"};
+        REQUIRE(call_trace::read(in).error() == trace_error::bad_magic);
+    }
+
+    std::ostringstream out;
+    call_recorder recorder{out, 64, 64};
+    recorder.record(make_render(5, 64, 1.0f, 1));
+    auto bytes = out.str();
+    {
+        std::istringstream in{bytes.substr(0, bytes.size() - 3)};
+        REQUIRE(call_trace::read(in).error() == trace_error::truncated);
+    }
+    {
+        auto bad = bytes;
+        bad[16] = 0x0F;  // First record tag.
+        std::istringstream in{bad};
+        REQUIRE(call_trace::read(in).error() == trace_error::bad_record);
+    }
+    {
+        auto newer = bytes;
+        newer[4] = 99;  // Version.
+        std::istringstream in{newer};
+        REQUIRE(call_trace::read(in).error() == trace_error::unsupported_version);
+    }
+    {
+        auto zero = bytes;
+        zero[4] = 0;
+        std::istringstream in{zero};
+        REQUIRE(call_trace::read(in).error() == trace_error::unsupported_version);
+    }
+    REQUIRE(call_trace::load("/nonexistent/session.qct").error() == trace_error::open_failed);
+    REQUIRE(std::string_view{to_string(trace_error::truncated)} == "trace is truncated");
+}
+
+TEST_CASE("replay drives a plugin through the recorded calls", "[plugin][call_trace]") {
+    call_trace trace;
+    recorded_call update;
+    update.delta_time = 0.5f;
+    trace.calls = {update, make_render(0, 32, 1.0f, 1), update, make_render(0, 48, 2.0f, 0)};
+
+    fake_plugin plugin;
+    auto result = replay(trace, plugin);
+    REQUIRE(result.updates == 2);
+    REQUIRE(result.renders == 2);
+    REQUIRE(plugin.updates == std::vector<float>{0.5f, 0.5f});
+    REQUIRE(plugin.renders.size() == 2);
+    REQUIRE(plugin.renders[1].width == 48);
+    REQUIRE(plugin.renders[1].height == 24);
+    REQUIRE(plugin.renders[1].camera.position[0] == 2.0f);
+    REQUIRE(plugin.renders[0].camera_dirty == 1);
+    REQUIRE(plugin.had_drawable);
+
+    fake_plugin headless;
+    replay(trace, headless, replay_options{.present = false});
+    REQUIRE_FALSE(headless.had_drawable);
+}
+
+TEST_CASE("replay at original timing keeps the recorded pace", "[plugin][call_trace]") {
+    call_trace trace;
+    trace.calls = {make_render(0, 8, 0.0f, 1), make_render(20'000'000, 8, 0.0f, 0)};
+
+    fake_plugin plugin;
+    auto result = replay(trace, plugin, replay_options{.timing = replay_timing::original});
+    REQUIRE(result.renders == 2);
+    REQUIRE(result.wall_ns >= 20'000'000);
+
+    fake_plugin fast;
+    auto quick = replay(trace, fast);
+    REQUIRE(quick.wall_ns < 20'000'000);
+}
+
+// ============================================================================
+// reload_stats tests
+// ============================================================================
+
+TEST_CASE("reload phases have distinct names", "[plugin][reload]") {
+    for (size_t i = 0; i < k_reload_phase_count; ++i) {
+        for (size_t j = i + 1; j < k_reload_phase_count; ++j) {
+            REQUIRE(to_string(static_cast<reload_phase>(i)) != to_string(static_cast<reload_phase>(j)));
+        }
+    }
+    REQUIRE(to_string(reload_phase::first_frame) == "first_frame");
+}
+
+TEST_CASE("failed reload records the phases it reached", "[plugin][reload]") {
+    manager mgr{"/nonexistent/libmissing.so"};
+    mgr.set_settle_time(std::chrono::milliseconds{1});
+
+    REQUIRE_FALSE(Q::async::sync_wait(mgr.reload_async()).has_value());
+
+    const auto& stats = mgr.stats();
+    REQUIRE(stats.reload_count == 1);
+    REQUIRE(stats.failure_count == 1);
+    REQUIRE(stats.phase(reload_phase::detect).count() == 0);  // Not started by the watcher.
+    REQUIRE(stats.phase(reload_phase::unload).count() == 1);
+    REQUIRE(stats.phase(reload_phase::settle).count() == 1);
+    REQUIRE(stats.phase(reload_phase::settle).min() >= 1'000'000);
+    REQUIRE(stats.phase(reload_phase::copy).count() == 0);
+    REQUIRE(stats.phase(reload_phase::first_frame).count() == 0);
+    REQUIRE(stats.edit_to_pixel.count() == 0);
+
+    std::ostringstream json;
+    stats.write_json(json);
+    REQUIRE(json.str().starts_with("{\"reloads\": 1, \"successes\": 0, \"failures\": 1"));
+    REQUIRE(json.str().find("\"first_frame\": {\"count\": 0") != std::string::npos);
+}
+
+// ============================================================================
+// frame_splitter tests
+// ============================================================================
+
+namespace {
+
+/// @brief Row-band backend that renders a constant value, optionally slowly.
+struct band_backend {
+    float                     value = 0.0f;
+    std::chrono::microseconds per_row{0};
+    uint32_t                  width  = 0;
+    uint32_t                  height = 0;
+    std::vector<float>        mean;   // Running mean, RGBA per pixel.
+    std::vector<uint32_t>     count;  // Samples per row.
+    std::vector<uint32_t>     salts;
+    uint32_t                  samples_per_call = 0;  // 0 renders one sample and reports nothing.
+    bool                      reset_pending    = false;
+    bool                      had_drawable     = false;
+
+    void render(Q_render_frame* frame) {
+        bool reset = frame->width != width || frame->height != height || frame->camera_dirty || reset_pending;
+        if (reset) {
+            width  = frame->width;
+            height = frame->height;
+            mean.assign(size_t{width} * height * 4, 0.0f);
+            count.assign(height, 0);
+            reset_pending = false;
+        }
+        had_drawable = had_drawable || frame->drawable != nullptr;
+        salts.push_back(frame->sample_salt);
+        uint32_t samples = std::max(samples_per_call, 1u);
+        for (uint32_t y = frame->row_begin; y < frame->row_end; ++y) {
+            for (size_t i = size_t{y} * width * 4; i < size_t{y + 1} * width * 4; ++i) {
+                mean[i] += (value - mean[i]) * samples / static_cast<float>(count[y] + samples);
+            }
+            count[y] += samples;
+        }
+        if (samples_per_call > 0) {
+            frame->samples_added      = samples_per_call;
+            frame->accumulation_reset = reset ? 1 : 0;
+        }
+        std::this_thread::sleep_for(per_row * (frame->row_end - frame->row_begin));
+    }
+
+    readback_result readback() {
+        auto* data = static_cast<float*>(std::malloc(mean.size() * sizeof(float)));
+        std::copy(mean.begin(), mean.end(), data);
+        return readback_result{.data = data, .width = width, .height = height, .channels = 4};
+    }
+
+    void readback_free(readback_result* result) {
+        std::free(result->data);
+        result->data = nullptr;
+    }
+
+    bool supports_row_bands() const { return true; }
+    bool supports_readback() const { return true; }
+};
+
+}  // namespace
+
+TEST_CASE("frame_splitter composites rows weighted by samples", "[plugin][splitter]") {
+    band_backend fast;
+    band_backend slow;
+    fast.value   = 1.0f;
+    slow.value   = 3.0f;
+    slow.per_row = std::chrono::microseconds{50};
+    basic_frame_splitter<band_backend> split{{&fast, &slow}};
+    REQUIRE(basic_frame_splitter<band_backend>::supports(fast));
+
+    std::vector<uint16_t> image(8 * 32 * 4);
+    REQUIRE_FALSE(split.present(image));  // Nothing rendered yet.
+    Q_render_frame frame{};
+    frame.width        = 8;
+    frame.height       = 32;
+    frame.camera_dirty = 1;
+    for (int i = 0; i < 6; ++i) {
+        split.render(&frame);
+        frame.camera_dirty = 0;
+
+        auto bands = split.bands();
+        REQUIRE(bands[0].begin == 0);
+        REQUIRE(bands[0].end == bands[1].begin);
+        REQUIRE(bands[1].end == 32);
+    }
+    REQUIRE_FALSE(fast.had_drawable);
+    REQUIRE(fast.salts[0] != slow.salts[0]);
+
+    // Every row got one sample per frame, from one backend or the other.
+    auto hdr = split.composite();
+    REQUIRE(hdr.size() == 8 * 32 * 4);
+    bool mixed = false;
+    for (uint32_t y = 0; y < 32; ++y) {
+        REQUIRE(split.row_samples(y) == 6);
+        REQUIRE(fast.count[y] + slow.count[y] == 6);
+        float expected = (1.0f * fast.count[y] + 3.0f * slow.count[y]) / 6.0f;
+        REQUIRE(std::abs(hdr[y * 8 * 4] - expected) < 1e-5f);
+        mixed = mixed || (fast.count[y] > 0 && slow.count[y] > 0);
+    }
+    REQUIRE(mixed);  // The slow backend's band shrank.
+    REQUIRE(image[0] == 0);  // Nothing is presented unless asked for.
+    REQUIRE(split.present(image));
+    REQUIRE(image[0] != 0);
+    std::vector<uint16_t> small(8 * 4);
+    REQUIRE_FALSE(split.present(small));
+
+    // A camera change restarts every row.
+    frame.camera_dirty = 1;
+    split.render(&frame);
+    for (uint32_t y = 0; y < 32; ++y) {
+        REQUIRE(split.row_samples(y) == 1);
+    }
+}
+
+TEST_CASE("frame_splitter derives each band's salt from the frame's", "[plugin][splitter]") {
+    band_backend a;
+    band_backend b;
+    basic_frame_splitter<band_backend> split{{&a, &b}, splitter_options{.concurrent = false}};
+
+    Q_render_frame frame{};
+    frame.width  = 4;
+    frame.height = 16;
+    split.render(&frame);
+    frame.sample_salt = 0xC0FFEEu;  // E.g. result_cache::resume_salt of a resumed pass.
+    split.render(&frame);
+
+    REQUIRE(a.salts.size() == 2);
+    REQUIRE(b.salts.size() == 2);
+    REQUIRE(a.salts[0] == 0);  // An unsalted frame keeps the first band unsalted.
+    REQUIRE(a.salts[1] != a.salts[0]);
+    REQUIRE(b.salts[1] != b.salts[0]);
+    REQUIRE(a.salts[1] != b.salts[1]);
+    REQUIRE(a.salts[1] == Q::gpu::derive_salt(0xC0FFEEu, 0));
+    REQUIRE(b.salts[1] == Q::gpu::derive_salt(0xC0FFEEu, 1));
+
+    // A splitter inside a splitter: no band of one matches a band of another.
+    std::vector<uint32_t> nested;
+    for (uint32_t outer = 0; outer < 4; ++outer) {
+        for (uint32_t inner = 0; inner < 4; ++inner) {
+            nested.push_back(Q::gpu::derive_salt(Q::gpu::derive_salt(0, outer), inner));
+        }
+    }
+    std::sort(nested.begin(), nested.end());
+    REQUIRE(std::adjacent_find(nested.begin(), nested.end()) == nested.end());
+}
+
+TEST_CASE("frame_splitter counts the samples backends report", "[plugin][splitter]") {
+    band_backend a;
+    band_backend b;
+    a.value            = 1.0f;
+    b.value            = 3.0f;
+    a.samples_per_call = 4;
+    b.samples_per_call = 2;
+    basic_frame_splitter<band_backend> split{{&a, &b}, splitter_options{.concurrent = false}};
+
+    Q_render_frame frame{};
+    frame.width        = 4;
+    frame.height       = 16;
+    frame.camera_dirty = 1;
+    for (int i = 0; i < 3; ++i) {
+        split.render(&frame);
+        frame.camera_dirty = 0;
+    }
+    auto check = [&] {
+        auto hdr = split.composite();
+        for (uint32_t y = 0; y < 16; ++y) {
+            REQUIRE(split.row_samples(y) == a.count[y] + b.count[y]);
+            float expected = (1.0f * a.count[y] + 3.0f * b.count[y]) / static_cast<float>(a.count[y] + b.count[y]);
+            REQUIRE(std::abs(hdr[y * 4 * 4] - expected) < 1e-5f);
+        }
+    };
+    check();
+    REQUIRE(split.row_samples(0) >= 6);
+
+    // A backend that restarts on its own discards its rows outside the band too.
+    a.reset_pending = true;
+    split.render(&frame);
+    check();
+}
+
+TEST_CASE("frame_splitter gives faster backends more rows", "[plugin][splitter]") {
+    band_backend fast;
+    band_backend slow;
+    fast.per_row = std::chrono::microseconds{20};
+    slow.per_row = std::chrono::microseconds{200};
+    basic_frame_splitter<band_backend> split{{&slow, &fast}, splitter_options{.concurrent = false}};
+
+    Q_render_frame frame{};
+    frame.width  = 4;
+    frame.height = 64;
+    split.render(&frame);
+    REQUIRE(split.bands()[0].rows() == 32);  // Equal until measured.
+    for (int i = 0; i < 20; ++i) {
+        split.render(&frame);
+    }
+
+    auto bands = split.bands();
+    REQUIRE(bands[0].rows() >= 4);  // min_rows keeps it measured.
+    REQUIRE(bands[1].rows() > 3 * bands[0].rows());
+    REQUIRE(split.throughput()[1] > split.throughput()[0]);
+}
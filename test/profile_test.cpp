@@ -0,0 +1,270 @@
+/// @file profile_test.cpp
+/// @brief Unit tests for the profiling module.
+///
+/// Hardware counters are often missing (VMs, CI containers), so these tests
+/// check that unavailable counters stay unavailable rather than requiring them.
+
+#include <quasi/async/scheduler.hpp>
+#include <quasi/profile/profile.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Q::profile;
+
+namespace {
+
+/// @brief Work the optimizer cannot remove.
+uint64_t spin(uint64_t n) {
+    volatile uint64_t acc = 0;
+    for (uint64_t i = 0; i < n; ++i) {
+        acc = acc + i * i;
+    }
+    return acc;
+}
+
+const stage_stats* find(const std::vector<stage_stats>& stages, std::string_view name) {
+    for (const auto& s : stages) {
+        if (s.name == name) return &s;
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+// ============================================================================
+// perf_counters tests
+// ============================================================================
+
+TEST_CASE("counter_values subtract and accumulate with validity", "[profile][counters]") {
+    counter_values a;
+    a.value[0] = 100;
+    a.value[5] = 50;
+    a.valid = 0b100001;
+    counter_values b;
+    b.value[0] = 40;
+    b.value[5] = 20;
+    b.valid = 0b100000;
+
+    auto d = a - b;
+    REQUIRE(d.valid == 0b100000);
+    REQUIRE(d[counter::task_clock] == 30);
+    REQUIRE_FALSE(d.has(counter::cycles));
+
+    counter_values total;
+    total += a - counter_values{.value = {}, .valid = a.valid};
+    total += d;
+    REQUIRE(total.valid == 0b100000);  // Narrowed to what every sample measured.
+    REQUIRE(total[counter::task_clock] == 80);
+}
+
+TEST_CASE("counter names are distinct", "[profile][counters]") {
+    for (size_t i = 0; i < k_counter_count; ++i) {
+        for (size_t j = i + 1; j < k_counter_count; ++j) {
+            REQUIRE(to_string(static_cast<counter>(i)) != to_string(static_cast<counter>(j)));
+        }
+    }
+}
+
+TEST_CASE("perf_counters reads only what it opened", "[profile][counters]") {
+    auto& counters = perf_counters::this_thread();
+    REQUIRE(&counters == &perf_counters::this_thread());
+
+    auto before = counters.read();
+    spin(2'000'000);
+    auto after = counters.read();
+    REQUIRE(before.valid == counters.available());
+    REQUIRE(after.valid == counters.available());
+
+    auto d = after - before;
+    if (d.has(counter::instructions)) {
+        REQUIRE(d[counter::instructions] > 2'000'000);
+    }
+    if (d.has(counter::task_clock)) {
+        REQUIRE(d[counter::task_clock] > 0);
+    }
+
+    // Another thread opens its own set.
+    const perf_counters* other = nullptr;
+    std::thread{[&] { other = &perf_counters::this_thread(); }}.join();
+    REQUIRE(other != &counters);
+}
+
+// ============================================================================
+// histogram tests
+// ============================================================================
+
+TEST_CASE("histogram buckets tile the value range", "[profile][histogram]") {
+    REQUIRE(histogram::bucket_of(0) == 0);
+    REQUIRE(histogram::bucket_lower(0) == 0);
+    for (size_t b = 0; b + 1 < histogram::k_bucket_count; ++b) {
+        REQUIRE(histogram::bucket_upper(b) + 1 == histogram::bucket_lower(b + 1));
+        REQUIRE(histogram::bucket_of(histogram::bucket_lower(b)) == b);
+        REQUIRE(histogram::bucket_of(histogram::bucket_upper(b)) == b);
+    }
+    REQUIRE(histogram::bucket_of(UINT64_MAX) == histogram::k_bucket_count - 1);
+
+    // Relative bucket width stays within 1/8.
+    for (uint64_t v : {9ull, 100ull, 12345ull, 1ull << 40}) {
+        size_t b = histogram::bucket_of(v);
+        auto width = histogram::bucket_upper(b) - histogram::bucket_lower(b) + 1;
+        REQUIRE(width * 8 <= histogram::bucket_lower(b));
+    }
+}
+
+TEST_CASE("histogram statistics and percentiles", "[profile][histogram]") {
+    histogram h;
+    REQUIRE(h.percentile(0.5) == 0);
+    for (uint64_t v = 1; v <= 1000; ++v) {
+        h.add(v);
+    }
+    REQUIRE(h.count() == 1000);
+    REQUIRE(h.min() == 1);
+    REQUIRE(h.max() == 1000);
+    REQUIRE(h.mean() == 500.5);
+
+    auto near = [](uint64_t got, uint64_t want) { return got * 8 >= want * 7 && got * 8 <= want * 9; };
+    REQUIRE(near(h.percentile(0.5), 500));
+    REQUIRE(near(h.percentile(0.99), 990));
+    REQUIRE(h.percentile(1.0) == 1000);
+
+    histogram other;
+    other.add(5000, 10);
+    h.merge(other);
+    REQUIRE(h.count() == 1010);
+    REQUIRE(h.max() == 5000);
+
+    std::ostringstream json;
+    other.write_json(json);
+    REQUIRE(json.str().starts_with("{\"count\": 10, \"sum\": 50000, \"min\": 5000"));
+    REQUIRE(json.str().find("\"buckets\": [[4608, 5119, 10]]") != std::string::npos);
+
+    h.clear();
+    REQUIRE(h.count() == 0);
+    REQUIRE(h.min() == 0);
+}
+
+// ============================================================================
+// profiler tests
+// ============================================================================
+
+TEST_CASE("profiler aggregates nested scopes by name", "[profile][profiler]") {
+    profiler prof;
+    for (int i = 0; i < 3; ++i) {
+        auto outer = prof.measure("outer");
+        spin(10'000);
+        {
+            auto inner = prof.measure("inner");
+            spin(10'000);
+        }
+    }
+
+    auto stages = prof.stages();
+    REQUIRE(stages.size() == 2);
+    REQUIRE(stages[0].name == "inner");  // First to finish.
+    const auto* outer = find(stages, "outer");
+    const auto* inner = find(stages, "inner");
+    REQUIRE(outer->calls == 3);
+    REQUIRE(inner->calls == 3);
+    REQUIRE(outer->wall_ns >= inner->wall_ns);
+    REQUIRE(outer->min_ns <= outer->max_ns);
+    REQUIRE(outer->counters.valid == prof.available_counters());
+    REQUIRE(prof.events().size() == 6);
+}
+
+TEST_CASE("profiler merges scopes from many threads", "[profile][profiler]") {
+    profiler prof;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 100; ++i) {
+                auto s = prof.measure("work");
+                spin(100);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    auto stages = prof.stages();
+    REQUIRE(stages.size() == 1);
+    REQUIRE(stages[0].calls == 400);
+
+    std::vector<uint32_t> threads_seen;
+    for (const auto& e : prof.events()) {
+        if (std::find(threads_seen.begin(), threads_seen.end(), e.thread) == threads_seen.end()) {
+            threads_seen.push_back(e.thread);
+        }
+    }
+    REQUIRE(threads_seen.size() == 4);
+}
+
+TEST_CASE("profiler without counters records time only", "[profile][profiler]") {
+    profiler prof{profiler_options{.counters = false}};
+    {
+        auto s = prof.measure("timed");
+        spin(1000);
+    }
+    REQUIRE(prof.available_counters() == 0);
+    auto stages = prof.stages();
+    REQUIRE(stages[0].counters.valid == 0);
+    REQUIRE(stages[0].wall_ns > 0);
+}
+
+TEST_CASE("profiler caps the trace but not the totals", "[profile][profiler]") {
+    profiler prof{profiler_options{.counters = false, .max_trace_events = 5}};
+    for (int i = 0; i < 8; ++i) {
+        prof.begin("capped");
+        prof.end();
+    }
+    REQUIRE(prof.events().size() == 5);
+    REQUIRE(prof.dropped_events() == 3);
+    REQUIRE(prof.stages()[0].calls == 8);
+
+    prof.end();  // Unbalanced end is ignored.
+    prof.reset();
+    REQUIRE(prof.stages().empty());
+    REQUIRE(prof.dropped_events() == 0);
+}
+
+TEST_CASE("profiler writes benchmark JSON and trace events", "[profile][profiler]") {
+    profiler prof{profiler_options{.counters = false}};
+    {
+        auto s = prof.measure("quote\"stage");
+    }
+
+    std::ostringstream json;
+    prof.write_stages_json(json);
+    REQUIRE(json.str().find("\"name\": \"quote\\\"stage\"") != std::string::npos);
+    REQUIRE(json.str().find("\"calls\": 1") != std::string::npos);
+    REQUIRE(json.str().find("\"cycles\": null") != std::string::npos);
+    REQUIRE(json.str().find("\"ipc\": null") != std::string::npos);
+
+    std::ostringstream trace;
+    prof.write_trace(trace);
+    REQUIRE(trace.str().starts_with("{\"displayTimeUnit\": \"ms\", \"traceEvents\": ["));
+    REQUIRE(trace.str().find("\"ph\": \"X\"") != std::string::npos);
+    REQUIRE(trace.str().find("\"args\": {\"cycles\": null") != std::string::npos);
+}
+
+TEST_CASE("scheduler records ticks in an attached profiler", "[profile][scheduler]") {
+    profiler prof{profiler_options{.counters = false}};
+    Q::async::scheduler sched;
+    sched.set_profiler(&prof);
+    sched.tick();
+    sched.tick();
+    sched.set_profiler(nullptr);
+    sched.tick();
+
+    auto stages = prof.stages();
+    REQUIRE(stages.size() == 1);
+    REQUIRE(stages[0].name == "scheduler.tick");
+    REQUIRE(stages[0].calls == 2);
+}